@@ -0,0 +1,72 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "bas/cache/decision_cache.hpp"
+
+namespace {
+
+double NsPerOp(std::chrono::steady_clock::time_point t0, std::size_t ops) {
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count() /
+         static_cast<double>(ops);
+}
+
+}  // namespace
+
+// 模拟高频回放：每个 tick 推进 1 ms，先 Prune 再按 hit_ratio 混合查询与写入。
+int main(int argc, char** argv) {
+  const std::size_t entries = argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 100000;
+  const std::size_t ticks = argc > 2 ? static_cast<std::size_t>(std::atoll(argv[2])) : 1000000;
+  const double hit_ratio = 0.7;
+
+  // TTL 远大于运行时长，稳态条目数由容量上限决定，每次写入都触发 LRU 淘汰。
+  bas::DecisionCache cache(static_cast<std::int64_t>(entries) * 4, entries);
+  bas::DecisionPackage pkg;
+  pkg.explanation = "候选索引=0；基准测试决策包";
+  pkg.fire.summary = "火力分配数=4";
+  pkg.maneuver.summary = "机动动作数=6，编队模式=集结";
+  const auto shared = std::make_shared<const bas::DecisionPackage>(pkg);
+
+  std::mt19937_64 rng(20240607ULL);
+  std::int64_t now = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < entries; ++i) {
+    cache.Put(rng(), shared, ++now);
+  }
+  std::cout << "填充 " << entries << " 条: " << std::fixed << std::setprecision(1) << NsPerOp(t0, entries)
+            << " ns/次\n";
+
+  std::vector<bas::DecisionCache::Key> recent;
+  recent.reserve(1024);
+  std::uniform_real_distribution<double> coin(0.0, 1.0);
+  std::size_t resident_hits = 0;
+  t0 = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < ticks; ++i) {
+    ++now;
+    cache.Prune(now);
+    if (!recent.empty() && coin(rng) < hit_ratio) {
+      resident_hits += cache.Get(recent[i % recent.size()], now) != nullptr ? 1 : 0;
+    } else {
+      const bas::DecisionCache::Key key = rng();
+      if (cache.Get(key, now) == nullptr) {
+        cache.Put(key, shared, now);
+      }
+      if (recent.size() < recent.capacity()) {
+        recent.push_back(key);
+      } else {
+        recent[i % recent.size()] = key;
+      }
+    }
+  }
+  const double tick_ns = NsPerOp(t0, ticks);
+
+  const bas::DecisionCacheStats& stats = cache.stats();
+  std::cout << "稳态 " << ticks << " 次 Prune+Get/Put: " << tick_ns << " ns/tick，条目=" << cache.size()
+            << "，命中=" << stats.hits << "（近期键命中 " << resident_hits << "），未命中=" << stats.misses
+            << "，淘汰=" << stats.evictions << "，过期=" << stats.expirations << "\n";
+  return EXIT_SUCCESS;
+}
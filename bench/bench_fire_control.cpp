@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "bas/decision/fire_control_engine.hpp"
+
+namespace {
+
+bas::BattlefieldSnapshot BuildEngagement(std::size_t shooters, std::size_t targets, std::uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> friendly_x(-3000.0, 3000.0);
+  std::uniform_real_distribution<double> friendly_y(-1500.0, 0.0);
+  std::uniform_real_distribution<double> hostile_y(500.0, 3500.0);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  const bas::UnitType kTypes[] = {bas::UnitType::Armor, bas::UnitType::Artillery, bas::UnitType::Infantry,
+                                  bas::UnitType::AirDefense, bas::UnitType::Command};
+
+  bas::BattlefieldSnapshot snap;
+  snap.timestamp_ms = 1000;
+  for (std::size_t i = 0; i < shooters; ++i) {
+    bas::EntityState f;
+    f.id = bas::EntityId::FromDis(1, 1, static_cast<std::uint16_t>(i + 1));
+    f.side = bas::Side::Friendly;
+    f.type = kTypes[i % 3];
+    f.pose = {friendly_x(rng), friendly_y(rng), 0.0};
+    f.weapons.push_back({"gun", 2000.0 + 2000.0 * unit(rng), 0.4 + 0.4 * unit(rng), i % 11 == 0 ? 0 : 8, 0.0,
+                         {bas::UnitType::Armor, bas::UnitType::Artillery}});
+    f.weapons.push_back({"atgm", 3500.0, 0.6 + 0.3 * unit(rng), 2, i % 7 == 0 ? 4.0 : 0.0, {bas::UnitType::Armor}});
+    snap.friendly_units.push_back(f);
+  }
+  for (std::size_t i = 0; i < targets; ++i) {
+    bas::EntityState h;
+    h.id = bas::EntityId::FromDis(2, 1, static_cast<std::uint16_t>(i + 1));
+    h.side = bas::Side::Hostile;
+    h.type = kTypes[i % 5];
+    h.pose = {friendly_x(rng), hostile_y(rng), 0.0};
+    h.speed_mps = 15.0 * unit(rng);
+    h.threat_level = unit(rng);
+    snap.hostile_units.push_back(h);
+  }
+  snap.RebuildTables();
+  return snap;
+}
+
+struct Quality {
+  double expected_kills = 0.0;
+  double total_score = 0.0;
+  std::size_t assignments = 0;
+  std::size_t max_shooters_on_target = 0;
+};
+
+// 期望毁伤数 = Σ_目标 [1 - Π(1 - Pk)]，同一目标多射手按独立事件合成。
+Quality Evaluate(const bas::FireDecision& decision) {
+  std::unordered_map<bas::EntityId, double> survive;
+  std::unordered_map<bas::EntityId, std::size_t> shooters;
+  Quality q;
+  for (const auto& a : decision.assignments) {
+    auto it = survive.emplace(a.target_id, 1.0).first;
+    it->second *= 1.0 - a.expected_kill_prob;
+    q.max_shooters_on_target = std::max(q.max_shooters_on_target, ++shooters[a.target_id]);
+    q.total_score += a.score;
+    ++q.assignments;
+  }
+  for (const auto& [id, p] : survive) {
+    q.expected_kills += 1.0 - p;
+  }
+  return q;
+}
+
+void Run(const char* label, const bas::FireControlEngine& engine, const bas::BattlefieldSnapshot& snap, int reps) {
+  const bas::EventMemory memory;
+  const bas::SnapshotIndex index(snap);
+  std::vector<double> latencies;
+  bas::FireDecision decision;
+  for (int r = 0; r < reps; ++r) {
+    const auto t0 = std::chrono::steady_clock::now();
+    decision = engine.Decide(snap, {}, memory, &index);
+    const auto t1 = std::chrono::steady_clock::now();
+    latencies.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+  }
+  std::sort(latencies.begin(), latencies.end());
+  const Quality q = Evaluate(decision);
+  std::cout << std::left << std::setw(18) << label << std::right << std::fixed << std::setprecision(3)
+            << " p50(ms)=" << latencies[latencies.size() / 2] << " p95(ms)=" << latencies[latencies.size() * 95 / 100]
+            << " 分配数=" << q.assignments << " 单目标最多射手=" << q.max_shooters_on_target
+            << " 期望毁伤=" << q.expected_kills << " 评分和=" << q.total_score << "\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t size = argc > 1 ? static_cast<std::size_t>(std::atoi(argv[1])) : 200;
+  const int reps = argc > 2 ? std::atoi(argv[2]) : 50;
+  const bas::BattlefieldSnapshot snap = BuildEngagement(size, size, 20240521U);
+  std::cout << "交战规模: " << size << "x" << size << "，重复次数=" << reps << "\n";
+
+  bas::FireControlConfig greedy;
+  Run("greedy", bas::FireControlEngine(greedy), snap, reps);
+
+  bas::FireControlConfig auction;
+  auction.solver = bas::AssignmentSolver::Auction;
+  auction.solve_budget_ms = 0.0;
+  Run("auction(不限时)", bas::FireControlEngine(auction), snap, reps);
+
+  auction.solve_budget_ms = 1.0;
+  Run("auction(1ms)", bas::FireControlEngine(auction), snap, reps);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "bas/decision/maneuver_engine.hpp"
+
+namespace {
+
+bas::BattlefieldSnapshot BuildSnapshot(std::size_t friendlies, std::size_t hostiles, std::uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> x(-3000.0, 3000.0);
+  std::uniform_real_distribution<double> friendly_y(-2500.0, -500.0);
+  std::uniform_real_distribution<double> hostile_y(1000.0, 4000.0);
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+  bas::BattlefieldSnapshot snap;
+  snap.timestamp_ms = 1000;
+  for (std::size_t i = 0; i < friendlies; ++i) {
+    bas::EntityState f;
+    f.id = bas::EntityId::FromDis(1, 1, static_cast<std::uint16_t>(i + 1));
+    f.side = bas::Side::Friendly;
+    f.pose = {x(rng), friendly_y(rng), 0.0};
+    snap.friendly_units.push_back(f);
+  }
+  for (std::size_t i = 0; i < hostiles; ++i) {
+    bas::EntityState h;
+    h.id = bas::EntityId::FromDis(2, 1, static_cast<std::uint16_t>(i + 1));
+    h.side = bas::Side::Hostile;
+    h.type = i % 3 == 0 ? bas::UnitType::Artillery : bas::UnitType::Armor;
+    h.pose = {x(rng), hostile_y(rng), 0.0};
+    h.threat_level = unit(rng);
+    snap.hostile_units.push_back(h);
+  }
+  return snap;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const std::size_t friendlies = argc > 1 ? static_cast<std::size_t>(std::atoi(argv[1])) : 200;
+  const int ticks = argc > 2 ? std::atoi(argv[2]) : 30;
+  const std::size_t threads = argc > 3 ? static_cast<std::size_t>(std::atoi(argv[3])) : 0;
+  std::unique_ptr<bas::ThreadPool> pool;
+  if (threads > 0) {
+    pool = std::make_unique<bas::ThreadPool>(threads);
+  }
+  std::cout << "我方单位数: " << friendlies << "，每组决策次数=" << ticks << "，工作线程=" << threads
+            << (threads == 0 ? "（顺序规划）" : "") << "\n";
+
+  for (const std::size_t hostiles : {10U, 100U, 1000U, 5000U}) {
+    bas::BattlefieldSnapshot snap = BuildSnapshot(friendlies, hostiles, 7U);
+    bas::ManeuverEngine engine({}, pool.get());
+    engine.Decide(snap, {});  // 预热：首次生成栅格瓦片
+
+    // 每次决策移动少量敌方，走栅格增量修正路径。
+    std::vector<double> latencies;
+    for (int t = 0; t < ticks; ++t) {
+      for (std::size_t k = 0; k < std::size_t{2}; ++k) {
+        snap.hostile_units[(t * 31 + k * 17) % hostiles].pose.x += 15.0;
+      }
+      const auto t0 = std::chrono::steady_clock::now();
+      engine.Decide(snap, {});
+      const auto t1 = std::chrono::steady_clock::now();
+      latencies.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << "敌方=" << std::setw(5) << hostiles << std::fixed << std::setprecision(3)
+              << " p50(ms)=" << latencies[latencies.size() / 2]
+              << " p95(ms)=" << latencies[latencies.size() * 95 / 100] << "\n";
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,85 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "bas/system/scenario_replay.hpp"
+
+namespace {
+
+double MsSince(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// 合成文本回放：每帧 entities 行 ENTITY，每 20 行插一条 FIRE，每帧一条 ENV。
+void WriteSyntheticLines(const std::string& path, std::size_t lines, std::size_t entities) {
+  std::ofstream out(path, std::ios::binary);
+  std::string block;
+  char line[256];
+  std::size_t written = 0;
+  for (std::size_t f = 0; written < lines; ++f) {
+    const long long ts = 1000LL + static_cast<long long>(f) * 100;
+    block += "ENV," + std::to_string(ts) + ",1500,0.1,0.2\n";
+    ++written;
+    for (std::size_t e = 0; e < entities && written < lines; ++e, ++written) {
+      const int n = std::snprintf(line, sizeof(line), "ENTITY,%lld,U-%zu,%s,armor,%.2f,%.2f,0,%.1f,%.1f,1,%.2f\n",
+                                  ts, e, e % 2 == 0 ? "friendly" : "hostile",
+                                  static_cast<double>(e) * 10.0 + static_cast<double>(f), static_cast<double>(e) * 5.0,
+                                  8.5, static_cast<double>(e % 360), 0.5);
+      block.append(line, static_cast<std::size_t>(n));
+      if (e % 20 == 19 && written + 1 < lines) {
+        block += "FIRE," + std::to_string(ts) + ",U-" + std::to_string(e) + ",U-" + std::to_string(e - 1) +
+                 ",120mm,0,0,0\n";
+        ++written;
+      }
+    }
+    if (block.size() > (1U << 22U)) {
+      out << block;
+      block.clear();
+    }
+  }
+  out << block;
+}
+
+void Report(const char* name, double ms, double mb, std::size_t lines) {
+  std::cout << name << ": " << ms << " ms，" << mb / (ms / 1000.0) << " MB/s，"
+            << static_cast<double>(lines) / (ms / 1000.0) / 1e6 << " 百万行/s\n";
+}
+
+}  // namespace
+
+// 用法: bench_replay_csv [行数] [每帧实体数] [并行线程数]
+int main(int argc, char** argv) {
+  const std::size_t lines = argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 10000000;
+  const std::size_t entities = argc > 2 ? static_cast<std::size_t>(std::atoll(argv[2])) : 500;
+  const std::size_t threads =
+      argc > 3 ? static_cast<std::size_t>(std::atoll(argv[3])) : std::max(1U, std::thread::hardware_concurrency());
+  const std::string path = (std::filesystem::temp_directory_path() / "bas_bench_replay_csv.bas").string();
+
+  WriteSyntheticLines(path, lines, entities);
+  const double mb = static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << "行数=" << lines << " 文件=" << mb << " MB 并行线程=" << threads << "\n";
+
+  auto t0 = std::chrono::steady_clock::now();
+  const auto sequential = bas::ScenarioReplayLoader{}.LoadBatches(path);
+  Report("顺序块读取", MsSince(t0), mb, lines);
+
+  bas::ScenarioReplayLoaderConfig config;
+  config.threads = threads;
+  t0 = std::chrono::steady_clock::now();
+  const auto parallel = bas::ScenarioReplayLoader(config).LoadBatches(path);
+  Report("并行切块", MsSince(t0), mb, lines);
+
+  std::filesystem::remove(path);
+  if (parallel.size() != sequential.size()) {
+    std::cerr << "并行加载帧数不一致\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
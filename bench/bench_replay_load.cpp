@@ -0,0 +1,75 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "bas/system/columnar_replay.hpp"
+#include "bas/system/scenario_replay.hpp"
+
+namespace {
+
+double MsSince(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// 合成文本回放：每帧一条 ENV、entities 条 ENTITY 与 entities/20 条 FIRE。
+void WriteSyntheticScenario(const std::string& path, std::size_t frames, std::size_t entities) {
+  std::ofstream out(path);
+  char line[256];
+  for (std::size_t f = 0; f < frames; ++f) {
+    const long long ts = 1000LL + static_cast<long long>(f) * 100;
+    out << "ENV," << ts << ",1500,0.1,0.2\n";
+    for (std::size_t e = 0; e < entities; ++e) {
+      const char* side = e % 2 == 0 ? "friendly" : "hostile";
+      std::snprintf(line, sizeof(line), "ENTITY,%lld,U-%zu,%s,armor,%.2f,%.2f,0,%.1f,%.1f,1,%.2f\n", ts, e, side,
+                    static_cast<double>(e) * 10.0 + static_cast<double>(f), static_cast<double>(e) * 5.0, 8.5,
+                    static_cast<double>(e % 360), 0.5);
+      out << line;
+    }
+    for (std::size_t e = 0; e + 20 <= entities; e += 20) {
+      out << "FIRE," << ts << ",U-" << e << ",U-" << e + 1 << ",120mm," << e << ",0,0\n";
+    }
+  }
+}
+
+}  // namespace
+
+// 同一场景分别以文本与列式格式加载，对比整场景加载耗时。
+int main(int argc, char** argv) {
+  const std::size_t frames = argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 2000;
+  const std::size_t entities = argc > 2 ? static_cast<std::size_t>(std::atoll(argv[2])) : 200;
+  const std::filesystem::path dir = std::filesystem::temp_directory_path();
+  const std::string text_path = (dir / "bas_bench_replay.bas").string();
+  const std::string columnar_path = (dir / "bas_bench_replay.basc").string();
+
+  WriteSyntheticScenario(text_path, frames, entities);
+  auto t0 = std::chrono::steady_clock::now();
+  const auto batches = bas::ScenarioReplayLoader{}.LoadBatches(text_path);
+  const double text_ms = MsSince(t0);
+  bas::WriteColumnarReplay(batches, columnar_path);
+
+  t0 = std::chrono::steady_clock::now();
+  const auto loaded = bas::ColumnarReplayReader(columnar_path).LoadBatches();
+  const double columnar_ms = MsSince(t0);
+  if (loaded.size() != batches.size()) {
+    std::cerr << "列式加载帧数不一致\n";
+    return EXIT_FAILURE;
+  }
+
+  const auto mb = [](const std::string& path) {
+    return static_cast<double>(std::filesystem::file_size(path)) / (1024.0 * 1024.0);
+  };
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "帧数=" << frames << " 每帧实体=" << entities << "\n";
+  std::cout << "文本加载: " << text_ms << " ms（" << mb(text_path) << " MB）\n";
+  std::cout << "列式加载: " << columnar_ms << " ms（" << mb(columnar_path) << " MB）\n";
+  std::cout << "加速比: " << (columnar_ms > 0.0 ? text_ms / columnar_ms : 0.0) << "x\n";
+
+  std::filesystem::remove(text_path);
+  std::filesystem::remove(columnar_path);
+  return EXIT_SUCCESS;
+}
@@ -1,30 +1,93 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
-#include <optional>
-#include <string>
+#include <memory>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 #include "bas/common/types.hpp"
 
 namespace bas {
 
+struct DecisionCacheStats {
+  std::size_t hits = 0;
+  std::size_t misses = 0;
+  std::size_t inserts = 0;
+  // 超出容量按最久未用淘汰的条目数。
+  std::size_t evictions = 0;
+  // 因 TTL 到期被移除的条目数（含 Get 时发现过期）。
+  std::size_t expirations = 0;
+};
+
+// 决策缓存：以 64 位特征哈希为键，容量有界。条目同时挂在两条侵入式链表上：
+// 按写入时间排序的时间链（过期只需从链头弹出）与按访问排序的 LRU 链（满容量时淘汰链头）。
+// 值为共享的不可变决策包，命中时不做深拷贝。非线程安全。
 class DecisionCache {
  public:
-  explicit DecisionCache(std::int64_t ttl_ms = 3000);
+  using Key = std::uint64_t;
+  using Value = std::shared_ptr<const DecisionPackage>;
+
+  explicit DecisionCache(std::int64_t ttl_ms = 3000, std::size_t capacity = 4096);
 
-  std::optional<DecisionPackage> Get(const std::string& key, std::int64_t now_ms) const;
-  void Put(const std::string& key, const DecisionPackage& value, std::int64_t now_ms);
+  // 未命中或已过期返回空指针；命中时刷新 LRU 位置。
+  Value Get(Key key, std::int64_t now_ms);
+  // 只读查看，不计入命中统计也不刷新 LRU。
+  Value Peek(Key key) const;
+  void Put(Key key, Value value, std::int64_t now_ms);
+  void Put(Key key, const DecisionPackage& value, std::int64_t now_ms);
+  // 原地替换已有条目的值，保留写入时间与链表位置；键不存在返回 false。
+  bool Replace(Key key, Value value);
+  // 移除全部过期条目，耗时与过期条目数成正比。
   void Prune(std::int64_t now_ms);
 
+  std::size_t size() const { return index_.size(); }
+  std::size_t capacity() const { return capacity_; }
+  const DecisionCacheStats& stats() const { return stats_; }
+
+  // FNV-1a 64 位哈希，供调用方把量化特征折叠成缓存键。
+  static Key HashBytes(std::string_view bytes, Key seed = 14695981039346656037ULL);
+
  private:
-  struct Entry {
+  static constexpr std::uint32_t kNil = 0xffffffffU;
+
+  struct Link {
+    std::uint32_t prev = kNil;
+    std::uint32_t next = kNil;
+  };
+  struct List {
+    std::uint32_t head = kNil;
+    std::uint32_t tail = kNil;
+  };
+  struct Node {
+    Key key = 0;
     std::int64_t timestamp_ms = 0;
-    DecisionPackage value;
+    Value value;
+    Link by_time;
+    Link by_use;
   };
 
-  std::unordered_map<std::string, Entry> table_;
+  static Link& TimeLink(Node& node) { return node.by_time; }
+  static Link& UseLink(Node& node) { return node.by_use; }
+
+  template <Link& (*L)(Node&)>
+  void Unlink(List& list, std::uint32_t slot);
+  template <Link& (*L)(Node&)>
+  void InsertAfter(List& list, std::uint32_t after, std::uint32_t slot);
+
+  bool Expired(const Node& node, std::int64_t now_ms) const { return now_ms - node.timestamp_ms > ttl_ms_; }
+  void Erase(std::uint32_t slot);
+
   std::int64_t ttl_ms_;
+  std::size_t capacity_;
+  // 节点池按下标链接，释放的槽位进空闲栈复用，稳定运行后不再分配。
+  std::vector<Node> nodes_;
+  std::vector<std::uint32_t> free_;
+  std::unordered_map<Key, std::uint32_t> index_;
+  List by_time_;
+  List by_use_;
+  DecisionCacheStats stats_;
 };
 
 }  // namespace bas
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "bas/common/entity_id.hpp"
+#include "bas/common/types.hpp"
+
+namespace bas {
+
+// 决策缓存键：各实体（编号、阵营、量化网格）的 64 位哈希求和，再与双方数量、能见度档位混合。
+// 求和与实体顺序无关、可逆，因此只需按变化实体增减各自贡献即可增量维护，稳态下不分配内存。
+class FeatureKeyBuilder {
+ public:
+  explicit FeatureKeyBuilder(double cell_m = 100.0, double visibility_bucket_m = 100.0);
+
+  // 无状态全量计算。
+  std::uint64_t Compute(const BattlefieldSnapshot& snapshot) const;
+
+  // 全量重算并记录各实体的位置与贡献，供后续增量更新。
+  std::uint64_t Rebuild(const BattlefieldSnapshot& snapshot);
+
+  // 只按 dirty 实体修正；实体增删、换阵营或下标变动等无法就地修正的情况自动退回 Rebuild。
+  std::uint64_t Update(const BattlefieldSnapshot& snapshot, const std::vector<EntityId>& dirty);
+
+  std::size_t rebuilds() const { return rebuilds_; }
+
+ private:
+  struct Tracked {
+    Side side = Side::Neutral;
+    std::uint32_t index = 0;
+    std::uint64_t contribution = 0;
+  };
+
+  std::uint64_t Contribution(const EntityState& unit, Side side) const;
+  std::uint64_t Finalize(std::uint64_t unit_sum, const BattlefieldSnapshot& snapshot) const;
+
+  double cell_m_;
+  double visibility_bucket_m_;
+  std::unordered_map<EntityId, Tracked> tracked_;
+  std::uint64_t unit_sum_ = 0;
+  std::size_t friendly_count_ = 0;
+  std::size_t hostile_count_ = 0;
+  std::size_t rebuilds_ = 0;
+};
+
+}  // namespace bas
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "bas/common/types.hpp"
+
+namespace bas {
+
+// 态势特征：双方各类型存活数量、双方质心（千米）、敌方威胁等级直方图、能见度（千米）、战术标签位。
+// 数量与标签差一项即距离 1，质心以千米计，便于用同一阈值衡量“态势是否缓慢演化”。
+constexpr std::size_t kSituationFeatureDim = 29;
+using SituationFeatures = std::array<double, kSituationFeatureDim>;
+
+SituationFeatures ExtractSituationFeatures(const BattlefieldSnapshot& snapshot, const SituationSemantics& semantics);
+double FeatureDistance(const SituationFeatures& a, const SituationFeatures& b);
+
+struct SimilarMatch {
+  std::shared_ptr<const DecisionPackage> value;
+  double distance = 0.0;
+  std::int64_t timestamp_ms = 0;
+};
+
+struct SimilarityIndexStats {
+  std::size_t queries = 0;
+  std::size_t matches = 0;
+  std::size_t candidates_checked = 0;
+  std::size_t inserts = 0;
+};
+
+// 近期决策的近似近邻索引：p-stable LSH（多表、每表若干随机投影量化拼桶），
+// 候选再按欧氏距离精确校验阈值与 TTL。容量固定，按环形覆盖最旧条目。非线程安全。
+class SimilarityIndex {
+ public:
+  SimilarityIndex(std::size_t capacity, double threshold, std::int64_t ttl_ms, std::uint32_t seed = 20240612U);
+
+  std::optional<SimilarMatch> FindNearest(const SituationFeatures& features, std::int64_t now_ms);
+  void Insert(const SituationFeatures& features, std::shared_ptr<const DecisionPackage> value, std::int64_t now_ms);
+
+  std::size_t size() const { return size_; }
+  const SimilarityIndexStats& stats() const { return stats_; }
+
+ private:
+  static constexpr std::size_t kTables = 4;
+  static constexpr std::size_t kProjections = 3;
+
+  struct Entry {
+    SituationFeatures features{};
+    std::shared_ptr<const DecisionPackage> value;
+    std::int64_t timestamp_ms = 0;
+    std::array<std::uint64_t, kTables> buckets{};
+  };
+
+  std::uint64_t BucketOf(std::size_t table, const SituationFeatures& features) const;
+  void Unindex(std::uint32_t slot);
+
+  double threshold_;
+  std::int64_t ttl_ms_;
+  double bucket_width_;
+  std::vector<double> projections_;
+  std::vector<double> offsets_;
+  std::vector<Entry> entries_;
+  std::size_t next_ = 0;
+  std::size_t size_ = 0;
+  std::array<std::unordered_map<std::uint64_t, std::vector<std::uint32_t>>, kTables> tables_;
+  // 查询去重：槽位上次被访问的查询序号。
+  std::vector<std::uint64_t> visit_stamp_;
+  std::uint64_t query_seq_ = 0;
+  SimilarityIndexStats stats_;
+};
+
+}  // namespace bas
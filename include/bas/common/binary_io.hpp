@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bas/common/byte_view.hpp"
+#include "bas/common/entity_id.hpp"
+
+namespace bas {
+
+// 检查点等内部状态的小端二进制编码，字符串与数组均以长度前缀存放。
+class BinaryWriter {
+ public:
+  template <typename T>
+  void Put(const T& value) {
+    const auto* p = reinterpret_cast<const std::uint8_t*>(&value);
+    bytes_.insert(bytes_.end(), p, p + sizeof(T));
+  }
+
+  void PutBool(bool value) { Put(static_cast<std::uint8_t>(value ? 1 : 0)); }
+  void PutSize(std::size_t value) { Put(static_cast<std::uint64_t>(value)); }
+
+  void PutString(std::string_view value) {
+    PutSize(value.size());
+    bytes_.insert(bytes_.end(), value.begin(), value.end());
+  }
+
+  void PutBytes(const std::vector<std::uint8_t>& value) {
+    PutSize(value.size());
+    bytes_.insert(bytes_.end(), value.begin(), value.end());
+  }
+
+  // 驻留名称的编号只在本进程内有效，按文本写出。
+  void PutId(EntityId id) { PutString(id.ToString()); }
+
+  const std::vector<std::uint8_t>& bytes() const { return bytes_; }
+  std::vector<std::uint8_t>& bytes() { return bytes_; }
+
+ private:
+  std::vector<std::uint8_t> bytes_;
+};
+
+// 越界读取抛出 std::runtime_error，数据损坏不会读出缓冲区之外。
+class BinaryReader {
+ public:
+  explicit BinaryReader(ByteView bytes) : bytes_(bytes) {}
+
+  template <typename T>
+  T Get() {
+    Require(sizeof(T));
+    T value;
+    std::memcpy(&value, bytes_.data() + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return value;
+  }
+
+  bool GetBool() { return Get<std::uint8_t>() != 0; }
+
+  // 读取元素个数，并按每个元素至少 min_element_bytes 字节校验剩余长度，避免损坏数据触发超大分配。
+  std::size_t GetSize(std::size_t min_element_bytes = 1) {
+    const auto value = Get<std::uint64_t>();
+    if (min_element_bytes > 0 && value > remaining() / min_element_bytes) {
+      throw std::runtime_error("状态数据损坏: 长度字段越界");
+    }
+    return static_cast<std::size_t>(value);
+  }
+
+  std::string GetString() {
+    const std::size_t n = GetSize();
+    std::string value(reinterpret_cast<const char*>(bytes_.data() + pos_), n);
+    pos_ += n;
+    return value;
+  }
+
+  std::vector<std::uint8_t> GetBytes() {
+    const std::size_t n = GetSize();
+    std::vector<std::uint8_t> value(bytes_.data() + pos_, bytes_.data() + pos_ + n);
+    pos_ += n;
+    return value;
+  }
+
+  EntityId GetId() { return EntityId::Intern(GetString()); }
+
+  std::size_t position() const { return pos_; }
+  std::size_t remaining() const { return bytes_.size() - pos_; }
+
+ private:
+  void Require(std::size_t n) const {
+    if (n > remaining()) {
+      throw std::runtime_error("状态数据损坏: 读取越界");
+    }
+  }
+
+  ByteView bytes_;
+  std::size_t pos_ = 0;
+};
+
+}  // namespace bas
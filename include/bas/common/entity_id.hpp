@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace bas {
+
+// 48位紧凑实体编号：site(16) | application(16) | entity(16)。
+// 热路径只比较/哈希整数；可读名称仅在输出时经驻留表还原。
+class EntityId {
+ public:
+  // DIS 中 site=0xFFFF 表示 ALL_SITES，不会出现在真实实体上，借作文本编号（如 "F-1"）的驻留命名空间。
+  static constexpr std::uint16_t kNamedSite = 0xFFFF;
+
+  constexpr EntityId() = default;
+  // 等价于 Intern；显式构造，避免字符串在比较与传参处被悄悄驻留。
+  explicit EntityId(const char* name);
+  explicit EntityId(const std::string& name);
+
+  // site=kNamedSite 为文本编号保留，传入时抛出 std::invalid_argument。
+  static constexpr EntityId FromDis(std::uint16_t site, std::uint16_t application, std::uint16_t entity) {
+    if (site == kNamedSite) {
+      throw std::invalid_argument("DIS 站点号 0xFFFF 为保留值");
+    }
+    return EntityId((static_cast<std::uint64_t>(site) << 32U) | (static_cast<std::uint64_t>(application) << 16U) |
+                    static_cast<std::uint64_t>(entity));
+  }
+  static constexpr EntityId FromRaw(std::uint64_t raw) { return EntityId(raw & 0xFFFFFFFFFFFFULL); }
+
+  // "site-app-entity" 形式的十进制三元组直接打包为 DIS 编号，其余文本进入进程级驻留表。
+  static EntityId Intern(std::string_view name);
+
+  constexpr std::uint64_t raw() const { return value_; }
+  constexpr bool valid() const { return value_ != 0; }
+  constexpr std::uint16_t site() const { return static_cast<std::uint16_t>(value_ >> 32U); }
+  constexpr std::uint16_t application() const { return static_cast<std::uint16_t>(value_ >> 16U); }
+  constexpr std::uint16_t entity() const { return static_cast<std::uint16_t>(value_); }
+  constexpr bool is_named() const { return site() == kNamedSite; }
+
+  std::string ToString() const;
+
+  friend constexpr bool operator==(EntityId a, EntityId b) { return a.value_ == b.value_; }
+  friend constexpr bool operator!=(EntityId a, EntityId b) { return a.value_ != b.value_; }
+  friend constexpr bool operator<(EntityId a, EntityId b) { return a.value_ < b.value_; }
+
+ private:
+  explicit constexpr EntityId(std::uint64_t raw) : value_(raw) {}
+
+  std::uint64_t value_ = 0;
+};
+
+std::ostream& operator<<(std::ostream& os, EntityId id);
+
+struct EntityIdHash {
+  std::size_t operator()(EntityId id) const {
+    // 48位编号低位常为连续序号，做一次乘法混合使哈希桶分布均匀。
+    std::uint64_t x = id.raw() * 0x9E3779B97F4A7C15ULL;
+    return static_cast<std::size_t>(x ^ (x >> 32U));
+  }
+};
+
+}  // namespace bas
+
+namespace std {
+
+template <>
+struct hash<bas::EntityId> {
+  std::size_t operator()(bas::EntityId id) const { return bas::EntityIdHash{}(id); }
+};
+
+}  // namespace std
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "bas/common/byte_view.hpp"
+
+namespace bas {
+
+// 只读内存映射文件：解析器直接读取映射区域，不做整文件拷贝。
+class MappedFile {
+ public:
+  MappedFile() = default;
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  ByteView view() const { return ByteView(data_, size_); }
+  std::size_t size() const { return size_; }
+  const std::string& path() const { return path_; }
+
+  // 提示内核该区间已处理完毕，可回收其页缓存，顺序扫描超大文件时常驻内存保持平稳。
+  void ReleaseRange(std::size_t offset, std::size_t length) const;
+
+ private:
+  void Reset();
+
+  std::string path_;
+  const std::uint8_t* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+}  // namespace bas
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace bas {
+
+// 进程级字符串驻留表：编号从1开始，0 表示空；只增不删，适用于取值有限的名称（实体编号、武器名）。
+class NameTable {
+ public:
+  std::uint32_t Intern(std::string_view name);
+  // 未知编号返回空串。
+  std::string Name(std::uint32_t slot) const;
+
+ private:
+  mutable std::shared_mutex mutex_;
+  std::deque<std::string> names_;
+  std::unordered_map<std::string_view, std::uint32_t> index_;
+};
+
+// 开火事件的原始武器名（如 DIS 弹药描述）经此驻留，FirePayload 只存编号。
+std::uint32_t InternWeaponName(std::string_view name);
+std::string WeaponNameOf(std::uint32_t id);
+
+}  // namespace bas
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "bas/common/types.hpp"
+
+namespace bas {
+
+struct SpatialNeighbor {
+  std::size_t index = 0;
+  double distance_sq = 0.0;
+};
+
+// 均匀网格空间索引：按 (x,y) 分桶，距离按三维计算，返回 EntityTable 行号。
+// 索引仅引用所建表，表须在索引生命周期内保持不变。
+class SpatialGrid {
+ public:
+  struct Cell {
+    std::int32_t cx = 0;
+    std::int32_t cy = 0;
+    std::uint32_t begin = 0;
+    std::uint32_t end = 0;
+  };
+
+  explicit SpatialGrid(double cell_size_m = 250.0);
+
+  void Build(const EntityTable& table);
+
+  std::size_t size() const { return items_.size(); }
+  bool empty() const { return items_.empty(); }
+  double cell_size() const { return cell_size_; }
+  const EntityTable* table() const { return table_; }
+
+  // 半径内全部行号，按行号升序输出，保证调用方遍历顺序与暴力扫描一致。
+  void QueryRadius(const Pose& center, double radius_m, std::vector<std::size_t>& out) const;
+  bool AnyWithin(const Pose& center, double radius_m) const;
+  bool Nearest(const Pose& point, SpatialNeighbor& out) const;
+  // k 近邻，按距离升序（距离相同时行号升序）。
+  void Knn(const Pose& point, std::size_t k, std::vector<SpatialNeighbor>& out) const;
+
+  const std::vector<Cell>& cells() const { return cells_; }
+  const std::uint32_t* CellItems(const Cell& cell) const { return items_.data() + cell.begin; }
+
+ private:
+  static std::uint64_t Key(std::int32_t cx, std::int32_t cy) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(cx)) << 32U) | static_cast<std::uint32_t>(cy);
+  }
+  std::int32_t CellCoord(double v) const;
+  const Cell* FindCell(std::int32_t cx, std::int32_t cy) const;
+
+  template <typename Visitor>
+  void VisitCellsInBox(std::int32_t min_cx, std::int32_t max_cx, std::int32_t min_cy, std::int32_t max_cy,
+                       Visitor&& visit) const;
+
+  double cell_size_;
+  const EntityTable* table_ = nullptr;
+  std::vector<Cell> cells_;
+  std::vector<std::uint32_t> items_;
+  std::unordered_map<std::uint64_t, std::uint32_t> cell_by_key_;
+  std::int32_t min_cx_ = 0;
+  std::int32_t max_cx_ = -1;
+  std::int32_t min_cy_ = 0;
+  std::int32_t max_cy_ = -1;
+};
+
+// 每个快照构建一次、由态势融合/火力/机动各阶段共享的空间索引。
+class SnapshotIndex {
+ public:
+  explicit SnapshotIndex(const BattlefieldSnapshot& snapshot, double cell_size_m = 250.0);
+
+  SnapshotIndex(const SnapshotIndex&) = delete;
+  SnapshotIndex& operator=(const SnapshotIndex&) = delete;
+
+  const EntityTable& friendlies() const { return *friendlies_; }
+  const EntityTable& hostiles() const { return *hostiles_; }
+  const SpatialGrid& friendly_grid() const { return friendly_grid_; }
+  const SpatialGrid& hostile_grid() const { return hostile_grid_; }
+
+ private:
+  EntityTable friendly_scratch_;
+  EntityTable hostile_scratch_;
+  const EntityTable* friendlies_;
+  const EntityTable* hostiles_;
+  SpatialGrid friendly_grid_;
+  SpatialGrid hostile_grid_;
+};
+
+}  // namespace bas
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bas {
+
+// 工作窃取线程池：每个工作线程持有自己的任务双端队列，本线程从尾部取（LIFO），
+// 空闲时从其他线程队列头部窃取（FIFO）。外部提交按轮转分发。
+// 槽位：工作线程占 [0, size())；外部线程调用 ParallelFor 期间独占租用一个外部槽位，
+// 因此按槽位索引的缓冲区不会被两个线程同时使用。
+class ThreadPool {
+ public:
+  using Task = std::function<void()>;
+  // 分块回调：[begin, end) 为本块下标范围，worker 为执行者槽位，取值 [0, slot_count())。
+  using RangeTask = std::function<void(std::size_t begin, std::size_t end, std::size_t worker)>;
+
+  // thread_count 为 0 时取硬件并发数。external_slots 为可同时调用 ParallelFor 的外部线程数，
+  // 超出时后来者等待空闲槽位。
+  explicit ThreadPool(std::size_t thread_count = 0, std::size_t external_slots = 4);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  std::size_t size() const { return workers_.size(); }
+  // 工作线程数 + 外部槽位数：调用 ParallelFor 的外部线程也参与执行。
+  std::size_t slot_count() const { return workers_.size() + external_slots_; }
+
+  // 提交独立任务。任务抛出的异常被捕获并计入 failed_tasks()，不会终止工作线程；需要结果的调用方应自行捕获。
+  void Submit(Task task);
+
+  // 把 [0, count) 按 grain 切块并行执行，调用线程协助执行直到全部完成；
+  // 任一块抛出的首个异常在全部块结束后重新抛出。结果确定性由调用方按下标写入保证。
+  void ParallelFor(std::size_t count, std::size_t grain, const RangeTask& fn);
+
+  // 当前线程在本池中的槽位；未租用槽位的外部线程返回 slot_count()。
+  std::size_t CurrentSlot() const;
+
+  std::size_t failed_tasks() const { return failed_tasks_.load(std::memory_order_relaxed); }
+
+ private:
+  struct WorkerQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void WorkerLoop(std::size_t index);
+  bool TryRunOne(std::size_t self);
+  bool PopLocal(std::size_t index, Task& out);
+  bool Steal(std::size_t thief, Task& out);
+  std::size_t AcquireExternalSlot();
+  void ReleaseExternalSlot(std::size_t slot);
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<std::size_t> next_queue_{0};
+  std::atomic<std::size_t> pending_{0};
+  std::atomic<std::size_t> failed_tasks_{0};
+  // 等待中的工作线程与 ParallelFor 调用方共用：有新任务或某个并行组完成时唤醒。
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+
+  std::size_t external_slots_;
+  std::mutex slot_mutex_;
+  std::condition_variable slot_free_;
+  std::vector<std::size_t> free_slots_;
+};
+
+}  // namespace bas
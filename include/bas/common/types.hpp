@@ -4,8 +4,11 @@
 #include <cmath>
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "bas/common/entity_id.hpp"
+
 namespace bas {
 
 enum class Side { Friendly, Hostile, Neutral };
@@ -14,6 +17,10 @@ enum class UnitType { Infantry, Armor, Artillery, AirDefense, Command, Unknown }
 
 enum class EventType { WeaponFire, SensorContact, TacticalTag, UnitLoss, Unknown };
 
+enum class WeaponKind : std::uint8_t { Unknown, Rifle, TankGun, Howitzer, Sam, Generic };
+
+enum class MunitionClass : std::uint8_t { Unknown, SmallArms, DirectFire, Indirect, AirDefense };
+
 struct Pose {
   double x = 0.0;
   double y = 0.0;
@@ -30,7 +37,7 @@ struct WeaponState {
 };
 
 struct EntityState {
-  std::string id;
+  EntityId id;
   Side side = Side::Neutral;
   UnitType type = UnitType::Unknown;
   Pose pose;
@@ -48,13 +55,103 @@ struct EnvironmentState {
   double terrain_risk = 0.0;
 };
 
+// 列存实体表：几何与威胁相关的热字段按列连续存放，供各引擎的成对距离循环直接遍历。
+struct EntityTable {
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> z;
+  std::vector<double> speed_mps;
+  std::vector<double> threat_level;
+  std::vector<std::uint8_t> alive;
+  std::vector<UnitType> type;
+  // 与所属快照 units_generation 相等时表示各列与单位列表对齐；0 表示未知。
+  std::uint64_t generation = 0;
+
+  std::size_t size() const { return x.size(); }
+  bool empty() const { return x.empty(); }
+
+  void Clear() {
+    x.clear();
+    y.clear();
+    z.clear();
+    speed_mps.clear();
+    threat_level.clear();
+    alive.clear();
+    type.clear();
+    generation = 0;
+  }
+
+  void Reserve(std::size_t n) {
+    x.reserve(n);
+    y.reserve(n);
+    z.reserve(n);
+    speed_mps.reserve(n);
+    threat_level.reserve(n);
+    alive.reserve(n);
+    type.reserve(n);
+  }
+
+  void Append(const EntityState& entity) {
+    x.push_back(entity.pose.x);
+    y.push_back(entity.pose.y);
+    z.push_back(entity.pose.z);
+    speed_mps.push_back(entity.speed_mps);
+    threat_level.push_back(entity.threat_level);
+    alive.push_back(entity.alive ? 1 : 0);
+    type.push_back(entity.type);
+  }
+
+  double DistanceSquared(std::size_t i, const Pose& p) const {
+    const double dx = x[i] - p.x;
+    const double dy = y[i] - p.y;
+    const double dz = z[i] - p.z;
+    return dx * dx + dy * dy + dz * dz;
+  }
+
+  static EntityTable FromEntities(const std::vector<EntityState>& units) {
+    EntityTable table;
+    table.Reserve(units.size());
+    for (const auto& unit : units) {
+      table.Append(unit);
+    }
+    return table;
+  }
+};
+
 struct BattlefieldSnapshot {
   std::int64_t timestamp_ms = 0;
   std::vector<EntityState> friendly_units;
   std::vector<EntityState> hostile_units;
   EnvironmentState env;
+  // 与 friendly_units / hostile_units 按下标对齐的列存视图；手工构造的快照可留空，由引擎按需构建。
+  EntityTable friendly_table;
+  EntityTable hostile_table;
+  // 单位列表的代号：修改 friendly_units / hostile_units 的一方须递增它，并在同步列存表后把表的 generation
+  // 置为相同值。为 0 时列存表一律视为过期。
+  std::uint64_t units_generation = 0;
+
+  // 按单位列表重建两张列存表，并标记为与当前单位列表对齐。
+  void RebuildTables() {
+    friendly_table = EntityTable::FromEntities(friendly_units);
+    hostile_table = EntityTable::FromEntities(hostile_units);
+    ++units_generation;
+    friendly_table.generation = units_generation;
+    hostile_table.generation = units_generation;
+  }
 };
 
+// 返回与 units 对齐的列存表：表的代号与快照单位列表代号一致时直接引用，否则构建到 scratch 中。
+inline const EntityTable& ResolveEntityTable(const EntityTable& table,
+                                             const std::vector<EntityState>& units,
+                                             std::uint64_t units_generation,
+                                             EntityTable& scratch) {
+  if (units_generation != 0 && table.generation == units_generation && table.size() == units.size()) {
+    return table;
+  }
+  scratch = EntityTable::FromEntities(units);
+  return scratch;
+}
+
 struct TacticalTag {
   std::string name;
   double confidence = 0.0;
@@ -65,23 +162,34 @@ struct SituationSemantics {
   std::vector<TacticalTag> tags;
 };
 
+// 开火事件的结构化载荷，融合与火控按字段判断，不再解析文本。
+struct FirePayload {
+  EntityId target_id;
+  WeaponKind weapon = WeaponKind::Unknown;
+  MunitionClass munition = MunitionClass::Unknown;
+  // 原始武器名的驻留编号（见 InternWeaponName），上下文按原名渲染；0 表示未记录，退回 weapon 的规范名。
+  std::uint32_t weapon_name = 0;
+};
+
 struct EventRecord {
   std::int64_t timestamp_ms = 0;
   EventType type = EventType::Unknown;
-  std::string actor_id;
+  EntityId actor_id;
   Pose pose;
+  // 为空时由 EventMemory::BuildContext 按结构化载荷渲染。
   std::string message;
+  FirePayload fire = {};
 };
 
 struct ThreatEstimate {
-  std::string target_id;
+  EntityId target_id;
   double index = 0.0;
   std::string reason;
 };
 
 struct TargetAssignment {
-  std::string shooter_id;
-  std::string target_id;
+  EntityId shooter_id;
+  EntityId target_id;
   std::string weapon_name;
   double score = 0.0;
   double expected_kill_prob = 0.0;
@@ -97,7 +205,7 @@ struct FireDecision {
 };
 
 struct ManeuverAction {
-  std::string unit_id;
+  EntityId unit_id;
   std::string action_name;
   std::vector<Pose> path;
   Pose next_pose;
@@ -115,6 +223,11 @@ struct DecisionPackage {
   ManeuverDecision maneuver;
   std::string explanation;
   bool from_cache = false;
+  // 由相似态势的近期决策复用而来（此时 from_cache 同为 true）。
+  bool from_similar = false;
+  // 生成该决策的 Tick 序号；异步模型模式下据此把后到的模型结果合并回决策包。
+  std::uint64_t tick_seq = 0;
+  bool model_pending = false;
 };
 
 inline double Distance(const Pose& a, const Pose& b) {
@@ -124,7 +237,7 @@ inline double Distance(const Pose& a, const Pose& b) {
   return std::sqrt(dx * dx + dy * dy + dz * dz);
 }
 
-inline UnitType UnitTypeFromString(const std::string& text) {
+inline UnitType UnitTypeFromString(std::string_view text) {
   if (text == "infantry") {
     return UnitType::Infantry;
   }
@@ -143,7 +256,63 @@ inline UnitType UnitTypeFromString(const std::string& text) {
   return UnitType::Unknown;
 }
 
-inline Side SideFromString(const std::string& text) {
+inline WeaponKind WeaponKindFromString(std::string_view text) {
+  if (text == "rifle") {
+    return WeaponKind::Rifle;
+  }
+  if (text == "tank_gun") {
+    return WeaponKind::TankGun;
+  }
+  if (text == "howitzer") {
+    return WeaponKind::Howitzer;
+  }
+  if (text == "sam") {
+    return WeaponKind::Sam;
+  }
+  if (text == "generic") {
+    return WeaponKind::Generic;
+  }
+  // 非规范名（如 "155mm_howitzer"）按子串识别曲射火炮，避免漏判炮兵活动。
+  if (text.find("howitzer") != std::string_view::npos) {
+    return WeaponKind::Howitzer;
+  }
+  return WeaponKind::Unknown;
+}
+
+inline const char* WeaponKindToString(WeaponKind kind) {
+  switch (kind) {
+    case WeaponKind::Rifle:
+      return "rifle";
+    case WeaponKind::TankGun:
+      return "tank_gun";
+    case WeaponKind::Howitzer:
+      return "howitzer";
+    case WeaponKind::Sam:
+      return "sam";
+    case WeaponKind::Generic:
+      return "generic";
+    default:
+      return "unknown";
+  }
+}
+
+inline MunitionClass MunitionClassOf(WeaponKind kind) {
+  switch (kind) {
+    case WeaponKind::Rifle:
+      return MunitionClass::SmallArms;
+    case WeaponKind::TankGun:
+    case WeaponKind::Generic:
+      return MunitionClass::DirectFire;
+    case WeaponKind::Howitzer:
+      return MunitionClass::Indirect;
+    case WeaponKind::Sam:
+      return MunitionClass::AirDefense;
+    default:
+      return MunitionClass::Unknown;
+  }
+}
+
+inline Side SideFromString(std::string_view text) {
   if (text == "friendly") {
     return Side::Friendly;
   }
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace bas {
+
+// 稀疏射手-目标收益图：arcs 按射手分组，arc_begin[i]..arc_begin[i+1] 为射手 i 的可行边。
+// 每个目标提供 slots_per_target 个射手席位。
+struct AssignmentArc {
+  std::uint32_t target = 0;
+  double value = 0.0;
+};
+
+struct AssignmentProblem {
+  std::size_t target_count = 0;
+  std::size_t slots_per_target = 1;
+  std::vector<std::uint32_t> arc_begin{0};
+  std::vector<AssignmentArc> arcs;
+
+  std::size_t shooter_count() const { return arc_begin.size() - 1; }
+  void AddShooter() { arc_begin.push_back(static_cast<std::uint32_t>(arcs.size())); }
+  // 为最近一次 AddShooter 的射手追加可行边。
+  void AddArc(std::uint32_t target, double value) {
+    arcs.push_back({target, value});
+    ++arc_begin.back();
+  }
+};
+
+struct AuctionOptions {
+  // 最小加价 = epsilon_ratio × 最大边收益；结果与最优解之差不超过 射手数 × 最小加价。
+  double epsilon_ratio = 1e-3;
+  // 求解预算（毫秒），<=0 表示不限时。超时后剩余射手按贪心补齐空闲席位。
+  double budget_ms = 0.0;
+};
+
+struct AssignmentResult {
+  static constexpr std::uint32_t kUnassigned = 0xFFFFFFFFU;
+
+  // 每个射手选中的边下标（指向 problem.arcs），未分配为 kUnassigned。
+  std::vector<std::uint32_t> arc_of_shooter;
+  double total_value = 0.0;
+  std::size_t bids = 0;
+  bool timed_out = false;
+};
+
+// 带席位容量的前向拍卖算法（Bertsekas），允许射手不分配（收益 0 的空选项）。
+AssignmentResult SolveAuctionAssignment(const AssignmentProblem& problem, const AuctionOptions& options = {});
+
+}  // namespace bas
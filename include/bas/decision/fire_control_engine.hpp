@@ -2,29 +2,50 @@
 
 #include <unordered_map>
 
+#include "bas/common/spatial_index.hpp"
 #include "bas/common/types.hpp"
 #include "bas/memory/event_memory.hpp"
 
 namespace bas {
 
+enum class AssignmentSolver {
+  Greedy,   // 逐射手取最优目标，再按首要威胁集火改写
+  Auction,  // 射手×目标全局拍卖，每目标最多 max_shooters_per_target 个射手
+};
+
 struct FireControlConfig {
   bool enable_focus_fire = true;
   bool enable_stagger_fire = true;
   std::size_t max_shooters_per_target = 2;
   double focus_fire_threat_threshold = 78.0;
+  AssignmentSolver solver = AssignmentSolver::Greedy;
+  double auction_epsilon_ratio = 2e-3;
+  // 单次决策的分配求解预算（毫秒），<=0 表示不限时。
+  double solve_budget_ms = 10.0;
 };
 
 class FireControlEngine {
  public:
   explicit FireControlEngine(FireControlConfig config = {});
 
+  // index 为空时按快照现场构建空间索引。
   FireDecision Decide(const BattlefieldSnapshot& snapshot,
                       const SituationSemantics& semantics,
-                      const EventMemory& memory) const;
+                      const EventMemory& memory,
+                      const SnapshotIndex* index = nullptr) const;
 
  private:
   static double TypeThreatWeight(UnitType type);
   static double ThreatIndex(const EntityState& target, double min_distance_m);
+  void AssignGreedy(const BattlefieldSnapshot& snapshot,
+                    const SnapshotIndex& index,
+                    const std::vector<double>& threat_by_target,
+                    FireDecision& out) const;
+  // 返回 true 表示拍卖在预算内收敛。
+  bool AssignAuction(const BattlefieldSnapshot& snapshot,
+                     const SnapshotIndex& index,
+                     const std::vector<double>& threat_by_target,
+                     FireDecision& out) const;
   static double WeaponFitScore(const WeaponState& weapon, const EntityState& shooter, const EntityState& target);
 
   FireControlConfig config_;
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <cstdint>
+#include <vector>
+
+#include "bas/common/spatial_index.hpp"
+#include "bas/common/thread_pool.hpp"
 #include "bas/common/types.hpp"
+#include "bas/decision/threat_raster.hpp"
 
 namespace bas {
 
@@ -8,22 +14,64 @@ struct ManeuverConfig {
   double emergency_distance_m = 450.0;
   double path_step_m = 80.0;
   int path_horizon_steps = 8;
+  // 需要路径规划的单位数达到该值且配置了线程池时并行规划。
+  std::size_t parallel_min_units = 16;
 };
 
 class ManeuverEngine {
  public:
-  explicit ManeuverEngine(ManeuverConfig config = {});
+  // pool 为空时在调用线程上顺序规划；非空时须比引擎存活更久。
+  explicit ManeuverEngine(ManeuverConfig config = {}, ThreadPool* pool = nullptr);
 
+  // index 为空时按快照现场构建空间索引。威胁栅格与规划缓冲在相邻两次调用间复用，故 Decide 为非 const，
+  // 同一引擎不可并发调用。
   ManeuverDecision Decide(const BattlefieldSnapshot& snapshot,
-                          const SituationSemantics& semantics) const;
+                          const SituationSemantics& semantics,
+                          const SnapshotIndex* index = nullptr);
+
+  const ManeuverConfig& config() const { return config_; }
 
  private:
+  // A* 搜索框：以起点为原点、path_step_m 为步长的格点坐标。
+  struct PlanBox {
+    std::int32_t goal_i = 0;
+    std::int32_t goal_j = 0;
+    std::int32_t min_i = 0;
+    std::int32_t min_j = 0;
+    std::int32_t width = 0;
+    std::int32_t height = 0;
+  };
+
+  struct OpenNode {
+    double f;
+    std::uint64_t seq;
+    std::int32_t node;
+  };
+
+  // 每个执行槽位一份，跨决策复用，避免逐单位分配。
+  struct PlannerScratch {
+    std::vector<double> g;
+    std::vector<double> node_cost;
+    std::vector<std::int32_t> parent;
+    std::vector<std::int32_t> chain;
+    std::vector<std::uint8_t> closed;
+    std::vector<OpenNode> open;
+  };
+
   static bool HasTag(const SituationSemantics& semantics, const std::string& name);
-  static double ThreatField(const Pose& point, const BattlefieldSnapshot& snapshot);
-  std::vector<Pose> PlanPath(const Pose& start, const Pose& goal, const BattlefieldSnapshot& snapshot) const;
+  PlanBox MakePlanBox(const Pose& start, const Pose& goal) const;
+  // 在八邻接栅格上做 A*，结果截断到 path_horizon_steps 步。只读访问威胁栅格，可并发调用。
+  void PlanPath(const Pose& start,
+                const Pose& goal,
+                double terrain_risk,
+                PlannerScratch& scratch,
+                std::vector<Pose>& path) const;
   static Pose MoveAway(const Pose& self, const Pose& threat, double step);
 
   ManeuverConfig config_;
+  ThreatRaster raster_;
+  ThreadPool* pool_;
+  std::vector<PlannerScratch> scratch_;
 };
 
 }  // namespace bas
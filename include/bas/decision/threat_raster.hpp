@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "bas/common/types.hpp"
+
+namespace bas {
+
+// 敌方威胁场栅格：地面平面按 cell_size 划分，每 32×32 个单元为一块瓦片，首次采样时整块计算。
+// Update 对比前后两次敌方状态，少量实体变化时在已生成瓦片上减旧加新，变化过多时整体失效重算。
+// 采样值不含地形风险项，由调用方自行叠加。
+class ThreatRaster {
+ public:
+  static constexpr std::int32_t kTileCells = 32;
+
+  struct Stats {
+    std::size_t tiles_built = 0;
+    std::size_t incremental_updates = 0;
+    std::size_t full_invalidations = 0;
+  };
+
+  explicit ThreatRaster(double cell_size_m = 80.0);
+
+  void Update(const std::vector<EntityState>& hostiles);
+
+  double cell_size() const { return cell_size_; }
+  std::int32_t CellCoord(double v) const;
+  // 单元 (cx, cy) 中心处的威胁值。
+  double SampleCell(std::int32_t cx, std::int32_t cy);
+  double Sample(const Pose& point) { return SampleCell(CellCoord(point.x), CellCoord(point.y)); }
+  // 只读采样：瓦片已生成时查表，否则按敌方逐个现算且不写入缓存，可被多个线程同时调用。
+  double SampleReadOnly(const Pose& point) const;
+  // 预先生成覆盖该矩形（单元坐标，闭区间）的全部瓦片，之后该区域内的采样不再写入。
+  void Materialize(std::int32_t min_cx, std::int32_t max_cx, std::int32_t min_cy, std::int32_t max_cy);
+
+  std::size_t tile_count() const { return tiles_.size(); }
+  const Stats& stats() const { return stats_; }
+
+ private:
+  struct Source {
+    EntityId id;
+    double x = 0.0;
+    double y = 0.0;
+    double weight = 0.0;
+    double artillery = 0.0;
+  };
+  using Tile = std::array<double, kTileCells * kTileCells>;
+
+  static std::uint64_t TileKey(std::int32_t tx, std::int32_t ty) {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(tx)) << 32U) | static_cast<std::uint32_t>(ty);
+  }
+  static std::int32_t TileCoord(std::int32_t c);
+  Tile& TileAt(std::int32_t tx, std::int32_t ty);
+  double PointValue(double x, double y) const;
+  void Accumulate(std::int32_t tx, std::int32_t ty, const Source& source, double sign, Tile& tile) const;
+
+  double cell_size_;
+  std::vector<Source> sources_;
+  std::unordered_map<EntityId, std::size_t> source_index_;
+  std::unordered_map<std::uint64_t, Tile> tiles_;
+  std::size_t updates_since_rebuild_ = 0;
+  Stats stats_;
+};
+
+}  // namespace bas
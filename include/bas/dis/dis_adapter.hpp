@@ -1,16 +1,20 @@
 #pragma once
 
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <optional>
 #include <unordered_map>
 #include <vector>
 
+#include "bas/common/binary_io.hpp"
 #include "bas/common/types.hpp"
 
 namespace bas {
 
 struct DisEntityPdu {
   std::int64_t timestamp_ms = 0;
-  std::string entity_id;
+  EntityId entity_id;
   Side side = Side::Neutral;
   UnitType type = UnitType::Unknown;
   Pose pose;
@@ -22,8 +26,8 @@ struct DisEntityPdu {
 
 struct DisFirePdu {
   std::int64_t timestamp_ms = 0;
-  std::string shooter_id;
-  std::string target_id;
+  EntityId shooter_id;
+  EntityId target_id;
   std::string weapon_name;
   Pose origin;
 };
@@ -32,20 +36,70 @@ struct DisPduBatch {
   std::vector<DisEntityPdu> entity_updates;
   std::vector<DisFirePdu> fire_events;
   std::optional<EnvironmentState> env;
+  // 帧时间戳：文本回放加载器按记录时间戳填入（只含环境记录的帧同样有效）；为 0 表示未知，由各 PDU 时间戳推导。
+  std::int64_t timestamp_ms = 0;
+};
+
+struct SnapshotUpdate {
+  // 不可变快照：发布后适配器不再改动它。最后一个持有者释放时缓冲经回收池交还适配器，
+  // 适配器按此后的变化实体追平后复用为下一版的工作副本，不整份复制。
+  std::shared_ptr<const BattlefieldSnapshot> snapshot;
+  // 自上次轮询以来状态发生变化的实体。
+  std::vector<EntityId> dirty_entities;
+  // 快照被整体替换（如 FeedMockFrame），消费者应丢弃基于增量维护的状态。
+  bool full_refresh = false;
+  std::uint64_t version = 0;
 };
 
 class DisAdapter {
  public:
   void FeedMockFrame(const BattlefieldSnapshot& snapshot);
   void Ingest(const DisPduBatch& batch);
+  // 兼容接口：返回快照拷贝。
   std::optional<BattlefieldSnapshot> Poll();
+  // 增量接口：开销与变化实体数成正比。
+  std::optional<SnapshotUpdate> PollUpdate();
   std::vector<EventRecord> DrainEvents();
 
+  // 检查点：写出快照、中立单位与环境，须在 PollUpdate/DrainEvents 之后调用（无待输出的增量与事件）。
+  void SaveState(BinaryWriter& out) const;
+  // 恢复后下一次轮询标记为整体刷新，消费者据此丢弃增量维护的状态。
+  void RestoreState(BinaryReader& in);
+
  private:
+  struct Slot {
+    Side side = Side::Neutral;
+    std::size_t index = 0;
+    bool dirty = false;
+  };
+
+  struct SnapshotPool;
+  struct ChangeLogEntry {
+    std::uint64_t version = 0;
+    std::vector<EntityId> ids;
+  };
+
+  BattlefieldSnapshot& MutableSnapshot();
+  void CatchUp(BattlefieldSnapshot& buffer) const;
   void UpsertEntity(const DisEntityPdu& pdu);
-  BattlefieldSnapshot BuildSnapshot(std::int64_t timestamp_ms) const;
+  void AppendToSide(EntityState&& state, Slot& slot);
+  EntityState RemoveFromSide(const Slot& slot);
+  void MarkDirty(EntityId id, Slot& slot);
 
-  std::unordered_map<std::string, EntityState> entities_;
+  // 已发布的最新快照（只读）与本轮修改所在的私有工作副本；工作副本在 PollUpdate 时移交发布。
+  std::shared_ptr<const BattlefieldSnapshot> published_;
+  std::unique_ptr<BattlefieldSnapshot> working_;
+  // 回收池经互斥量交接缓冲所有权，消费者线程释放快照与适配器复用之间有明确的先后关系。
+  std::shared_ptr<SnapshotPool> pool_;
+  // 最近若干版本中行内容或下标改变的实体；版本不早于 change_log_base_ 的回收缓冲可按此追平。
+  std::deque<ChangeLogEntry> change_log_;
+  std::uint64_t change_log_base_ = 0;
+  std::vector<EntityId> moved_;
+  std::vector<EntityState> neutral_units_;
+  std::unordered_map<EntityId, Slot> slots_;
+  std::vector<EntityId> dirty_;
+  bool full_refresh_ = false;
+  std::uint64_t version_ = 0;
   EnvironmentState env_;
   std::int64_t latest_timestamp_ms_ = 0;
   bool has_update_ = false;
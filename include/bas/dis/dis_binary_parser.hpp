@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 
+#include "bas/common/byte_view.hpp"
 #include "bas/dis/dis_adapter.hpp"
 
 namespace bas {
@@ -22,21 +23,31 @@ struct DisPduHeader {
 class DisBinaryParser {
  public:
   std::vector<DisPduBatch> ParseFile(const std::string& path) const;
-  std::vector<DisPduBatch> ParseBytes(const std::vector<std::uint8_t>& bytes) const;
+  std::vector<DisPduBatch> ParseBytes(ByteView bytes) const;
+
+  static constexpr std::size_t kHeaderLength = 12;
+
+  // 单条PDU解析接口，供流式解析与UDP接收复用；stream_offset 仅用于错误信息中的字节偏移。
+  static DisPduHeader ReadPduHeader(ByteView bytes, std::size_t offset, std::size_t stream_offset);
+  void AppendPdu(ByteView bytes,
+                 std::size_t offset,
+                 const DisPduHeader& header,
+                 std::size_t stream_offset,
+                 DisPduBatch& batch) const;
 
  private:
-  static DisPduHeader ParseHeader(const std::vector<std::uint8_t>& bytes, std::size_t offset);
-  static DisEntityPdu ParseEntityStatePdu(const std::vector<std::uint8_t>& bytes, std::size_t offset, std::size_t length);
-  static DisFirePdu ParseFirePdu(const std::vector<std::uint8_t>& bytes, std::size_t offset, std::size_t length);
+  static DisPduHeader ParseHeader(ByteView bytes, std::size_t offset);
+  static DisEntityPdu ParseEntityStatePdu(ByteView bytes, std::size_t offset, std::size_t stream_offset);
+  static DisFirePdu ParseFirePdu(ByteView bytes, std::size_t offset, std::size_t stream_offset);
 
-  static std::uint16_t ReadU16BE(const std::vector<std::uint8_t>& bytes, std::size_t offset);
-  static std::uint32_t ReadU32BE(const std::vector<std::uint8_t>& bytes, std::size_t offset);
-  static float ReadF32BE(const std::vector<std::uint8_t>& bytes, std::size_t offset);
-  static double ReadF64BE(const std::vector<std::uint8_t>& bytes, std::size_t offset);
+  static std::uint16_t ReadU16BE(ByteView bytes, std::size_t offset);
+  static std::uint32_t ReadU32BE(ByteView bytes, std::size_t offset);
+  static float ReadF32BE(ByteView bytes, std::size_t offset);
+  static double ReadF64BE(ByteView bytes, std::size_t offset);
 
-  static std::string ParseEntityId(const std::vector<std::uint8_t>& bytes, std::size_t offset);
+  static EntityId ParseEntityId(ByteView bytes, std::size_t offset, std::size_t stream_offset);
   static Side ParseForceId(std::uint8_t force_id);
-  static UnitType ParseUnitType(const std::vector<std::uint8_t>& bytes, std::size_t offset);
+  static UnitType ParseUnitType(ByteView bytes, std::size_t offset);
 };
 
 }  // namespace bas
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "bas/common/binary_io.hpp"
+#include "bas/common/byte_view.hpp"
+#include "bas/dis/dis_binary_parser.hpp"
+
+namespace bas {
+
+struct DisStreamConfig {
+  // 批次关闭规则：已见最大时间戳超过某批次时间戳 reorder_window 以上时，该批次关闭并输出。
+  // 0 表示遇到更新的时间戳即关闭此前所有批次。批次关闭后才到达的同时间戳 PDU 为迟到 PDU：
+  // 实体状态仅在该实体已有更新状态时丢弃，否则与开火一并并入下一个输出的批次，不单独输出旧时间戳批次。
+  std::uint32_t reorder_window = 0;
+  // 未关闭批次数上限，超出时强制关闭最早批次，保证乱序输入下内存有界；0 表示不限制。
+  std::size_t max_open_batches = 4096;
+};
+
+class DisStreamParser {
+ public:
+  using BatchSink = std::function<void(DisPduBatch&&)>;
+
+  explicit DisStreamParser(DisStreamConfig config = {});
+
+  // 输入任意大小的字节块；跨块的残缺PDU会被暂存，关闭的批次按时间戳升序交给 sink。
+  void Feed(ByteView chunk, const BatchSink& sink);
+  // 输入结束：输出全部未关闭批次；若仍有残缺PDU则抛出异常。
+  void Finish(const BatchSink& sink);
+
+  std::size_t consumed_bytes() const { return consumed_bytes_; }
+  std::size_t open_batches() const { return open_.size(); }
+  // 迟到PDU数（含并入后续批次与被丢弃的PDU）。
+  std::size_t late_pdus() const { return late_pdus_; }
+  // 块尾残缺PDU已暂存的字节数；consumed_bytes() + pending_bytes() 即已喂入的总字节数。
+  std::size_t pending_bytes() const { return carry_.size(); }
+
+  // 检查点：保存未关闭批次、残缺PDU与关闭进度。恢复后从已喂入的总字节数处按原切块继续 Feed，
+  // 批次关闭时机只在块尾检查，切块不同会改变乱序输入的分批结果。
+  void SaveState(BinaryWriter& out) const;
+  void RestoreState(BinaryReader& in);
+
+ private:
+  void ConsumePdu(ByteView bytes, std::size_t offset, const DisPduHeader& header);
+  void CloseReady(const BatchSink& sink);
+  void Emit(DisPduBatch&& batch, const BatchSink& sink);
+
+  DisStreamConfig config_;
+  DisBinaryParser parser_;
+  std::vector<std::uint8_t> carry_;
+  std::map<std::uint32_t, DisPduBatch> open_;
+  // 待并入下一个输出批次的迟到PDU。
+  DisPduBatch late_;
+  // 各实体已接收状态的最新时间戳，用于判断迟到状态是否已被覆盖。
+  std::unordered_map<EntityId, std::uint32_t> entity_timestamps_;
+  std::size_t consumed_bytes_ = 0;
+  std::size_t late_pdus_ = 0;
+  std::uint32_t max_timestamp_ = 0;
+  bool has_closed_ = false;
+  std::uint32_t last_closed_timestamp_ = 0;
+};
+
+}  // namespace bas
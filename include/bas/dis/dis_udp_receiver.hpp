@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "bas/common/spsc_queue.hpp"
+#include "bas/dis/dis_adapter.hpp"
+#include "bas/dis/dis_binary_parser.hpp"
+
+namespace bas {
+
+struct DisUdpConfig {
+  std::string bind_address = "0.0.0.0";
+  std::uint16_t port = 3000;
+  // 非空时加入该组播组；为空时按单播/广播接收。
+  std::string multicast_group;
+  std::string multicast_interface = "0.0.0.0";
+  std::size_t recv_batch = 64;
+  std::size_t max_datagram_bytes = 8192;
+  std::size_t queue_capacity = 1024;
+  int socket_buffer_bytes = 4 * 1024 * 1024;
+  int poll_interval_ms = 50;
+};
+
+struct DisUdpStats {
+  std::uint64_t datagrams = 0;
+  std::uint64_t bytes = 0;
+  std::uint64_t pdus = 0;
+  std::uint64_t parse_errors = 0;
+  std::uint64_t dropped_batches = 0;
+  std::uint64_t dropped_pdus = 0;
+  std::size_t backlog = 0;
+};
+
+// 实时 DIS 接收器：独立 I/O 线程用 recvmmsg 批量收包并解析，经 SPSC 队列交给决策线程。
+class DisUdpReceiver {
+ public:
+  explicit DisUdpReceiver(DisUdpConfig config = {});
+  ~DisUdpReceiver();
+
+  DisUdpReceiver(const DisUdpReceiver&) = delete;
+  DisUdpReceiver& operator=(const DisUdpReceiver&) = delete;
+
+  void Start();
+  void Stop();
+  bool running() const { return running_.load(std::memory_order_acquire); }
+  std::uint16_t bound_port() const { return bound_port_; }
+
+  // 仅由单一消费线程调用。
+  bool TryPop(DisPduBatch& batch);
+  std::size_t DrainInto(DisAdapter& adapter, std::size_t max_batches = static_cast<std::size_t>(-1));
+
+  DisUdpStats stats() const;
+
+ private:
+  void OpenSocket();
+  void RunLoop();
+
+  DisUdpConfig config_;
+  DisBinaryParser parser_;
+  SpscQueue<DisPduBatch> queue_;
+  std::thread thread_;
+  std::atomic<bool> running_{false};
+  int fd_ = -1;
+  std::uint16_t bound_port_ = 0;
+
+  std::atomic<std::uint64_t> datagrams_{0};
+  std::atomic<std::uint64_t> bytes_{0};
+  std::atomic<std::uint64_t> pdus_{0};
+  std::atomic<std::uint64_t> parse_errors_{0};
+  std::atomic<std::uint64_t> dropped_batches_{0};
+  std::atomic<std::uint64_t> dropped_pdus_{0};
+};
+
+}  // namespace bas
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/socket.h>
+
+namespace bas {
+
+struct HttpUrl {
+  std::string host;
+  std::uint16_t port = 80;
+  std::string target = "/";
+
+  // 仅支持 http://host[:port][/path]；https 需经本地代理转发。
+  static bool Parse(const std::string& url, HttpUrl& out);
+};
+
+struct HttpResponse {
+  int status = 0;
+  std::string body;
+  // 非空表示传输层失败（连接、超时、协议错误），此时 status 为 0。
+  std::string error;
+
+  bool ok() const { return error.empty() && status >= 200 && status < 300; }
+};
+
+struct HttpClientStats {
+  std::size_t requests = 0;
+  std::size_t connections_opened = 0;
+  std::size_t connections_reused = 0;
+  // 实际发起的域名解析次数：每个 host:port 只解析一次，连接全部失败后才重新解析。
+  std::size_t dns_lookups = 0;
+};
+
+// 进程内 HTTP/1.1 客户端：按 host:port 维护长连接池与解析结果缓存，每个请求有从发起时刻起算的整体截止时间
+// （连接、发送、接收共用；域名解析只在首次连接该主机时发生）。线程安全，可被多个 ModelRuntime 副本共享。
+class HttpClient {
+ public:
+  using Headers = std::vector<std::pair<std::string, std::string>>;
+
+  explicit HttpClient(std::size_t max_idle_per_host = 4);
+  ~HttpClient();
+
+  HttpClient(const HttpClient&) = delete;
+  HttpClient& operator=(const HttpClient&) = delete;
+
+  HttpResponse Post(const std::string& url, const std::string& body, const Headers& headers, int timeout_ms);
+
+  HttpClientStats stats() const;
+  std::size_t idle_connections() const;
+
+ private:
+  struct ResolvedAddress {
+    int family = 0;
+    int socktype = 0;
+    int protocol = 0;
+    sockaddr_storage addr{};
+    socklen_t addr_len = 0;
+  };
+
+  int AcquireIdle(const std::string& key);
+  void ReleaseIdle(const std::string& key, int fd);
+  // 取缓存的解析结果，缺失时解析并缓存；失败返回 false 并写入 error。
+  bool Resolve(const HttpUrl& url, const std::string& key, std::vector<ResolvedAddress>& out, std::string& error);
+  int Connect(const HttpUrl& url, const std::string& key, std::chrono::steady_clock::time_point deadline,
+              std::string& error);
+
+  std::size_t max_idle_per_host_;
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::vector<int>> idle_;
+  std::unordered_map<std::string, std::vector<ResolvedAddress>> resolved_;
+  HttpClientStats stats_;
+};
+
+}  // namespace bas
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bas {
+
+struct ModelBatchOptions {
+  // 首个请求到达后最多等待多久再发出整批。
+  int window_ms = 5;
+  std::size_t max_batch_size = 8;
+};
+
+struct ModelBatchReply {
+  std::string content;
+  // 非空表示该条请求失败，内容为可直接展示的回退说明。
+  std::string error;
+};
+
+struct ModelBatchStats {
+  std::size_t requests = 0;
+  std::size_t deduplicated = 0;
+  std::size_t batches = 0;
+  std::size_t largest_batch = 0;
+};
+
+// 模型请求合批器：窗口内到达的请求由首个到达者（领队线程）打包成一次调用发出，
+// 其余线程阻塞等待各自结果；与在途请求载荷完全相同的请求直接共享结果，不再发送。
+// 线程安全，由 ModelRuntime 的各副本共享。
+class ModelBatcher {
+ public:
+  // payloads 与返回值按下标一一对应。
+  using SendFn = std::function<std::vector<ModelBatchReply>(const std::vector<std::string>& payloads)>;
+
+  explicit ModelBatcher(ModelBatchOptions options = {});
+
+  ModelBatchReply Submit(const std::string& payload, const SendFn& send);
+
+  ModelBatchStats stats() const;
+  // 累加其他合批器的统计（如批量回放各场景的独立合批器），最大批取两者较大值。
+  void MergeStats(const ModelBatchStats& other);
+
+ private:
+  struct Entry {
+    ModelBatchReply reply;
+    bool done = false;
+  };
+
+  struct Batch {
+    std::vector<std::string> payloads;
+    std::vector<std::shared_ptr<Entry>> entries;
+  };
+
+  ModelBatchOptions options_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::shared_ptr<Batch> open_batch_;
+  // 已提交但尚未完成的请求（含等待中与发送中），用于去重。
+  std::unordered_map<std::string, std::shared_ptr<Entry>> inflight_;
+  ModelBatchStats stats_;
+};
+
+}  // namespace bas
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace bas {
+
+struct ModelResponseCacheStats {
+  std::size_t hits = 0;
+  std::size_t misses = 0;
+  std::size_t expired = 0;
+  std::size_t evictions = 0;
+  std::size_t loaded = 0;
+  std::size_t entries = 0;
+};
+
+struct CachedModelResponse {
+  std::size_t selected_index = 0;
+  std::string explanation;
+};
+
+// 模型响应缓存：按规范化后的候选方案与战术标签集合索引，不含记忆上下文，
+// 因此单位小幅移动导致决策缓存未命中时仍可复用上次排序结果。
+// 容量有界（LRU 淘汰），可落盘供重复回放复用。线程安全，由 ModelRuntime 各副本共享。
+class ModelResponseCache {
+ public:
+  // ttl_ms <= 0 表示永不过期。
+  ModelResponseCache(std::size_t capacity, std::int64_t ttl_ms);
+
+  // 候选逐条折叠空白，标签排序去重；模型名与生成长度也进入键，换模型不会误命中。
+  static std::string MakeKey(const std::string& model_name,
+                             std::size_t max_tokens,
+                             const std::vector<std::string>& candidates,
+                             const std::vector<std::string>& tags);
+
+  std::optional<CachedModelResponse> Get(const std::string& key, std::int64_t now_ms);
+  void Put(const std::string& key, const CachedModelResponse& value, std::int64_t now_ms);
+
+  // 文本格式，每行一条；加载时跳过已过期与格式错误的行。
+  bool Load(const std::string& path, std::int64_t now_ms);
+  bool Save(const std::string& path) const;
+
+  ModelResponseCacheStats stats() const;
+
+  // 复制当前条目，统计清零（entries 除外）；批量回放据此为每个场景建立独立缓存。
+  std::shared_ptr<ModelResponseCache> Clone() const;
+  // 按从旧到新并入 other 的条目（同键以 other 为准）并累加其命中统计。
+  void Merge(const ModelResponseCache& other);
+
+ private:
+  struct Entry {
+    std::string key;
+    CachedModelResponse value;
+    std::int64_t stored_ms = 0;
+  };
+
+  bool Expired(const Entry& entry, std::int64_t now_ms) const;
+  void InsertLocked(const std::string& key, const CachedModelResponse& value, std::int64_t stored_ms);
+
+  std::size_t capacity_;
+  std::int64_t ttl_ms_;
+  mutable std::mutex mutex_;
+  // 头部为最近使用。
+  std::list<Entry> lru_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+  ModelResponseCacheStats stats_;
+};
+
+}  // namespace bas
@@ -1,9 +1,16 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "bas/inference/http_client.hpp"
+#include "bas/inference/model_batcher.hpp"
+#include "bas/inference/model_response_cache.hpp"
+
 namespace bas {
 
 enum class ModelBackend { Mock, OpenAICompatible };
@@ -16,11 +23,26 @@ struct ModelConfig {
   std::string endpoint = "http://127.0.0.1:8000/v1/chat/completions";
   std::string api_key;
   int timeout_ms = 250;
+  // 合批：窗口内并发到达的请求合并为一次 /v1/batch 调用；仅对 OpenAI 兼容后端生效。
+  bool enable_batching = false;
+  int batch_window_ms = 5;
+  std::size_t max_batch_size = 8;
+  // 为空时由 endpoint 推导（.../chat/completions → .../batch）。
+  std::string batch_endpoint = {};
+  // 响应缓存：按候选方案与战术标签复用模型排序结果，命中时不发请求；仅对 OpenAI 兼容后端生效。
+  bool enable_response_cache = false;
+  std::size_t response_cache_capacity = 1024;
+  // <= 0 表示永不过期；按墙钟计时，落盘后跨进程仍有效。
+  std::int64_t response_cache_ttl_ms = 10 * 60 * 1000;
+  // 非空时 Configure 从该文件加载，SaveResponseCache 写回。
+  std::string response_cache_path = {};
 };
 
 struct ModelRequest {
   std::string context;
   std::vector<std::string> candidate_summaries;
+  // 当前态势的战术标签名，参与响应缓存键。
+  std::vector<std::string> tags = {};
 };
 
 struct ModelResponse {
@@ -30,17 +52,47 @@ struct ModelResponse {
 
 class ModelRuntime {
  public:
+  ModelRuntime();
+
   void Configure(const ModelConfig& config);
   ModelResponse RankAndExplain(const ModelRequest& request) const;
 
+  // 隔离副本：共享配置与连接池，合批器新建、响应缓存复制当前条目，此后与本运行时及其他副本互不影响。
+  ModelRuntime Fork() const;
+  // 把 Fork 副本的缓存条目与合批、缓存统计并回本运行时（及共享其状态的副本）。
+  void Absorb(const ModelRuntime& fork) const;
+
+  const ModelConfig& config() const { return config_; }
+  // 未启用合批时返回全零统计。
+  ModelBatchStats batch_stats() const;
+  // 未启用响应缓存时返回全零统计。
+  ModelResponseCacheStats response_cache_stats() const;
+  // 写回 response_cache_path；未启用缓存或未配置路径时返回 false。
+  bool SaveResponseCache() const;
+
  private:
+  struct CallSettings {
+    std::string endpoint;
+    std::string batch_endpoint;
+    HttpClient::Headers headers;
+    int timeout_ms = 0;
+  };
+
+  ModelBatchReply SendChat(const std::string& payload, const CallSettings& call) const;
+  std::vector<ModelBatchReply> SendBatch(const std::vector<std::string>& payloads, const CallSettings& call) const;
+
   static std::string EscapeJson(const std::string& text);
-  static std::string RunCommand(const std::string& command);
   static std::string ExtractAssistantContent(const std::string& json_text);
   static std::string ExtractExplanation(const std::string& text);
   static std::size_t ParseSelectedIndex(const std::string& text, std::size_t max_index);
 
   ModelConfig config_;
+  // 副本之间共享连接池，AgentPipeline 按值持有也能复用长连接。
+  std::shared_ptr<HttpClient> http_;
+  std::shared_ptr<ModelBatcher> batcher_;
+  std::shared_ptr<ModelResponseCache> response_cache_;
+  // 服务端不支持批量接口（404）后改为逐条发送，副本间共享。
+  std::shared_ptr<std::atomic<bool>> batch_unsupported_;
 };
 
 }  // namespace bas
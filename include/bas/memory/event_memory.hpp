@@ -1,29 +1,197 @@
 #pragma once
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <deque>
+#include <iterator>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "bas/common/binary_io.hpp"
 #include "bas/common/types.hpp"
 
 namespace bas {
 
+// 事件视图：message 指向记忆内部的驻留字符串，在下一次 AddEvent 之前有效；结构化事件的 message 为空。
+struct EventView {
+  std::int64_t timestamp_ms = 0;
+  EventType type = EventType::Unknown;
+  EntityId actor_id;
+  Pose pose;
+  std::string_view message;
+  FirePayload fire;
+
+  EventRecord ToRecord() const { return {timestamp_ms, type, actor_id, pose, std::string(message), fire}; }
+};
+
+// 定长环形事件记忆：记录紧凑存放、消息文本驻留共享，并按事件类型与参与方各维护一条
+// “上一条同类事件”链，最近同类事件 O(1)、按参与方检索 O(k)。查询结果为惰性视图，不复制记录。
 class EventMemory {
+ private:
+  enum class Chain { All, Type, Actor };
+
  public:
-  explicit EventMemory(std::int64_t retention_ms = 10 * 60 * 1000);
+  // 按时间从新到旧遍历，遇到窗口外的事件即停止。
+  class Range {
+   public:
+    class Iterator {
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = EventView;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = EventView;
+
+      EventView operator*() const { return memory_->View(seq_); }
+      Iterator& operator++();
+      friend bool operator==(const Iterator& a, const Iterator& b) { return a.seq_ == b.seq_; }
+      friend bool operator!=(const Iterator& a, const Iterator& b) { return a.seq_ != b.seq_; }
+
+     private:
+      friend class Range;
+      Iterator(const EventMemory* memory, std::uint64_t seq, Chain chain, std::int64_t now_ms, std::int64_t window_ms);
+
+      const EventMemory* memory_ = nullptr;
+      std::uint64_t seq_ = 0;
+      Chain chain_ = Chain::All;
+      std::int64_t now_ms_ = 0;
+      std::int64_t window_ms_ = 0;
+    };
+
+    Iterator begin() const { return Iterator(memory_, head_, chain_, now_ms_, window_ms_); }
+    Iterator end() const { return Iterator(memory_, 0, chain_, now_ms_, window_ms_); }
+    bool empty() const { return begin() == end(); }
+    std::size_t size() const;
+    EventView front() const { return *begin(); }
+
+   private:
+    friend class EventMemory;
+    Range(const EventMemory* memory, std::uint64_t head, Chain chain, std::int64_t now_ms, std::int64_t window_ms)
+        : memory_(memory), head_(head), chain_(chain), now_ms_(now_ms), window_ms_(window_ms) {}
+
+    const EventMemory* memory_;
+    std::uint64_t head_;
+    Chain chain_;
+    std::int64_t now_ms_;
+    std::int64_t window_ms_;
+  };
+
+  // context_budget_bytes 为 0 时上下文不设上限。
+  explicit EventMemory(std::int64_t retention_ms = 10 * 60 * 1000,
+                       std::size_t capacity = 4096,
+                       std::size_t context_budget_bytes = 0);
 
   void AddEvent(const EventRecord& event);
   void AddEvents(const std::vector<EventRecord>& events);
-  std::vector<EventRecord> QueryRecent(std::int64_t now_ms, std::int64_t window_ms) const;
-  std::optional<EventRecord> LastEventByType(EventType type, std::int64_t now_ms, std::int64_t window_ms) const;
-  std::string BuildContext(std::int64_t now_ms, std::int64_t window_ms) const;
+
+  // 以下查询返回的视图在下一次 AddEvent 之前有效。
+  Range QueryRecent(std::int64_t now_ms, std::int64_t window_ms) const;
+  Range QueryByType(EventType type, std::int64_t now_ms, std::int64_t window_ms) const;
+  Range QueryByActor(EntityId actor_id, std::int64_t now_ms, std::int64_t window_ms) const;
+  std::optional<EventView> LastEventByType(EventType type, std::int64_t now_ms, std::int64_t window_ms) const;
+
+  // 按到达顺序（从旧到新）拼接窗口内事件。已渲染的明细行跨调用保留，只追加新事件、从头部剔除过期事件；
+  // 超出预算时把较早的事件按（类型、参与方）折叠为汇总行置于开头，明细区占预算的 3/4。
+  // 结果只取决于当前窗口内容，与调用历史无关（要求 now_ms 单调不减，窗口长度变化时整体重建）。
+  std::string BuildContext(std::int64_t now_ms, std::int64_t window_ms);
+
+  std::size_t size() const { return static_cast<std::size_t>(next_seq_ - first_seq_); }
+  std::size_t capacity() const { return ring_.size(); }
+  std::size_t interned_messages() const { return message_ids_.size(); }
+
+  // 检查点：按从旧到新写出存活事件，恢复时依次重新加入，检索链与上下文缓存随之重建。
+  void SaveState(BinaryWriter& out) const;
+  void RestoreState(BinaryReader& in);
 
  private:
-  void Trim(std::int64_t now_ms);
+  static constexpr std::size_t kEventTypeCount = static_cast<std::size_t>(EventType::Unknown) + 1;
+
+  struct Slot {
+    std::int64_t timestamp_ms = 0;
+    EventType type = EventType::Unknown;
+    EntityId actor_id;
+    Pose pose;
+    std::uint32_t message = 0;
+    FirePayload fire;
+    // 同类型、同参与方的上一条事件序号；0 表示无。
+    std::uint64_t prev_same_type = 0;
+    std::uint64_t prev_same_actor = 0;
+  };
+
+  bool Live(std::uint64_t seq) const { return seq != 0 && seq >= first_seq_ && seq < next_seq_; }
+  const Slot& SlotOf(std::uint64_t seq) const { return ring_[seq % ring_.size()]; }
+  EventView View(std::uint64_t seq) const;
+  void EvictOldest();
+  void RenderContent(const Slot& slot, std::string& out) const;
+  void RenderLine(const Slot& slot, std::string& out) const;
+  void DropTailBefore(std::uint64_t seq);
+  void UpdateSummary();
+  void EnterSummary(std::uint64_t seq);
+  void LeaveSummary(std::uint64_t seq);
+  void RenderSummary();
+  std::uint32_t InternMessage(const std::string& message);
+  void ReleaseMessage(std::uint32_t id);
 
-  std::deque<EventRecord> events_;
   std::int64_t retention_ms_;
+  std::vector<Slot> ring_;
+  // 存活事件序号区间 [first_seq_, next_seq_)，序号从 1 开始单调递增，槽位为序号对容量取模。
+  std::uint64_t first_seq_ = 1;
+  std::uint64_t next_seq_ = 1;
+  std::array<std::uint64_t, kEventTypeCount> type_head_{};
+  std::unordered_map<EntityId, std::uint64_t> actor_head_;
+  // 驻留消息：deque 保证追加时已有字符串地址不变，引用计数归零后回收编号。
+  std::deque<std::string> messages_;
+  std::vector<std::uint32_t> message_refs_;
+  std::vector<std::uint32_t> free_messages_;
+  std::unordered_map<std::string_view, std::uint32_t> message_ids_;
+
+  static constexpr std::uint32_t kNoGroup = 0xFFFFFFFFU;
+
+  // 汇总分组（类型、参与方）：成员按序号先进先出，单调队列维护成员时间戳的最小/最大值；
+  // 分组按最近成员序号串成双向链，汇总行只在分组变化后重新渲染。
+  struct SummaryGroup {
+    std::uint64_t key = 0;
+    EventType type = EventType::Unknown;
+    EntityId actor_id;
+    std::size_t count = 0;
+    std::uint64_t last_seq = 0;
+    std::deque<std::pair<std::uint64_t, std::int64_t>> min_ts;
+    std::deque<std::pair<std::uint64_t, std::int64_t>> max_ts;
+    std::uint32_t prev = kNoGroup;
+    std::uint32_t next = kNoGroup;
+    std::string line;
+    bool dirty = true;
+  };
+
+  // BuildContext 的增量状态：[lo, tail_start) 折叠进汇总，[tail_start, next) 为已渲染的明细行。
+  struct ContextCache {
+    std::int64_t window_ms = -1;
+    std::int64_t now_ms = 0;
+    std::uint64_t lo = 1;
+    std::uint64_t tail_start = 1;
+    std::uint64_t next = 1;
+    std::string tail;
+    std::deque<std::uint32_t> tail_lengths;
+    // 已计入分组的区间 [summary_lo, summary_hi)；summary_members 记录其中每个事件所属分组，
+    // 事件离开时槽位可能已被环形覆盖，据此出队而不回读槽位。
+    std::uint64_t summary_lo = 0;
+    std::uint64_t summary_hi = 0;
+    std::deque<std::uint32_t> summary_members;
+    std::vector<SummaryGroup> groups;
+    std::vector<std::uint32_t> free_groups;
+    std::unordered_map<std::uint64_t, std::uint32_t> group_of;
+    std::uint32_t oldest_group = kNoGroup;
+    std::uint32_t newest_group = kNoGroup;
+    bool summary_changed = false;
+    std::string summary;
+  };
+  std::size_t context_budget_bytes_;
+  ContextCache context_;
 };
 
 }  // namespace bas
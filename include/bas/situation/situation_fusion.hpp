@@ -2,18 +2,23 @@
 
 #include <vector>
 
+#include "bas/common/spatial_index.hpp"
 #include "bas/common/types.hpp"
+#include "bas/memory/event_memory.hpp"
 
 namespace bas {
 
 class SituationFusion {
  public:
+  // 只读取快照时刻前 window_ms 内的记忆事件；index 为空时按快照现场构建空间索引。
   SituationSemantics Infer(const BattlefieldSnapshot& snapshot,
-                           const std::vector<EventRecord>& recent_events) const;
+                           const EventMemory& memory,
+                           std::int64_t window_ms,
+                           const SnapshotIndex* index = nullptr) const;
 
  private:
-  static int CountEnemyOnLeftFlank(const BattlefieldSnapshot& snapshot);
-  static int CountNearbyArmor(const BattlefieldSnapshot& snapshot, double range_m);
+  static int CountEnemyOnLeftFlank(const EntityTable& friendlies, const EntityTable& hostiles);
+  static int CountNearbyArmor(const SnapshotIndex& index, double range_m);
 };
 
 }  // namespace bas
@@ -1,10 +1,20 @@
 #pragma once
 
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "bas/cache/decision_cache.hpp"
+#include "bas/cache/feature_key.hpp"
+#include "bas/cache/similarity_index.hpp"
+#include "bas/common/thread_pool.hpp"
 #include "bas/decision/fire_control_engine.hpp"
 #include "bas/decision/maneuver_engine.hpp"
+#include "bas/dis/dis_adapter.hpp"
 #include "bas/inference/model_runtime.hpp"
 #include "bas/memory/event_memory.hpp"
 #include "bas/situation/situation_fusion.hpp"
@@ -14,6 +24,68 @@ namespace bas {
 struct PipelineConfig {
   std::int64_t cache_ttl_ms = 3000;
   std::int64_t memory_window_ms = 5 * 60 * 1000;
+  // 事件记忆环形缓冲容量，超出时覆盖最旧事件。
+  std::size_t memory_capacity = 4096;
+  // 模型上下文字节预算，超出部分按参与方折叠为汇总行；0 表示不设上限。
+  std::size_t context_budget_bytes = 4096;
+  // 分阶段并行：火力与机动只读共享输入，在独立线程上与调用线程并发执行。
+  bool parallel_stages = false;
+  // 机动路径规划线程数：非 0 时流水线自建线程池交给机动引擎，需规划单位数达到 parallel_min_units 时并行规划。
+  std::size_t maneuver_threads = 0;
+  double spatial_cell_m = 250.0;
+  // 异步模型模式：Tick 立即返回规则方案与临时解释，模型结果稍后按 tick_seq 合并。
+  bool async_model = false;
+  // 在途模型请求上限，超过时本次 Tick 不再发起请求，避免慢模型下请求无限堆积。
+  std::size_t max_inflight_model_requests = 4;
+  // 决策缓存条目上限，超出时淘汰最久未用条目。
+  std::size_t cache_capacity = 4096;
+  // 相似态势复用：精确缓存未命中时，在近期决策中找特征距离不超过阈值的最近邻，
+  // 重新校验射程、弹药、存活与机动起点偏移后直接沿用，省去火力、机动与模型调用。
+  bool similarity_reuse = false;
+  double similarity_threshold = 0.5;
+  std::size_t similarity_capacity = 256;
+  double similarity_max_drift_m = 150.0;
+};
+
+struct SimilarReuseStats {
+  std::size_t lookups = 0;
+  std::size_t reused = 0;
+  // 找到近邻但硬约束校验未通过、改为重新计算的次数。
+  std::size_t rejected = 0;
+};
+
+struct StageLatency {
+  std::size_t samples = 0;
+  double total_ms = 0.0;
+  double max_ms = 0.0;
+
+  void Record(double ms) {
+    ++samples;
+    total_ms += ms;
+    max_ms = ms > max_ms ? ms : max_ms;
+  }
+  double mean_ms() const { return samples == 0 ? 0.0 : total_ms / static_cast<double>(samples); }
+};
+
+// 各阶段耗时。缓存或相似复用命中的 Tick 只计入 tick 与 fusion 之前的阶段。
+struct PipelineStageStats {
+  StageLatency tick;
+  // 写入事件记忆、构建空间索引与态势融合。
+  StageLatency fusion;
+  StageLatency fire;
+  StageLatency maneuver;
+  // 火力与机动阶段的墙钟时间；并行时接近二者的较大值，顺序执行时为二者之和。
+  StageLatency decision;
+  StageLatency context;
+  // 同步模式为模型调用耗时；异步模式只含提交，模型本身与后续 Tick 重叠执行。
+  StageLatency model;
+};
+
+struct ModelUpdate {
+  std::uint64_t tick_seq = 0;
+  std::int64_t timestamp_ms = 0;
+  std::size_t selected_index = 0;
+  std::string explanation;
 };
 
 class AgentPipeline {
@@ -23,18 +95,85 @@ class AgentPipeline {
                 ManeuverEngine maneuver_engine,
                 ModelRuntime model_runtime);
 
+  using ModelUpdateCallback = std::function<void(const ModelUpdate&)>;
+
+  ~AgentPipeline();
+
+  AgentPipeline(const AgentPipeline&) = delete;
+  AgentPipeline& operator=(const AgentPipeline&) = delete;
+
   DecisionPackage Tick(const BattlefieldSnapshot& snapshot, const std::vector<EventRecord>& dis_events);
+  // 按 DisAdapter 报告的变化实体增量维护缓存键，适合逐帧连续轮询的场景。
+  DecisionPackage Tick(const SnapshotUpdate& update, const std::vector<EventRecord>& dis_events);
+
+  // 异步模式下模型结果完成时在模型线程上回调，回调内不得调用本对象的其他方法。
+  void SetModelUpdateCallback(ModelUpdateCallback callback);
+  // 取出自上次调用以来完成的模型结果（已合并进决策缓存），须与 Tick 在同一线程调用。
+  std::vector<ModelUpdate> DrainModelUpdates();
+  // 阻塞直到全部在途模型请求完成，返回值同 DrainModelUpdates。
+  std::vector<ModelUpdate> WaitForModelUpdates();
+  std::size_t inflight_model_requests() const;
+  const DecisionCacheStats& cache_stats() const { return cache_.stats(); }
+  const SimilarReuseStats& similar_stats() const { return similar_stats_; }
+  const PipelineStageStats& stage_stats() const { return stage_stats_; }
+
+  // 检查点：只保存事件记忆，须在新建流水线的首次 Tick 之前恢复。决策缓存与相似索引从空开始，
+  // 缓存键在下一次 Tick 时全量重建。
+  void SaveState(BinaryWriter& out) const;
+  void RestoreState(BinaryReader& in);
+
+  // tick_seq 匹配时把模型结果写入决策包并返回 true。
+  static bool ApplyModelUpdate(DecisionPackage& pkg, const ModelUpdate& update);
 
  private:
-  std::string BuildCacheKey(const BattlefieldSnapshot& snapshot) const;
+  struct AsyncModelState {
+    mutable std::mutex mutex;
+    std::condition_variable done;
+    std::vector<ModelUpdate> completed;
+    std::size_t inflight = 0;
+    ModelUpdateCallback callback;
+  };
+
+  struct PendingTick {
+    DecisionCache::Key cache_key = 0;
+    // 模型结果合并后才登记进相似索引，避免复用仍在等待模型的临时解释。
+    SituationFeatures features{};
+    std::int64_t timestamp_ms = 0;
+  };
+
+  DecisionPackage Decide(const BattlefieldSnapshot& snapshot,
+                         const std::vector<EventRecord>& dis_events,
+                         DecisionCache::Key cache_key);
+  // 写入精确缓存，启用相似复用时一并登记进相似索引。
+  void Remember(DecisionCache::Key cache_key,
+                const SituationFeatures& features,
+                const DecisionPackage& pkg,
+                std::int64_t timestamp_ms);
+  static std::string FormatExplanation(const ModelResponse& response);
+  void MergeCompletedModelUpdates();
 
   PipelineConfig config_;
   SituationFusion fusion_;
   EventMemory memory_;
   FireControlEngine fire_engine_;
+  // 先于机动引擎声明，引擎析构前线程池始终有效。
+  std::unique_ptr<ThreadPool> maneuver_pool_;
   ManeuverEngine maneuver_engine_;
   ModelRuntime model_runtime_;
   DecisionCache cache_;
+  FeatureKeyBuilder key_builder_;
+  std::uint64_t key_version_ = 0;
+  std::unique_ptr<SimilarityIndex> similar_;
+  SimilarReuseStats similar_stats_;
+  PipelineStageStats stage_stats_;
+  // 分阶段并行时执行机动阶段的单线程池，调用线程同时执行火力阶段。
+  std::unique_ptr<ThreadPool> stage_pool_;
+  std::uint64_t tick_seq_ = 0;
+  std::shared_ptr<AsyncModelState> async_;
+  std::unordered_map<std::uint64_t, PendingTick> pending_ticks_;
+  std::vector<ModelUpdate> ready_updates_;
+  // 最后声明、最先析构：析构时先等待在途模型请求结束。
+  std::unique_ptr<ThreadPool> model_pool_;
 };
 
 }  // namespace bas
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "bas/common/mapped_file.hpp"
+#include "bas/dis/dis_adapter.hpp"
+
+namespace bas {
+
+// 列式二进制回放（.basc），小端定宽字段：
+//   文件头 | 帧索引（每帧时间戳、块偏移、实体数、开火数、环境标志）| 实体编号字典 | 武器名字典 | 各帧数据块
+// 帧数据块：[环境 3×f64] 实体列（时间戳 i64；x、y、z、速度、航向、威胁 f64；编号 u32；阵营、类型、存活 u8）
+//           开火列（时间戳 i64；x、y、z f64；射手、目标、武器 u32），块按 8 字节对齐。
+// 每条 PDU 保留自己的时间戳，批内时间戳不一致（如 DIS 迟到开火并入后续批次）时转换前后逐条相同。
+// 编号与武器名以字典下标存放，加载时每个字典项只驻留一次，各帧直接按列拷贝，不做文本或字节序解析。
+constexpr char kColumnarReplayMagic[4] = {'B', 'A', 'S', 'C'};
+constexpr std::uint32_t kColumnarReplayVersion = 2;
+
+// 按扩展名识别列式回放（.basc）。
+bool IsColumnarReplay(const std::string& path);
+
+// 帧时间戳取 DisPduBatch::timestamp_ms；为 0 时取批内 PDU 时间戳的最大值，只含环境记录且未给出时间戳的
+// 批次沿用上一帧时间戳。
+std::vector<std::uint8_t> EncodeColumnarReplay(const std::vector<DisPduBatch>& batches);
+void WriteColumnarReplay(const std::vector<DisPduBatch>& batches, const std::string& path);
+
+class ColumnarReplayReader {
+ public:
+  // 映射文件并校验文件头、帧索引与字典；格式错误时抛出 std::runtime_error。
+  explicit ColumnarReplayReader(const std::string& path);
+
+  std::size_t frame_count() const { return frame_count_; }
+  std::int64_t timestamp(std::size_t frame) const;
+  DisPduBatch ReadFrame(std::size_t frame) const;
+  std::vector<DisPduBatch> LoadBatches() const;
+
+  // 顺序回放时提示内核回收已读帧的页缓存。
+  void ReleaseFrame(std::size_t frame) const;
+
+ private:
+  std::vector<std::string> ReadDictionary(std::size_t& offset, std::uint32_t count) const;
+
+  MappedFile file_;
+  std::size_t frame_count_ = 0;
+  std::size_t index_offset_ = 0;
+  std::vector<EntityId> ids_;
+  std::vector<std::string> weapons_;
+};
+
+}  // namespace bas
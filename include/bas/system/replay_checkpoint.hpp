@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "bas/common/mapped_file.hpp"
+
+namespace bas {
+
+// 回放检查点侧车文件（默认为 <回放文件>.ckpt），小端定宽字段：
+//   文件头 | 各检查点状态块 | 帧索引 | 检查点表
+// 文件头记录源文件长度与修改时间、乱序窗口和读块大小，任一不符即视为过期，回放退回从头开始。
+constexpr char kReplayCheckpointMagic[4] = {'B', 'A', 'S', 'K'};
+constexpr std::uint32_t kReplayCheckpointVersion = 4;
+
+struct ReplayFrameIndexEntry {
+  std::int64_t timestamp_ms = 0;
+  std::uint64_t offset = 0;
+};
+
+// 帧索引（时间戳 → 偏移）：.bas 为每帧首行的字节偏移；DIS 为每个读块结束处已喂入的字节数
+// 与此前已关闭批次的最大时间戳；.basc 为帧序号。
+struct ReplayFrameIndex {
+  // .bas 各帧在文件中按时间升序连续存放时为 true，此时可从下一帧首行直接续读；否则索引为空。
+  bool monotonic = true;
+  std::vector<ReplayFrameIndexEntry> entries;
+};
+
+// 扫描 .bas 文件，只读记录类型与时间戳字段；无法解析的行留给加载器报错。
+ReplayFrameIndex BuildTextFrameIndex(const std::string& path);
+
+struct ReplayCheckpoint {
+  // 检查点处最后一个已决策帧的时间戳与累计帧数。
+  std::int64_t timestamp_ms = 0;
+  std::uint64_t frames = 0;
+  // 续读位置：DIS 为字节偏移；.bas 为下一帧首行偏移，为 0 时从头解析并跳过 frames 帧；.basc 为帧序号。
+  std::uint64_t resume_offset = 0;
+  std::vector<std::uint8_t> state;
+};
+
+// 检查点表项：状态块在侧车文件中的位置。
+struct ReplayCheckpointEntry {
+  std::int64_t timestamp_ms = 0;
+  std::uint64_t frames = 0;
+  std::uint64_t resume_offset = 0;
+  std::uint64_t state_offset = 0;
+  std::uint64_t state_bytes = 0;
+};
+
+// 回放过程中逐个追加检查点，Finish 时写出帧索引与检查点表；先写临时文件再改名，读方不会看到半成品。
+class ReplayCheckpointWriter {
+ public:
+  ReplayCheckpointWriter(const std::string& path,
+                         const std::string& source_path,
+                         std::uint32_t reorder_window,
+                         std::uint64_t chunk_bytes);
+  // 未调用 Finish（回放中途失败）时删除临时文件，保留原有侧车。
+  ~ReplayCheckpointWriter();
+
+  ReplayCheckpointWriter(const ReplayCheckpointWriter&) = delete;
+  ReplayCheckpointWriter& operator=(const ReplayCheckpointWriter&) = delete;
+
+  void Add(const ReplayCheckpoint& checkpoint);
+  void Finish(const ReplayFrameIndex& index);
+
+  std::size_t checkpoint_count() const { return table_.size(); }
+
+ private:
+  std::string path_;
+  std::string temp_path_;
+  std::ofstream out_;
+  std::vector<std::uint8_t> header_;
+  std::uint64_t written_ = 0;
+  std::vector<ReplayCheckpointEntry> table_;
+};
+
+class ReplayCheckpointReader {
+ public:
+  // 映射侧车文件并校验文件头与检查点表；格式错误时抛出 std::runtime_error。
+  explicit ReplayCheckpointReader(const std::string& path);
+
+  // 侧车是否由同一源文件、同一乱序窗口生成。
+  bool Matches(const std::string& source_path, std::uint32_t reorder_window) const;
+
+  std::uint64_t chunk_bytes() const { return chunk_bytes_; }
+  const ReplayFrameIndex& index() const { return index_; }
+  std::size_t checkpoint_count() const { return table_.size(); }
+
+  // 时间戳不晚于 timestamp_ms 的最后一个检查点（二分查找）；不存在时返回 nullopt。
+  std::optional<ReplayCheckpoint> Find(std::int64_t timestamp_ms) const;
+
+ private:
+  MappedFile file_;
+  std::uint32_t reorder_window_ = 0;
+  std::uint64_t source_bytes_ = 0;
+  std::int64_t source_mtime_ = 0;
+  std::uint64_t chunk_bytes_ = 0;
+  ReplayFrameIndex index_;
+  std::vector<ReplayCheckpointEntry> table_;
+};
+
+}  // namespace bas
@@ -5,6 +5,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "bas/common/binary_io.hpp"
 #include "bas/common/types.hpp"
 
 namespace bas {
@@ -15,7 +16,7 @@ struct ReplayMetricsResult {
   std::size_t total_hostile_losses = 0;
   double survival_rate = 0.0;
   double hit_contribution_rate = 0.0;
-  std::unordered_map<std::string, double> shooter_kill_contribution;
+  std::unordered_map<EntityId, double> shooter_kill_contribution;
 };
 
 class ReplayMetricsEvaluator {
@@ -26,10 +27,14 @@ class ReplayMetricsEvaluator {
   void ObserveDecision(std::int64_t timestamp_ms, const DecisionPackage& decision);
   ReplayMetricsResult Finalize() const;
 
+  // 检查点：保存全部累计量，恢复后继续观测与从头回放得到相同的指标。
+  void SaveState(BinaryWriter& out) const;
+  void RestoreState(BinaryReader& in);
+
  private:
   struct ShotRecord {
     std::int64_t timestamp_ms = 0;
-    std::string shooter_id;
+    EntityId shooter_id;
   };
 
   void PruneShotHistory(std::int64_t now_ms);
@@ -37,10 +42,10 @@ class ReplayMetricsEvaluator {
   std::int64_t kill_credit_window_ms_;
   bool initialized_ = false;
 
-  std::unordered_map<std::string, bool> friendly_alive_state_;
-  std::unordered_map<std::string, bool> hostile_alive_state_;
-  std::unordered_map<std::string, std::vector<ShotRecord>> shots_by_target_;
-  std::unordered_map<std::string, double> shooter_kill_credit_;
+  std::unordered_map<EntityId, bool> friendly_alive_state_;
+  std::unordered_map<EntityId, bool> hostile_alive_state_;
+  std::unordered_map<EntityId, std::vector<ShotRecord>> shots_by_target_;
+  std::unordered_map<EntityId, double> shooter_kill_credit_;
 
   std::size_t initial_friendly_count_ = 0;
   std::size_t final_friendly_alive_ = 0;
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "bas/inference/model_runtime.hpp"
+#include "bas/system/agent_pipeline.hpp"
+#include "bas/system/replay_metrics.hpp"
+
+namespace bas {
+
+struct ReplayOptions {
+  std::uint32_t reorder_window = 0;
+  // 接收解析放到独立线程，经有界队列交给决策循环。
+  bool staged_ingest = false;
+  std::size_t stage_queue_depth = 4;
+  PipelineConfig pipeline{3000, 5 * 60 * 1000};
+  // 大于 0 时每隔该时长（回放时间）保存一次适配器、事件记忆与指标状态，回放结束后写出帧索引与检查点侧车。
+  std::int64_t checkpoint_interval_ms = 0;
+  // 侧车文件路径，为空时取 <回放文件>.ckpt。
+  std::string checkpoint_path;
+  // 只统计时间戳落在 [from_ms, to_ms] 内的 Tick；越过 to_ms 即停止接收。
+  // 设置 from_ms 且侧车与源文件一致时，从不晚于 from_ms - cache_ttl_ms 的最近检查点续放，其后的帧照常决策预热。
+  std::optional<std::int64_t> from_ms;
+  std::optional<std::int64_t> to_ms;
+  // DIS 二进制流式读取的块大小；从检查点续放时改用侧车记录的块大小，保证分批一致。
+  std::size_t stream_chunk_bytes = 1U << 20U;
+};
+
+struct ReplayRunResult {
+  std::string path;
+  // 非空表示该场景加载或回放失败，其余字段无效。
+  std::string error;
+  // 本次实际读入的帧数（从检查点续放时不含检查点之前的帧）。
+  std::size_t frames = 0;
+  std::size_t ticks = 0;
+  std::size_t decisions = 0;
+  std::size_t cache_hits = 0;
+  std::size_t model_updates = 0;
+  double first_decision_ms = 0.0;
+  double avg_latency_ms = 0.0;
+  double p95_latency_ms = 0.0;
+  // 已升序排列。
+  std::vector<double> latencies_ms;
+  // 逐 Tick 的火力分配、机动与解释摘要哈希，同步模型模式下可用于比对两次运行是否一致。
+  std::uint64_t decision_digest = 0;
+  // 指标按回放起点累计到最后一帧，与从头回放到 to_ms 一致。
+  ReplayMetricsResult metrics;
+  // 从检查点续放时为检查点时间戳。
+  std::optional<std::int64_t> resumed_from_ms;
+  // 定位耗时：从开始到第一个计入统计的 Tick 之前，含加载侧车、恢复状态与预热帧。
+  double seek_ms = 0.0;
+  std::size_t checkpoints_written = 0;
+  PipelineStageStats stages;
+  SimilarReuseStats similar;
+  // 所用模型运行时的合批与响应缓存统计；批量回放中各场景使用独立副本，只含本场景。
+  ModelBatchStats model_batch;
+  ModelResponseCacheStats model_cache;
+};
+
+struct ReplayBatchReport {
+  // 与输入顺序一致，与线程数无关。
+  std::vector<ReplayRunResult> scenarios;
+  std::size_t failed = 0;
+  std::size_t frames = 0;
+  std::size_t decisions = 0;
+  std::size_t cache_hits = 0;
+  std::size_t initial_friendly = 0;
+  std::size_t final_friendly_alive = 0;
+  std::size_t hostile_losses = 0;
+  // 合并口径：Σ存活 / Σ初始兵力；命中贡献率按各场景敌方损失数加权。
+  double survival_rate = 0.0;
+  double hit_contribution_rate = 0.0;
+  // 全部场景的 Tick 时延合并后统计。
+  double avg_latency_ms = 0.0;
+  double p95_latency_ms = 0.0;
+  double wall_ms = 0.0;
+};
+
+// 按扩展名识别二进制回放（.bin/.dis/.disbin），其余按文本格式加载。
+bool IsBinaryReplay(const std::string& path);
+
+// 单个场景的完整回放：独立的 AgentPipeline、DisAdapter 与 ReplayMetricsEvaluator。
+// 加载或回放失败时不抛出，写入 error。保存检查点或按时间段回放时接收与决策在同一线程进行（忽略 staged_ingest）。
+ReplayRunResult RunReplay(const std::string& path, const ReplayOptions& options, const ModelRuntime& model_runtime);
+
+// 目录：收集其中的回放文件（.bas/.basc/.bin/.dis/.disbin）并按文件名排序；
+// 否则视为清单文件，每行一个路径，忽略空行与 # 注释，相对路径相对清单所在目录。失败时抛出 std::runtime_error。
+std::vector<std::string> CollectReplayInputs(const std::string& directory_or_manifest);
+
+// 在 thread_count 个线程上并行回放各场景（0 取硬件并发数）。各场景开始时从 model_runtime 派生隔离副本（见
+// ModelRuntime::Fork），运行期间合批与响应缓存不跨场景共享，场景结束即并回 model_runtime；
+// 后开始的场景可命中先完成场景写入的缓存条目，并回顺序随调度变化。
+ReplayBatchReport RunReplayBatch(const std::vector<std::string>& paths,
+                                 const ReplayOptions& options,
+                                 const ModelRuntime& model_runtime,
+                                 std::size_t thread_count);
+
+}  // namespace bas
@@ -18,13 +18,30 @@ struct ReplayStats {
   double p95_latency_ms = 0.0;
 };
 
+struct ScenarioReplayLoaderConfig {
+  // 并行解析线程数（0 取硬件并发数）；文件按行边界切块，每块不小于 min_chunk_bytes。
+  std::size_t threads = 1;
+  std::size_t min_chunk_bytes = 4U << 20U;
+  // 顺序读取的块缓冲大小。
+  std::size_t block_bytes = 1U << 20U;
+  // 从该字节偏移（须为行首）开始读取，供按帧索引从检查点续读；错误行号仍按整个文件计。
+  std::uint64_t start_offset = 0;
+};
+
+// 字段以 string_view 切分、数值用 std::from_chars 解析，逐行不分配临时字符串。
+// 单线程时按块缓冲顺序读取；多线程时映射文件按行边界切块并行解析，再按时间戳合并，
+// 同一时间戳的记录保持文件中的先后顺序，结果与单线程一致。
 class ScenarioReplayLoader {
  public:
+  explicit ScenarioReplayLoader(ScenarioReplayLoaderConfig config = {}) : config_(config) {}
+
   std::vector<DisPduBatch> LoadBatches(const std::string& path) const;
 
  private:
-  static std::vector<std::string> SplitCsv(const std::string& line);
-  static std::string Trim(const std::string& value);
+  std::vector<DisPduBatch> LoadSequential(const std::string& path) const;
+  std::vector<DisPduBatch> LoadParallel(const std::string& path, std::size_t threads) const;
+
+  ScenarioReplayLoaderConfig config_;
 };
 
 }  // namespace bas
@@ -3,10 +3,11 @@ import argparse
 import json
 import logging
 import os
+import threading
 import time
 import uuid
 from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
-from typing import Any, Dict, List
+from typing import Any, Dict, List, Tuple
 
 import torch
 from transformers import AutoModelForCausalLM, AutoTokenizer
@@ -35,34 +36,49 @@ class ModelRunner:
         if self.device != "cuda":
             self.model = self.model.to(self.device)
         self.model.eval()
+        # 生成接口不可重入：单条与批量请求共用一把锁，按到达顺序串行前向。
+        self.lock = threading.Lock()
+        if self.tokenizer.pad_token_id is None:
+            self.tokenizer.pad_token = self.tokenizer.eos_token
         LOGGER.info("模型加载完成，耗时 %.1f 秒", time.time() - started)
 
-    def generate(self, messages: List[Dict[str, Any]], max_tokens: int, temperature: float) -> str:
+    @staticmethod
+    def build_prompt(messages: List[Dict[str, Any]]) -> str:
         prompt_parts = []
         for msg in messages:
             role = msg.get("role", "user")
             content = msg.get("content", "")
             prompt_parts.append(f"[{role}] {content}")
         prompt_parts.append("[assistant]")
-        prompt = "\n".join(prompt_parts)
+        return "\n".join(prompt_parts)
+
+    def generate(self, messages: List[Dict[str, Any]], max_tokens: int, temperature: float) -> str:
+        return self.generate_batch([messages], max_tokens=max_tokens, temperature=temperature)[0]
 
-        inputs = self.tokenizer(prompt, return_tensors="pt")
-        inputs = {k: v.to(self.device) for k, v in inputs.items()}
+    def generate_batch(self, batch: List[List[Dict[str, Any]]], max_tokens: int, temperature: float) -> List[str]:
+        prompts = [self.build_prompt(messages) for messages in batch]
 
         use_sampling = temperature > 1e-5
-        out = self.model.generate(
-            **inputs,
-            max_new_tokens=max_tokens,
-            do_sample=use_sampling,
-            temperature=max(temperature, 1e-5),
-            eos_token_id=self.tokenizer.eos_token_id,
-            pad_token_id=self.tokenizer.eos_token_id,
-        )
-        new_tokens = out[0][inputs["input_ids"].shape[1] :]
-        return self.tokenizer.decode(new_tokens, skip_special_tokens=True).strip()
+        with self.lock, torch.no_grad():
+            # 左侧填充，使各条提示词末尾对齐，一次前向生成整批。分词器为共享对象，设置与分词须在锁内完成。
+            self.tokenizer.padding_side = "left"
+            inputs = self.tokenizer(prompts, return_tensors="pt", padding=True)
+            inputs = {k: v.to(self.device) for k, v in inputs.items()}
+            out = self.model.generate(
+                **inputs,
+                max_new_tokens=max_tokens,
+                do_sample=use_sampling,
+                temperature=max(temperature, 1e-5),
+                eos_token_id=self.tokenizer.eos_token_id,
+                pad_token_id=self.tokenizer.pad_token_id,
+            )
+        prompt_len = inputs["input_ids"].shape[1]
+        return [self.tokenizer.decode(row[prompt_len:], skip_special_tokens=True).strip() for row in out]
 
 
 class OpenAIHandler(BaseHTTPRequestHandler):
+    # HTTP/1.1 长连接：客户端连接池复用连接，因此每个响应都必须带 Content-Length，且请求体必须读完。
+    protocol_version = "HTTP/1.1"
     runner: ModelRunner = None
     model_name: str = "Qwen1.5-1.8B-Chat"
 
@@ -74,9 +90,12 @@ class OpenAIHandler(BaseHTTPRequestHandler):
         self.end_headers()
         self.wfile.write(data)
 
-    def _read_json(self) -> Dict[str, Any]:
+    def _read_body(self) -> bytes:
         content_length = int(self.headers.get("Content-Length", "0"))
-        body = self.rfile.read(content_length)
+        return self.rfile.read(content_length) if content_length > 0 else b""
+
+    def _read_json(self) -> Dict[str, Any]:
+        body = self._read_body()
         if not body:
             return {}
         return json.loads(body.decode("utf-8"))
@@ -93,8 +112,69 @@ class OpenAIHandler(BaseHTTPRequestHandler):
             return
         self._send_json({"error": "未找到接口"}, status=404)
 
+    def _completion(self, content: str, latency_ms: int) -> Dict[str, Any]:
+        return {
+            "id": f"chatcmpl-{uuid.uuid4().hex[:12]}",
+            "object": "chat.completion",
+            "created": int(time.time()),
+            "model": self.model_name,
+            "choices": [
+                {
+                    "index": 0,
+                    "message": {"role": "assistant", "content": content},
+                    "finish_reason": "stop",
+                }
+            ],
+            "usage": {"prompt_tokens": 0, "completion_tokens": 0, "total_tokens": 0},
+            "latency_ms": latency_ms,
+        }
+
+    def _handle_batch(self) -> None:
+        # 请求体：{"requests": [<chat.completions 请求体>, ...]}；采样参数（max_tokens、temperature）相同的条目
+        # 合为一次生成，响应按请求顺序返回。
+        try:
+            req = self._read_json()
+            requests = req.get("requests", [])
+            if not isinstance(requests, list) or not requests:
+                self._send_json({"error": "requests 字段必须为非空列表"}, status=400)
+                return
+            groups: Dict[Tuple[int, float], List[int]] = {}
+            for index, item in enumerate(requests):
+                messages = item.get("messages", []) if isinstance(item, dict) else []
+                if not isinstance(messages, list) or not messages:
+                    self._send_json({"error": "每条请求的 messages 字段必须为非空列表"}, status=400)
+                    return
+                max_tokens = int(item.get("max_tokens", self.runner.max_new_tokens))
+                max_tokens = max(1, min(max_tokens, 512))
+                temperature = float(item.get("temperature", self.runner.temperature))
+                groups.setdefault((max_tokens, temperature), []).append(index)
+
+            started = time.time()
+            contents: List[str] = [""] * len(requests)
+            for (max_tokens, temperature), indices in groups.items():
+                batch = [requests[i]["messages"] for i in indices]
+                outputs = self.runner.generate_batch(batch, max_tokens=max_tokens, temperature=temperature)
+                for i, content in zip(indices, outputs):
+                    contents[i] = content
+            latency_ms = int((time.time() - started) * 1000)
+            LOGGER.info("批量生成 %d 条（%d 组采样参数），耗时 %d 毫秒", len(requests), len(groups), latency_ms)
+
+            self._send_json({
+                "object": "batch.completion",
+                "responses": [self._completion(content, latency_ms) for content in contents],
+                "latency_ms": latency_ms,
+            })
+        except Exception as exc:  # pylint: disable=broad-except
+            LOGGER.exception("批量请求处理失败")
+            self._send_json({"error": str(exc)}, status=500)
+
     def do_POST(self) -> None:
+        if self.path == "/v1/batch":
+            self._handle_batch()
+            return
         if self.path != "/v1/chat/completions":
+            # 丢弃请求体，否则残留字节会被当作同一连接上的下一个请求。
+            self._read_body()
             self._send_json({"error": "未找到接口"}, status=404)
             return
 
@@ -113,22 +193,7 @@ class OpenAIHandler(BaseHTTPRequestHandler):
             content = self.runner.generate(messages, max_tokens=max_tokens, temperature=temperature)
             latency_ms = int((time.time() - started) * 1000)
 
-            response = {
-                "id": f"chatcmpl-{uuid.uuid4().hex[:12]}",
-                "object": "chat.completion",
-                "created": int(time.time()),
-                "model": self.model_name,
-                "choices": [
-                    {
-                        "index": 0,
-                        "message": {"role": "assistant", "content": content},
-                        "finish_reason": "stop",
-                    }
-                ],
-                "usage": {"prompt_tokens": 0, "completion_tokens": 0, "total_tokens": 0},
-                "latency_ms": latency_ms,
-            }
-            self._send_json(response)
+            self._send_json(self._completion(content, latency_ms))
         except Exception as exc:  # pylint: disable=broad-except
             LOGGER.exception("请求处理失败")
             self._send_json({"error": str(exc)}, status=500)
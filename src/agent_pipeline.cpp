@@ -1,73 +1,342 @@
 #include "bas/system/agent_pipeline.hpp"
 
 #include <algorithm>
-#include <sstream>
+#include <chrono>
+#include <exception>
+#include <unordered_map>
 
 namespace bas {
 
+namespace {
+
+// 复用前的硬约束校验：射手与目标仍存活、武器有弹且就绪、目标仍在射程内；机动单位存活且未偏离路径起点过远。
+bool StillFeasible(const DecisionPackage& pkg, const BattlefieldSnapshot& snapshot, double max_drift_m) {
+  std::unordered_map<EntityId, const EntityState*> units;
+  units.reserve(snapshot.friendly_units.size() + snapshot.hostile_units.size());
+  for (const auto* side : {&snapshot.friendly_units, &snapshot.hostile_units}) {
+    for (const auto& unit : *side) {
+      units[unit.id] = &unit;
+    }
+  }
+  const auto alive = [&units](EntityId id) -> const EntityState* {
+    const auto it = units.find(id);
+    return it != units.end() && it->second->alive ? it->second : nullptr;
+  };
+
+  for (const auto& assignment : pkg.fire.assignments) {
+    const EntityState* shooter = alive(assignment.shooter_id);
+    const EntityState* target = alive(assignment.target_id);
+    if (shooter == nullptr || target == nullptr) {
+      return false;
+    }
+    const auto weapon = std::find_if(shooter->weapons.begin(), shooter->weapons.end(),
+                                     [&](const WeaponState& w) { return w.name == assignment.weapon_name; });
+    if (weapon == shooter->weapons.end() || weapon->ammo <= 0 || weapon->ready_in_s > 0.0 ||
+        Distance(shooter->pose, target->pose) > weapon->range_m) {
+      return false;
+    }
+  }
+  for (const auto& action : pkg.maneuver.actions) {
+    const EntityState* unit = alive(action.unit_id);
+    if (unit == nullptr || (!action.path.empty() && Distance(unit->pose, action.path.front()) > max_drift_m)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+double ElapsedMs(std::chrono::steady_clock::time_point since) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+// 作用域计时：析构时把耗时记入对应阶段。
+class StageTimer {
+ public:
+  explicit StageTimer(StageLatency& stage) : stage_(stage), start_(std::chrono::steady_clock::now()) {}
+  ~StageTimer() { stage_.Record(ElapsedMs(start_)); }
+
+  StageTimer(const StageTimer&) = delete;
+  StageTimer& operator=(const StageTimer&) = delete;
+
+ private:
+  StageLatency& stage_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace
+
 AgentPipeline::AgentPipeline(PipelineConfig config,
                              FireControlEngine fire_engine,
                              ManeuverEngine maneuver_engine,
                              ModelRuntime model_runtime)
     : config_(config),
-      memory_(config.memory_window_ms * 2),
+      memory_(config.memory_window_ms * 2, config.memory_capacity, config.context_budget_bytes),
       fire_engine_(std::move(fire_engine)),
       maneuver_engine_(std::move(maneuver_engine)),
       model_runtime_(std::move(model_runtime)),
-      cache_(config.cache_ttl_ms) {}
+      cache_(config.cache_ttl_ms, config.cache_capacity),
+      async_(std::make_shared<AsyncModelState>()) {
+  if (config_.similarity_reuse) {
+    similar_ = std::make_unique<SimilarityIndex>(config_.similarity_capacity, config_.similarity_threshold,
+                                                 config_.cache_ttl_ms);
+  }
+  if (config_.maneuver_threads > 0) {
+    maneuver_pool_ = std::make_unique<ThreadPool>(config_.maneuver_threads);
+    maneuver_engine_ = ManeuverEngine(maneuver_engine_.config(), maneuver_pool_.get());
+  }
+  if (config_.parallel_stages) {
+    stage_pool_ = std::make_unique<ThreadPool>(1);
+  }
+  if (config_.async_model) {
+    // 合批时需要多个在途请求同时阻塞在合批器里才能凑批，否则单线程顺序调用即可。
+    const bool batching = model_runtime_.config().enable_batching;
+    model_pool_ = std::make_unique<ThreadPool>(batching ? std::max<std::size_t>(1, config_.max_inflight_model_requests) : 1);
+  }
+}
+
+AgentPipeline::~AgentPipeline() = default;
 
 DecisionPackage AgentPipeline::Tick(const BattlefieldSnapshot& snapshot, const std::vector<EventRecord>& dis_events) {
+  // 快照来源未知，全量计算键且不改变增量状态。
+  return Decide(snapshot, dis_events, key_builder_.Compute(snapshot));
+}
+
+DecisionPackage AgentPipeline::Tick(const SnapshotUpdate& update, const std::vector<EventRecord>& dis_events) {
+  // 只有紧接上一次增量更新的版本才能按 dirty 实体修正，跳过轮询或整体替换时全量重建。
+  const bool contiguous = !update.full_refresh && key_version_ != 0 && update.version == key_version_ + 1;
+  const DecisionCache::Key cache_key = contiguous ? key_builder_.Update(*update.snapshot, update.dirty_entities)
+                                                  : key_builder_.Rebuild(*update.snapshot);
+  key_version_ = update.version;
+  return Decide(*update.snapshot, dis_events, cache_key);
+}
+
+void AgentPipeline::SaveState(BinaryWriter& out) const { memory_.SaveState(out); }
+
+void AgentPipeline::RestoreState(BinaryReader& in) {
+  memory_.RestoreState(in);
+  key_version_ = 0;
+}
+
+DecisionPackage AgentPipeline::Decide(const BattlefieldSnapshot& snapshot,
+                                      const std::vector<EventRecord>& dis_events,
+                                      DecisionCache::Key cache_key) {
+  const StageTimer tick_timer(stage_stats_.tick);
+  if (model_pool_ != nullptr) {
+    MergeCompletedModelUpdates();
+  }
   cache_.Prune(snapshot.timestamp_ms);
-  const std::string cache_key = BuildCacheKey(snapshot);
 
-  if (const auto cached = cache_.Get(cache_key, snapshot.timestamp_ms); cached.has_value()) {
+  if (const DecisionCache::Value cached = cache_.Get(cache_key, snapshot.timestamp_ms); cached != nullptr) {
     DecisionPackage pkg = *cached;
     pkg.from_cache = true;
     return pkg;
   }
 
+  const auto fusion_start = std::chrono::steady_clock::now();
   memory_.AddEvents(dis_events);
-  const auto recent_events = memory_.QueryRecent(snapshot.timestamp_ms, config_.memory_window_ms);
 
-  const auto semantics = fusion_.Infer(snapshot, recent_events);
+  // 空间索引每个快照只建一次，由融合、火力、机动三个阶段共享。
+  const SnapshotIndex index(snapshot, config_.spatial_cell_m);
+  const auto semantics = fusion_.Infer(snapshot, memory_, config_.memory_window_ms, &index);
+  static const EntityId kFusionActor = EntityId::Intern("fusion");
   for (const auto& tag : semantics.tags) {
-    memory_.AddEvent({snapshot.timestamp_ms, EventType::TacticalTag, "fusion", {}, tag.name + ":" + tag.reason});
+    memory_.AddEvent({snapshot.timestamp_ms, EventType::TacticalTag, kFusionActor, {}, tag.name + ":" + tag.reason});
+  }
+  stage_stats_.fusion.Record(ElapsedMs(fusion_start));
+
+  SituationFeatures features{};
+  if (similar_ != nullptr) {
+    features = ExtractSituationFeatures(snapshot, semantics);
+    ++similar_stats_.lookups;
+    if (const auto match = similar_->FindNearest(features, snapshot.timestamp_ms); match.has_value()) {
+      if (StillFeasible(*match->value, snapshot, config_.similarity_max_drift_m)) {
+        ++similar_stats_.reused;
+        // 同时登记到精确缓存，态势不变的后续 Tick 直接命中。
+        cache_.Put(cache_key, match->value, snapshot.timestamp_ms);
+        DecisionPackage pkg = *match->value;
+        pkg.from_cache = true;
+        pkg.from_similar = true;
+        return pkg;
+      }
+      ++similar_stats_.rejected;
+    }
   }
 
   DecisionPackage pkg;
-  pkg.fire = fire_engine_.Decide(snapshot, semantics, memory_);
-  pkg.maneuver = maneuver_engine_.Decide(snapshot, semantics);
+  {
+    // 火力与机动只读快照、语义、记忆与空间索引，各自只修改本引擎的内部状态，可以并发。
+    const StageTimer decision_timer(stage_stats_.decision);
+    double fire_ms = 0.0;
+    double maneuver_ms = 0.0;
+    const auto run_stage = [&](std::size_t stage) {
+      const auto start = std::chrono::steady_clock::now();
+      if (stage == 0) {
+        pkg.fire = fire_engine_.Decide(snapshot, semantics, memory_, &index);
+        fire_ms = ElapsedMs(start);
+      } else {
+        pkg.maneuver = maneuver_engine_.Decide(snapshot, semantics, &index);
+        maneuver_ms = ElapsedMs(start);
+      }
+    };
+    if (stage_pool_ != nullptr) {
+      stage_pool_->ParallelFor(2, 1, [&](std::size_t begin, std::size_t end, std::size_t) {
+        for (std::size_t stage = begin; stage < end; ++stage) {
+          run_stage(stage);
+        }
+      });
+    } else {
+      run_stage(0);
+      run_stage(1);
+    }
+    stage_stats_.fire.Record(fire_ms);
+    stage_stats_.maneuver.Record(maneuver_ms);
+  }
 
+  const auto context_start = std::chrono::steady_clock::now();
   const std::string memory_context = memory_.BuildContext(snapshot.timestamp_ms, config_.memory_window_ms);
   const std::vector<std::string> candidates = {
       "方案A（积极）： " + pkg.fire.summary + "；" + pkg.maneuver.summary,
       "方案B（稳健）：优先利用掩护，在置信度较低时减少远程开火"};
 
-  const ModelRequest request{memory_context, candidates};
-  const ModelResponse model_response = model_runtime_.RankAndExplain(request);
-  std::string concise_explanation = model_response.explanation;
-  if (concise_explanation.size() > 360) {
-    concise_explanation = concise_explanation.substr(0, 360) + "...";
+  ModelRequest request{memory_context, candidates, {}};
+  for (const auto& tag : semantics.tags) {
+    request.tags.push_back(tag.name);
   }
-  pkg.explanation = "候选索引=" + std::to_string(model_response.selected_index) + "；" + concise_explanation;
+  stage_stats_.context.Record(ElapsedMs(context_start));
   pkg.from_cache = false;
+  pkg.tick_seq = ++tick_seq_;
+
+  const StageTimer model_timer(stage_stats_.model);
+  if (model_pool_ == nullptr) {
+    pkg.explanation = FormatExplanation(model_runtime_.RankAndExplain(request));
+    Remember(cache_key, features, pkg, snapshot.timestamp_ms);
+    return pkg;
+  }
 
+  bool submit = false;
+  {
+    std::lock_guard<std::mutex> lock(async_->mutex);
+    if (async_->inflight < config_.max_inflight_model_requests) {
+      ++async_->inflight;
+      submit = true;
+    }
+  }
+  if (!submit) {
+    pkg.explanation = "候选索引=0；模型请求积压，本次沿用规则方案";
+    Remember(cache_key, features, pkg, snapshot.timestamp_ms);
+    return pkg;
+  }
+
+  pkg.model_pending = true;
+  pkg.explanation = "候选索引=0；模型排序进行中（决策序号=" + std::to_string(pkg.tick_seq) + "），暂按规则方案执行";
   cache_.Put(cache_key, pkg, snapshot.timestamp_ms);
+  pending_ticks_[pkg.tick_seq] = PendingTick{cache_key, features, snapshot.timestamp_ms};
+
+  // 任务只持有共享状态与模型运行时副本，不引用流水线本身。
+  model_pool_->Submit([state = async_, runtime = model_runtime_, request = std::move(request), seq = pkg.tick_seq,
+                       timestamp = snapshot.timestamp_ms] {
+    // 任务异常也必须归还在途名额并给出结果，否则 WaitForModelUpdates 永久阻塞、该 Tick 一直待定。
+    ModelUpdate update{seq, timestamp, 0, {}};
+    try {
+      const ModelResponse response = runtime.RankAndExplain(request);
+      update.selected_index = response.selected_index;
+      update.explanation = FormatExplanation(response);
+    } catch (const std::exception& ex) {
+      update.explanation = std::string("候选索引=0；模型排序失败，沿用规则方案：") + ex.what();
+    } catch (...) {
+      update.explanation = "候选索引=0；模型排序失败，沿用规则方案";
+    }
+    ModelUpdateCallback callback;
+    {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->completed.push_back(update);
+      --state->inflight;
+      callback = state->callback;
+    }
+    state->done.notify_all();
+    if (callback) {
+      callback(update);
+    }
+  });
   return pkg;
 }
 
-std::string AgentPipeline::BuildCacheKey(const BattlefieldSnapshot& snapshot) const {
-  std::ostringstream oss;
-  oss << "f=" << snapshot.friendly_units.size() << "|h=" << snapshot.hostile_units.size();
-  oss << "|v=" << static_cast<int>(snapshot.env.visibility_m / 100.0);
+void AgentPipeline::Remember(DecisionCache::Key cache_key,
+                             const SituationFeatures& features,
+                             const DecisionPackage& pkg,
+                             std::int64_t timestamp_ms) {
+  auto value = std::make_shared<const DecisionPackage>(pkg);
+  cache_.Put(cache_key, value, timestamp_ms);
+  if (similar_ != nullptr) {
+    similar_->Insert(features, std::move(value), timestamp_ms);
+  }
+}
+
+std::string AgentPipeline::FormatExplanation(const ModelResponse& response) {
+  std::string concise_explanation = response.explanation;
+  if (concise_explanation.size() > 360) {
+    concise_explanation = concise_explanation.substr(0, 360) + "...";
+  }
+  return "候选索引=" + std::to_string(response.selected_index) + "；" + concise_explanation;
+}
+
+void AgentPipeline::SetModelUpdateCallback(ModelUpdateCallback callback) {
+  std::lock_guard<std::mutex> lock(async_->mutex);
+  async_->callback = std::move(callback);
+}
 
-  for (const auto& unit : snapshot.friendly_units) {
-    oss << "|" << unit.id << "@" << static_cast<int>(unit.pose.x / 100.0) << "," << static_cast<int>(unit.pose.y / 100.0);
+void AgentPipeline::MergeCompletedModelUpdates() {
+  std::vector<ModelUpdate> completed;
+  {
+    std::lock_guard<std::mutex> lock(async_->mutex);
+    completed.swap(async_->completed);
+  }
+  for (auto& update : completed) {
+    const auto it = pending_ticks_.find(update.tick_seq);
+    if (it != pending_ticks_.end()) {
+      // 缓存条目仍属于该 Tick 时才回写；已被更新的决策覆盖或过期则只交给调用方。
+      if (const DecisionCache::Value cached = cache_.Peek(it->second.cache_key); cached != nullptr) {
+        auto merged = std::make_shared<DecisionPackage>(*cached);
+        if (ApplyModelUpdate(*merged, update)) {
+          cache_.Replace(it->second.cache_key, merged);
+          if (similar_ != nullptr) {
+            similar_->Insert(it->second.features, std::move(merged), it->second.timestamp_ms);
+          }
+        }
+      }
+      pending_ticks_.erase(it);
+    }
+    ready_updates_.push_back(std::move(update));
   }
-  for (const auto& unit : snapshot.hostile_units) {
-    oss << "|" << unit.id << "@" << static_cast<int>(unit.pose.x / 100.0) << "," << static_cast<int>(unit.pose.y / 100.0);
+}
+
+std::vector<ModelUpdate> AgentPipeline::DrainModelUpdates() {
+  MergeCompletedModelUpdates();
+  std::vector<ModelUpdate> out;
+  out.swap(ready_updates_);
+  return out;
+}
+
+std::vector<ModelUpdate> AgentPipeline::WaitForModelUpdates() {
+  {
+    std::unique_lock<std::mutex> lock(async_->mutex);
+    async_->done.wait(lock, [this] { return async_->inflight == 0; });
+  }
+  return DrainModelUpdates();
+}
+
+std::size_t AgentPipeline::inflight_model_requests() const {
+  std::lock_guard<std::mutex> lock(async_->mutex);
+  return async_->inflight;
+}
+
+bool AgentPipeline::ApplyModelUpdate(DecisionPackage& pkg, const ModelUpdate& update) {
+  if (pkg.tick_seq != update.tick_seq) {
+    return false;
   }
-  return oss.str();
+  pkg.explanation = update.explanation;
+  pkg.model_pending = false;
+  return true;
 }
 
 }  // namespace bas
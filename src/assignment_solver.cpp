@@ -0,0 +1,134 @@
+#include "bas/decision/assignment_solver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+
+namespace bas {
+
+namespace {
+
+constexpr std::uint32_t kNoHolder = 0xFFFFFFFFU;
+// 每隔若干次出价检查一次时钟，避免计时本身成为热点。
+constexpr std::size_t kClockCheckInterval = 64;
+
+template <typename TimePoint>
+void RunAuction(const AssignmentProblem& problem,
+                std::size_t slots,
+                double epsilon,
+                const TimePoint* deadline,
+                std::vector<double>& price,
+                std::vector<std::uint32_t>& holder,
+                std::deque<std::uint32_t>& pending,
+                AssignmentResult& result) {
+  while (!pending.empty()) {
+    if (deadline != nullptr && result.bids % kClockCheckInterval == 0 && TimePoint::clock::now() >= *deadline) {
+      result.timed_out = true;
+      return;
+    }
+    const std::uint32_t shooter = pending.front();
+    pending.pop_front();
+    ++result.bids;
+
+    // 空选项净收益为 0，因此最优与次优初值都取 0。
+    double best_net = 0.0;
+    double second_net = 0.0;
+    std::uint32_t best_slot = kNoHolder;
+    std::uint32_t best_arc = kNoHolder;
+    for (std::uint32_t a = problem.arc_begin[shooter]; a < problem.arc_begin[shooter + 1]; ++a) {
+      const AssignmentArc& arc = problem.arcs[a];
+      const std::size_t base = static_cast<std::size_t>(arc.target) * slots;
+      for (std::size_t s = 0; s < slots; ++s) {
+        const double net = arc.value - price[base + s];
+        if (net > best_net) {
+          second_net = best_net;
+          best_net = net;
+          best_slot = static_cast<std::uint32_t>(base + s);
+          best_arc = a;
+        } else if (net > second_net) {
+          second_net = net;
+        }
+      }
+    }
+    if (best_slot == kNoHolder) {
+      continue;
+    }
+
+    price[best_slot] += best_net - second_net + epsilon;
+    const std::uint32_t evicted = holder[best_slot];
+    if (evicted != kNoHolder) {
+      result.arc_of_shooter[evicted] = AssignmentResult::kUnassigned;
+      pending.push_back(evicted);
+    }
+    holder[best_slot] = shooter;
+    result.arc_of_shooter[shooter] = best_arc;
+  }
+}
+
+}  // namespace
+
+AssignmentResult SolveAuctionAssignment(const AssignmentProblem& problem, const AuctionOptions& options) {
+  using Clock = std::chrono::steady_clock;
+  const auto deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+                                           std::chrono::duration<double, std::milli>(options.budget_ms));
+
+  const std::size_t shooters = problem.shooter_count();
+  const std::size_t slots = std::max<std::size_t>(1, problem.slots_per_target);
+  AssignmentResult result;
+  result.arc_of_shooter.assign(shooters, AssignmentResult::kUnassigned);
+
+  double max_value = 0.0;
+  for (const auto& arc : problem.arcs) {
+    max_value = std::max(max_value, arc.value);
+  }
+  if (max_value <= 0.0) {
+    return result;
+  }
+  const double epsilon = std::max(1e-12, options.epsilon_ratio * max_value);
+
+  std::vector<double> price(problem.target_count * slots, 0.0);
+  std::vector<std::uint32_t> holder(price.size(), kNoHolder);
+  std::deque<std::uint32_t> pending;
+  for (std::uint32_t i = 0; i < shooters; ++i) {
+    if (problem.arc_begin[i] != problem.arc_begin[i + 1]) {
+      pending.push_back(i);
+    }
+  }
+
+  RunAuction(problem, slots, epsilon, options.budget_ms > 0.0 ? &deadline : nullptr, price, holder, pending, result);
+
+  // 超时：未定射手按原始收益贪心占用剩余空闲席位。
+  for (const std::uint32_t shooter : pending) {
+    double best_value = 0.0;
+    std::uint32_t best_slot = kNoHolder;
+    std::uint32_t best_arc = kNoHolder;
+    for (std::uint32_t a = problem.arc_begin[shooter]; a < problem.arc_begin[shooter + 1]; ++a) {
+      const AssignmentArc& arc = problem.arcs[a];
+      if (arc.value <= best_value) {
+        continue;
+      }
+      const std::size_t base = static_cast<std::size_t>(arc.target) * slots;
+      for (std::size_t s = 0; s < slots; ++s) {
+        if (holder[base + s] == kNoHolder) {
+          best_value = arc.value;
+          best_slot = static_cast<std::uint32_t>(base + s);
+          best_arc = a;
+          break;
+        }
+      }
+    }
+    if (best_slot != kNoHolder) {
+      holder[best_slot] = shooter;
+      result.arc_of_shooter[shooter] = best_arc;
+    }
+  }
+
+  for (const std::uint32_t arc : result.arc_of_shooter) {
+    if (arc != AssignmentResult::kUnassigned) {
+      result.total_value += problem.arcs[arc].value;
+    }
+  }
+  return result;
+}
+
+}  // namespace bas
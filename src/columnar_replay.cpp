@@ -0,0 +1,394 @@
+#include "bas/system/columnar_replay.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace bas {
+
+namespace {
+
+constexpr std::size_t kHeaderBytes = 32;
+constexpr std::size_t kIndexEntryBytes = 32;
+constexpr std::uint32_t kHasEnv = 1U;
+
+struct IndexEntry {
+  std::int64_t timestamp_ms;
+  std::uint64_t offset;
+  std::uint32_t entity_count;
+  std::uint32_t fire_count;
+  std::uint32_t flags;
+  std::uint32_t block_bytes;
+};
+static_assert(sizeof(IndexEntry) == kIndexEntryBytes, "帧索引项须为 32 字节定长");
+
+std::size_t Align8(std::size_t n) { return (n + 7U) & ~std::size_t{7U}; }
+
+std::size_t BlockBytes(std::size_t entities, std::size_t fires, bool has_env) {
+  return (has_env ? 3 * sizeof(double) : 0) +
+         Align8(entities * (sizeof(std::int64_t) + 6 * sizeof(double) + sizeof(std::uint32_t) + 3)) +
+         Align8(fires * (sizeof(std::int64_t) + 3 * sizeof(double) + 3 * sizeof(std::uint32_t)));
+}
+
+bool HostIsLittleEndian() {
+  const std::uint16_t probe = 1;
+  std::uint8_t first = 0;
+  std::memcpy(&first, &probe, 1);
+  return first == 1;
+}
+
+class ByteWriter {
+ public:
+  explicit ByteWriter(std::vector<std::uint8_t>& out) : out_(out) {}
+
+  template <typename T>
+  void Put(const T& value) {
+    const auto* p = reinterpret_cast<const std::uint8_t*>(&value);
+    out_.insert(out_.end(), p, p + sizeof(T));
+  }
+
+  template <typename T, typename F>
+  void Column(std::size_t n, const F& get) {
+    for (std::size_t i = 0; i < n; ++i) {
+      Put(static_cast<T>(get(i)));
+    }
+  }
+
+  void Bytes(const std::string& s) { out_.insert(out_.end(), s.begin(), s.end()); }
+  void Pad8() { out_.resize(Align8(out_.size()), 0); }
+
+ private:
+  std::vector<std::uint8_t>& out_;
+};
+
+class Dictionary {
+ public:
+  std::uint32_t Add(const std::string& s) {
+    const auto [it, inserted] = index_.try_emplace(s, static_cast<std::uint32_t>(strings_.size()));
+    if (inserted) {
+      strings_.push_back(s);
+    }
+    return it->second;
+  }
+
+  std::uint32_t size() const { return static_cast<std::uint32_t>(strings_.size()); }
+
+  void Write(ByteWriter& w) const {
+    std::uint32_t offset = 0;
+    w.Put(offset);
+    for (const auto& s : strings_) {
+      offset += static_cast<std::uint32_t>(s.size());
+      w.Put(offset);
+    }
+    for (const auto& s : strings_) {
+      w.Bytes(s);
+    }
+    w.Pad8();
+  }
+
+ private:
+  std::vector<std::string> strings_;
+  std::unordered_map<std::string, std::uint32_t> index_;
+};
+
+// 文件与内存同为小端定宽表示，按下标直接取列中元素（memcpy 规避对齐要求，编译后即普通加载）。
+template <typename T>
+T At(const std::uint8_t* column, std::size_t i) {
+  T value;
+  std::memcpy(&value, column + i * sizeof(T), sizeof(T));
+  return value;
+}
+
+IndexEntry EntryAt(const MappedFile& file, std::size_t index_offset, std::size_t frame) {
+  IndexEntry e{};
+  std::memcpy(&e, file.view().data() + index_offset + frame * kIndexEntryBytes, kIndexEntryBytes);
+  return e;
+}
+
+[[noreturn]] void Corrupt(const std::string& path, const std::string& what) {
+  throw std::runtime_error("列式回放文件损坏: " + path + "（" + what + "）");
+}
+
+}  // namespace
+
+bool IsColumnarReplay(const std::string& path) {
+  const auto pos = path.find_last_of('.');
+  return pos != std::string::npos && path.substr(pos + 1) == "basc";
+}
+
+std::vector<std::uint8_t> EncodeColumnarReplay(const std::vector<DisPduBatch>& batches) {
+  if (!HostIsLittleEndian()) {
+    throw std::runtime_error("列式回放仅支持小端主机");
+  }
+
+  // 先收集字典，各帧数据块只写下标。
+  Dictionary ids;
+  Dictionary weapons;
+  for (const auto& batch : batches) {
+    for (const auto& pdu : batch.entity_updates) {
+      ids.Add(pdu.entity_id.ToString());
+    }
+    for (const auto& pdu : batch.fire_events) {
+      ids.Add(pdu.shooter_id.ToString());
+      ids.Add(pdu.target_id.ToString());
+      weapons.Add(pdu.weapon_name);
+    }
+  }
+
+  std::vector<std::uint8_t> out;
+  ByteWriter w(out);
+  w.Put(kColumnarReplayMagic);
+  w.Put(kColumnarReplayVersion);
+  w.Put(static_cast<std::uint32_t>(batches.size()));
+  w.Put(ids.size());
+  w.Put(weapons.size());
+  w.Put(std::uint32_t{0});
+  w.Put(std::uint64_t{0});  // 文件总长，末尾回填
+
+  const std::size_t index_offset = out.size();
+  out.resize(index_offset + batches.size() * kIndexEntryBytes, 0);
+  ids.Write(w);
+  weapons.Write(w);
+
+  std::int64_t ts = 0;
+  for (std::size_t f = 0; f < batches.size(); ++f) {
+    const DisPduBatch& batch = batches[f];
+    const auto& ents = batch.entity_updates;
+    const auto& fires = batch.fire_events;
+    // 未给出帧时间戳时取批内最大值（与适配器快照时间一致）；只有环境记录的批次沿用上一帧。
+    if (batch.timestamp_ms != 0) {
+      ts = batch.timestamp_ms;
+    } else if (!ents.empty() || !fires.empty()) {
+      ts = std::numeric_limits<std::int64_t>::min();
+      for (const auto& pdu : ents) {
+        ts = std::max(ts, pdu.timestamp_ms);
+      }
+      for (const auto& pdu : fires) {
+        ts = std::max(ts, pdu.timestamp_ms);
+      }
+    }
+
+    const std::size_t block_offset = out.size();
+    if (batch.env.has_value()) {
+      w.Put(batch.env->visibility_m);
+      w.Put(batch.env->weather_risk);
+      w.Put(batch.env->terrain_risk);
+    }
+    const std::size_t n = ents.size();
+    w.Column<std::int64_t>(n, [&](std::size_t i) { return ents[i].timestamp_ms; });
+    w.Column<double>(n, [&](std::size_t i) { return ents[i].pose.x; });
+    w.Column<double>(n, [&](std::size_t i) { return ents[i].pose.y; });
+    w.Column<double>(n, [&](std::size_t i) { return ents[i].pose.z; });
+    w.Column<double>(n, [&](std::size_t i) { return ents[i].speed_mps; });
+    w.Column<double>(n, [&](std::size_t i) { return ents[i].heading_deg; });
+    w.Column<double>(n, [&](std::size_t i) { return ents[i].threat_level; });
+    w.Column<std::uint32_t>(n, [&](std::size_t i) { return ids.Add(ents[i].entity_id.ToString()); });
+    w.Column<std::uint8_t>(n, [&](std::size_t i) { return ents[i].side; });
+    w.Column<std::uint8_t>(n, [&](std::size_t i) { return ents[i].type; });
+    w.Column<std::uint8_t>(n, [&](std::size_t i) { return ents[i].alive; });
+    w.Pad8();
+    const std::size_t m = fires.size();
+    w.Column<std::int64_t>(m, [&](std::size_t i) { return fires[i].timestamp_ms; });
+    w.Column<double>(m, [&](std::size_t i) { return fires[i].origin.x; });
+    w.Column<double>(m, [&](std::size_t i) { return fires[i].origin.y; });
+    w.Column<double>(m, [&](std::size_t i) { return fires[i].origin.z; });
+    w.Column<std::uint32_t>(m, [&](std::size_t i) { return ids.Add(fires[i].shooter_id.ToString()); });
+    w.Column<std::uint32_t>(m, [&](std::size_t i) { return ids.Add(fires[i].target_id.ToString()); });
+    w.Column<std::uint32_t>(m, [&](std::size_t i) { return weapons.Add(fires[i].weapon_name); });
+    w.Pad8();
+
+    const IndexEntry entry{ts,
+                           static_cast<std::uint64_t>(block_offset),
+                           static_cast<std::uint32_t>(n),
+                           static_cast<std::uint32_t>(m),
+                           batch.env.has_value() ? kHasEnv : 0U,
+                           static_cast<std::uint32_t>(out.size() - block_offset)};
+    std::memcpy(out.data() + index_offset + f * kIndexEntryBytes, &entry, kIndexEntryBytes);
+  }
+
+  const auto total = static_cast<std::uint64_t>(out.size());
+  std::memcpy(out.data() + 24, &total, sizeof(total));
+  return out;
+}
+
+void WriteColumnarReplay(const std::vector<DisPduBatch>& batches, const std::string& path) {
+  const std::vector<std::uint8_t> bytes = EncodeColumnarReplay(batches);
+  std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+  if (!ofs) {
+    throw std::runtime_error("无法写入列式回放文件: " + path);
+  }
+  ofs.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  if (!ofs) {
+    throw std::runtime_error("列式回放文件写入失败: " + path);
+  }
+}
+
+ColumnarReplayReader::ColumnarReplayReader(const std::string& path) : file_(path) {
+  if (!HostIsLittleEndian()) {
+    throw std::runtime_error("列式回放仅支持小端主机");
+  }
+  const std::uint8_t* base = file_.view().data();
+  if (file_.size() < kHeaderBytes || std::memcmp(base, kColumnarReplayMagic, 4) != 0) {
+    Corrupt(path, "文件头无效");
+  }
+  std::uint32_t version = 0;
+  std::uint32_t frames = 0;
+  std::uint32_t id_count = 0;
+  std::uint32_t weapon_count = 0;
+  std::uint64_t total = 0;
+  std::memcpy(&version, base + 4, 4);
+  std::memcpy(&frames, base + 8, 4);
+  std::memcpy(&id_count, base + 12, 4);
+  std::memcpy(&weapon_count, base + 16, 4);
+  std::memcpy(&total, base + 24, 8);
+  if (version != kColumnarReplayVersion) {
+    throw std::runtime_error("不支持的列式回放版本: " + std::to_string(version));
+  }
+  if (total != file_.size()) {
+    Corrupt(path, "文件长度不符，可能被截断");
+  }
+  frame_count_ = frames;
+  index_offset_ = kHeaderBytes;
+  std::size_t offset = index_offset_ + frame_count_ * kIndexEntryBytes;
+  if (offset > file_.size()) {
+    Corrupt(path, "帧索引越界");
+  }
+
+  const std::vector<std::string> id_names = ReadDictionary(offset, id_count);
+  ids_.reserve(id_names.size());
+  for (const auto& name : id_names) {
+    ids_.push_back(EntityId::Intern(name));
+  }
+  weapons_ = ReadDictionary(offset, weapon_count);
+
+  // 一次性校验索引，ReadFrame 只需再校验列中的字典下标。
+  std::int64_t prev_ts = 0;
+  for (std::size_t f = 0; f < frame_count_; ++f) {
+    const IndexEntry e = EntryAt(file_, index_offset_, f);
+    if (e.offset < offset || e.offset > file_.size() || e.block_bytes > file_.size() - e.offset ||
+        e.block_bytes != BlockBytes(e.entity_count, e.fire_count, (e.flags & kHasEnv) != 0)) {
+      Corrupt(path, "第" + std::to_string(f) + "帧数据块越界");
+    }
+    if (f > 0 && e.timestamp_ms < prev_ts) {
+      Corrupt(path, "帧时间戳未按升序排列");
+    }
+    prev_ts = e.timestamp_ms;
+  }
+}
+
+std::int64_t ColumnarReplayReader::timestamp(std::size_t frame) const {
+  return EntryAt(file_, index_offset_, frame).timestamp_ms;
+}
+
+std::vector<std::string> ColumnarReplayReader::ReadDictionary(std::size_t& offset, std::uint32_t count) const {
+  const std::uint8_t* base = file_.view().data();
+  const std::size_t offsets_bytes = (static_cast<std::size_t>(count) + 1) * sizeof(std::uint32_t);
+  if (offsets_bytes > file_.size() - offset) {
+    Corrupt(file_.path(), "字典越界");
+  }
+  const std::uint8_t* bounds = base + offset;
+  const std::size_t text = offset + offsets_bytes;
+  const std::uint32_t text_bytes = At<std::uint32_t>(bounds, count);
+  if (text_bytes > file_.size() - text) {
+    Corrupt(file_.path(), "字典越界");
+  }
+  std::vector<std::string> out;
+  out.reserve(count);
+  for (std::uint32_t i = 0; i < count; ++i) {
+    const std::uint32_t begin = At<std::uint32_t>(bounds, i);
+    const std::uint32_t end = At<std::uint32_t>(bounds, i + 1);
+    if (begin > end || end > text_bytes) {
+      Corrupt(file_.path(), "字典偏移无效");
+    }
+    out.emplace_back(reinterpret_cast<const char*>(base + text + begin), end - begin);
+  }
+  offset = Align8(text + text_bytes);
+  return out;
+}
+
+DisPduBatch ColumnarReplayReader::ReadFrame(std::size_t frame) const {
+  const IndexEntry e = EntryAt(file_, index_offset_, frame);
+  const std::uint8_t* p = file_.view().data() + e.offset;
+  DisPduBatch batch;
+  batch.timestamp_ms = e.timestamp_ms;
+  if ((e.flags & kHasEnv) != 0) {
+    batch.env = EnvironmentState{At<double>(p, 0), At<double>(p, 1), At<double>(p, 2)};
+    p += 3 * sizeof(double);
+  }
+
+  const std::size_t n = e.entity_count;
+  const std::uint8_t* entity_ts = p;
+  const std::uint8_t* x = entity_ts + n * sizeof(std::int64_t);
+  const std::uint8_t* y = x + n * sizeof(double);
+  const std::uint8_t* z = y + n * sizeof(double);
+  const std::uint8_t* speed = z + n * sizeof(double);
+  const std::uint8_t* heading = speed + n * sizeof(double);
+  const std::uint8_t* threat = heading + n * sizeof(double);
+  const std::uint8_t* id = threat + n * sizeof(double);
+  const std::uint8_t* side = id + n * sizeof(std::uint32_t);
+  const std::uint8_t* type = side + n;
+  const std::uint8_t* alive = type + n;
+  batch.entity_updates.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto id_index = At<std::uint32_t>(id, i);
+    if (id_index >= ids_.size() || side[i] > static_cast<std::uint8_t>(Side::Neutral) ||
+        type[i] > static_cast<std::uint8_t>(UnitType::Unknown)) {
+      Corrupt(file_.path(), "第" + std::to_string(frame) + "帧实体列取值无效");
+    }
+    DisEntityPdu& pdu = batch.entity_updates[i];
+    pdu.timestamp_ms = At<std::int64_t>(entity_ts, i);
+    pdu.entity_id = ids_[id_index];
+    pdu.side = static_cast<Side>(side[i]);
+    pdu.type = static_cast<UnitType>(type[i]);
+    pdu.pose = {At<double>(x, i), At<double>(y, i), At<double>(z, i)};
+    pdu.speed_mps = At<double>(speed, i);
+    pdu.heading_deg = At<double>(heading, i);
+    pdu.alive = alive[i] != 0;
+    pdu.threat_level = At<double>(threat, i);
+  }
+  p += Align8(static_cast<std::size_t>(alive + n - p));
+
+  const std::size_t m = e.fire_count;
+  const std::uint8_t* fire_ts = p;
+  const std::uint8_t* ox = fire_ts + m * sizeof(std::int64_t);
+  const std::uint8_t* oy = ox + m * sizeof(double);
+  const std::uint8_t* oz = oy + m * sizeof(double);
+  const std::uint8_t* shooter = oz + m * sizeof(double);
+  const std::uint8_t* target = shooter + m * sizeof(std::uint32_t);
+  const std::uint8_t* weapon = target + m * sizeof(std::uint32_t);
+  batch.fire_events.resize(m);
+  for (std::size_t i = 0; i < m; ++i) {
+    const auto shooter_index = At<std::uint32_t>(shooter, i);
+    const auto target_index = At<std::uint32_t>(target, i);
+    const auto weapon_index = At<std::uint32_t>(weapon, i);
+    if (shooter_index >= ids_.size() || target_index >= ids_.size() || weapon_index >= weapons_.size()) {
+      Corrupt(file_.path(), "第" + std::to_string(frame) + "帧开火列取值无效");
+    }
+    DisFirePdu& pdu = batch.fire_events[i];
+    pdu.timestamp_ms = At<std::int64_t>(fire_ts, i);
+    pdu.shooter_id = ids_[shooter_index];
+    pdu.target_id = ids_[target_index];
+    pdu.weapon_name = weapons_[weapon_index];
+    pdu.origin = {At<double>(ox, i), At<double>(oy, i), At<double>(oz, i)};
+  }
+  return batch;
+}
+
+std::vector<DisPduBatch> ColumnarReplayReader::LoadBatches() const {
+  std::vector<DisPduBatch> batches;
+  batches.reserve(frame_count_);
+  for (std::size_t f = 0; f < frame_count_; ++f) {
+    batches.push_back(ReadFrame(f));
+  }
+  return batches;
+}
+
+void ColumnarReplayReader::ReleaseFrame(std::size_t frame) const {
+  const IndexEntry e = EntryAt(file_, index_offset_, frame);
+  file_.ReleaseRange(static_cast<std::size_t>(e.offset), e.block_bytes);
+}
+
+}  // namespace bas
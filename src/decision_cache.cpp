@@ -1,32 +1,140 @@
 #include "bas/cache/decision_cache.hpp"
 
+#include <algorithm>
+#include <utility>
+
 namespace bas {
 
-DecisionCache::DecisionCache(std::int64_t ttl_ms) : ttl_ms_(ttl_ms) {}
+DecisionCache::DecisionCache(std::int64_t ttl_ms, std::size_t capacity)
+    : ttl_ms_(ttl_ms), capacity_(std::max<std::size_t>(1, capacity)) {
+  index_.reserve(capacity_);
+}
+
+DecisionCache::Value DecisionCache::Get(Key key, std::int64_t now_ms) {
+  const auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++stats_.misses;
+    return nullptr;
+  }
+  const std::uint32_t slot = it->second;
+  if (Expired(nodes_[slot], now_ms)) {
+    Erase(slot);
+    ++stats_.expirations;
+    ++stats_.misses;
+    return nullptr;
+  }
+  Unlink<UseLink>(by_use_, slot);
+  InsertAfter<UseLink>(by_use_, by_use_.tail, slot);
+  ++stats_.hits;
+  return nodes_[slot].value;
+}
+
+DecisionCache::Value DecisionCache::Peek(Key key) const {
+  const auto it = index_.find(key);
+  return it == index_.end() ? nullptr : nodes_[it->second].value;
+}
+
+void DecisionCache::Put(Key key, const DecisionPackage& value, std::int64_t now_ms) {
+  Put(key, std::make_shared<const DecisionPackage>(value), now_ms);
+}
 
-std::optional<DecisionPackage> DecisionCache::Get(const std::string& key, std::int64_t now_ms) const {
-  const auto it = table_.find(key);
-  if (it == table_.end()) {
-    return std::nullopt;
+void DecisionCache::Put(Key key, Value value, std::int64_t now_ms) {
+  ++stats_.inserts;
+  if (const auto it = index_.find(key); it != index_.end()) {
+    Erase(it->second);
+  } else if (index_.size() >= capacity_) {
+    Erase(by_use_.head);
+    ++stats_.evictions;
   }
-  if (now_ms - it->second.timestamp_ms > ttl_ms_) {
-    return std::nullopt;
+
+  std::uint32_t slot;
+  if (!free_.empty()) {
+    slot = free_.back();
+    free_.pop_back();
+  } else {
+    slot = static_cast<std::uint32_t>(nodes_.size());
+    nodes_.emplace_back();
   }
-  return it->second.value;
+  Node& node = nodes_[slot];
+  node.key = key;
+  node.timestamp_ms = now_ms;
+  node.value = std::move(value);
+  index_.emplace(key, slot);
+
+  // 时间链按写入时间升序；回放时间单调递增时总是挂在链尾，乱序写入才向前查找。
+  std::uint32_t after = by_time_.tail;
+  while (after != kNil && nodes_[after].timestamp_ms > now_ms) {
+    after = nodes_[after].by_time.prev;
+  }
+  InsertAfter<TimeLink>(by_time_, after, slot);
+  InsertAfter<UseLink>(by_use_, by_use_.tail, slot);
 }
 
-void DecisionCache::Put(const std::string& key, const DecisionPackage& value, std::int64_t now_ms) {
-  table_[key] = Entry{now_ms, value};
+bool DecisionCache::Replace(Key key, Value value) {
+  const auto it = index_.find(key);
+  if (it == index_.end()) {
+    return false;
+  }
+  nodes_[it->second].value = std::move(value);
+  return true;
 }
 
 void DecisionCache::Prune(std::int64_t now_ms) {
-  for (auto it = table_.begin(); it != table_.end();) {
-    if (now_ms - it->second.timestamp_ms > ttl_ms_) {
-      it = table_.erase(it);
-    } else {
-      ++it;
-    }
+  while (by_time_.head != kNil && Expired(nodes_[by_time_.head], now_ms)) {
+    Erase(by_time_.head);
+    ++stats_.expirations;
   }
 }
 
+DecisionCache::Key DecisionCache::HashBytes(std::string_view bytes, Key seed) {
+  Key hash = seed;
+  for (const char c : bytes) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+template <DecisionCache::Link& (*L)(DecisionCache::Node&)>
+void DecisionCache::Unlink(List& list, std::uint32_t slot) {
+  Link& link = L(nodes_[slot]);
+  if (link.prev != kNil) {
+    L(nodes_[link.prev]).next = link.next;
+  } else {
+    list.head = link.next;
+  }
+  if (link.next != kNil) {
+    L(nodes_[link.next]).prev = link.prev;
+  } else {
+    list.tail = link.prev;
+  }
+  link = Link{};
+}
+
+template <DecisionCache::Link& (*L)(DecisionCache::Node&)>
+void DecisionCache::InsertAfter(List& list, std::uint32_t after, std::uint32_t slot) {
+  Link& link = L(nodes_[slot]);
+  link.prev = after;
+  link.next = after == kNil ? list.head : L(nodes_[after]).next;
+  if (link.next != kNil) {
+    L(nodes_[link.next]).prev = slot;
+  } else {
+    list.tail = slot;
+  }
+  if (after != kNil) {
+    L(nodes_[after]).next = slot;
+  } else {
+    list.head = slot;
+  }
+}
+
+void DecisionCache::Erase(std::uint32_t slot) {
+  Unlink<TimeLink>(by_time_, slot);
+  Unlink<UseLink>(by_use_, slot);
+  Node& node = nodes_[slot];
+  index_.erase(node.key);
+  node.value.reset();
+  free_.push_back(slot);
+}
+
 }  // namespace bas
@@ -1,19 +1,201 @@
 #include "bas/dis/dis_adapter.hpp"
 
 #include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "bas/common/name_table.hpp"
 
 namespace bas {
 
+namespace {
+
+void AssignDefaultWeapons(EntityState& state) {
+  // 默认武器配置：即使未加载外部表，也能保障决策链路运行。
+  switch (state.type) {
+    case UnitType::Infantry:
+      state.weapons.push_back({"rifle", 800.0, 0.25, 200, 0.0, {UnitType::Infantry}});
+      break;
+    case UnitType::Armor:
+      state.weapons.push_back({"tank_gun", 2500.0, 0.65, 30, 0.0,
+                               {UnitType::Armor, UnitType::Artillery, UnitType::Command}});
+      break;
+    case UnitType::Artillery:
+      state.weapons.push_back({"howitzer", 8000.0, 0.55, 20, 0.0,
+                               {UnitType::Armor, UnitType::Artillery, UnitType::Command}});
+      break;
+    case UnitType::AirDefense:
+      state.weapons.push_back({"sam", 3500.0, 0.60, 12, 0.0, {UnitType::AirDefense}});
+      break;
+    default:
+      state.weapons.push_back({"generic", 1000.0, 0.20, 50, 0.0, {}});
+      break;
+  }
+}
+
+void WriteTableRow(EntityTable& table, std::size_t i, const EntityState& entity) {
+  table.x[i] = entity.pose.x;
+  table.y[i] = entity.pose.y;
+  table.z[i] = entity.pose.z;
+  table.speed_mps[i] = entity.speed_mps;
+  table.threat_level[i] = entity.threat_level;
+  table.alive[i] = entity.alive ? 1 : 0;
+  table.type[i] = entity.type;
+}
+
+void ResizeTable(EntityTable& table, std::size_t n) {
+  table.x.resize(n);
+  table.y.resize(n);
+  table.z.resize(n);
+  table.speed_mps.resize(n);
+  table.threat_level.resize(n);
+  table.alive.resize(n);
+  table.type.resize(n);
+}
+
+void SwapRemoveTableRow(EntityTable& table, std::size_t i) {
+  const std::size_t last = table.size() - 1;
+  table.x[i] = table.x[last];
+  table.y[i] = table.y[last];
+  table.z[i] = table.z[last];
+  table.speed_mps[i] = table.speed_mps[last];
+  table.threat_level[i] = table.threat_level[last];
+  table.alive[i] = table.alive[last];
+  table.type[i] = table.type[last];
+  table.x.pop_back();
+  table.y.pop_back();
+  table.z.pop_back();
+  table.speed_mps.pop_back();
+  table.threat_level.pop_back();
+  table.alive.pop_back();
+  table.type.pop_back();
+}
+
+void WriteUnits(BinaryWriter& out, const std::vector<EntityState>& units) {
+  out.PutSize(units.size());
+  for (const auto& unit : units) {
+    out.PutId(unit.id);
+    out.Put(static_cast<std::uint8_t>(unit.side));
+    out.Put(static_cast<std::uint8_t>(unit.type));
+    out.Put(unit.pose);
+    out.Put(unit.speed_mps);
+    out.Put(unit.heading_deg);
+    out.Put(unit.threat_level);
+    out.PutBool(unit.alive);
+    out.PutString(unit.formation_group);
+    out.PutSize(unit.weapons.size());
+    for (const auto& weapon : unit.weapons) {
+      out.PutString(weapon.name);
+      out.Put(weapon.range_m);
+      out.Put(weapon.kill_probability);
+      out.Put(static_cast<std::int32_t>(weapon.ammo));
+      out.Put(weapon.ready_in_s);
+      out.PutSize(weapon.preferred_targets.size());
+      for (const UnitType target : weapon.preferred_targets) {
+        out.Put(static_cast<std::uint8_t>(target));
+      }
+    }
+  }
+}
+
+UnitType ReadUnitType(BinaryReader& in) {
+  const auto value = in.Get<std::uint8_t>();
+  if (value > static_cast<std::uint8_t>(UnitType::Unknown)) {
+    throw std::runtime_error("状态数据损坏: 单位类型无效");
+  }
+  return static_cast<UnitType>(value);
+}
+
+std::vector<EntityState> ReadUnits(BinaryReader& in) {
+  std::vector<EntityState> units(in.GetSize());
+  for (auto& unit : units) {
+    unit.id = in.GetId();
+    const auto side = in.Get<std::uint8_t>();
+    if (side > static_cast<std::uint8_t>(Side::Neutral)) {
+      throw std::runtime_error("状态数据损坏: 阵营无效");
+    }
+    unit.side = static_cast<Side>(side);
+    unit.type = ReadUnitType(in);
+    unit.pose = in.Get<Pose>();
+    unit.speed_mps = in.Get<double>();
+    unit.heading_deg = in.Get<double>();
+    unit.threat_level = in.Get<double>();
+    unit.alive = in.GetBool();
+    unit.formation_group = in.GetString();
+    unit.weapons.resize(in.GetSize());
+    for (auto& weapon : unit.weapons) {
+      weapon.name = in.GetString();
+      weapon.range_m = in.Get<double>();
+      weapon.kill_probability = in.Get<double>();
+      weapon.ammo = in.Get<std::int32_t>();
+      weapon.ready_in_s = in.Get<double>();
+      weapon.preferred_targets.resize(in.GetSize());
+      for (auto& target : weapon.preferred_targets) {
+        target = ReadUnitType(in);
+      }
+    }
+  }
+  return units;
+}
+
+// 回收缓冲数与变化日志深度：消费者通常只持有一两版快照，超出时整份复制追平。
+constexpr std::size_t kMaxPooledSnapshots = 4;
+constexpr std::size_t kChangeLogDepth = 8;
+
+}  // namespace
+
+struct DisAdapter::SnapshotPool {
+  std::mutex mutex;
+  std::vector<std::unique_ptr<BattlefieldSnapshot>> free;
+
+  void Put(BattlefieldSnapshot* snapshot) {
+    std::unique_ptr<BattlefieldSnapshot> owned(snapshot);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free.size() < kMaxPooledSnapshots) {
+      free.push_back(std::move(owned));
+    }
+  }
+
+  std::unique_ptr<BattlefieldSnapshot> Take() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (free.empty()) {
+      return nullptr;
+    }
+    // 最后归还的缓冲版本最新，追平所需的差量最少。
+    auto snapshot = std::move(free.back());
+    free.pop_back();
+    return snapshot;
+  }
+};
+
 void DisAdapter::FeedMockFrame(const BattlefieldSnapshot& snapshot) {
-  entities_.clear();
-  for (const auto& unit : snapshot.friendly_units) {
-    entities_[unit.id] = unit;
+  working_ = std::make_unique<BattlefieldSnapshot>();
+  neutral_units_.clear();
+  slots_.clear();
+  dirty_.clear();
+  moved_.clear();
+  // 整体替换后旧缓冲无法按差量追平。
+  change_log_.clear();
+  change_log_base_ = version_ + 1;
+
+  BattlefieldSnapshot& next = *working_;
+  next.friendly_units = snapshot.friendly_units;
+  next.hostile_units = snapshot.hostile_units;
+  next.friendly_table = EntityTable::FromEntities(next.friendly_units);
+  next.hostile_table = EntityTable::FromEntities(next.hostile_units);
+  for (std::size_t i = 0; i < next.friendly_units.size(); ++i) {
+    slots_[next.friendly_units[i].id] = {Side::Friendly, i, true};
+    dirty_.push_back(next.friendly_units[i].id);
   }
-  for (const auto& unit : snapshot.hostile_units) {
-    entities_[unit.id] = unit;
+  for (std::size_t i = 0; i < next.hostile_units.size(); ++i) {
+    slots_[next.hostile_units[i].id] = {Side::Hostile, i, true};
+    dirty_.push_back(next.hostile_units[i].id);
   }
+
   env_ = snapshot.env;
   latest_timestamp_ms_ = snapshot.timestamp_ms;
+  full_refresh_ = true;
   has_update_ = true;
 }
 
@@ -25,9 +207,11 @@ void DisAdapter::Ingest(const DisPduBatch& batch) {
 
   for (const auto& fire : batch.fire_events) {
     latest_timestamp_ms_ = std::max(latest_timestamp_ms_, fire.timestamp_ms);
-    buffered_events_.push_back(
-        {fire.timestamp_ms, EventType::WeaponFire, fire.shooter_id, fire.origin,
-         "武器=" + fire.weapon_name + "，目标=" + fire.target_id});
+    // 文本延迟到构建模型上下文时再渲染。
+    const WeaponKind weapon = WeaponKindFromString(fire.weapon_name);
+    buffered_events_.push_back({fire.timestamp_ms, EventType::WeaponFire, fire.shooter_id, fire.origin, {},
+                                FirePayload{fire.target_id, weapon, MunitionClassOf(weapon),
+                                            InternWeaponName(fire.weapon_name)}});
   }
 
   if (batch.env.has_value()) {
@@ -37,11 +221,55 @@ void DisAdapter::Ingest(const DisPduBatch& batch) {
 }
 
 std::optional<BattlefieldSnapshot> DisAdapter::Poll() {
+  auto update = PollUpdate();
+  if (!update.has_value()) {
+    return std::nullopt;
+  }
+  return *update->snapshot;
+}
+
+std::optional<SnapshotUpdate> DisAdapter::PollUpdate() {
   if (!has_update_) {
     return std::nullopt;
   }
   has_update_ = false;
-  return BuildSnapshot(latest_timestamp_ms_);
+
+  BattlefieldSnapshot& snapshot = MutableSnapshot();
+  snapshot.timestamp_ms = latest_timestamp_ms_;
+  snapshot.env = env_;
+  // 列存表随单位列表同步维护，发布时以版本号标记二者对齐。
+  ++version_;
+  snapshot.units_generation = version_;
+  snapshot.friendly_table.generation = version_;
+  snapshot.hostile_table.generation = version_;
+
+  std::vector<EntityId> changed = dirty_;
+  changed.insert(changed.end(), moved_.begin(), moved_.end());
+  moved_.clear();
+  change_log_.push_back({version_, std::move(changed)});
+  if (change_log_.size() > kChangeLogDepth) {
+    change_log_base_ = change_log_.front().version;
+    change_log_.pop_front();
+  }
+
+  // 发布后工作副本转为只读；最后一个持有者释放时经回收池交还。
+  if (!pool_) {
+    pool_ = std::make_shared<SnapshotPool>();
+  }
+  std::shared_ptr<SnapshotPool> pool = pool_;
+  published_ = std::shared_ptr<const BattlefieldSnapshot>(
+      working_.release(), [pool](BattlefieldSnapshot* released) { pool->Put(released); });
+
+  SnapshotUpdate update;
+  update.snapshot = published_;
+  update.dirty_entities.swap(dirty_);
+  update.full_refresh = full_refresh_;
+  update.version = version_;
+  for (const EntityId id : update.dirty_entities) {
+    slots_[id].dirty = false;
+  }
+  full_refresh_ = false;
+  return update;
 }
 
 std::vector<EventRecord> DisAdapter::DrainEvents() {
@@ -50,55 +278,209 @@ std::vector<EventRecord> DisAdapter::DrainEvents() {
   return events;
 }
 
-void DisAdapter::UpsertEntity(const DisEntityPdu& pdu) {
-  EntityState& state = entities_[pdu.entity_id];
-  state.id = pdu.entity_id;
-  state.side = pdu.side;
-  state.type = pdu.type;
-  state.pose = pdu.pose;
-  state.speed_mps = pdu.speed_mps;
-  state.heading_deg = pdu.heading_deg;
-  state.alive = pdu.alive;
-  state.threat_level = pdu.threat_level;
-
-  if (state.weapons.empty()) {
-    // 默认武器配置：即使未加载外部表，也能保障决策链路运行。
-    switch (pdu.type) {
-      case UnitType::Infantry:
-        state.weapons.push_back({"rifle", 800.0, 0.25, 200, 0.0, {UnitType::Infantry}});
-        break;
-      case UnitType::Armor:
-        state.weapons.push_back({"tank_gun", 2500.0, 0.65, 30, 0.0,
-                                 {UnitType::Armor, UnitType::Artillery, UnitType::Command}});
-        break;
-      case UnitType::Artillery:
-        state.weapons.push_back({"howitzer", 8000.0, 0.55, 20, 0.0,
-                                 {UnitType::Armor, UnitType::Artillery, UnitType::Command}});
-        break;
-      case UnitType::AirDefense:
-        state.weapons.push_back({"sam", 3500.0, 0.60, 12, 0.0, {UnitType::AirDefense}});
-        break;
-      default:
-        state.weapons.push_back({"generic", 1000.0, 0.20, 50, 0.0, {}});
-        break;
-    }
+BattlefieldSnapshot& DisAdapter::MutableSnapshot() {
+  if (working_) {
+    return *working_;
+  }
+  if (!published_) {
+    working_ = std::make_unique<BattlefieldSnapshot>();
+    return *working_;
   }
+  // 已发布快照只读：取回收缓冲追平到最新版本，没有可用缓冲时才分配新副本。
+  working_ = pool_->Take();
+  if (working_) {
+    CatchUp(*working_);
+  } else {
+    working_ = std::make_unique<BattlefieldSnapshot>(*published_);
+  }
+  return *working_;
 }
 
-BattlefieldSnapshot DisAdapter::BuildSnapshot(std::int64_t timestamp_ms) const {
-  BattlefieldSnapshot snapshot;
-  snapshot.timestamp_ms = timestamp_ms;
-  snapshot.env = env_;
+void DisAdapter::CatchUp(BattlefieldSnapshot& buffer) const {
+  const BattlefieldSnapshot& latest = *published_;
+  const std::uint64_t from = buffer.units_generation;
+  std::size_t changes = 0;
+  for (const ChangeLogEntry& entry : change_log_) {
+    changes += entry.version > from ? entry.ids.size() : 0;
+  }
+  if (from < change_log_base_ || changes >= latest.friendly_units.size() + latest.hostile_units.size()) {
+    buffer = latest;
+    return;
+  }
 
-  for (const auto& [_, entity] : entities_) {
-    if (entity.side == Side::Friendly) {
-      snapshot.friendly_units.push_back(entity);
-    } else if (entity.side == Side::Hostile) {
-      snapshot.hostile_units.push_back(entity);
+  // 此后没有改动过的实体在两版中下标与内容都相同；新增、移出或补位的实体都已记入日志。
+  buffer.friendly_units.resize(latest.friendly_units.size());
+  buffer.hostile_units.resize(latest.hostile_units.size());
+  ResizeTable(buffer.friendly_table, latest.friendly_table.size());
+  ResizeTable(buffer.hostile_table, latest.hostile_table.size());
+  for (const ChangeLogEntry& entry : change_log_) {
+    if (entry.version <= from) {
+      continue;
+    }
+    for (const EntityId id : entry.ids) {
+      const Slot& slot = slots_.at(id);
+      if (slot.side == Side::Friendly) {
+        buffer.friendly_units[slot.index] = latest.friendly_units[slot.index];
+        WriteTableRow(buffer.friendly_table, slot.index, latest.friendly_units[slot.index]);
+      } else if (slot.side == Side::Hostile) {
+        buffer.hostile_units[slot.index] = latest.hostile_units[slot.index];
+        WriteTableRow(buffer.hostile_table, slot.index, latest.hostile_units[slot.index]);
+      }
     }
   }
+  buffer.timestamp_ms = latest.timestamp_ms;
+  buffer.env = latest.env;
+  buffer.units_generation = latest.units_generation;
+  buffer.friendly_table.generation = latest.friendly_table.generation;
+  buffer.hostile_table.generation = latest.hostile_table.generation;
+}
+
+void DisAdapter::UpsertEntity(const DisEntityPdu& pdu) {
+  BattlefieldSnapshot& snapshot = MutableSnapshot();
+  const auto [it, inserted] = slots_.try_emplace(pdu.entity_id);
+  Slot& slot = it->second;
 
-  return snapshot;
+  EntityState state;
+  if (inserted) {
+    state.id = pdu.entity_id;
+    state.type = pdu.type;
+    AssignDefaultWeapons(state);
+  } else if (slot.side != pdu.side) {
+    state = RemoveFromSide(slot);
+  }
+
+  if (inserted || slot.side != pdu.side) {
+    state.side = pdu.side;
+    state.type = pdu.type;
+    state.pose = pdu.pose;
+    state.speed_mps = pdu.speed_mps;
+    state.heading_deg = pdu.heading_deg;
+    state.alive = pdu.alive;
+    state.threat_level = pdu.threat_level;
+    AppendToSide(std::move(state), slot);
+    MarkDirty(pdu.entity_id, slot);
+    return;
+  }
+
+  std::vector<EntityState>* units = &neutral_units_;
+  EntityTable* table = nullptr;
+  if (slot.side == Side::Friendly) {
+    units = &snapshot.friendly_units;
+    table = &snapshot.friendly_table;
+  } else if (slot.side == Side::Hostile) {
+    units = &snapshot.hostile_units;
+    table = &snapshot.hostile_table;
+  }
+
+  EntityState& entity = (*units)[slot.index];
+  entity.type = pdu.type;
+  entity.pose = pdu.pose;
+  entity.speed_mps = pdu.speed_mps;
+  entity.heading_deg = pdu.heading_deg;
+  entity.alive = pdu.alive;
+  entity.threat_level = pdu.threat_level;
+  if (table != nullptr) {
+    WriteTableRow(*table, slot.index, entity);
+  }
+  MarkDirty(pdu.entity_id, slot);
+}
+
+void DisAdapter::AppendToSide(EntityState&& state, Slot& slot) {
+  BattlefieldSnapshot& snapshot = *working_;
+  slot.side = state.side;
+  if (state.side == Side::Friendly) {
+    slot.index = snapshot.friendly_units.size();
+    snapshot.friendly_table.Append(state);
+    snapshot.friendly_units.push_back(std::move(state));
+  } else if (state.side == Side::Hostile) {
+    slot.index = snapshot.hostile_units.size();
+    snapshot.hostile_table.Append(state);
+    snapshot.hostile_units.push_back(std::move(state));
+  } else {
+    slot.index = neutral_units_.size();
+    neutral_units_.push_back(std::move(state));
+  }
+}
+
+EntityState DisAdapter::RemoveFromSide(const Slot& slot) {
+  BattlefieldSnapshot& snapshot = *working_;
+  std::vector<EntityState>* units = &neutral_units_;
+  EntityTable* table = nullptr;
+  if (slot.side == Side::Friendly) {
+    units = &snapshot.friendly_units;
+    table = &snapshot.friendly_table;
+  } else if (slot.side == Side::Hostile) {
+    units = &snapshot.hostile_units;
+    table = &snapshot.hostile_table;
+  }
+
+  // 交换删除：末尾实体补位并修正其槽位下标，保持 AoS 与列存表对齐。
+  EntityState removed = std::move((*units)[slot.index]);
+  if (slot.index + 1 != units->size()) {
+    (*units)[slot.index] = std::move(units->back());
+    slots_[(*units)[slot.index].id].index = slot.index;
+    moved_.push_back((*units)[slot.index].id);
+  }
+  units->pop_back();
+  if (table != nullptr) {
+    SwapRemoveTableRow(*table, slot.index);
+  }
+  return removed;
+}
+
+void DisAdapter::SaveState(BinaryWriter& out) const {
+  static const BattlefieldSnapshot kEmpty;
+  const BattlefieldSnapshot& snapshot = working_ ? *working_ : published_ ? *published_ : kEmpty;
+  WriteUnits(out, snapshot.friendly_units);
+  WriteUnits(out, snapshot.hostile_units);
+  WriteUnits(out, neutral_units_);
+  out.Put(env_);
+  out.Put(latest_timestamp_ms_);
+  out.Put(version_);
+}
+
+void DisAdapter::RestoreState(BinaryReader& in) {
+  auto next = std::make_unique<BattlefieldSnapshot>();
+  next->friendly_units = ReadUnits(in);
+  next->hostile_units = ReadUnits(in);
+  std::vector<EntityState> neutral = ReadUnits(in);
+  env_ = in.Get<EnvironmentState>();
+  latest_timestamp_ms_ = in.Get<std::int64_t>();
+  version_ = in.Get<std::uint64_t>();
+
+  next->timestamp_ms = latest_timestamp_ms_;
+  next->env = env_;
+  next->friendly_table = EntityTable::FromEntities(next->friendly_units);
+  next->hostile_table = EntityTable::FromEntities(next->hostile_units);
+  slots_.clear();
+  for (std::size_t i = 0; i < next->friendly_units.size(); ++i) {
+    slots_[next->friendly_units[i].id] = {Side::Friendly, i, false};
+  }
+  for (std::size_t i = 0; i < next->hostile_units.size(); ++i) {
+    slots_[next->hostile_units[i].id] = {Side::Hostile, i, false};
+  }
+  for (std::size_t i = 0; i < neutral.size(); ++i) {
+    slots_[neutral[i].id] = {Side::Neutral, i, false};
+  }
+  working_ = std::move(next);
+  published_.reset();
+  // 恢复前发布的缓冲版本号属于另一条时间线，可能被误判为可追平；换新回收池，旧缓冲归还后随旧池释放。
+  pool_.reset();
+  neutral_units_ = std::move(neutral);
+  dirty_.clear();
+  moved_.clear();
+  change_log_.clear();
+  change_log_base_ = version_ + 1;
+  buffered_events_.clear();
+  full_refresh_ = true;
+  has_update_ = false;
+}
+
+void DisAdapter::MarkDirty(EntityId id, Slot& slot) {
+  if (!slot.dirty) {
+    slot.dirty = true;
+    dirty_.push_back(id);
+  }
 }
 
 }  // namespace bas
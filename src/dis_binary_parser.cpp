@@ -3,17 +3,17 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
-#include <fstream>
-#include <map>
+#include <limits>
 #include <sstream>
 #include <stdexcept>
 
+#include "bas/common/mapped_file.hpp"
+#include "bas/dis/dis_stream_parser.hpp"
+
 namespace bas {
 
 namespace {
 
-constexpr std::size_t kDisHeaderLength = 12;
-
 std::string BuildError(const std::string& msg, std::size_t offset) {
   std::ostringstream oss;
   oss << msg << "，字节偏移=" << offset;
@@ -33,55 +33,52 @@ double ClampThreat(double value) {
 }  // namespace
 
 std::vector<DisPduBatch> DisBinaryParser::ParseFile(const std::string& path) const {
-  std::ifstream ifs(path, std::ios::binary);
-  if (!ifs) {
-    throw std::runtime_error("无法打开DIS二进制文件: " + path);
-  }
-
-  std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-  if (bytes.empty()) {
+  const MappedFile file(path);
+  if (file.size() == 0) {
     return {};
   }
-  return ParseBytes(bytes);
+  return ParseBytes(file.view());
 }
 
-std::vector<DisPduBatch> DisBinaryParser::ParseBytes(const std::vector<std::uint8_t>& bytes) const {
-  std::map<std::uint32_t, DisPduBatch> by_timestamp;
+std::vector<DisPduBatch> DisBinaryParser::ParseBytes(ByteView bytes) const {
+  // 整块解析等价于重排窗口无穷大的流式解析：全部PDU按时间戳归并后一次性输出。
+  DisStreamParser stream({std::numeric_limits<std::uint32_t>::max(), 0});
+  std::vector<DisPduBatch> batches;
+  const auto sink = [&batches](DisPduBatch&& batch) { batches.push_back(std::move(batch)); };
+  stream.Feed(bytes, sink);
+  stream.Finish(sink);
+  return batches;
+}
 
-  std::size_t offset = 0;
-  while (offset < bytes.size()) {
-    if (bytes.size() - offset < kDisHeaderLength) {
-      throw std::runtime_error(BuildError("DIS头部不完整", offset));
-    }
+DisPduHeader DisBinaryParser::ReadPduHeader(ByteView bytes, std::size_t offset, std::size_t stream_offset) {
+  const DisPduHeader header = ParseHeader(bytes, offset);
+  if (header.length < kHeaderLength) {
+    throw std::runtime_error(BuildError("PDU长度非法（小于12）", stream_offset));
+  }
+  return header;
+}
 
-    const DisPduHeader header = ParseHeader(bytes, offset);
-    if (header.length < kDisHeaderLength) {
-      throw std::runtime_error(BuildError("PDU长度非法（小于12）", offset));
+void DisBinaryParser::AppendPdu(ByteView bytes,
+                                std::size_t offset,
+                                const DisPduHeader& header,
+                                std::size_t stream_offset,
+                                DisPduBatch& batch) const {
+  if (header.pdu_type == 1) {
+    if (header.length < 88) {
+      throw std::runtime_error(BuildError("实体状态PDU长度不足", stream_offset));
     }
-    if (offset + header.length > bytes.size()) {
-      throw std::runtime_error(BuildError("PDU长度超出文件范围", offset));
+    batch.entity_updates.push_back(ParseEntityStatePdu(bytes, offset, stream_offset));
+  } else if (header.pdu_type == 2) {
+    if (header.length < 64) {
+      throw std::runtime_error(BuildError("开火PDU长度不足", stream_offset));
     }
-
-    if (header.pdu_type == 1) {
-      by_timestamp[header.timestamp].entity_updates.push_back(ParseEntityStatePdu(bytes, offset, header.length));
-    } else if (header.pdu_type == 2) {
-      by_timestamp[header.timestamp].fire_events.push_back(ParseFirePdu(bytes, offset, header.length));
-    } else {
-      throw std::runtime_error(BuildError("不支持的PDU类型: " + std::to_string(header.pdu_type), offset));
-    }
-
-    offset += header.length;
-  }
-
-  std::vector<DisPduBatch> batches;
-  batches.reserve(by_timestamp.size());
-  for (auto& [_, batch] : by_timestamp) {
-    batches.push_back(std::move(batch));
+    batch.fire_events.push_back(ParseFirePdu(bytes, offset, stream_offset));
+  } else {
+    throw std::runtime_error(BuildError("不支持的PDU类型: " + std::to_string(header.pdu_type), stream_offset));
   }
-  return batches;
 }
 
-DisPduHeader DisBinaryParser::ParseHeader(const std::vector<std::uint8_t>& bytes, std::size_t offset) {
+DisPduHeader DisBinaryParser::ParseHeader(ByteView bytes, std::size_t offset) {
   DisPduHeader h;
   h.protocol_version = bytes[offset + 0];
   h.exercise_id = bytes[offset + 1];
@@ -93,17 +90,11 @@ DisPduHeader DisBinaryParser::ParseHeader(const std::vector<std::uint8_t>& bytes
   return h;
 }
 
-DisEntityPdu DisBinaryParser::ParseEntityStatePdu(const std::vector<std::uint8_t>& bytes,
-                                                  std::size_t offset,
-                                                  std::size_t length) {
-  if (length < 88) {
-    throw std::runtime_error(BuildError("实体状态PDU长度不足", offset));
-  }
-
+DisEntityPdu DisBinaryParser::ParseEntityStatePdu(ByteView bytes, std::size_t offset, std::size_t stream_offset) {
   const DisPduHeader header = ParseHeader(bytes, offset);
   DisEntityPdu out;
   out.timestamp_ms = static_cast<std::int64_t>(header.timestamp);
-  out.entity_id = ParseEntityId(bytes, offset + 12);
+  out.entity_id = ParseEntityId(bytes, offset + 12, stream_offset);
   out.side = ParseForceId(bytes[offset + 18]);
   out.type = ParseUnitType(bytes, offset + 20);
 
@@ -150,16 +141,12 @@ DisEntityPdu DisBinaryParser::ParseEntityStatePdu(const std::vector<std::uint8_t
   return out;
 }
 
-DisFirePdu DisBinaryParser::ParseFirePdu(const std::vector<std::uint8_t>& bytes, std::size_t offset, std::size_t length) {
-  if (length < 64) {
-    throw std::runtime_error(BuildError("开火PDU长度不足", offset));
-  }
-
+DisFirePdu DisBinaryParser::ParseFirePdu(ByteView bytes, std::size_t offset, std::size_t stream_offset) {
   const DisPduHeader header = ParseHeader(bytes, offset);
   DisFirePdu out;
   out.timestamp_ms = static_cast<std::int64_t>(header.timestamp);
-  out.shooter_id = ParseEntityId(bytes, offset + 12);
-  out.target_id = ParseEntityId(bytes, offset + 18);
+  out.shooter_id = ParseEntityId(bytes, offset + 12, stream_offset);
+  out.target_id = ParseEntityId(bytes, offset + 18, stream_offset);
 
   out.weapon_name = "弹药";
   out.origin.x = ReadF64BE(bytes, offset + 40);
@@ -168,24 +155,24 @@ DisFirePdu DisBinaryParser::ParseFirePdu(const std::vector<std::uint8_t>& bytes,
   return out;
 }
 
-std::uint16_t DisBinaryParser::ReadU16BE(const std::vector<std::uint8_t>& bytes, std::size_t offset) {
+std::uint16_t DisBinaryParser::ReadU16BE(ByteView bytes, std::size_t offset) {
   return static_cast<std::uint16_t>((static_cast<std::uint16_t>(bytes[offset]) << 8U) |
                                     static_cast<std::uint16_t>(bytes[offset + 1]));
 }
 
-std::uint32_t DisBinaryParser::ReadU32BE(const std::vector<std::uint8_t>& bytes, std::size_t offset) {
+std::uint32_t DisBinaryParser::ReadU32BE(ByteView bytes, std::size_t offset) {
   return (static_cast<std::uint32_t>(bytes[offset]) << 24U) | (static_cast<std::uint32_t>(bytes[offset + 1]) << 16U) |
          (static_cast<std::uint32_t>(bytes[offset + 2]) << 8U) | static_cast<std::uint32_t>(bytes[offset + 3]);
 }
 
-float DisBinaryParser::ReadF32BE(const std::vector<std::uint8_t>& bytes, std::size_t offset) {
+float DisBinaryParser::ReadF32BE(ByteView bytes, std::size_t offset) {
   const std::uint32_t raw = ReadU32BE(bytes, offset);
   float value = 0.0f;
   std::memcpy(&value, &raw, sizeof(value));
   return value;
 }
 
-double DisBinaryParser::ReadF64BE(const std::vector<std::uint8_t>& bytes, std::size_t offset) {
+double DisBinaryParser::ReadF64BE(ByteView bytes, std::size_t offset) {
   std::uint64_t raw = 0;
   for (int i = 0; i < 8; ++i) {
     raw = (raw << 8U) | static_cast<std::uint64_t>(bytes[offset + i]);
@@ -196,11 +183,15 @@ double DisBinaryParser::ReadF64BE(const std::vector<std::uint8_t>& bytes, std::s
   return value;
 }
 
-std::string DisBinaryParser::ParseEntityId(const std::vector<std::uint8_t>& bytes, std::size_t offset) {
+EntityId DisBinaryParser::ParseEntityId(ByteView bytes, std::size_t offset, std::size_t stream_offset) {
   const std::uint16_t site = ReadU16BE(bytes, offset + 0);
   const std::uint16_t app = ReadU16BE(bytes, offset + 2);
   const std::uint16_t entity = ReadU16BE(bytes, offset + 4);
-  return std::to_string(site) + "-" + std::to_string(app) + "-" + std::to_string(entity);
+  if (site == EntityId::kNamedSite) {
+    // ALL_SITES 不会出现在真实实体上，且与文本编号的驻留命名空间冲突。
+    throw std::runtime_error(BuildError("实体编号站点号非法（0xFFFF）", stream_offset));
+  }
+  return EntityId::FromDis(site, app, entity);
 }
 
 Side DisBinaryParser::ParseForceId(std::uint8_t force_id) {
@@ -216,7 +207,7 @@ Side DisBinaryParser::ParseForceId(std::uint8_t force_id) {
   }
 }
 
-UnitType DisBinaryParser::ParseUnitType(const std::vector<std::uint8_t>& bytes, std::size_t offset) {
+UnitType DisBinaryParser::ParseUnitType(ByteView bytes, std::size_t offset) {
   const std::uint8_t kind = bytes[offset + 0];
   const std::uint8_t domain = bytes[offset + 1];
   const std::uint8_t category = bytes[offset + 4];
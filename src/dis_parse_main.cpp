@@ -1,7 +1,9 @@
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <string>
 
+#include "bas/common/mapped_file.hpp"
 #include "bas/dis/dis_binary_parser.hpp"
 
 int main(int argc, char** argv) {
@@ -11,8 +13,12 @@ int main(int argc, char** argv) {
   }
 
   try {
+    const bas::MappedFile file(argv[1]);
     bas::DisBinaryParser parser;
-    const auto batches = parser.ParseFile(argv[1]);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const auto batches = parser.ParseBytes(file.view());
+    const auto t1 = std::chrono::steady_clock::now();
 
     std::size_t entity_count = 0;
     std::size_t fire_count = 0;
@@ -21,10 +27,16 @@ int main(int argc, char** argv) {
       fire_count += batch.fire_events.size();
     }
 
+    const double elapsed_s = std::chrono::duration<double>(t1 - t0).count();
+    const double size_mb = static_cast<double>(file.size()) / (1024.0 * 1024.0);
+
     std::cout << "输入文件: " << argv[1] << "\n";
+    std::cout << "文件大小(MB): " << size_mb << "\n";
     std::cout << "时间帧数: " << batches.size() << "\n";
     std::cout << "实体状态PDU数量: " << entity_count << "\n";
     std::cout << "开火PDU数量: " << fire_count << "\n";
+    std::cout << "解析耗时(毫秒): " << elapsed_s * 1000.0 << "\n";
+    std::cout << "解析吞吐(MB/s): " << (elapsed_s > 0.0 ? size_mb / elapsed_s : 0.0) << "\n";
   } catch (const std::exception& e) {
     std::cerr << "DIS解析失败: " << e.what() << "\n";
     return EXIT_FAILURE;
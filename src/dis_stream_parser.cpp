@@ -0,0 +1,248 @@
+#include "bas/dis/dis_stream_parser.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace bas {
+
+namespace {
+
+std::string BuildError(const std::string& msg, std::size_t offset) {
+  std::ostringstream oss;
+  oss << msg << "，字节偏移=" << offset;
+  return oss.str();
+}
+
+void WriteBatch(BinaryWriter& out, const DisPduBatch& batch) {
+  out.PutSize(batch.entity_updates.size());
+  for (const auto& pdu : batch.entity_updates) {
+    out.Put(pdu.timestamp_ms);
+    out.PutId(pdu.entity_id);
+    out.Put(static_cast<std::uint8_t>(pdu.side));
+    out.Put(static_cast<std::uint8_t>(pdu.type));
+    out.Put(pdu.pose);
+    out.Put(pdu.speed_mps);
+    out.Put(pdu.heading_deg);
+    out.PutBool(pdu.alive);
+    out.Put(pdu.threat_level);
+  }
+  out.PutSize(batch.fire_events.size());
+  for (const auto& pdu : batch.fire_events) {
+    out.Put(pdu.timestamp_ms);
+    out.PutId(pdu.shooter_id);
+    out.PutId(pdu.target_id);
+    out.PutString(pdu.weapon_name);
+    out.Put(pdu.origin);
+  }
+  out.PutBool(batch.env.has_value());
+  if (batch.env.has_value()) {
+    out.Put(*batch.env);
+  }
+}
+
+DisPduBatch ReadBatch(BinaryReader& in) {
+  DisPduBatch batch;
+  batch.entity_updates.resize(in.GetSize());
+  for (auto& pdu : batch.entity_updates) {
+    pdu.timestamp_ms = in.Get<std::int64_t>();
+    pdu.entity_id = in.GetId();
+    const auto side = in.Get<std::uint8_t>();
+    const auto type = in.Get<std::uint8_t>();
+    if (side > static_cast<std::uint8_t>(Side::Neutral) || type > static_cast<std::uint8_t>(UnitType::Unknown)) {
+      throw std::runtime_error("状态数据损坏: 枚举取值无效");
+    }
+    pdu.side = static_cast<Side>(side);
+    pdu.type = static_cast<UnitType>(type);
+    pdu.pose = in.Get<Pose>();
+    pdu.speed_mps = in.Get<double>();
+    pdu.heading_deg = in.Get<double>();
+    pdu.alive = in.GetBool();
+    pdu.threat_level = in.Get<double>();
+  }
+  batch.fire_events.resize(in.GetSize());
+  for (auto& pdu : batch.fire_events) {
+    pdu.timestamp_ms = in.Get<std::int64_t>();
+    pdu.shooter_id = in.GetId();
+    pdu.target_id = in.GetId();
+    pdu.weapon_name = in.GetString();
+    pdu.origin = in.Get<Pose>();
+  }
+  if (in.GetBool()) {
+    batch.env = in.Get<EnvironmentState>();
+  }
+  return batch;
+}
+
+}  // namespace
+
+DisStreamParser::DisStreamParser(DisStreamConfig config) : config_(config) {}
+
+void DisStreamParser::Feed(ByteView chunk, const BatchSink& sink) {
+  std::size_t pos = 0;
+
+  // 先补齐上一块遗留的残缺PDU，只有这部分字节需要拷贝。
+  if (!carry_.empty()) {
+    const std::size_t need_header = DisBinaryParser::kHeaderLength > carry_.size()
+                                        ? DisBinaryParser::kHeaderLength - carry_.size()
+                                        : 0;
+    const std::size_t take_header = std::min(need_header, chunk.size());
+    carry_.insert(carry_.end(), chunk.begin(), chunk.begin() + take_header);
+    pos += take_header;
+    if (carry_.size() < DisBinaryParser::kHeaderLength) {
+      return;
+    }
+
+    const DisPduHeader header = DisBinaryParser::ReadPduHeader(carry_, 0, consumed_bytes_);
+    const std::size_t take_body = std::min<std::size_t>(header.length - carry_.size(), chunk.size() - pos);
+    carry_.insert(carry_.end(), chunk.begin() + pos, chunk.begin() + pos + take_body);
+    pos += take_body;
+    if (carry_.size() < header.length) {
+      return;
+    }
+
+    ConsumePdu(carry_, 0, header);
+    carry_.clear();
+  }
+
+  while (pos < chunk.size()) {
+    if (chunk.size() - pos < DisBinaryParser::kHeaderLength) {
+      break;
+    }
+    const DisPduHeader header = DisBinaryParser::ReadPduHeader(chunk, pos, consumed_bytes_);
+    if (chunk.size() - pos < header.length) {
+      break;
+    }
+    ConsumePdu(chunk, pos, header);
+    pos += header.length;
+  }
+
+  carry_.assign(chunk.begin() + pos, chunk.end());
+  CloseReady(sink);
+}
+
+void DisStreamParser::Finish(const BatchSink& sink) {
+  if (!carry_.empty()) {
+    if (carry_.size() < DisBinaryParser::kHeaderLength) {
+      throw std::runtime_error(BuildError("DIS头部不完整", consumed_bytes_));
+    }
+    throw std::runtime_error(BuildError("PDU长度超出文件范围", consumed_bytes_));
+  }
+
+  for (auto& [timestamp, batch] : open_) {
+    Emit(std::move(batch), sink);
+    has_closed_ = true;
+    last_closed_timestamp_ = std::max(last_closed_timestamp_, timestamp);
+  }
+  open_.clear();
+  // 迟到PDU之后再无新批次：单独输出，不丢弃。
+  if (!late_.entity_updates.empty() || !late_.fire_events.empty()) {
+    Emit({}, sink);
+  }
+}
+
+void DisStreamParser::SaveState(BinaryWriter& out) const {
+  out.PutSize(open_.size());
+  for (const auto& [timestamp, batch] : open_) {
+    out.Put(timestamp);
+    WriteBatch(out, batch);
+  }
+  out.PutBytes(carry_);
+  out.PutSize(consumed_bytes_);
+  out.PutSize(late_pdus_);
+  out.Put(max_timestamp_);
+  out.PutBool(has_closed_);
+  out.Put(last_closed_timestamp_);
+  WriteBatch(out, late_);
+  out.PutSize(entity_timestamps_.size());
+  for (const auto& [id, timestamp] : entity_timestamps_) {
+    out.PutId(id);
+    out.Put(timestamp);
+  }
+}
+
+void DisStreamParser::RestoreState(BinaryReader& in) {
+  open_.clear();
+  const std::size_t open_count = in.GetSize();
+  for (std::size_t i = 0; i < open_count; ++i) {
+    const auto timestamp = in.Get<std::uint32_t>();
+    open_[timestamp] = ReadBatch(in);
+  }
+  carry_ = in.GetBytes();
+  consumed_bytes_ = static_cast<std::size_t>(in.Get<std::uint64_t>());
+  late_pdus_ = static_cast<std::size_t>(in.Get<std::uint64_t>());
+  max_timestamp_ = in.Get<std::uint32_t>();
+  has_closed_ = in.GetBool();
+  last_closed_timestamp_ = in.Get<std::uint32_t>();
+  late_ = ReadBatch(in);
+  entity_timestamps_.clear();
+  const std::size_t entity_count = in.GetSize();
+  for (std::size_t i = 0; i < entity_count; ++i) {
+    const EntityId id = in.GetId();
+    entity_timestamps_[id] = in.Get<std::uint32_t>();
+  }
+}
+
+void DisStreamParser::ConsumePdu(ByteView bytes, std::size_t offset, const DisPduHeader& header) {
+  if (has_closed_ && header.timestamp <= last_closed_timestamp_) {
+    // 迟到PDU：所属时间戳已输出，不单独输出旧时间戳批次，暂存后并入下一个输出的批次，保留原时间戳。
+    // 实体状态仅在该实体已有更新状态时丢弃，避免位置回退；此前未再出现的实体（如迟到的毁伤）照常生效。
+    ++late_pdus_;
+    DisPduBatch late;
+    parser_.AppendPdu(bytes, offset, header, consumed_bytes_, late);
+    for (auto& pdu : late.fire_events) {
+      late_.fire_events.push_back(std::move(pdu));
+    }
+    for (auto& pdu : late.entity_updates) {
+      auto [it, inserted] = entity_timestamps_.try_emplace(pdu.entity_id, header.timestamp);
+      if (!inserted && it->second > header.timestamp) {
+        continue;
+      }
+      it->second = header.timestamp;
+      late_.entity_updates.push_back(std::move(pdu));
+    }
+    consumed_bytes_ += header.length;
+    return;
+  }
+  DisPduBatch& batch = open_[header.timestamp];
+  const std::size_t entity_count = batch.entity_updates.size();
+  parser_.AppendPdu(bytes, offset, header, consumed_bytes_, batch);
+  if (batch.entity_updates.size() > entity_count) {
+    std::uint32_t& latest = entity_timestamps_[batch.entity_updates.back().entity_id];
+    latest = std::max(latest, header.timestamp);
+  }
+  max_timestamp_ = std::max(max_timestamp_, header.timestamp);
+  consumed_bytes_ += header.length;
+}
+
+void DisStreamParser::CloseReady(const BatchSink& sink) {
+  while (!open_.empty()) {
+    auto it = open_.begin();
+    const bool window_closed = max_timestamp_ - it->first > config_.reorder_window;
+    const bool over_limit = config_.max_open_batches > 0 && open_.size() > config_.max_open_batches;
+    if (!window_closed && !over_limit) {
+      break;
+    }
+    has_closed_ = true;
+    last_closed_timestamp_ = std::max(last_closed_timestamp_, it->first);
+    Emit(std::move(it->second), sink);
+    open_.erase(it);
+  }
+}
+
+void DisStreamParser::Emit(DisPduBatch&& batch, const BatchSink& sink) {
+  if (!late_.entity_updates.empty() || !late_.fire_events.empty()) {
+    // 迟到PDU时间戳更早，排在本批次之前，同一实体的更新状态随后覆盖。
+    late_.entity_updates.insert(late_.entity_updates.end(), std::make_move_iterator(batch.entity_updates.begin()),
+                                std::make_move_iterator(batch.entity_updates.end()));
+    late_.fire_events.insert(late_.fire_events.end(), std::make_move_iterator(batch.fire_events.begin()),
+                             std::make_move_iterator(batch.fire_events.end()));
+    batch.entity_updates = std::move(late_.entity_updates);
+    batch.fire_events = std::move(late_.fire_events);
+    late_ = {};
+  }
+  sink(std::move(batch));
+}
+
+}  // namespace bas
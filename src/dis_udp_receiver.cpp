@@ -0,0 +1,195 @@
+#include "bas/dis/dis_udp_receiver.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace bas {
+
+namespace {
+
+in_addr ParseIpv4(const std::string& text, const char* field) {
+  in_addr addr{};
+  if (::inet_pton(AF_INET, text.c_str(), &addr) != 1) {
+    throw std::runtime_error(std::string("非法的IPv4地址[") + field + "]: " + text);
+  }
+  return addr;
+}
+
+std::string ErrnoText(const std::string& msg) { return msg + "（" + std::strerror(errno) + "）"; }
+
+}  // namespace
+
+DisUdpReceiver::DisUdpReceiver(DisUdpConfig config) : config_(std::move(config)), queue_(config_.queue_capacity) {}
+
+DisUdpReceiver::~DisUdpReceiver() { Stop(); }
+
+void DisUdpReceiver::Start() {
+  if (running()) {
+    return;
+  }
+  OpenSocket();
+  running_.store(true, std::memory_order_release);
+  thread_ = std::thread([this]() { RunLoop(); });
+}
+
+void DisUdpReceiver::Stop() {
+  running_.store(false, std::memory_order_release);
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
+bool DisUdpReceiver::TryPop(DisPduBatch& batch) { return queue_.TryPop(batch); }
+
+std::size_t DisUdpReceiver::DrainInto(DisAdapter& adapter, std::size_t max_batches) {
+  std::size_t drained = 0;
+  DisPduBatch batch;
+  while (drained < max_batches && queue_.TryPop(batch)) {
+    adapter.Ingest(batch);
+    ++drained;
+  }
+  return drained;
+}
+
+DisUdpStats DisUdpReceiver::stats() const {
+  DisUdpStats out;
+  out.datagrams = datagrams_.load(std::memory_order_relaxed);
+  out.bytes = bytes_.load(std::memory_order_relaxed);
+  out.pdus = pdus_.load(std::memory_order_relaxed);
+  out.parse_errors = parse_errors_.load(std::memory_order_relaxed);
+  out.dropped_batches = dropped_batches_.load(std::memory_order_relaxed);
+  out.dropped_pdus = dropped_pdus_.load(std::memory_order_relaxed);
+  out.backlog = queue_.SizeApprox();
+  return out;
+}
+
+void DisUdpReceiver::OpenSocket() {
+  fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+  if (fd_ < 0) {
+    throw std::runtime_error(ErrnoText("创建UDP套接字失败"));
+  }
+
+  const auto fail = [this](const std::string& msg) {
+    const std::string text = ErrnoText(msg);
+    ::close(fd_);
+    fd_ = -1;
+    throw std::runtime_error(text);
+  };
+
+  const int reuse = 1;
+  ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+  ::setsockopt(fd_, SOL_SOCKET, SO_BROADCAST, &reuse, sizeof(reuse));
+  if (config_.socket_buffer_bytes > 0) {
+    ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &config_.socket_buffer_bytes, sizeof(config_.socket_buffer_bytes));
+  }
+
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(config_.port);
+  addr.sin_addr = ParseIpv4(config_.bind_address, "bind_address");
+  if (::bind(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+    fail("绑定UDP端口失败: " + config_.bind_address + ":" + std::to_string(config_.port));
+  }
+
+  if (!config_.multicast_group.empty()) {
+    ip_mreq mreq{};
+    mreq.imr_multiaddr = ParseIpv4(config_.multicast_group, "multicast_group");
+    mreq.imr_interface = ParseIpv4(config_.multicast_interface, "multicast_interface");
+    if (::setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) != 0) {
+      fail("加入组播组失败: " + config_.multicast_group);
+    }
+  }
+
+  sockaddr_in bound{};
+  socklen_t bound_len = sizeof(bound);
+  if (::getsockname(fd_, reinterpret_cast<sockaddr*>(&bound), &bound_len) == 0) {
+    bound_port_ = ntohs(bound.sin_port);
+  }
+}
+
+void DisUdpReceiver::RunLoop() {
+  const std::size_t batch = std::max<std::size_t>(1, config_.recv_batch);
+  std::vector<std::uint8_t> buffers(batch * config_.max_datagram_bytes);
+  std::vector<iovec> iovecs(batch);
+  std::vector<mmsghdr> messages(batch);
+  for (std::size_t i = 0; i < batch; ++i) {
+    iovecs[i].iov_base = buffers.data() + i * config_.max_datagram_bytes;
+    iovecs[i].iov_len = config_.max_datagram_bytes;
+    std::memset(&messages[i], 0, sizeof(mmsghdr));
+    messages[i].msg_hdr.msg_iov = &iovecs[i];
+    messages[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  pollfd pfd{fd_, POLLIN, 0};
+  while (running_.load(std::memory_order_acquire)) {
+    const int ready = ::poll(&pfd, 1, config_.poll_interval_ms);
+    if (ready <= 0) {
+      continue;
+    }
+
+    const int received = ::recvmmsg(fd_, messages.data(), static_cast<unsigned int>(batch), MSG_DONTWAIT, nullptr);
+    if (received <= 0) {
+      continue;
+    }
+
+    // 一次 recvmmsg 读到的全部数据报合并为一个批次入队，减少队列操作与适配器调用次数。
+    DisPduBatch out;
+    std::uint64_t burst_bytes = 0;
+    for (int i = 0; i < received; ++i) {
+      const std::size_t length = messages[static_cast<std::size_t>(i)].msg_len;
+      const ByteView datagram(buffers.data() + static_cast<std::size_t>(i) * config_.max_datagram_bytes, length);
+      burst_bytes += length;
+
+      const std::size_t entity_mark = out.entity_updates.size();
+      const std::size_t fire_mark = out.fire_events.size();
+      try {
+        std::size_t offset = 0;
+        while (offset < datagram.size()) {
+          if (datagram.size() - offset < DisBinaryParser::kHeaderLength) {
+            throw std::runtime_error("数据报内DIS头部不完整");
+          }
+          const DisPduHeader header = DisBinaryParser::ReadPduHeader(datagram, offset, offset);
+          if (offset + header.length > datagram.size()) {
+            throw std::runtime_error("数据报内PDU长度越界");
+          }
+          parser_.AppendPdu(datagram, offset, header, offset, out);
+          offset += header.length;
+        }
+      } catch (const std::exception&) {
+        // 畸形数据报整包丢弃，不影响同批其余数据报。
+        out.entity_updates.resize(entity_mark);
+        out.fire_events.resize(fire_mark);
+        parse_errors_.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    datagrams_.fetch_add(static_cast<std::uint64_t>(received), std::memory_order_relaxed);
+    bytes_.fetch_add(burst_bytes, std::memory_order_relaxed);
+
+    const std::uint64_t pdu_count = out.entity_updates.size() + out.fire_events.size();
+    if (pdu_count == 0) {
+      continue;
+    }
+    pdus_.fetch_add(pdu_count, std::memory_order_relaxed);
+    if (!queue_.TryPush(std::move(out))) {
+      dropped_batches_.fetch_add(1, std::memory_order_relaxed);
+      dropped_pdus_.fetch_add(pdu_count, std::memory_order_relaxed);
+    }
+  }
+}
+
+}  // namespace bas
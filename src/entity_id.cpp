@@ -0,0 +1,84 @@
+#include "bas/common/entity_id.hpp"
+
+#include <ostream>
+
+#include "bas/common/name_table.hpp"
+
+namespace bas {
+
+namespace {
+
+NameTable& EntityNames() {
+  static NameTable table;
+  return table;
+}
+
+bool ParseU16(std::string_view text, std::uint16_t& out) {
+  if (text.empty() || text.size() > 5) {
+    return false;
+  }
+  std::uint32_t value = 0;
+  for (char c : text) {
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    value = value * 10U + static_cast<std::uint32_t>(c - '0');
+  }
+  if (value > 0xFFFFU) {
+    return false;
+  }
+  out = static_cast<std::uint16_t>(value);
+  return true;
+}
+
+bool ParseDisTriple(std::string_view text, EntityId& out) {
+  const auto first = text.find('-');
+  if (first == std::string_view::npos) {
+    return false;
+  }
+  const auto second = text.find('-', first + 1);
+  if (second == std::string_view::npos) {
+    return false;
+  }
+  std::uint16_t site = 0;
+  std::uint16_t app = 0;
+  std::uint16_t entity = 0;
+  if (!ParseU16(text.substr(0, first), site) || !ParseU16(text.substr(first + 1, second - first - 1), app) ||
+      !ParseU16(text.substr(second + 1), entity) || site == EntityId::kNamedSite) {
+    return false;
+  }
+  out = EntityId::FromDis(site, app, entity);
+  return true;
+}
+
+}  // namespace
+
+EntityId::EntityId(const char* name) : EntityId(Intern(name == nullptr ? std::string_view() : std::string_view(name))) {}
+
+EntityId::EntityId(const std::string& name) : EntityId(Intern(name)) {}
+
+EntityId EntityId::Intern(std::string_view name) {
+  if (name.empty()) {
+    return EntityId();
+  }
+  EntityId dis_id;
+  if (ParseDisTriple(name, dis_id)) {
+    return dis_id;
+  }
+  const std::uint32_t slot = EntityNames().Intern(name);
+  return FromRaw((static_cast<std::uint64_t>(kNamedSite) << 32U) | slot);
+}
+
+std::string EntityId::ToString() const {
+  if (!valid()) {
+    return {};
+  }
+  if (is_named()) {
+    return EntityNames().Name(static_cast<std::uint32_t>(value_ & 0xFFFFFFFFULL));
+  }
+  return std::to_string(site()) + "-" + std::to_string(application()) + "-" + std::to_string(entity());
+}
+
+std::ostream& operator<<(std::ostream& os, EntityId id) { return os << id.ToString(); }
+
+}  // namespace bas
@@ -1,14 +1,72 @@
 #include "bas/memory/event_memory.hpp"
 
-#include <sstream>
+#include <algorithm>
+#include <stdexcept>
+
+#include "bas/common/name_table.hpp"
 
 namespace bas {
 
-EventMemory::EventMemory(std::int64_t retention_ms) : retention_ms_(retention_ms) {}
+EventMemory::Range::Iterator::Iterator(const EventMemory* memory,
+                                       std::uint64_t seq,
+                                       Chain chain,
+                                       std::int64_t now_ms,
+                                       std::int64_t window_ms)
+    : memory_(memory), seq_(seq), chain_(chain), now_ms_(now_ms), window_ms_(window_ms) {
+  if (!memory_->Live(seq_) || now_ms_ - memory_->SlotOf(seq_).timestamp_ms > window_ms_) {
+    seq_ = 0;
+  }
+}
+
+EventMemory::Range::Iterator& EventMemory::Range::Iterator::operator++() {
+  const Slot& slot = memory_->SlotOf(seq_);
+  switch (chain_) {
+    case Chain::All:
+      seq_ = seq_ - 1;
+      break;
+    case Chain::Type:
+      seq_ = slot.prev_same_type;
+      break;
+    case Chain::Actor:
+      seq_ = slot.prev_same_actor;
+      break;
+  }
+  if (!memory_->Live(seq_) || now_ms_ - memory_->SlotOf(seq_).timestamp_ms > window_ms_) {
+    seq_ = 0;
+  }
+  return *this;
+}
+
+std::size_t EventMemory::Range::size() const {
+  return static_cast<std::size_t>(std::distance(begin(), end()));
+}
+
+EventMemory::EventMemory(std::int64_t retention_ms, std::size_t capacity, std::size_t context_budget_bytes)
+    : retention_ms_(retention_ms), ring_(std::max<std::size_t>(1, capacity)), context_budget_bytes_(context_budget_bytes) {}
 
 void EventMemory::AddEvent(const EventRecord& event) {
-  events_.push_back(event);
-  Trim(event.timestamp_ms);
+  if (size() == ring_.size()) {
+    EvictOldest();
+  }
+  const std::uint64_t seq = next_seq_++;
+  Slot& slot = ring_[seq % ring_.size()];
+  slot.timestamp_ms = event.timestamp_ms;
+  slot.type = event.type;
+  slot.actor_id = event.actor_id;
+  slot.pose = event.pose;
+  slot.message = InternMessage(event.message);
+  slot.fire = event.fire;
+
+  std::uint64_t& type_head = type_head_[static_cast<std::size_t>(event.type)];
+  slot.prev_same_type = type_head;
+  type_head = seq;
+  std::uint64_t& actor_head = actor_head_[event.actor_id];
+  slot.prev_same_actor = actor_head;
+  actor_head = seq;
+
+  while (size() > 1 && event.timestamp_ms - SlotOf(first_seq_).timestamp_ms > retention_ms_) {
+    EvictOldest();
+  }
 }
 
 void EventMemory::AddEvents(const std::vector<EventRecord>& events) {
@@ -17,45 +75,323 @@ void EventMemory::AddEvents(const std::vector<EventRecord>& events) {
   }
 }
 
-std::vector<EventRecord> EventMemory::QueryRecent(std::int64_t now_ms, std::int64_t window_ms) const {
-  std::vector<EventRecord> out;
-  for (auto it = events_.rbegin(); it != events_.rend(); ++it) {
-    if (now_ms - it->timestamp_ms > window_ms) {
-      break;
+void EventMemory::SaveState(BinaryWriter& out) const {
+  out.PutSize(size());
+  for (std::uint64_t seq = first_seq_; seq < next_seq_; ++seq) {
+    const EventView view = View(seq);
+    out.Put(view.timestamp_ms);
+    out.Put(static_cast<std::uint8_t>(view.type));
+    out.PutId(view.actor_id);
+    out.Put(view.pose);
+    out.PutString(view.message);
+    out.PutId(view.fire.target_id);
+    out.Put(view.fire.weapon);
+    out.Put(view.fire.munition);
+    // 驻留编号只在本进程内有效，检查点存原名。
+    out.PutString(WeaponNameOf(view.fire.weapon_name));
+  }
+}
+
+void EventMemory::RestoreState(BinaryReader& in) {
+  *this = EventMemory(retention_ms_, ring_.size(), context_budget_bytes_);
+  const std::size_t count = in.GetSize();
+  for (std::size_t i = 0; i < count; ++i) {
+    EventRecord event;
+    event.timestamp_ms = in.Get<std::int64_t>();
+    const auto type = in.Get<std::uint8_t>();
+    if (type >= kEventTypeCount) {
+      throw std::runtime_error("状态数据损坏: 事件类型无效");
     }
-    out.push_back(*it);
+    event.type = static_cast<EventType>(type);
+    event.actor_id = in.GetId();
+    event.pose = in.Get<Pose>();
+    event.message = in.GetString();
+    event.fire.target_id = in.GetId();
+    event.fire.weapon = in.Get<WeaponKind>();
+    event.fire.munition = in.Get<MunitionClass>();
+    event.fire.weapon_name = InternWeaponName(in.GetString());
+    if (event.fire.weapon > WeaponKind::Generic || event.fire.munition > MunitionClass::AirDefense) {
+      throw std::runtime_error("状态数据损坏: 开火载荷无效");
+    }
+    AddEvent(event);
   }
-  return out;
 }
 
-std::optional<EventRecord> EventMemory::LastEventByType(EventType type,
-                                                         std::int64_t now_ms,
-                                                         std::int64_t window_ms) const {
-  for (auto it = events_.rbegin(); it != events_.rend(); ++it) {
-    if (now_ms - it->timestamp_ms > window_ms) {
-      break;
+EventMemory::Range EventMemory::QueryRecent(std::int64_t now_ms, std::int64_t window_ms) const {
+  return Range(this, next_seq_ - 1, Chain::All, now_ms, window_ms);
+}
+
+EventMemory::Range EventMemory::QueryByType(EventType type, std::int64_t now_ms, std::int64_t window_ms) const {
+  return Range(this, type_head_[static_cast<std::size_t>(type)], Chain::Type, now_ms, window_ms);
+}
+
+EventMemory::Range EventMemory::QueryByActor(EntityId actor_id, std::int64_t now_ms, std::int64_t window_ms) const {
+  const auto it = actor_head_.find(actor_id);
+  return Range(this, it == actor_head_.end() ? 0 : it->second, Chain::Actor, now_ms, window_ms);
+}
+
+std::optional<EventView> EventMemory::LastEventByType(EventType type,
+                                                      std::int64_t now_ms,
+                                                      std::int64_t window_ms) const {
+  const Range range = QueryByType(type, now_ms, window_ms);
+  if (range.empty()) {
+    return std::nullopt;
+  }
+  return range.front();
+}
+
+std::string EventMemory::BuildContext(std::int64_t now_ms, std::int64_t window_ms) {
+  ContextCache& c = context_;
+  if (window_ms != c.window_ms || now_ms < c.now_ms) {
+    c = ContextCache{};
+    c.window_ms = window_ms;
+  }
+  c.now_ms = now_ms;
+
+  // 窗口起点只前移：被环形覆盖或已过期的头部事件连同其明细行一并剔除。
+  std::uint64_t lo = std::max(c.lo, first_seq_);
+  while (lo < next_seq_ && now_ms - SlotOf(lo).timestamp_ms > window_ms) {
+    ++lo;
+  }
+  c.lo = lo;
+  c.next = std::max(c.next, lo);
+  DropTailBefore(lo);
+
+  for (; c.next < next_seq_; ++c.next) {
+    const std::size_t before = c.tail.size();
+    RenderLine(SlotOf(c.next), c.tail);
+    c.tail_lengths.push_back(static_cast<std::uint32_t>(c.tail.size() - before));
+  }
+
+  if (context_budget_bytes_ > 0) {
+    const std::size_t detail_budget = context_budget_bytes_ - context_budget_bytes_ / 4;
+    std::size_t excess = c.tail.size() > detail_budget ? c.tail.size() - detail_budget : 0;
+    std::uint64_t cut = c.tail_start;
+    for (std::size_t i = 0; excess > 0 && i < c.tail_lengths.size(); ++i) {
+      excess -= std::min<std::size_t>(excess, c.tail_lengths[i]);
+      ++cut;
+    }
+    DropTailBefore(cut);
+  }
+
+  UpdateSummary();
+  return c.summary + c.tail;
+}
+
+void EventMemory::RenderContent(const Slot& slot, std::string& out) const {
+  if (slot.type == EventType::WeaponFire && messages_[slot.message].empty()) {
+    out += "武器=";
+    if (slot.fire.weapon_name != 0) {
+      out += WeaponNameOf(slot.fire.weapon_name);
+    } else {
+      out += WeaponKindToString(slot.fire.weapon);
     }
-    if (it->type == type) {
-      return *it;
+    out += "，目标=";
+    out += slot.fire.target_id.ToString();
+  } else {
+    out += messages_[slot.message];
+  }
+}
+
+void EventMemory::RenderLine(const Slot& slot, std::string& out) const {
+  out += "[时间=";
+  out += std::to_string(slot.timestamp_ms);
+  out += "][";
+  out += EventTypeToString(slot.type);
+  out += "] 参与方=";
+  out += slot.actor_id.ToString();
+  out += " 内容=";
+  RenderContent(slot, out);
+  out += "\n";
+}
+
+void EventMemory::DropTailBefore(std::uint64_t seq) {
+  ContextCache& c = context_;
+  std::size_t bytes = 0;
+  while (c.tail_start < seq && !c.tail_lengths.empty()) {
+    bytes += c.tail_lengths.front();
+    c.tail_lengths.pop_front();
+    ++c.tail_start;
+  }
+  c.tail.erase(0, bytes);
+  // 明细为空时起点直接对齐到 seq（此时尚未渲染到 seq 之后）。
+  c.tail_start = std::max(c.tail_start, std::min(seq, c.next));
+}
+
+void EventMemory::UpdateSummary() {
+  ContextCache& c = context_;
+  // 汇总区两端只前移：头部事件过期离开，明细裁剪下来的事件从尾部进入。
+  for (const std::uint64_t leave_end = std::min(c.lo, c.summary_hi); c.summary_lo < leave_end; ++c.summary_lo) {
+    LeaveSummary(c.summary_lo);
+  }
+  c.summary_lo = c.lo;
+  c.summary_hi = std::max(c.summary_hi, c.lo);
+  for (; c.summary_hi < c.tail_start; ++c.summary_hi) {
+    EnterSummary(c.summary_hi);
+  }
+  if (c.summary_changed) {
+    RenderSummary();
+    c.summary_changed = false;
+  }
+}
+
+void EventMemory::EnterSummary(std::uint64_t seq) {
+  ContextCache& c = context_;
+  const Slot& slot = SlotOf(seq);
+  const std::uint64_t key = slot.actor_id.raw() * kEventTypeCount + static_cast<std::uint64_t>(slot.type);
+  auto it = c.group_of.find(key);
+  if (it == c.group_of.end()) {
+    std::uint32_t id = 0;
+    if (!c.free_groups.empty()) {
+      id = c.free_groups.back();
+      c.free_groups.pop_back();
+    } else {
+      id = static_cast<std::uint32_t>(c.groups.size());
+      c.groups.emplace_back();
+    }
+    SummaryGroup& fresh = c.groups[id];
+    fresh.key = key;
+    fresh.type = slot.type;
+    fresh.actor_id = slot.actor_id;
+    it = c.group_of.emplace(key, id).first;
+  }
+  const std::uint32_t id = it->second;
+  SummaryGroup& group = c.groups[id];
+  ++group.count;
+  group.last_seq = seq;
+  while (!group.min_ts.empty() && group.min_ts.back().second >= slot.timestamp_ms) {
+    group.min_ts.pop_back();
+  }
+  group.min_ts.emplace_back(seq, slot.timestamp_ms);
+  while (!group.max_ts.empty() && group.max_ts.back().second <= slot.timestamp_ms) {
+    group.max_ts.pop_back();
+  }
+  group.max_ts.emplace_back(seq, slot.timestamp_ms);
+  group.dirty = true;
+  c.summary_members.push_back(id);
+
+  // 新成员序号最大，分组移到链尾。
+  if (c.newest_group != id) {
+    if (group.count > 1) {
+      (group.prev == kNoGroup ? c.oldest_group : c.groups[group.prev].next) = group.next;
+      c.groups[group.next].prev = group.prev;
     }
+    group.prev = c.newest_group;
+    group.next = kNoGroup;
+    (c.newest_group == kNoGroup ? c.oldest_group : c.groups[c.newest_group].next) = id;
+    c.newest_group = id;
   }
-  return std::nullopt;
+  c.summary_changed = true;
 }
 
-std::string EventMemory::BuildContext(std::int64_t now_ms, std::int64_t window_ms) const {
-  std::ostringstream oss;
-  const auto recent = QueryRecent(now_ms, window_ms);
-  for (const auto& ev : recent) {
-    oss << "[时间=" << ev.timestamp_ms << "]"
-        << "[" << EventTypeToString(ev.type) << "] 参与方=" << ev.actor_id << " 内容=" << ev.message << "\n";
+void EventMemory::LeaveSummary(std::uint64_t seq) {
+  ContextCache& c = context_;
+  const std::uint32_t id = c.summary_members.front();
+  c.summary_members.pop_front();
+  SummaryGroup& group = c.groups[id];
+  if (group.min_ts.front().first == seq) {
+    group.min_ts.pop_front();
+  }
+  if (group.max_ts.front().first == seq) {
+    group.max_ts.pop_front();
+  }
+  group.dirty = true;
+  c.summary_changed = true;
+  if (--group.count > 0) {
+    return;
+  }
+  // 最早成员即最后一个成员时分组清空，摘链并回收编号。
+  (group.prev == kNoGroup ? c.oldest_group : c.groups[group.prev].next) = group.next;
+  (group.next == kNoGroup ? c.newest_group : c.groups[group.next].prev) = group.prev;
+  c.group_of.erase(group.key);
+  group = SummaryGroup{};
+  c.free_groups.push_back(id);
+}
+
+void EventMemory::RenderSummary() {
+  ContextCache& c = context_;
+  // 汇总区同样受预算约束：从最近活跃的分组往前保留，其余计数后以一行说明；超出预算的分组不渲染。
+  const std::size_t summary_budget = context_budget_bytes_ / 4;
+  std::size_t used = 0;
+  std::size_t kept_events = 0;
+  std::vector<std::uint32_t> kept;
+  std::uint32_t id = c.newest_group;
+  for (; id != kNoGroup; id = c.groups[id].prev) {
+    SummaryGroup& group = c.groups[id];
+    if (group.dirty) {
+      group.line = "[汇总][时间=" + std::to_string(group.min_ts.front().second) + "~" +
+                   std::to_string(group.max_ts.front().second) + "][" + EventTypeToString(group.type) +
+                   "] 参与方=" + group.actor_id.ToString() + " 次数=" + std::to_string(group.count) + " 最近内容=";
+      RenderContent(SlotOf(group.last_seq), group.line);
+      group.line += "\n";
+      group.dirty = false;
+    }
+    if (used + group.line.size() + 64 > summary_budget) {
+      break;
+    }
+    used += group.line.size();
+    kept_events += group.count;
+    kept.push_back(id);
+  }
+  c.summary.clear();
+  if (id != kNoGroup) {
+    const std::uint64_t omitted = c.summary_hi - c.summary_lo - kept_events;
+    c.summary = "[汇总] 更早的 " + std::to_string(omitted) + " 条事件已省略\n";
+  }
+  for (auto it = kept.rbegin(); it != kept.rend(); ++it) {
+    c.summary += c.groups[*it].line;
+  }
+}
+
+EventView EventMemory::View(std::uint64_t seq) const {
+  const Slot& slot = SlotOf(seq);
+  return {slot.timestamp_ms, slot.type, slot.actor_id, slot.pose, messages_[slot.message], slot.fire};
+}
+
+void EventMemory::EvictOldest() {
+  const std::uint64_t seq = first_seq_++;
+  const Slot& slot = SlotOf(seq);
+  ReleaseMessage(slot.message);
+  std::uint64_t& type_head = type_head_[static_cast<std::size_t>(slot.type)];
+  if (type_head == seq) {
+    type_head = 0;
+  }
+  // 链上更早的节点只会比它更旧，参与方的链头就是它本身时整条链已失效。
+  const auto it = actor_head_.find(slot.actor_id);
+  if (it != actor_head_.end() && it->second == seq) {
+    actor_head_.erase(it);
+  }
+}
+
+std::uint32_t EventMemory::InternMessage(const std::string& message) {
+  const auto it = message_ids_.find(message);
+  if (it != message_ids_.end()) {
+    ++message_refs_[it->second];
+    return it->second;
+  }
+  std::uint32_t id = 0;
+  if (!free_messages_.empty()) {
+    id = free_messages_.back();
+    free_messages_.pop_back();
+    messages_[id] = message;
+    message_refs_[id] = 1;
+  } else {
+    id = static_cast<std::uint32_t>(messages_.size());
+    messages_.push_back(message);
+    message_refs_.push_back(1);
   }
-  return oss.str();
+  message_ids_.emplace(messages_[id], id);
+  return id;
 }
 
-void EventMemory::Trim(std::int64_t now_ms) {
-  while (!events_.empty() && now_ms - events_.front().timestamp_ms > retention_ms_) {
-    events_.pop_front();
+void EventMemory::ReleaseMessage(std::uint32_t id) {
+  if (--message_refs_[id] != 0) {
+    return;
   }
+  message_ids_.erase(messages_[id]);
+  messages_[id].clear();
+  messages_[id].shrink_to_fit();
+  free_messages_.push_back(id);
 }
 
 }  // namespace bas
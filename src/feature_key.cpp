@@ -0,0 +1,91 @@
+#include "bas/cache/feature_key.hpp"
+
+#include <cmath>
+
+namespace bas {
+
+namespace {
+
+// splitmix64 终混：相邻网格、相邻编号的输入也能得到独立分布的输出，求和时不易相互抵消。
+std::uint64_t Mix(std::uint64_t x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+std::uint64_t Quantize(double value, double step) {
+  return static_cast<std::uint64_t>(static_cast<std::int64_t>(std::floor(value / step)));
+}
+
+}  // namespace
+
+FeatureKeyBuilder::FeatureKeyBuilder(double cell_m, double visibility_bucket_m)
+    : cell_m_(cell_m), visibility_bucket_m_(visibility_bucket_m) {}
+
+std::uint64_t FeatureKeyBuilder::Compute(const BattlefieldSnapshot& snapshot) const {
+  std::uint64_t sum = 0;
+  for (const auto& unit : snapshot.friendly_units) {
+    sum += Contribution(unit, Side::Friendly);
+  }
+  for (const auto& unit : snapshot.hostile_units) {
+    sum += Contribution(unit, Side::Hostile);
+  }
+  return Finalize(sum, snapshot);
+}
+
+std::uint64_t FeatureKeyBuilder::Rebuild(const BattlefieldSnapshot& snapshot) {
+  ++rebuilds_;
+  tracked_.clear();
+  unit_sum_ = 0;
+  for (const Side side : {Side::Friendly, Side::Hostile}) {
+    const auto& units = side == Side::Friendly ? snapshot.friendly_units : snapshot.hostile_units;
+    for (std::size_t i = 0; i < units.size(); ++i) {
+      const std::uint64_t contribution = Contribution(units[i], side);
+      tracked_[units[i].id] = Tracked{side, static_cast<std::uint32_t>(i), contribution};
+      unit_sum_ += contribution;
+    }
+  }
+  friendly_count_ = snapshot.friendly_units.size();
+  hostile_count_ = snapshot.hostile_units.size();
+  return Finalize(unit_sum_, snapshot);
+}
+
+std::uint64_t FeatureKeyBuilder::Update(const BattlefieldSnapshot& snapshot, const std::vector<EntityId>& dirty) {
+  if (snapshot.friendly_units.size() != friendly_count_ || snapshot.hostile_units.size() != hostile_count_) {
+    return Rebuild(snapshot);
+  }
+  std::uint64_t sum = unit_sum_;
+  for (const EntityId id : dirty) {
+    const auto it = tracked_.find(id);
+    if (it == tracked_.end()) {
+      // 双方数量未变时，未登记的实体只可能是中立方（不进快照）；真正新增必然改变数量或挤占某个已登记实体的下标。
+      continue;
+    }
+    Tracked& tracked = it->second;
+    const auto& units = tracked.side == Side::Friendly ? snapshot.friendly_units : snapshot.hostile_units;
+    if (tracked.index >= units.size() || units[tracked.index].id != id || units[tracked.index].side != tracked.side) {
+      return Rebuild(snapshot);
+    }
+    const std::uint64_t contribution = Contribution(units[tracked.index], tracked.side);
+    sum += contribution - tracked.contribution;
+    tracked.contribution = contribution;
+  }
+  unit_sum_ = sum;
+  return Finalize(unit_sum_, snapshot);
+}
+
+std::uint64_t FeatureKeyBuilder::Contribution(const EntityState& unit, Side side) const {
+  const std::uint64_t identity = Mix(unit.id.raw() * 4 + static_cast<std::uint64_t>(side));
+  const std::uint64_t cell = (Quantize(unit.pose.x, cell_m_) << 32) ^ (Quantize(unit.pose.y, cell_m_) & 0xffffffffULL);
+  return Mix(identity ^ Mix(cell));
+}
+
+std::uint64_t FeatureKeyBuilder::Finalize(std::uint64_t unit_sum, const BattlefieldSnapshot& snapshot) const {
+  std::uint64_t key = Mix(unit_sum);
+  key = Mix(key ^ static_cast<std::uint64_t>(snapshot.friendly_units.size()));
+  key = Mix(key ^ (static_cast<std::uint64_t>(snapshot.hostile_units.size()) << 32));
+  return Mix(key ^ Quantize(snapshot.env.visibility_m, visibility_bucket_m_));
+}
+
+}  // namespace bas
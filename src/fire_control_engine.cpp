@@ -2,8 +2,11 @@
 
 #include <algorithm>
 #include <limits>
+#include <optional>
 #include <unordered_set>
 
+#include "bas/decision/assignment_solver.hpp"
+
 namespace bas {
 
 namespace {
@@ -12,12 +15,17 @@ double PreferredTargetBonus(const WeaponState& weapon, UnitType target_type) {
   return IsPreferredTarget(weapon, target_type) ? 1.15 : 0.85;
 }
 
-double MinDistanceToFriendlies(const EntityState& target, const std::vector<EntityState>& friendlies) {
-  double min_distance = std::numeric_limits<double>::infinity();
-  for (const auto& friendly : friendlies) {
-    min_distance = std::min(min_distance, Distance(friendly.pose, target.pose));
+double MinDistanceToFriendlies(const EntityState& target, const SpatialGrid& friendly_grid) {
+  SpatialNeighbor nearest;
+  return friendly_grid.Nearest(target.pose, nearest) ? std::sqrt(nearest.distance_sq) : 99999.0;
+}
+
+double MaxWeaponRange(const EntityState& shooter) {
+  double range = 0.0;
+  for (const auto& weapon : shooter.weapons) {
+    range = std::max(range, weapon.range_m);
   }
-  return std::isfinite(min_distance) ? min_distance : 99999.0;
+  return range;
 }
 
 }  // namespace
@@ -26,21 +34,27 @@ FireControlEngine::FireControlEngine(FireControlConfig config) : config_(config)
 
 FireDecision FireControlEngine::Decide(const BattlefieldSnapshot& snapshot,
                                        const SituationSemantics&,
-                                       const EventMemory& memory) const {
+                                       const EventMemory& memory,
+                                       const SnapshotIndex* index) const {
   FireDecision out;
   if (snapshot.friendly_units.empty() || snapshot.hostile_units.empty()) {
     out.summary = "火力分配数=0";
     return out;
   }
 
-  std::unordered_map<std::string, double> threat_by_target;
-  for (const auto& target : snapshot.hostile_units) {
+  std::optional<SnapshotIndex> local_index;
+  const SnapshotIndex& geo = index != nullptr ? *index : local_index.emplace(snapshot);
+
+  // 威胁指数按敌方下标存放，与列存表/空间索引行号一致，避免逐目标哈希。
+  std::vector<double> threat_by_target(snapshot.hostile_units.size(), 0.0);
+  for (std::size_t t = 0; t < snapshot.hostile_units.size(); ++t) {
+    const EntityState& target = snapshot.hostile_units[t];
     if (!target.alive) {
       continue;
     }
-    const double min_distance = MinDistanceToFriendlies(target, snapshot.friendly_units);
+    const double min_distance = MinDistanceToFriendlies(target, geo.friendly_grid());
     const double threat_index = ThreatIndex(target, min_distance);
-    threat_by_target[target.id] = threat_index;
+    threat_by_target[t] = threat_index;
     out.threats.push_back({target.id, threat_index,
                            std::string("类型=") + UnitTypeToString(target.type) + "，距离=" +
                                std::to_string(static_cast<int>(min_distance)) + "米"});
@@ -50,7 +64,38 @@ FireDecision FireControlEngine::Decide(const BattlefieldSnapshot& snapshot,
     return a.index > b.index;
   });
 
-  std::unordered_map<std::string, std::size_t> assigned_shooters_per_target;
+  std::string solver_note;
+  if (config_.solver == AssignmentSolver::Auction) {
+    solver_note = AssignAuction(snapshot, geo, threat_by_target, out) ? "，分配求解=拍卖" : "，分配求解=拍卖(超时贪心补齐)";
+  } else {
+    AssignGreedy(snapshot, geo, threat_by_target, out);
+  }
+
+  if (config_.enable_stagger_fire) {
+    std::sort(out.assignments.begin(), out.assignments.end(), [](const TargetAssignment& a, const TargetAssignment& b) {
+      return a.score > b.score;
+    });
+    for (std::size_t i = 0; i < out.assignments.size(); ++i) {
+      out.assignments[i].scheduled_offset_s = static_cast<double>(i) * 1.25;
+      if (out.assignments[i].tactic == "single_shot") {
+        out.assignments[i].tactic = "stagger_fire";
+      }
+    }
+  }
+
+  const auto recent_fire = memory.LastEventByType(EventType::WeaponFire, snapshot.timestamp_ms, 5 * 60 * 1000);
+  out.summary = "火力分配数=" + std::to_string(out.assignments.size()) +
+                "，最高威胁目标=" + (out.threats.empty() ? std::string("无") : out.threats.front().target_id.ToString()) +
+                "，近期火力记忆=" + (recent_fire.has_value() ? std::string("有") : std::string("无")) + solver_note;
+  return out;
+}
+
+void FireControlEngine::AssignGreedy(const BattlefieldSnapshot& snapshot,
+                                     const SnapshotIndex& geo,
+                                     const std::vector<double>& threat_by_target,
+                                     FireDecision& out) const {
+  std::unordered_map<EntityId, std::size_t> assigned_shooters_per_target;
+  std::vector<std::size_t> candidates;
   for (const auto& shooter : snapshot.friendly_units) {
     if (!shooter.alive || shooter.weapons.empty()) {
       continue;
@@ -60,12 +105,15 @@ FireDecision FireControlEngine::Decide(const BattlefieldSnapshot& snapshot,
     const WeaponState* best_weapon = nullptr;
     double best_score = -std::numeric_limits<double>::infinity();
 
-    for (const auto& target : snapshot.hostile_units) {
+    // 只评估射程内目标：射程外的组合评分恒为负，不会被选中。
+    geo.hostile_grid().QueryRadius(shooter.pose, MaxWeaponRange(shooter), candidates);
+    for (const std::size_t t : candidates) {
+      const EntityState& target = snapshot.hostile_units[t];
       if (!target.alive) {
         continue;
       }
       for (const auto& weapon : shooter.weapons) {
-        const double shot_score = WeaponFitScore(weapon, shooter, target) * threat_by_target[target.id];
+        const double shot_score = WeaponFitScore(weapon, shooter, target) * threat_by_target[t];
         if (shot_score > best_score) {
           best_score = shot_score;
           best_target = &target;
@@ -90,7 +138,7 @@ FireDecision FireControlEngine::Decide(const BattlefieldSnapshot& snapshot,
   }
 
   if (config_.enable_focus_fire && !out.threats.empty() && out.threats.front().index >= config_.focus_fire_threat_threshold) {
-    const std::string& priority_target = out.threats.front().target_id;
+    const EntityId priority_target = out.threats.front().target_id;
     for (auto& assignment : out.assignments) {
       if (assigned_shooters_per_target[priority_target] >= config_.max_shooters_per_target) {
         break;
@@ -104,24 +152,79 @@ FireDecision FireControlEngine::Decide(const BattlefieldSnapshot& snapshot,
       ++assigned_shooters_per_target[priority_target];
     }
   }
+}
 
-  if (config_.enable_stagger_fire) {
-    std::sort(out.assignments.begin(), out.assignments.end(), [](const TargetAssignment& a, const TargetAssignment& b) {
-      return a.score > b.score;
-    });
-    for (std::size_t i = 0; i < out.assignments.size(); ++i) {
-      out.assignments[i].scheduled_offset_s = static_cast<double>(i) * 1.25;
-      if (out.assignments[i].tactic == "single_shot") {
-        out.assignments[i].tactic = "stagger_fire";
+bool FireControlEngine::AssignAuction(const BattlefieldSnapshot& snapshot,
+                                      const SnapshotIndex& geo,
+                                      const std::vector<double>& threat_by_target,
+                                      FireDecision& out) const {
+  // 每条边保留该射手对该目标评分最高的武器；弹药耗尽或未就绪的武器评分为负，不会成边。
+  AssignmentProblem problem;
+  problem.target_count = snapshot.hostile_units.size();
+  problem.slots_per_target = std::max<std::size_t>(1, config_.max_shooters_per_target);
+  std::vector<const WeaponState*> arc_weapon;
+  std::vector<std::size_t> shooter_index;
+  std::vector<std::size_t> candidates;
+  for (std::size_t s = 0; s < snapshot.friendly_units.size(); ++s) {
+    const EntityState& shooter = snapshot.friendly_units[s];
+    if (!shooter.alive || shooter.weapons.empty()) {
+      continue;
+    }
+    problem.AddShooter();
+    shooter_index.push_back(s);
+    geo.hostile_grid().QueryRadius(shooter.pose, MaxWeaponRange(shooter), candidates);
+    for (const std::size_t t : candidates) {
+      const EntityState& target = snapshot.hostile_units[t];
+      if (!target.alive) {
+        continue;
+      }
+      const WeaponState* best_weapon = nullptr;
+      double best_score = 0.0;
+      for (const auto& weapon : shooter.weapons) {
+        const double shot_score = WeaponFitScore(weapon, shooter, target) * threat_by_target[t];
+        if (shot_score > best_score) {
+          best_score = shot_score;
+          best_weapon = &weapon;
+        }
+      }
+      if (best_weapon != nullptr) {
+        problem.AddArc(static_cast<std::uint32_t>(t), best_score);
+        arc_weapon.push_back(best_weapon);
       }
     }
   }
 
-  const auto recent_fire = memory.LastEventByType(EventType::WeaponFire, snapshot.timestamp_ms, 5 * 60 * 1000);
-  out.summary = "火力分配数=" + std::to_string(out.assignments.size()) +
-                "，最高威胁目标=" + (out.threats.empty() ? std::string("无") : out.threats.front().target_id) +
-                "，近期火力记忆=" + (recent_fire.has_value() ? std::string("有") : std::string("无"));
-  return out;
+  const AssignmentResult result =
+      SolveAuctionAssignment(problem, {config_.auction_epsilon_ratio, config_.solve_budget_ms});
+
+  std::vector<std::size_t> shooters_per_target(snapshot.hostile_units.size(), 0);
+  for (const std::uint32_t arc : result.arc_of_shooter) {
+    if (arc != AssignmentResult::kUnassigned) {
+      ++shooters_per_target[problem.arcs[arc].target];
+    }
+  }
+
+  for (std::size_t i = 0; i < shooter_index.size(); ++i) {
+    const std::uint32_t arc = result.arc_of_shooter[i];
+    if (arc == AssignmentResult::kUnassigned) {
+      continue;
+    }
+    const std::uint32_t t = problem.arcs[arc].target;
+    TargetAssignment a;
+    a.shooter_id = snapshot.friendly_units[shooter_index[i]].id;
+    a.target_id = snapshot.hostile_units[t].id;
+    a.weapon_name = arc_weapon[arc]->name;
+    a.score = problem.arcs[arc].value;
+    a.expected_kill_prob = arc_weapon[arc]->kill_probability;
+    if (config_.enable_focus_fire && shooters_per_target[t] > 1) {
+      a.tactic = "focus_fire";
+      a.rationale = "全局分配下多射手协同压制该目标";
+    } else {
+      a.rationale = "全局分配下该组合收益最高";
+    }
+    out.assignments.push_back(a);
+  }
+  return !result.timed_out;
 }
 
 double FireControlEngine::TypeThreatWeight(UnitType type) {
@@ -0,0 +1,496 @@
+#include "bas/inference/http_client.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace bas {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string ToLower(std::string text) {
+  std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+  return text;
+}
+
+std::string Trim(const std::string& text) {
+  const auto begin = text.find_first_not_of(" \t");
+  if (begin == std::string::npos) {
+    return {};
+  }
+  const auto end = text.find_last_not_of(" \t\r");
+  return text.substr(begin, end - begin + 1);
+}
+
+int RemainingMs(Clock::time_point deadline) {
+  const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+  return left > 0 ? static_cast<int>(left) : 0;
+}
+
+// 等待 fd 就绪；超时返回 false。
+bool WaitFd(int fd, short events, Clock::time_point deadline) {
+  for (;;) {
+    pollfd pfd{fd, events, 0};
+    const int rc = ::poll(&pfd, 1, RemainingMs(deadline));
+    if (rc > 0) {
+      return true;
+    }
+    if (rc == 0) {
+      return false;
+    }
+    if (errno != EINTR) {
+      return false;
+    }
+  }
+}
+
+bool SendAll(int fd, const std::string& data, Clock::time_point deadline, std::string& error) {
+  std::size_t sent = 0;
+  while (sent < data.size()) {
+    const ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n > 0) {
+      sent += static_cast<std::size_t>(n);
+      continue;
+    }
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      if (!WaitFd(fd, POLLOUT, deadline)) {
+        error = "发送超时";
+        return false;
+      }
+      continue;
+    }
+    error = "发送失败: " + std::string(std::strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+enum class RecvStatus { Data, Closed, Timeout, Failed };
+
+RecvStatus RecvMore(int fd, std::string& buffer, Clock::time_point deadline) {
+  char chunk[16384];
+  for (;;) {
+    const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+    if (n > 0) {
+      buffer.append(chunk, static_cast<std::size_t>(n));
+      return RecvStatus::Data;
+    }
+    if (n == 0) {
+      return RecvStatus::Closed;
+    }
+    if (errno == EINTR) {
+      continue;
+    }
+    if (errno != EAGAIN && errno != EWOULDBLOCK) {
+      return RecvStatus::Failed;
+    }
+    if (!WaitFd(fd, POLLIN, deadline)) {
+      return RecvStatus::Timeout;
+    }
+  }
+}
+
+struct Exchange {
+  HttpResponse response;
+  bool keep_alive = false;
+  // 尚未收到任何响应字节就失败：复用的空闲连接可能已被对端关闭，可换新连接重试。
+  bool stale = false;
+};
+
+// 从 pos 起增量解码分块响应体：完整的分块追加到 body 并推进 pos，数据尚不完整时停在该分块开头等待更多字节，
+// 每个字节只解析一次。收到结束分块时 complete 为 true，格式错误返回 false。
+bool DecodeChunked(const std::string& raw, std::size_t& pos, std::string& body, bool& complete, std::string& error) {
+  complete = false;
+  for (;;) {
+    const std::size_t line_end = raw.find("\r\n", pos);
+    if (line_end == std::string::npos) {
+      return true;
+    }
+    std::size_t size = 0;
+    try {
+      size = std::stoul(raw.substr(pos, line_end - pos), nullptr, 16);
+    } catch (const std::exception&) {
+      error = "分块长度非法";
+      return false;
+    }
+    const std::size_t data_begin = line_end + 2;
+    if (size == 0) {
+      // 忽略 trailer，只要求以空行结束。
+      complete = raw.find("\r\n", data_begin) != std::string::npos;
+      return true;
+    }
+    if (raw.size() < data_begin + size + 2) {
+      return true;
+    }
+    body.append(raw, data_begin, size);
+    pos = data_begin + size + 2;
+  }
+}
+
+Exchange RunExchange(int fd, const std::string& request, Clock::time_point deadline) {
+  Exchange ex;
+  if (!SendAll(fd, request, deadline, ex.response.error)) {
+    ex.stale = true;
+    return ex;
+  }
+
+  std::string raw;
+  std::size_t header_end = std::string::npos;
+  while ((header_end = raw.find("\r\n\r\n")) == std::string::npos) {
+    const RecvStatus st = RecvMore(fd, raw, deadline);
+    if (st == RecvStatus::Data) {
+      continue;
+    }
+    ex.stale = raw.empty() && st != RecvStatus::Timeout;
+    ex.response.error = st == RecvStatus::Timeout ? "等待响应超时" : "连接在响应头完成前关闭";
+    return ex;
+  }
+
+  const std::size_t status_end = raw.find("\r\n");
+  const std::string status_line = raw.substr(0, status_end);
+  const std::size_t sp = status_line.find(' ');
+  if (status_line.rfind("HTTP/1.", 0) != 0 || sp == std::string::npos) {
+    ex.response.error = "响应状态行非法";
+    return ex;
+  }
+  ex.response.status = std::atoi(status_line.c_str() + sp + 1);
+  const bool http11 = status_line.rfind("HTTP/1.1", 0) == 0;
+
+  long long content_length = -1;
+  bool chunked = false;
+  bool close_requested = !http11;
+  std::size_t pos = status_end + 2;
+  while (pos < header_end) {
+    const std::size_t line_end = raw.find("\r\n", pos);
+    const std::string line = raw.substr(pos, line_end - pos);
+    pos = line_end + 2;
+    const std::size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    const std::string name = ToLower(Trim(line.substr(0, colon)));
+    const std::string value = ToLower(Trim(line.substr(colon + 1)));
+    if (name == "content-length") {
+      content_length = std::atoll(value.c_str());
+    } else if (name == "transfer-encoding") {
+      chunked = value.find("chunked") != std::string::npos;
+    } else if (name == "connection") {
+      close_requested = value.find("close") != std::string::npos ? true
+                        : value.find("keep-alive") != std::string::npos ? false
+                                                                         : close_requested;
+    }
+  }
+
+  const std::size_t body_begin = header_end + 4;
+  const bool no_body = ex.response.status == 204 || ex.response.status == 304 || ex.response.status / 100 == 1;
+  if (no_body) {
+    ex.keep_alive = !close_requested;
+    return ex;
+  }
+
+  if (chunked) {
+    std::size_t chunk_pos = body_begin;
+    for (;;) {
+      bool complete = false;
+      if (!DecodeChunked(raw, chunk_pos, ex.response.body, complete, ex.response.error)) {
+        ex.response.status = 0;
+        return ex;
+      }
+      if (complete) {
+        break;
+      }
+      const RecvStatus st = RecvMore(fd, raw, deadline);
+      if (st != RecvStatus::Data) {
+        ex.response.status = 0;
+        ex.response.error = st == RecvStatus::Timeout ? "接收响应体超时" : "分块响应体不完整";
+        return ex;
+      }
+    }
+    ex.keep_alive = !close_requested;
+    return ex;
+  }
+
+  if (content_length >= 0) {
+    const std::size_t total = body_begin + static_cast<std::size_t>(content_length);
+    while (raw.size() < total) {
+      const RecvStatus st = RecvMore(fd, raw, deadline);
+      if (st != RecvStatus::Data) {
+        ex.response.status = 0;
+        ex.response.error = st == RecvStatus::Timeout ? "接收响应体超时" : "响应体长度不足";
+        return ex;
+      }
+    }
+    ex.response.body = raw.substr(body_begin, static_cast<std::size_t>(content_length));
+    ex.keep_alive = !close_requested;
+    return ex;
+  }
+
+  // 无长度信息：读到对端关闭为止，连接不可复用。
+  for (;;) {
+    const RecvStatus st = RecvMore(fd, raw, deadline);
+    if (st == RecvStatus::Closed) {
+      break;
+    }
+    if (st != RecvStatus::Data) {
+      ex.response.status = 0;
+      ex.response.error = st == RecvStatus::Timeout ? "接收响应体超时" : "接收响应体失败";
+      return ex;
+    }
+  }
+  ex.response.body = raw.substr(body_begin);
+  return ex;
+}
+
+}  // namespace
+
+bool HttpUrl::Parse(const std::string& url, HttpUrl& out) {
+  static const std::string kScheme = "http://";
+  if (url.compare(0, kScheme.size(), kScheme) != 0) {
+    return false;
+  }
+  const std::size_t host_begin = kScheme.size();
+  const std::size_t path_begin = url.find('/', host_begin);
+  const std::string authority = url.substr(host_begin, path_begin == std::string::npos ? std::string::npos
+                                                                                       : path_begin - host_begin);
+  out.target = path_begin == std::string::npos ? "/" : url.substr(path_begin);
+  out.port = 80;
+
+  const std::size_t colon = authority.rfind(':');
+  if (colon != std::string::npos && authority.find(']') == std::string::npos) {
+    out.host = authority.substr(0, colon);
+    const int port = std::atoi(authority.c_str() + colon + 1);
+    if (port <= 0 || port > 65535) {
+      return false;
+    }
+    out.port = static_cast<std::uint16_t>(port);
+  } else {
+    out.host = authority;
+  }
+  return !out.host.empty();
+}
+
+HttpClient::HttpClient(std::size_t max_idle_per_host) : max_idle_per_host_(max_idle_per_host) {}
+
+HttpClient::~HttpClient() {
+  for (auto& [key, fds] : idle_) {
+    for (const int fd : fds) {
+      ::close(fd);
+    }
+  }
+}
+
+int HttpClient::AcquireIdle(const std::string& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = idle_.find(key);
+  while (it != idle_.end() && !it->second.empty()) {
+    const int fd = it->second.back();
+    it->second.pop_back();
+    // 空闲连接上不应有可读数据；可读意味着对端已关闭或发来残留数据，直接丢弃。
+    pollfd pfd{fd, POLLIN, 0};
+    if (::poll(&pfd, 1, 0) == 0) {
+      ++stats_.connections_reused;
+      return fd;
+    }
+    ::close(fd);
+  }
+  return -1;
+}
+
+void HttpClient::ReleaseIdle(const std::string& key, int fd) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& fds = idle_[key];
+  if (fds.size() >= max_idle_per_host_) {
+    ::close(fd);
+    return;
+  }
+  fds.push_back(fd);
+}
+
+bool HttpClient::Resolve(const HttpUrl& url,
+                         const std::string& key,
+                         std::vector<ResolvedAddress>& out,
+                         std::string& error) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto it = resolved_.find(key);
+    if (it != resolved_.end()) {
+      out = it->second;
+      return true;
+    }
+    ++stats_.dns_lookups;
+  }
+
+  // getaddrinfo 不受截止时间约束，只在首次连接该主机或缓存失效时调用。
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* results = nullptr;
+  const std::string port = std::to_string(url.port);
+  const int gai = ::getaddrinfo(url.host.c_str(), port.c_str(), &hints, &results);
+  if (gai != 0) {
+    error = "域名解析失败: " + std::string(::gai_strerror(gai));
+    return false;
+  }
+  out.clear();
+  for (addrinfo* ai = results; ai != nullptr; ai = ai->ai_next) {
+    if (ai->ai_addrlen > sizeof(sockaddr_storage)) {
+      continue;
+    }
+    ResolvedAddress address;
+    address.family = ai->ai_family;
+    address.socktype = ai->ai_socktype;
+    address.protocol = ai->ai_protocol;
+    std::memcpy(&address.addr, ai->ai_addr, ai->ai_addrlen);
+    address.addr_len = ai->ai_addrlen;
+    out.push_back(address);
+  }
+  ::freeaddrinfo(results);
+  if (out.empty()) {
+    error = "域名解析失败: 无可用地址";
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  resolved_[key] = out;
+  return true;
+}
+
+int HttpClient::Connect(const HttpUrl& url,
+                        const std::string& key,
+                        std::chrono::steady_clock::time_point deadline,
+                        std::string& error) {
+  std::vector<ResolvedAddress> addresses;
+  if (!Resolve(url, key, addresses, error)) {
+    return -1;
+  }
+
+  int fd = -1;
+  bool timed_out = false;
+  for (const ResolvedAddress& address : addresses) {
+    fd = ::socket(address.family, address.socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, address.protocol);
+    if (fd < 0) {
+      continue;
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&address.addr), address.addr_len) != 0) {
+      int so_error = errno;
+      if (so_error == EINPROGRESS) {
+        if (!WaitFd(fd, POLLOUT, deadline)) {
+          ::close(fd);
+          fd = -1;
+          error = "连接超时";
+          timed_out = true;
+          break;
+        }
+        socklen_t len = sizeof(so_error);
+        ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &so_error, &len);
+      }
+      if (so_error != 0) {
+        error = "连接失败: " + std::string(std::strerror(so_error));
+        ::close(fd);
+        fd = -1;
+        continue;
+      }
+    }
+    const int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    break;
+  }
+  if (fd < 0) {
+    if (error.empty()) {
+      error = "无法创建套接字";
+    }
+    if (!timed_out) {
+      // 全部地址都连不上：地址可能已变更，下次请求重新解析。
+      std::lock_guard<std::mutex> lock(mutex_);
+      resolved_.erase(key);
+    }
+  }
+  return fd;
+}
+
+HttpResponse HttpClient::Post(const std::string& url,
+                              const std::string& body,
+                              const Headers& headers,
+                              int timeout_ms) {
+  const auto deadline = Clock::now() + std::chrono::milliseconds(std::max(1, timeout_ms));
+  HttpResponse failed;
+  HttpUrl parsed;
+  if (!HttpUrl::Parse(url, parsed)) {
+    failed.error = "不支持的地址（仅支持http）: " + url;
+    return failed;
+  }
+  const std::string key = parsed.host + ":" + std::to_string(parsed.port);
+
+  std::string request = "POST " + parsed.target + " HTTP/1.1\r\nHost: " + parsed.host;
+  if (parsed.port != 80) {
+    request += ":" + std::to_string(parsed.port);
+  }
+  request += "\r\nContent-Length: " + std::to_string(body.size()) + "\r\nConnection: keep-alive\r\n";
+  for (const auto& [name, value] : headers) {
+    request += name + ": " + value + "\r\n";
+  }
+  request += "\r\n";
+  request += body;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++stats_.requests;
+  }
+
+  // 复用连接失败且尚未收到响应时，换新连接重试一次。
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    int fd = attempt == 0 ? AcquireIdle(key) : -1;
+    const bool reused = fd >= 0;
+    if (!reused) {
+      fd = Connect(parsed, key, deadline, failed.error);
+      if (fd < 0) {
+        return failed;
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++stats_.connections_opened;
+    }
+
+    Exchange ex = RunExchange(fd, request, deadline);
+    if (ex.keep_alive && ex.response.error.empty()) {
+      ReleaseIdle(key, fd);
+    } else {
+      ::close(fd);
+    }
+    if (reused && ex.stale && Clock::now() < deadline) {
+      continue;
+    }
+    return std::move(ex.response);
+  }
+  failed.error = "连接被对端重置";
+  return failed;
+}
+
+HttpClientStats HttpClient::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+std::size_t HttpClient::idle_connections() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::size_t total = 0;
+  for (const auto& [key, fds] : idle_) {
+    total += fds.size();
+  }
+  return total;
+}
+
+}  // namespace bas
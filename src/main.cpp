@@ -13,17 +13,18 @@ bas::DisPduBatch BuildDemoPdus(std::int64_t now_ms) {
   bas::DisPduBatch batch;
   batch.env = bas::EnvironmentState{900.0, 0.2, 0.3};
 
-  batch.entity_updates.push_back({now_ms, "F-1", bas::Side::Friendly, bas::UnitType::Armor, {0.0, 0.0, 0.0}, 6.0,
-                                  15.0, true, 0.35});
-  batch.entity_updates.push_back({now_ms, "F-2", bas::Side::Friendly, bas::UnitType::Infantry, {-25.0, -10.0, 0.0},
-                                  2.0, 20.0, true, 0.20});
-
-  batch.entity_updates.push_back({now_ms, "H-1", bas::Side::Hostile, bas::UnitType::Armor, {380.0, 180.0, 0.0}, 9.0,
-                                  210.0, true, 0.95});
-  batch.entity_updates.push_back({now_ms, "H-2", bas::Side::Hostile, bas::UnitType::Artillery, {-160.0, 140.0, 0.0},
-                                  3.5, 195.0, true, 0.82});
-
-  batch.fire_events.push_back({now_ms - 45 * 1000, "H-2", "F-1", "howitzer", {-160.0, 140.0, 0.0}});
+  batch.entity_updates.push_back({now_ms, bas::EntityId::Intern("F-1"), bas::Side::Friendly, bas::UnitType::Armor,
+                                  {0.0, 0.0, 0.0}, 6.0, 15.0, true, 0.35});
+  batch.entity_updates.push_back({now_ms, bas::EntityId::Intern("F-2"), bas::Side::Friendly, bas::UnitType::Infantry,
+                                  {-25.0, -10.0, 0.0}, 2.0, 20.0, true, 0.20});
+
+  batch.entity_updates.push_back({now_ms, bas::EntityId::Intern("H-1"), bas::Side::Hostile, bas::UnitType::Armor,
+                                  {380.0, 180.0, 0.0}, 9.0, 210.0, true, 0.95});
+  batch.entity_updates.push_back({now_ms, bas::EntityId::Intern("H-2"), bas::Side::Hostile, bas::UnitType::Artillery,
+                                  {-160.0, 140.0, 0.0}, 3.5, 195.0, true, 0.82});
+
+  batch.fire_events.push_back({now_ms - 45 * 1000, bas::EntityId::Intern("H-2"), bas::EntityId::Intern("F-1"),
+                               "howitzer", {-160.0, 140.0, 0.0}});
   return batch;
 }
 
@@ -125,7 +126,11 @@ int main() {
   model_runtime.Configure(
       {backend, "Qwen1.5-1.8B-Chat", 192, true, "http://127.0.0.1:8000/v1/chat/completions", "", timeout_ms});
 
-  bas::AgentPipeline pipeline({3000, 5 * 60 * 1000}, bas::FireControlEngine{}, bas::ManeuverEngine{}, model_runtime);
+  bas::PipelineConfig pipeline_config{3000, 5 * 60 * 1000};
+  if (const char* threads_env = std::getenv("BAS_MANEUVER_THREADS"); threads_env != nullptr) {
+    pipeline_config.maneuver_threads = static_cast<std::size_t>(std::strtoul(threads_env, nullptr, 10));
+  }
+  bas::AgentPipeline pipeline(pipeline_config, bas::FireControlEngine{}, bas::ManeuverEngine{}, model_runtime);
 
   const bas::DecisionPackage first = pipeline.Tick(*snapshot, adapter.DrainEvents());
   std::cout << "模型后端: " << (backend == bas::ModelBackend::OpenAICompatible ? "OpenAI兼容接口" : "模拟后端")
@@ -2,15 +2,36 @@
 
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdlib>
 #include <limits>
-#include <unordered_map>
+#include <optional>
 
 namespace bas {
 
-ManeuverEngine::ManeuverEngine(ManeuverConfig config) : config_(config) {}
+namespace {
+
+constexpr double kThreatCostWeight = 35.0;
+
+// 每个并行块规划的单位数：单位间代价相近，小块即可均衡负载。
+constexpr std::size_t kPlanGrain = 4;
+
+template <typename Node>
+bool OpenNodeGreater(const Node& a, const Node& b) {
+  return a.f != b.f ? a.f > b.f : a.seq > b.seq;
+}
+
+}  // namespace
+
+ManeuverEngine::ManeuverEngine(ManeuverConfig config, ThreadPool* pool)
+    : config_(config),
+      raster_(config.path_step_m),
+      pool_(pool),
+      scratch_(pool != nullptr ? pool->slot_count() : 1) {}
 
 ManeuverDecision ManeuverEngine::Decide(const BattlefieldSnapshot& snapshot,
-                                        const SituationSemantics& semantics) const {
+                                        const SituationSemantics& semantics,
+                                        const SnapshotIndex* index) {
   ManeuverDecision out;
   if (snapshot.friendly_units.empty()) {
     out.summary = "机动动作数=0";
@@ -30,6 +51,15 @@ ManeuverDecision ManeuverEngine::Decide(const BattlefieldSnapshot& snapshot,
   centroid.y /= static_cast<double>(snapshot.friendly_units.size());
   centroid.z /= static_cast<double>(snapshot.friendly_units.size());
 
+  std::optional<SnapshotIndex> local_index;
+  const SnapshotIndex& geo = index != nullptr ? *index : local_index.emplace(snapshot);
+  const double terrain_risk = snapshot.env.terrain_risk;
+  raster_.Update(snapshot.hostile_units);
+
+  // 第一阶段顺序确定动作与目标点；第二阶段只做路径规划，可并行。
+  std::vector<std::size_t> plan_actions;
+  std::vector<Pose> plan_goals;
+  std::vector<const EntityState*> plan_units;
   for (const auto& unit : snapshot.friendly_units) {
     if (!unit.alive) {
       continue;
@@ -37,12 +67,10 @@ ManeuverDecision ManeuverEngine::Decide(const BattlefieldSnapshot& snapshot,
 
     const EntityState* nearest = nullptr;
     double nearest_dist = std::numeric_limits<double>::infinity();
-    for (const auto& enemy : snapshot.hostile_units) {
-      const double d = Distance(unit.pose, enemy.pose);
-      if (d < nearest_dist) {
-        nearest_dist = d;
-        nearest = &enemy;
-      }
+    SpatialNeighbor neighbor;
+    if (geo.hostile_grid().Nearest(unit.pose, neighbor)) {
+      nearest = &snapshot.hostile_units[neighbor.index];
+      nearest_dist = std::sqrt(neighbor.distance_sq);
     }
 
     ManeuverAction action;
@@ -83,11 +111,36 @@ ManeuverDecision ManeuverEngine::Decide(const BattlefieldSnapshot& snapshot,
       goal.y = (goal.y * 0.8) + (centroid.y * 0.2);
     }
 
-    action.path = PlanPath(unit.pose, goal, snapshot);
-    action.next_pose = action.path.empty() ? goal : action.path.back();
+    plan_actions.push_back(out.actions.size());
+    plan_goals.push_back(goal);
+    plan_units.push_back(&unit);
     out.actions.push_back(action);
   }
 
+  // 规划前生成所有搜索框覆盖的栅格瓦片，并行阶段对栅格只读。
+  const double step = config_.path_step_m;
+  for (std::size_t k = 0; k < plan_actions.size(); ++k) {
+    const Pose& start = plan_units[k]->pose;
+    const PlanBox box = MakePlanBox(start, plan_goals[k]);
+    raster_.Materialize(raster_.CellCoord(start.x + box.min_i * step),
+                        raster_.CellCoord(start.x + (box.min_i + box.width - 1) * step),
+                        raster_.CellCoord(start.y + box.min_j * step),
+                        raster_.CellCoord(start.y + (box.min_j + box.height - 1) * step));
+  }
+
+  const auto plan_range = [&](std::size_t begin, std::size_t end, std::size_t slot) {
+    for (std::size_t k = begin; k < end; ++k) {
+      ManeuverAction& action = out.actions[plan_actions[k]];
+      PlanPath(plan_units[k]->pose, plan_goals[k], terrain_risk, scratch_[slot], action.path);
+      action.next_pose = action.path.empty() ? plan_goals[k] : action.path.back();
+    }
+  };
+  if (pool_ != nullptr && plan_actions.size() >= config_.parallel_min_units) {
+    pool_->ParallelFor(plan_actions.size(), kPlanGrain, plan_range);
+  } else {
+    plan_range(0, plan_actions.size(), scratch_.size() - 1);
+  }
+
   out.summary = "机动动作数=" + std::to_string(out.actions.size()) +
                 "，编队模式=" + (out.formation_mode == "disperse" ? "分散" : "集结");
   return out;
@@ -102,57 +155,123 @@ bool ManeuverEngine::HasTag(const SituationSemantics& semantics, const std::stri
   return false;
 }
 
-double ManeuverEngine::ThreatField(const Pose& point, const BattlefieldSnapshot& snapshot) {
-  double threat = 0.0;
-  for (const auto& enemy : snapshot.hostile_units) {
-    const double d = std::max(25.0, Distance(point, enemy.pose));
-    threat += (enemy.threat_level * 120.0 + 20.0) / d;
-    if (enemy.type == UnitType::Artillery) {
-      threat += 12.0 / std::sqrt(d);
-    }
-  }
-  threat += snapshot.env.terrain_risk * 5.0;
-  return threat;
+ManeuverEngine::PlanBox ManeuverEngine::MakePlanBox(const Pose& start, const Pose& goal) const {
+  // 搜索范围：起点与目标外扩 horizon 个格，足以容纳绕行且与敌方数量无关。
+  const double step = config_.path_step_m;
+  const std::int32_t horizon = std::max(1, config_.path_horizon_steps);
+  PlanBox box;
+  box.goal_i = static_cast<std::int32_t>(std::lround((goal.x - start.x) / step));
+  box.goal_j = static_cast<std::int32_t>(std::lround((goal.y - start.y) / step));
+  box.min_i = std::min(0, box.goal_i) - horizon;
+  box.min_j = std::min(0, box.goal_j) - horizon;
+  box.width = std::abs(box.goal_i) + 2 * horizon + 1;
+  box.height = std::abs(box.goal_j) + 2 * horizon + 1;
+  return box;
 }
 
-std::vector<Pose> ManeuverEngine::PlanPath(const Pose& start, const Pose& goal, const BattlefieldSnapshot& snapshot) const {
-  std::vector<Pose> path;
-  path.push_back(start);
-  Pose current = start;
-
-  static constexpr std::array<std::pair<double, double>, 8> kDirections = {{{1.0, 0.0},  {0.0, 1.0},  {-1.0, 0.0},
-                                                                             {0.0, -1.0}, {0.7, 0.7}, {-0.7, 0.7},
-                                                                             {-0.7, -0.7}, {0.7, -0.7}}};
-
-  for (int step = 0; step < config_.path_horizon_steps; ++step) {
-    Pose best_next = current;
-    double best_cost = std::numeric_limits<double>::infinity();
-
-    for (const auto& dir : kDirections) {
-      Pose candidate{current.x + dir.first * config_.path_step_m, current.y + dir.second * config_.path_step_m,
-                     current.z};
-      const double goal_cost = Distance(candidate, goal) * 0.8;
-      const double threat_cost = ThreatField(candidate, snapshot) * 35.0;
-      const double smoothness_cost = Distance(candidate, current) * 0.2;
-      const double total_cost = goal_cost + threat_cost + smoothness_cost;
-      if (total_cost < best_cost) {
-        best_cost = total_cost;
-        best_next = candidate;
-      }
-    }
+void ManeuverEngine::PlanPath(const Pose& start,
+                              const Pose& goal,
+                              double terrain_risk,
+                              PlannerScratch& scratch,
+                              std::vector<Pose>& path) const {
+  const double step = config_.path_step_m;
+  const std::int32_t horizon = std::max(1, config_.path_horizon_steps);
+  const PlanBox box = MakePlanBox(start, goal);
+  const std::int32_t width = box.width;
+  const auto node_count = static_cast<std::size_t>(box.width) * static_cast<std::size_t>(box.height);
+  const Pose goal_node_pose{start.x + box.goal_i * step, start.y + box.goal_j * step, start.z};
+  const auto node_of = [&](std::int32_t i, std::int32_t j) { return (j - box.min_j) * width + (i - box.min_i); };
+  const auto pose_of = [&](std::int32_t node) {
+    return Pose{start.x + (node % width + box.min_i) * step, start.y + (node / width + box.min_j) * step, start.z};
+  };
 
-    current = best_next;
-    path.push_back(current);
-    if (Distance(current, goal) < config_.path_step_m) {
+  // 先批量读取搜索框内各节点的进入代价（栅格查表），其最小值用于加强启发式。
+  const double terrain_cost = terrain_risk * 5.0;
+  std::vector<double>& node_cost = scratch.node_cost;
+  node_cost.resize(node_count);
+  double min_node_cost = std::numeric_limits<double>::infinity();
+  for (std::size_t n = 0; n < node_count; ++n) {
+    node_cost[n] = (raster_.SampleReadOnly(pose_of(static_cast<std::int32_t>(n))) + terrain_cost) * kThreatCostWeight;
+    min_node_cost = std::min(min_node_cost, node_cost[n]);
+  }
+  // 启发式 = 直线距离 + 剩余最少步数 × 最小进入代价，可采纳且一致。
+  const auto heuristic = [&](std::int32_t i, std::int32_t j, const Pose& p) {
+    const std::int32_t steps = std::max(std::abs(box.goal_i - i), std::abs(box.goal_j - j));
+    return Distance(p, goal_node_pose) + steps * min_node_cost;
+  };
+
+  std::vector<double>& g = scratch.g;
+  std::vector<std::int32_t>& parent = scratch.parent;
+  std::vector<std::uint8_t>& closed = scratch.closed;
+  std::vector<OpenNode>& open = scratch.open;
+  g.assign(node_count, std::numeric_limits<double>::infinity());
+  parent.assign(node_count, -1);
+  closed.assign(node_count, 0);
+  open.clear();
+  const auto push_open = [&open](const OpenNode& node) {
+    open.push_back(node);
+    std::push_heap(open.begin(), open.end(), OpenNodeGreater<OpenNode>);
+  };
+
+  const std::int32_t start_node = node_of(0, 0);
+  const std::int32_t goal_node = node_of(box.goal_i, box.goal_j);
+  std::uint64_t seq = 0;
+  g[start_node] = 0.0;
+  push_open({heuristic(0, 0, start), seq++, start_node});
+
+  static constexpr std::array<std::array<std::int32_t, 2>, 8> kNeighbors = {
+      {{1, 0}, {0, 1}, {-1, 0}, {0, -1}, {1, 1}, {-1, 1}, {-1, -1}, {1, -1}}};
+
+  while (!open.empty()) {
+    std::pop_heap(open.begin(), open.end(), OpenNodeGreater<OpenNode>);
+    const OpenNode top = open.back();
+    open.pop_back();
+    if (closed[top.node] != 0) {
+      continue;
+    }
+    closed[top.node] = 1;
+    if (top.node == goal_node) {
       break;
     }
+    const std::int32_t i = top.node % width + box.min_i;
+    const std::int32_t j = top.node / width + box.min_j;
+    for (const auto& dir : kNeighbors) {
+      const std::int32_t ni = i + dir[0];
+      const std::int32_t nj = j + dir[1];
+      if (ni < box.min_i || nj < box.min_j || ni >= box.min_i + width || nj >= box.min_j + box.height) {
+        continue;
+      }
+      const std::int32_t next = node_of(ni, nj);
+      if (closed[next] != 0) {
+        continue;
+      }
+      const double move = (dir[0] != 0 && dir[1] != 0 ? std::sqrt(2.0) : 1.0) * step;
+      const double cost = g[top.node] + move + node_cost[next];
+      if (cost < g[next]) {
+        g[next] = cost;
+        parent[next] = top.node;
+        push_open({cost + heuristic(ni, nj, pose_of(next)), seq++, next});
+      }
+    }
   }
 
-  if (Distance(path.back(), goal) > config_.path_step_m) {
-    path.push_back(goal);
+  std::vector<std::int32_t>& chain = scratch.chain;
+  chain.clear();
+  for (std::int32_t node = goal_node; node != -1; node = parent[node]) {
+    chain.push_back(node);
+  }
+  std::reverse(chain.begin(), chain.end());
+
+  path.clear();
+  path.reserve(static_cast<std::size_t>(horizon) + 2);
+  path.push_back(start);
+  for (std::size_t k = 1; k < chain.size() && k <= static_cast<std::size_t>(horizon); ++k) {
+    path.push_back(pose_of(chain[k]));
   }
 
-  return path;
+  if (Distance(path.back(), goal) > step) {
+    path.push_back(goal);
+  }
 }
 
 Pose ManeuverEngine::MoveAway(const Pose& self, const Pose& threat, double step) {
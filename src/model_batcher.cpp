@@ -0,0 +1,90 @@
+#include "bas/inference/model_batcher.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+namespace bas {
+
+ModelBatcher::ModelBatcher(ModelBatchOptions options) : options_(options) {
+  options_.window_ms = std::max(0, options_.window_ms);
+  options_.max_batch_size = std::max<std::size_t>(1, options_.max_batch_size);
+}
+
+ModelBatchReply ModelBatcher::Submit(const std::string& payload, const SendFn& send) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  ++stats_.requests;
+
+  if (const auto it = inflight_.find(payload); it != inflight_.end()) {
+    ++stats_.deduplicated;
+    const std::shared_ptr<Entry> entry = it->second;
+    cv_.wait(lock, [&entry] { return entry->done; });
+    return entry->reply;
+  }
+
+  auto entry = std::make_shared<Entry>();
+  inflight_.emplace(payload, entry);
+
+  const bool leader = open_batch_ == nullptr;
+  if (leader) {
+    open_batch_ = std::make_shared<Batch>();
+  }
+  const std::shared_ptr<Batch> batch = open_batch_;
+  batch->payloads.push_back(payload);
+  batch->entries.push_back(entry);
+  if (batch->payloads.size() >= options_.max_batch_size) {
+    // 满批立即封口，后续请求另起一批。
+    open_batch_.reset();
+    cv_.notify_all();
+  }
+
+  if (!leader) {
+    cv_.wait(lock, [&entry] { return entry->done; });
+    return entry->reply;
+  }
+
+  cv_.wait_for(lock, std::chrono::milliseconds(options_.window_ms),
+               [&batch, this] { return batch->payloads.size() >= options_.max_batch_size; });
+  if (open_batch_ == batch) {
+    open_batch_.reset();
+  }
+  ++stats_.batches;
+  stats_.largest_batch = std::max(stats_.largest_batch, batch->payloads.size());
+  lock.unlock();
+
+  // 封口后批内容不再变化，可在锁外发送。
+  std::vector<ModelBatchReply> replies;
+  try {
+    replies = send(batch->payloads);
+  } catch (const std::exception& e) {
+    replies.clear();
+    replies.resize(batch->payloads.size(), ModelBatchReply{{}, std::string("模型批量调用异常（") + e.what() + "）"});
+  }
+  if (replies.size() != batch->payloads.size()) {
+    replies.resize(batch->payloads.size(), ModelBatchReply{{}, "模型批量响应条目数不符"});
+  }
+
+  lock.lock();
+  for (std::size_t i = 0; i < batch->entries.size(); ++i) {
+    batch->entries[i]->reply = std::move(replies[i]);
+    batch->entries[i]->done = true;
+    inflight_.erase(batch->payloads[i]);
+  }
+  cv_.notify_all();
+  return entry->reply;
+}
+
+ModelBatchStats ModelBatcher::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void ModelBatcher::MergeStats(const ModelBatchStats& other) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.requests += other.requests;
+  stats_.deduplicated += other.deduplicated;
+  stats_.batches += other.batches;
+  stats_.largest_batch = std::max(stats_.largest_batch, other.largest_batch);
+}
+
+}  // namespace bas
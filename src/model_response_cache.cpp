@@ -0,0 +1,236 @@
+#include "bas/inference/model_response_cache.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+
+namespace bas {
+
+namespace {
+
+constexpr const char* kFileHeader = "BAS_MODEL_RESPONSE_CACHE 1";
+
+std::string CollapseWhitespace(const std::string& text) {
+  std::string out;
+  out.reserve(text.size());
+  bool pending_space = false;
+  for (const char c : text) {
+    if (std::isspace(static_cast<unsigned char>(c)) != 0) {
+      pending_space = !out.empty();
+      continue;
+    }
+    if (pending_space) {
+      out.push_back(' ');
+      pending_space = false;
+    }
+    out.push_back(c);
+  }
+  return out;
+}
+
+std::string EscapeField(const std::string& text) {
+  std::string out;
+  out.reserve(text.size());
+  for (const char c : text) {
+    switch (c) {
+      case '\\':
+        out += "\\\\";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      default:
+        out.push_back(c);
+        break;
+    }
+  }
+  return out;
+}
+
+std::string UnescapeField(const std::string& text) {
+  std::string out;
+  out.reserve(text.size());
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    if (text[i] != '\\' || i + 1 == text.size()) {
+      out.push_back(text[i]);
+      continue;
+    }
+    const char c = text[++i];
+    out.push_back(c == 't' ? '\t' : c == 'n' ? '\n' : c == 'r' ? '\r' : c);
+  }
+  return out;
+}
+
+}  // namespace
+
+ModelResponseCache::ModelResponseCache(std::size_t capacity, std::int64_t ttl_ms)
+    : capacity_(std::max<std::size_t>(1, capacity)), ttl_ms_(ttl_ms) {}
+
+std::string ModelResponseCache::MakeKey(const std::string& model_name,
+                                        std::size_t max_tokens,
+                                        const std::vector<std::string>& candidates,
+                                        const std::vector<std::string>& tags) {
+  std::vector<std::string> sorted_tags = tags;
+  std::sort(sorted_tags.begin(), sorted_tags.end());
+  sorted_tags.erase(std::unique(sorted_tags.begin(), sorted_tags.end()), sorted_tags.end());
+
+  // 字段间用 ASCII 单元分隔符，避免候选文本内容与分隔符混淆。
+  std::string key = model_name + '\x1f' + std::to_string(max_tokens);
+  for (const auto& candidate : candidates) {
+    key += '\x1e';
+    key += CollapseWhitespace(candidate);
+  }
+  key += '\x1d';
+  for (const auto& tag : sorted_tags) {
+    key += '\x1f';
+    key += tag;
+  }
+  return key;
+}
+
+std::optional<CachedModelResponse> ModelResponseCache::Get(const std::string& key, std::int64_t now_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++stats_.misses;
+    return std::nullopt;
+  }
+  if (Expired(*it->second, now_ms)) {
+    lru_.erase(it->second);
+    index_.erase(it);
+    ++stats_.expired;
+    ++stats_.misses;
+    return std::nullopt;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second);
+  ++stats_.hits;
+  return it->second->value;
+}
+
+void ModelResponseCache::Put(const std::string& key, const CachedModelResponse& value, std::int64_t now_ms) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  InsertLocked(key, value, now_ms);
+}
+
+bool ModelResponseCache::Load(const std::string& path, std::int64_t now_ms) {
+  std::ifstream in(path);
+  if (!in.is_open()) {
+    return false;
+  }
+  std::string line;
+  if (!std::getline(in, line) || line != kFileHeader) {
+    return false;
+  }
+
+  // 文件按从旧到新写出，顺序插入后最新条目位于 LRU 头部。
+  std::lock_guard<std::mutex> lock(mutex_);
+  while (std::getline(in, line)) {
+    const std::size_t t1 = line.find('\t');
+    const std::size_t t2 = t1 == std::string::npos ? t1 : line.find('\t', t1 + 1);
+    const std::size_t t3 = t2 == std::string::npos ? t2 : line.find('\t', t2 + 1);
+    if (t3 == std::string::npos) {
+      continue;
+    }
+    Entry entry;
+    try {
+      entry.stored_ms = std::stoll(line.substr(0, t1));
+      entry.value.selected_index = static_cast<std::size_t>(std::stoul(line.substr(t1 + 1, t2 - t1 - 1)));
+    } catch (const std::exception&) {
+      continue;
+    }
+    if (Expired(entry, now_ms)) {
+      continue;
+    }
+    entry.key = UnescapeField(line.substr(t2 + 1, t3 - t2 - 1));
+    entry.value.explanation = UnescapeField(line.substr(t3 + 1));
+    InsertLocked(entry.key, entry.value, entry.stored_ms);
+    ++stats_.loaded;
+  }
+  return true;
+}
+
+bool ModelResponseCache::Save(const std::string& path) const {
+  // 先写临时文件再改名，中途失败不会破坏已有缓存文件。
+  const std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ios::trunc);
+    if (!out.is_open()) {
+      return false;
+    }
+    out << kFileHeader << "\n";
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = lru_.rbegin(); it != lru_.rend(); ++it) {
+      out << it->stored_ms << "\t" << it->value.selected_index << "\t" << EscapeField(it->key) << "\t"
+          << EscapeField(it->value.explanation) << "\n";
+    }
+    if (!out.good()) {
+      return false;
+    }
+  }
+  return std::rename(tmp_path.c_str(), path.c_str()) == 0;
+}
+
+ModelResponseCacheStats ModelResponseCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ModelResponseCacheStats out = stats_;
+  out.entries = lru_.size();
+  return out;
+}
+
+std::shared_ptr<ModelResponseCache> ModelResponseCache::Clone() const {
+  auto copy = std::make_shared<ModelResponseCache>(capacity_, ttl_ms_);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto it = lru_.rbegin(); it != lru_.rend(); ++it) {
+    copy->InsertLocked(it->key, it->value, it->stored_ms);
+  }
+  return copy;
+}
+
+void ModelResponseCache::Merge(const ModelResponseCache& other) {
+  // 先在对方锁内取出条目，避免同时持有两把锁。
+  std::vector<Entry> entries;
+  ModelResponseCacheStats other_stats;
+  {
+    std::lock_guard<std::mutex> lock(other.mutex_);
+    entries.assign(other.lru_.rbegin(), other.lru_.rend());
+    other_stats = other.stats_;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const Entry& entry : entries) {
+    InsertLocked(entry.key, entry.value, entry.stored_ms);
+  }
+  stats_.hits += other_stats.hits;
+  stats_.misses += other_stats.misses;
+  stats_.expired += other_stats.expired;
+  stats_.evictions += other_stats.evictions;
+}
+
+bool ModelResponseCache::Expired(const Entry& entry, std::int64_t now_ms) const {
+  return ttl_ms_ > 0 && now_ms - entry.stored_ms > ttl_ms_;
+}
+
+void ModelResponseCache::InsertLocked(const std::string& key, const CachedModelResponse& value, std::int64_t stored_ms) {
+  if (const auto it = index_.find(key); it != index_.end()) {
+    it->second->value = value;
+    it->second->stored_ms = stored_ms;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return;
+  }
+  lru_.push_front(Entry{key, value, stored_ms});
+  index_.emplace(key, lru_.begin());
+  while (lru_.size() > capacity_) {
+    index_.erase(lru_.back().key);
+    lru_.pop_back();
+    ++stats_.evictions;
+  }
+}
+
+}  // namespace bas
@@ -1,14 +1,12 @@
 #include "bas/inference/model_runtime.hpp"
 
-#include <array>
-#include <cstdio>
+#include <algorithm>
+#include <chrono>
 #include <cstdlib>
-#include <ctime>
-#include <fstream>
 #include <regex>
 #include <sstream>
 #include <stdexcept>
-#include <unistd.h>
+#include <string_view>
 
 namespace bas {
 
@@ -73,10 +71,354 @@ std::string UnescapeJsonString(const std::string& input) {
   return out;
 }
 
+std::string DeriveBatchEndpoint(const std::string& endpoint) {
+  static const std::string kChatSuffix = "/chat/completions";
+  if (endpoint.size() >= kChatSuffix.size() &&
+      endpoint.compare(endpoint.size() - kChatSuffix.size(), kChatSuffix.size(), kChatSuffix) == 0) {
+    return endpoint.substr(0, endpoint.size() - kChatSuffix.size()) + "/batch";
+  }
+  return endpoint + "/batch";
+}
+
+// 只读 JSON 扫描器：按字段路径逐层读取，不建树。各方法在格式错误时返回 false，读取位置不确定。
+class JsonScanner {
+ public:
+  explicit JsonScanner(std::string_view text) : text_(text) {}
+
+  std::size_t position() const { return pos_; }
+  void Seek(std::size_t pos) { pos_ = pos; }
+  bool AtEnd() {
+    SkipWs();
+    return pos_ == text_.size();
+  }
+  bool Peek(char c) {
+    SkipWs();
+    return pos_ < text_.size() && text_[pos_] == c;
+  }
+
+  bool ReadString(std::string& out) {
+    if (!Peek('"')) {
+      return false;
+    }
+    ++pos_;
+    out.clear();
+    while (pos_ < text_.size()) {
+      const char c = text_[pos_++];
+      if (c == '"') {
+        return true;
+      }
+      if (c != '\\') {
+        out.push_back(c);
+        continue;
+      }
+      if (pos_ >= text_.size()) {
+        return false;
+      }
+      const char e = text_[pos_++];
+      switch (e) {
+        case 'n':
+          out.push_back('\n');
+          break;
+        case 't':
+          out.push_back('\t');
+          break;
+        case 'r':
+          out.push_back('\r');
+          break;
+        case 'b':
+          out.push_back('\b');
+          break;
+        case 'f':
+          out.push_back('\f');
+          break;
+        case 'u': {
+          std::uint32_t cp = 0;
+          if (!ReadHex4(cp)) {
+            return false;
+          }
+          // 代理对合成一个码点。
+          if (cp >= 0xD800 && cp < 0xDC00 && text_.substr(pos_, 2) == "\\u") {
+            pos_ += 2;
+            std::uint32_t low = 0;
+            if (!ReadHex4(low) || low < 0xDC00 || low >= 0xE000) {
+              return false;
+            }
+            cp = 0x10000 + ((cp - 0xD800) << 10U) + (low - 0xDC00);
+          }
+          AppendUtf8(cp, out);
+          break;
+        }
+        default:
+          out.push_back(e);
+          break;
+      }
+    }
+    return false;
+  }
+
+  // 跳过当前位置的一个完整值。
+  bool SkipValue() {
+    SkipWs();
+    if (pos_ >= text_.size()) {
+      return false;
+    }
+    const char c = text_[pos_];
+    if (c == '"') {
+      std::string unused;
+      return ReadString(unused);
+    }
+    if (c == '{') {
+      return ForEachMember([this](std::string_view) { return SkipValue(); });
+    }
+    if (c == '[') {
+      return ForEachElement([this](std::size_t) { return SkipValue(); });
+    }
+    const std::size_t start = pos_;
+    while (pos_ < text_.size() && std::string_view(",}] \t\r\n").find(text_[pos_]) == std::string_view::npos) {
+      ++pos_;
+    }
+    return pos_ > start;
+  }
+
+  // 当前位置须为对象；对每个键调用 on_member(key)，回调须消费该键的值并返回是否成功。
+  template <typename F>
+  bool ForEachMember(F&& on_member) {
+    if (!Peek('{')) {
+      return false;
+    }
+    ++pos_;
+    if (Peek('}')) {
+      ++pos_;
+      return true;
+    }
+    std::string key;
+    for (;;) {
+      if (!ReadString(key) || !Peek(':')) {
+        return false;
+      }
+      ++pos_;
+      if (!on_member(std::string_view(key))) {
+        return false;
+      }
+      if (Peek(',')) {
+        ++pos_;
+        continue;
+      }
+      if (Peek('}')) {
+        ++pos_;
+        return true;
+      }
+      return false;
+    }
+  }
+
+  // 当前位置须为数组；对每个元素调用 on_element(下标)，回调须消费该元素并返回是否成功。
+  template <typename F>
+  bool ForEachElement(F&& on_element) {
+    if (!Peek('[')) {
+      return false;
+    }
+    ++pos_;
+    if (Peek(']')) {
+      ++pos_;
+      return true;
+    }
+    for (std::size_t i = 0;; ++i) {
+      if (!on_element(i)) {
+        return false;
+      }
+      if (Peek(',')) {
+        ++pos_;
+        continue;
+      }
+      if (Peek(']')) {
+        ++pos_;
+        return true;
+      }
+      return false;
+    }
+  }
+
+ private:
+  void SkipWs() {
+    while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\r' ||
+                                   text_[pos_] == '\n')) {
+      ++pos_;
+    }
+  }
+
+  bool ReadHex4(std::uint32_t& out) {
+    if (text_.size() - pos_ < 4) {
+      return false;
+    }
+    out = 0;
+    for (int i = 0; i < 4; ++i) {
+      const char h = text_[pos_++];
+      out <<= 4U;
+      if (h >= '0' && h <= '9') {
+        out |= static_cast<std::uint32_t>(h - '0');
+      } else if (h >= 'a' && h <= 'f') {
+        out |= static_cast<std::uint32_t>(h - 'a' + 10);
+      } else if (h >= 'A' && h <= 'F') {
+        out |= static_cast<std::uint32_t>(h - 'A' + 10);
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static void AppendUtf8(std::uint32_t cp, std::string& out) {
+    if (cp < 0x80) {
+      out.push_back(static_cast<char>(cp));
+    } else if (cp < 0x800) {
+      out.push_back(static_cast<char>(0xC0 | (cp >> 6U)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3FU)));
+    } else if (cp < 0x10000) {
+      out.push_back(static_cast<char>(0xE0 | (cp >> 12U)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 6U) & 0x3FU)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3FU)));
+    } else {
+      out.push_back(static_cast<char>(0xF0 | (cp >> 18U)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 12U) & 0x3FU)));
+      out.push_back(static_cast<char>(0x80 | ((cp >> 6U) & 0x3FU)));
+      out.push_back(static_cast<char>(0x80 | (cp & 0x3FU)));
+    }
+  }
+
+  std::string_view text_;
+  std::size_t pos_ = 0;
+};
+
+// 当前位置为 chat 结果的 choices 数组：读取 choices[0].message.content，字段缺失时 content 保持为空。
+bool ReadFirstChoiceContent(JsonScanner& json, std::string& content) {
+  return json.ForEachElement([&](std::size_t choice) {
+    if (choice != 0) {
+      return json.SkipValue();
+    }
+    return json.ForEachMember([&](std::string_view field) {
+      if (field != "message") {
+        return json.SkipValue();
+      }
+      return json.ForEachMember([&](std::string_view name) {
+        if (name != "content" || !json.Peek('"')) {
+          return json.SkipValue();
+        }
+        return json.ReadString(content);
+      });
+    });
+  });
+}
+
+// 批量响应 {"responses":[<chat 结果>...]} 按下标对应请求；单条缺失、出错或格式不符只影响该条。
+std::vector<ModelBatchReply> ParseBatchReplies(std::string_view body, std::size_t count) {
+  std::vector<ModelBatchReply> replies(count);
+  std::vector<bool> seen(count, false);
+  JsonScanner json(body);
+  const bool parsed = json.ForEachMember([&](std::string_view key) {
+    if (key != "responses") {
+      return json.SkipValue();
+    }
+    return json.ForEachElement([&](std::size_t i) {
+      if (i >= count) {
+        return json.SkipValue();
+      }
+      seen[i] = true;
+      const std::size_t start = json.position();
+      std::string content;
+      bool item_error = false;
+      // 条目内的 error 字段（非 null）表示服务端单条失败。
+      const bool item_ok = json.ForEachMember([&](std::string_view field) {
+        if (field == "error") {
+          item_error = !json.Peek('n');
+          return json.SkipValue();
+        }
+        return field == "choices" ? ReadFirstChoiceContent(json, content) : json.SkipValue();
+      });
+      if (!item_ok) {
+        json.Seek(start);
+        replies[i].error = "模型批量响应第" + std::to_string(i) + "条格式错误，回退到候选0";
+        return json.SkipValue();
+      }
+      if (item_error) {
+        replies[i].error = "模型批量响应第" + std::to_string(i) + "条失败，回退到候选0";
+      } else if (content.empty()) {
+        replies[i].error = "模型响应解析失败，回退到候选0";
+      } else {
+        replies[i].content = std::move(content);
+      }
+      return true;
+    });
+  });
+  for (std::size_t i = 0; i < count; ++i) {
+    if (!parsed) {
+      replies[i] = {{}, "模型批量响应解析失败，回退到候选0"};
+    } else if (!seen[i]) {
+      replies[i].error = "模型批量响应缺少第" + std::to_string(i) + "条，回退到候选0";
+    }
+  }
+  return replies;
+}
+
+std::int64_t WallClockMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
 }  // namespace
 
+ModelRuntime::ModelRuntime()
+    : http_(std::make_shared<HttpClient>()), batch_unsupported_(std::make_shared<std::atomic<bool>>(false)) {}
+
 void ModelRuntime::Configure(const ModelConfig& config) {
   config_ = config;
+  batcher_.reset();
+  batch_unsupported_ = std::make_shared<std::atomic<bool>>(false);
+  if (config_.enable_batching) {
+    batcher_ = std::make_shared<ModelBatcher>(ModelBatchOptions{config_.batch_window_ms, config_.max_batch_size});
+  }
+  response_cache_.reset();
+  if (config_.enable_response_cache) {
+    response_cache_ = std::make_shared<ModelResponseCache>(config_.response_cache_capacity, config_.response_cache_ttl_ms);
+    if (!config_.response_cache_path.empty()) {
+      response_cache_->Load(config_.response_cache_path, WallClockMs());
+    }
+  }
+}
+
+ModelRuntime ModelRuntime::Fork() const {
+  ModelRuntime fork = *this;
+  if (batcher_ != nullptr) {
+    fork.batcher_ = std::make_shared<ModelBatcher>(ModelBatchOptions{config_.batch_window_ms, config_.max_batch_size});
+  }
+  if (response_cache_ != nullptr) {
+    fork.response_cache_ = response_cache_->Clone();
+  }
+  return fork;
+}
+
+void ModelRuntime::Absorb(const ModelRuntime& fork) const {
+  if (batcher_ != nullptr && fork.batcher_ != nullptr && fork.batcher_ != batcher_) {
+    batcher_->MergeStats(fork.batcher_->stats());
+  }
+  if (response_cache_ != nullptr && fork.response_cache_ != nullptr && fork.response_cache_ != response_cache_) {
+    response_cache_->Merge(*fork.response_cache_);
+  }
+}
+
+ModelResponseCacheStats ModelRuntime::response_cache_stats() const {
+  return response_cache_ != nullptr ? response_cache_->stats() : ModelResponseCacheStats{};
+}
+
+bool ModelRuntime::SaveResponseCache() const {
+  if (response_cache_ == nullptr || config_.response_cache_path.empty()) {
+    return false;
+  }
+  return response_cache_->Save(config_.response_cache_path);
+}
+
+ModelBatchStats ModelRuntime::batch_stats() const {
+  return batcher_ != nullptr ? batcher_->stats() : ModelBatchStats{};
 }
 
 ModelResponse ModelRuntime::RankAndExplain(const ModelRequest& request) const {
@@ -99,6 +441,16 @@ ModelResponse ModelRuntime::RankAndExplain(const ModelRequest& request) const {
   const std::string api_key = config_.api_key.empty() ? ReadEnvOrDefault("BAS_QWEN_API_KEY", "") : config_.api_key;
   const int timeout_ms = std::max(500, ReadIntEnvOrDefault("BAS_QWEN_TIMEOUT_MS", config_.timeout_ms));
 
+  std::string cache_key;
+  if (response_cache_ != nullptr) {
+    cache_key = ModelResponseCache::MakeKey(model_name, config_.max_tokens, request.candidate_summaries, request.tags);
+    if (const auto cached = response_cache_->Get(cache_key, WallClockMs()); cached.has_value()) {
+      response.selected_index = std::min(cached->selected_index, request.candidate_summaries.size() - 1);
+      response.explanation = cached->explanation;
+      return response;
+    }
+  }
+
   std::ostringstream candidate_lines;
   for (std::size_t i = 0; i < request.candidate_summaries.size(); ++i) {
     candidate_lines << i << ": " << request.candidate_summaries[i] << "\n";
@@ -117,46 +469,107 @@ ModelResponse ModelRuntime::RankAndExplain(const ModelRequest& request) const {
       "{\"role\":\"user\",\"content\":\"" +
       EscapeJson(prompt) + "\"}],\"temperature\":0.1,\"max_tokens\":" + std::to_string(config_.max_tokens) + "}";
 
-  const std::string temp_path = "/tmp/bas_model_request_" + std::to_string(::getpid()) + "_" +
-                                std::to_string(static_cast<long long>(std::time(nullptr))) + ".json";
+  CallSettings call;
+  call.endpoint = endpoint;
+  call.batch_endpoint = config_.batch_endpoint.empty() ? DeriveBatchEndpoint(endpoint) : config_.batch_endpoint;
+  call.headers = {{"Content-Type", "application/json"}};
+  if (!api_key.empty()) {
+    call.headers.emplace_back("Authorization", "Bearer " + api_key);
+  }
+  call.timeout_ms = timeout_ms;
+
+  // 载荷包含完整提示词，同一载荷的并发请求由合批器去重。
+  const ModelBatchReply reply =
+      batcher_ == nullptr
+          ? SendChat(payload, call)
+          : batcher_->Submit(payload, [this, &call](const std::vector<std::string>& payloads) {
+              return SendBatch(payloads, call);
+            });
+  if (!reply.error.empty()) {
+    response.selected_index = 0;
+    response.explanation = reply.error;
+    return response;
+  }
 
-  {
-    std::ofstream ofs(temp_path, std::ios::binary);
-    if (!ofs) {
-      response.selected_index = 0;
-      response.explanation = "创建临时请求文件失败，回退到候选0";
-      return response;
-    }
-    ofs << payload;
+  response.selected_index = ParseSelectedIndex(reply.content, request.candidate_summaries.size());
+  response.explanation = ExtractExplanation(reply.content);
+  // 只缓存模型真实给出的结果，回退说明不入缓存。
+  if (response_cache_ != nullptr) {
+    response_cache_->Put(cache_key, {response.selected_index, response.explanation}, WallClockMs());
   }
+  return response;
+}
 
-  std::ostringstream command;
-  command << "curl -sS --max-time " << (timeout_ms / 1000.0);
-  command << " -H \"Content-Type: application/json\"";
-  if (!api_key.empty()) {
-    command << " -H \"Authorization: Bearer " << api_key << "\"";
+ModelBatchReply ModelRuntime::SendChat(const std::string& payload, const CallSettings& call) const {
+  ModelBatchReply reply;
+  const HttpResponse http_response = http_->Post(call.endpoint, payload, call.headers, call.timeout_ms);
+  if (!http_response.error.empty()) {
+    reply.error = "模型调用失败（" + http_response.error + "），回退到候选0";
+    return reply;
+  }
+  if (!http_response.ok()) {
+    reply.error = "模型服务返回HTTP " + std::to_string(http_response.status) + "，回退到候选0";
+    return reply;
+  }
+  if (http_response.body.empty()) {
+    reply.error = "模型调用返回空响应，回退到候选0";
+    return reply;
   }
-  command << " --data @" << temp_path << " \"" << endpoint << "\" 2>/dev/null";
 
-  const std::string raw = RunCommand(command.str());
-  std::remove(temp_path.c_str());
+  reply.content = ExtractAssistantContent(http_response.body);
+  if (reply.content.empty()) {
+    reply.error = "模型响应解析失败，回退到候选0";
+  }
+  return reply;
+}
 
-  if (raw.empty()) {
-    response.selected_index = 0;
-    response.explanation = "模型调用返回空响应，回退到候选0";
-    return response;
+std::vector<ModelBatchReply> ModelRuntime::SendBatch(const std::vector<std::string>& payloads,
+                                                     const CallSettings& call) const {
+  // 逐条回退共用一个截止时间，整批耗时不超过单次调用的超时。
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(call.timeout_ms);
+  const auto send_each = [this, &payloads, &call, deadline] {
+    std::vector<ModelBatchReply> replies;
+    replies.reserve(payloads.size());
+    CallSettings single = call;
+    for (const auto& payload : payloads) {
+      const auto remaining =
+          std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+      if (remaining <= 0) {
+        replies.push_back({{}, "模型调用超时，回退到候选0"});
+        continue;
+      }
+      single.timeout_ms = static_cast<int>(remaining);
+      replies.push_back(SendChat(payload, single));
+    }
+    return replies;
+  };
+  if (payloads.size() == 1 || batch_unsupported_->load()) {
+    return send_each();
   }
 
-  const std::string content = ExtractAssistantContent(raw);
-  if (content.empty()) {
-    response.selected_index = 0;
-    response.explanation = "模型响应解析失败，回退到候选0";
-    return response;
+  // 批量接口请求体：{"requests":[<chat 请求体>...]}；响应 "responses" 数组按序给出各条 chat 结果。
+  std::string body = "{\"requests\":[";
+  for (std::size_t i = 0; i < payloads.size(); ++i) {
+    body += (i == 0 ? "" : ",") + payloads[i];
   }
+  body += "]}";
 
-  response.selected_index = ParseSelectedIndex(content, request.candidate_summaries.size());
-  response.explanation = ExtractExplanation(content);
-  return response;
+  const HttpResponse http_response = http_->Post(call.batch_endpoint, body, call.headers, call.timeout_ms);
+  if (http_response.error.empty() && http_response.status == 404) {
+    batch_unsupported_->store(true);
+    return send_each();
+  }
+
+  if (!http_response.error.empty()) {
+    return std::vector<ModelBatchReply>(
+        payloads.size(), ModelBatchReply{{}, "模型批量调用失败（" + http_response.error + "），回退到候选0"});
+  }
+  if (!http_response.ok()) {
+    return std::vector<ModelBatchReply>(
+        payloads.size(),
+        ModelBatchReply{{}, "模型服务返回HTTP " + std::to_string(http_response.status) + "，回退到候选0"});
+  }
+  return ParseBatchReplies(http_response.body, payloads.size());
 }
 
 std::string ModelRuntime::EscapeJson(const std::string& text) {
@@ -186,27 +599,14 @@ std::string ModelRuntime::EscapeJson(const std::string& text) {
   return oss.str();
 }
 
-std::string ModelRuntime::RunCommand(const std::string& command) {
-  std::array<char, 512> buffer{};
-  std::string output;
-  FILE* pipe = popen(command.c_str(), "r");
-  if (pipe == nullptr) {
-    return output;
-  }
-  while (fgets(buffer.data(), static_cast<int>(buffer.size()), pipe) != nullptr) {
-    output += buffer.data();
-  }
-  pclose(pipe);
-  return output;
-}
-
 std::string ModelRuntime::ExtractAssistantContent(const std::string& json_text) {
-  const std::regex content_re("\"content\"\\s*:\\s*\"((?:\\\\.|[^\"\\\\])*)\"");
-  std::smatch match;
-  if (!std::regex_search(json_text, match, content_re) || match.size() < 2) {
-    return {};
-  }
-  return UnescapeJsonString(match[1].str());
+  // 与批量响应共用扫描器，只取 choices[0].message.content，其他字段中的同名键不会被误取。
+  std::string content;
+  JsonScanner json(json_text);
+  const bool parsed = json.ForEachMember([&](std::string_view key) {
+    return key == "choices" ? ReadFirstChoiceContent(json, content) : json.SkipValue();
+  });
+  return parsed ? content : std::string{};
 }
 
 std::string ModelRuntime::ExtractExplanation(const std::string& text) {
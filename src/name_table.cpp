@@ -0,0 +1,48 @@
+#include "bas/common/name_table.hpp"
+
+#include <mutex>
+
+namespace bas {
+
+std::uint32_t NameTable::Intern(std::string_view name) {
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const auto it = index_.find(name);
+    if (it != index_.end()) {
+      return it->second;
+    }
+  }
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  const auto it = index_.find(name);
+  if (it != index_.end()) {
+    return it->second;
+  }
+  // deque 保证已驻留字符串地址稳定，可直接作为索引键。
+  names_.emplace_back(name);
+  const auto slot = static_cast<std::uint32_t>(names_.size());
+  index_.emplace(std::string_view(names_.back()), slot);
+  return slot;
+}
+
+std::string NameTable::Name(std::uint32_t slot) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  if (slot == 0 || slot > names_.size()) {
+    return {};
+  }
+  return names_[slot - 1];
+}
+
+namespace {
+
+NameTable& WeaponNames() {
+  static NameTable table;
+  return table;
+}
+
+}  // namespace
+
+std::uint32_t InternWeaponName(std::string_view name) { return name.empty() ? 0 : WeaponNames().Intern(name); }
+
+std::string WeaponNameOf(std::uint32_t id) { return WeaponNames().Name(id); }
+
+}  // namespace bas
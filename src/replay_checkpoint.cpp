@@ -0,0 +1,237 @@
+#include "bas/system/replay_checkpoint.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string_view>
+
+#include "bas/common/binary_io.hpp"
+
+namespace bas {
+
+namespace {
+
+// 魔数、版本、乱序窗口、标志（位0=.bas 单调）、源文件长度、源文件修改时间、读块大小、尾部偏移。
+constexpr std::size_t kHeaderBytes = 48;
+constexpr std::size_t kIndexEntryBytes = 16;
+constexpr std::size_t kTableEntryBytes = 40;
+
+[[noreturn]] void Corrupt(const std::string& path, const std::string& detail) {
+  throw std::runtime_error("检查点文件损坏: " + path + "（" + detail + "）");
+}
+
+std::uint64_t SourceBytes(const std::string& source_path) {
+  return static_cast<std::uint64_t>(std::filesystem::file_size(source_path));
+}
+
+std::int64_t SourceMtime(const std::string& source_path) {
+  return static_cast<std::int64_t>(std::filesystem::last_write_time(source_path).time_since_epoch().count());
+}
+
+bool ParseTimestamp(std::string_view field, std::int64_t& out) {
+  while (!field.empty() && (field.front() == ' ' || field.front() == '\t')) {
+    field.remove_prefix(1);
+  }
+  while (!field.empty() && (field.back() == ' ' || field.back() == '\t' || field.back() == '\r')) {
+    field.remove_suffix(1);
+  }
+  if (field.size() > 1 && field.front() == '+') {
+    field.remove_prefix(1);
+  }
+  const char* end = field.data() + field.size();
+  const auto [ptr, ec] = std::from_chars(field.data(), end, out);
+  return !field.empty() && ec == std::errc() && ptr == end;
+}
+
+}  // namespace
+
+ReplayFrameIndex BuildTextFrameIndex(const std::string& path) {
+  const MappedFile file(path);
+  const std::string_view text(reinterpret_cast<const char*>(file.view().data()), file.size());
+  ReplayFrameIndex index;
+  std::size_t pos = 0;
+  while (pos < text.size()) {
+    const std::size_t nl = text.find('\n', pos);
+    const std::size_t line_end = nl == std::string_view::npos ? text.size() : nl;
+    const std::string_view line = text.substr(pos, line_end - pos);
+    const std::size_t line_offset = pos;
+    pos = line_end + 1;
+
+    const std::size_t first = line.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos || line[first] == '#') {
+      continue;
+    }
+    const std::size_t c1 = line.find(',');
+    if (c1 == std::string_view::npos) {
+      continue;
+    }
+    const std::size_t c2 = line.find(',', c1 + 1);
+    std::int64_t ts = 0;
+    if (!ParseTimestamp(line.substr(c1 + 1, c2 == std::string_view::npos ? std::string_view::npos : c2 - c1 - 1),
+                        ts)) {
+      continue;
+    }
+    if (!index.entries.empty() && ts == index.entries.back().timestamp_ms) {
+      continue;
+    }
+    if (!index.entries.empty() && ts < index.entries.back().timestamp_ms) {
+      // 时间戳回退：同一帧的记录分散在文件各处，无法按行偏移续读。
+      index.monotonic = false;
+      index.entries.clear();
+      break;
+    }
+    index.entries.push_back({ts, line_offset});
+  }
+  return index;
+}
+
+ReplayCheckpointWriter::ReplayCheckpointWriter(const std::string& path,
+                                               const std::string& source_path,
+                                               std::uint32_t reorder_window,
+                                               std::uint64_t chunk_bytes)
+    : path_(path), temp_path_(path + ".tmp") {
+  BinaryWriter header;
+  header.Put(kReplayCheckpointMagic);
+  header.Put(kReplayCheckpointVersion);
+  header.Put(reorder_window);
+  header.Put(std::uint32_t{0});
+  header.Put(SourceBytes(source_path));
+  header.Put(SourceMtime(source_path));
+  header.Put(chunk_bytes);
+  header.Put(std::uint64_t{0});
+  header_ = std::move(header.bytes());
+
+  out_.open(temp_path_, std::ios::binary | std::ios::trunc);
+  if (!out_) {
+    throw std::runtime_error("无法写入检查点文件: " + temp_path_);
+  }
+  // 文件头在 Finish 时回填标志与尾部偏移。
+  out_.write(reinterpret_cast<const char*>(header_.data()), static_cast<std::streamsize>(header_.size()));
+  written_ = header_.size();
+}
+
+ReplayCheckpointWriter::~ReplayCheckpointWriter() {
+  if (out_.is_open()) {
+    out_.close();
+    std::error_code ec;
+    std::filesystem::remove(temp_path_, ec);
+  }
+}
+
+void ReplayCheckpointWriter::Add(const ReplayCheckpoint& checkpoint) {
+  if (!table_.empty() && checkpoint.timestamp_ms < table_.back().timestamp_ms) {
+    throw std::runtime_error("检查点须按时间戳升序追加");
+  }
+  out_.write(reinterpret_cast<const char*>(checkpoint.state.data()),
+             static_cast<std::streamsize>(checkpoint.state.size()));
+  table_.push_back({checkpoint.timestamp_ms, checkpoint.frames, checkpoint.resume_offset, written_,
+                    checkpoint.state.size()});
+  written_ += checkpoint.state.size();
+}
+
+void ReplayCheckpointWriter::Finish(const ReplayFrameIndex& index) {
+  BinaryWriter footer;
+  footer.PutSize(index.entries.size());
+  for (const auto& entry : index.entries) {
+    footer.Put(entry.timestamp_ms);
+    footer.Put(entry.offset);
+  }
+  footer.PutSize(table_.size());
+  for (const auto& entry : table_) {
+    footer.Put(entry.timestamp_ms);
+    footer.Put(entry.frames);
+    footer.Put(entry.resume_offset);
+    footer.Put(entry.state_offset);
+    footer.Put(entry.state_bytes);
+  }
+  out_.write(reinterpret_cast<const char*>(footer.bytes().data()), static_cast<std::streamsize>(footer.bytes().size()));
+
+  const std::uint32_t flags = index.monotonic ? 1U : 0U;
+  std::memcpy(header_.data() + 12, &flags, sizeof(flags));
+  std::memcpy(header_.data() + 40, &written_, sizeof(written_));
+  out_.seekp(0);
+  out_.write(reinterpret_cast<const char*>(header_.data()), static_cast<std::streamsize>(header_.size()));
+  out_.close();
+  if (!out_) {
+    throw std::runtime_error("检查点文件写入失败: " + temp_path_);
+  }
+  std::filesystem::rename(temp_path_, path_);
+}
+
+ReplayCheckpointReader::ReplayCheckpointReader(const std::string& path) : file_(path) {
+  if (file_.size() < kHeaderBytes || std::memcmp(file_.view().data(), kReplayCheckpointMagic, 4) != 0) {
+    Corrupt(path, "文件头无效");
+  }
+  BinaryReader header(file_.view().subview(4, kHeaderBytes - 4));
+  const auto version = header.Get<std::uint32_t>();
+  if (version != kReplayCheckpointVersion) {
+    throw std::runtime_error("不支持的检查点版本: " + std::to_string(version));
+  }
+  reorder_window_ = header.Get<std::uint32_t>();
+  index_.monotonic = (header.Get<std::uint32_t>() & 1U) != 0;
+  source_bytes_ = header.Get<std::uint64_t>();
+  source_mtime_ = header.Get<std::int64_t>();
+  chunk_bytes_ = header.Get<std::uint64_t>();
+  const auto footer_offset = header.Get<std::uint64_t>();
+  if (footer_offset < kHeaderBytes || footer_offset > file_.size()) {
+    Corrupt(path, "尾部偏移越界");
+  }
+
+  BinaryReader footer(file_.view().subview(footer_offset, file_.size() - footer_offset));
+  try {
+    index_.entries.resize(footer.GetSize(kIndexEntryBytes));
+    for (auto& entry : index_.entries) {
+      entry.timestamp_ms = footer.Get<std::int64_t>();
+      entry.offset = footer.Get<std::uint64_t>();
+    }
+    table_.resize(footer.GetSize(kTableEntryBytes));
+    for (auto& entry : table_) {
+      entry.timestamp_ms = footer.Get<std::int64_t>();
+      entry.frames = footer.Get<std::uint64_t>();
+      entry.resume_offset = footer.Get<std::uint64_t>();
+      entry.state_offset = footer.Get<std::uint64_t>();
+      entry.state_bytes = footer.Get<std::uint64_t>();
+    }
+  } catch (const std::runtime_error&) {
+    Corrupt(path, "尾部截断");
+  }
+  if (footer.remaining() != 0) {
+    Corrupt(path, "文件长度不符");
+  }
+  for (const auto& entry : table_) {
+    if (entry.state_offset < kHeaderBytes || entry.state_offset > footer_offset ||
+        entry.state_bytes > footer_offset - entry.state_offset) {
+      Corrupt(path, "状态块越界");
+    }
+  }
+  if (!std::is_sorted(table_.begin(), table_.end(),
+                      [](const auto& a, const auto& b) { return a.timestamp_ms < b.timestamp_ms; })) {
+    Corrupt(path, "检查点表未按时间排序");
+  }
+}
+
+bool ReplayCheckpointReader::Matches(const std::string& source_path, std::uint32_t reorder_window) const {
+  std::error_code ec;
+  const auto bytes = std::filesystem::file_size(source_path, ec);
+  if (ec || bytes != source_bytes_ || reorder_window != reorder_window_) {
+    return false;
+  }
+  const auto mtime = std::filesystem::last_write_time(source_path, ec);
+  return !ec && static_cast<std::int64_t>(mtime.time_since_epoch().count()) == source_mtime_;
+}
+
+std::optional<ReplayCheckpoint> ReplayCheckpointReader::Find(std::int64_t timestamp_ms) const {
+  const auto it = std::upper_bound(table_.begin(), table_.end(), timestamp_ms,
+                                   [](std::int64_t ts, const ReplayCheckpointEntry& e) { return ts < e.timestamp_ms; });
+  if (it == table_.begin()) {
+    return std::nullopt;
+  }
+  const ReplayCheckpointEntry& entry = *std::prev(it);
+  const std::uint8_t* state = file_.view().data() + entry.state_offset;
+  return ReplayCheckpoint{entry.timestamp_ms, entry.frames, entry.resume_offset,
+                          std::vector<std::uint8_t>(state, state + entry.state_bytes)};
+}
+
+}  // namespace bas
@@ -0,0 +1,64 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bas/common/mapped_file.hpp"
+#include "bas/dis/dis_binary_parser.hpp"
+#include "bas/system/columnar_replay.hpp"
+#include "bas/system/replay_runner.hpp"
+#include "bas/system/scenario_replay.hpp"
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cerr << "用法: bas_replay_convert <输入回放(.bas/.bin/.dis/.disbin)> <输出文件(.basc)>\n";
+    return EXIT_FAILURE;
+  }
+  const std::string input = argv[1];
+  const std::string output = argv[2];
+
+  try {
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<bas::DisPduBatch> batches;
+    if (bas::IsBinaryReplay(input)) {
+      batches = bas::DisBinaryParser{}.ParseFile(input);
+    } else {
+      batches = bas::ScenarioReplayLoader{}.LoadBatches(input);
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    bas::WriteColumnarReplay(batches, output);
+    const auto t2 = std::chrono::steady_clock::now();
+
+    // 回读一遍，确认输出可被加载器完整解码。
+    const bas::ColumnarReplayReader reader(output);
+    const auto loaded = reader.LoadBatches();
+    const auto t3 = std::chrono::steady_clock::now();
+    if (loaded.size() != batches.size()) {
+      std::cerr << "转换校验失败: 帧数不一致\n";
+      return EXIT_FAILURE;
+    }
+
+    std::size_t entity_count = 0;
+    std::size_t fire_count = 0;
+    for (const auto& batch : batches) {
+      entity_count += batch.entity_updates.size();
+      fire_count += batch.fire_events.size();
+    }
+    const auto ms = [](auto a, auto b) { return std::chrono::duration<double, std::milli>(b - a).count(); };
+    std::cout << "输入文件: " << input << "\n";
+    std::cout << "输出文件: " << output << "\n";
+    std::cout << "时间帧数: " << batches.size() << "\n";
+    std::cout << "实体状态记录数: " << entity_count << "\n";
+    std::cout << "开火记录数: " << fire_count << "\n";
+    std::cout << "输出大小(MB): " << static_cast<double>(bas::MappedFile(output).size()) / (1024.0 * 1024.0) << "\n";
+    std::cout << "源格式加载耗时(毫秒): " << ms(t0, t1) << "\n";
+    std::cout << "写出耗时(毫秒): " << ms(t1, t2) << "\n";
+    std::cout << "列式加载耗时(毫秒): " << ms(t2, t3) << "\n";
+  } catch (const std::exception& e) {
+    std::cerr << "回放转换失败: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
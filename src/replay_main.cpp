@@ -1,17 +1,14 @@
-#include <algorithm>
-#include <chrono>
+#include <cstdint>
 #include <cstdlib>
+#include <exception>
 #include <iostream>
-#include <numeric>
+#include <optional>
 #include <string>
 #include <vector>
 
-#include "bas/dis/dis_binary_parser.hpp"
-#include "bas/dis/dis_adapter.hpp"
 #include "bas/inference/model_runtime.hpp"
 #include "bas/system/agent_pipeline.hpp"
-#include "bas/system/replay_metrics.hpp"
-#include "bas/system/scenario_replay.hpp"
+#include "bas/system/replay_runner.hpp"
 
 namespace {
 
@@ -23,103 +20,210 @@ bas::ModelBackend ResolveBackend() {
   return bas::ModelBackend::Mock;
 }
 
-bool IsBinaryReplay(const std::string& path) {
-  const auto pos = path.find_last_of('.');
-  if (pos == std::string::npos) {
-    return false;
-  }
-  const std::string ext = path.substr(pos + 1);
-  return ext == "bin" || ext == "dis" || ext == "disbin";
+void PrintStage(const char* name, const bas::StageLatency& stage) {
+  std::cout << " " << name << "=" << stage.mean_ms() << "/" << stage.max_ms;
 }
 
 }  // namespace
 
 int main(int argc, char** argv) {
-  if (argc < 2) {
-    std::cerr << "用法: bas_replay <回放文件路径>\n";
-    return EXIT_FAILURE;
-  }
-
-  const std::string replay_file = argv[1];
-
-  std::vector<bas::DisPduBatch> batches;
-  try {
-    if (IsBinaryReplay(replay_file)) {
-      bas::DisBinaryParser parser;
-      batches = parser.ParseFile(replay_file);
+  const char* usage =
+      "用法: bas_replay <回放文件路径> | --batch <目录或清单> [--threads <线程数>] [--reorder-window <时间戳单位>] "
+      "[--async-model] [--model-batch-window <毫秒>] [--model-cache <文件>] [--similar-reuse <阈值>] [--staged] "
+      "[--maneuver-threads <线程数>] [--checkpoint-every <毫秒>] [--from <时间戳毫秒>] [--to <时间戳毫秒>]\n";
+  std::string replay_file;
+  std::string batch_input;
+  std::size_t threads = 0;
+  std::uint32_t reorder_window = 0;
+  bool async_model = false;
+  int batch_window_ms = -1;
+  std::string model_cache_path;
+  double similar_threshold = -1.0;
+  bool staged = false;
+  std::size_t maneuver_threads = 0;
+  std::int64_t checkpoint_every_ms = 0;
+  std::optional<std::int64_t> from_ms;
+  std::optional<std::int64_t> to_ms;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--batch" && i + 1 < argc) {
+      batch_input = argv[++i];
+    } else if (arg == "--threads" && i + 1 < argc) {
+      threads = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--reorder-window" && i + 1 < argc) {
+      reorder_window = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--async-model") {
+      async_model = true;
+    } else if (arg == "--model-batch-window" && i + 1 < argc) {
+      batch_window_ms = std::atoi(argv[++i]);
+    } else if (arg == "--model-cache" && i + 1 < argc) {
+      model_cache_path = argv[++i];
+    } else if (arg == "--similar-reuse" && i + 1 < argc) {
+      similar_threshold = std::strtod(argv[++i], nullptr);
+    } else if (arg == "--staged") {
+      // 分阶段：接收解析、融合决策、模型排序分别在不同线程上重叠执行。
+      staged = true;
+      async_model = true;
+    } else if (arg == "--maneuver-threads" && i + 1 < argc) {
+      maneuver_threads = static_cast<std::size_t>(std::strtoul(argv[++i], nullptr, 10));
+    } else if (arg == "--checkpoint-every" && i + 1 < argc) {
+      checkpoint_every_ms = std::strtoll(argv[++i], nullptr, 10);
+    } else if (arg == "--from" && i + 1 < argc) {
+      from_ms = std::strtoll(argv[++i], nullptr, 10);
+    } else if (arg == "--to" && i + 1 < argc) {
+      to_ms = std::strtoll(argv[++i], nullptr, 10);
+    } else if (replay_file.empty() && arg.rfind("--", 0) != 0) {
+      replay_file = arg;
     } else {
-      bas::ScenarioReplayLoader loader;
-      batches = loader.LoadBatches(replay_file);
+      std::cerr << "未知参数: " << arg << "\n";
+      return EXIT_FAILURE;
     }
-  } catch (const std::exception& e) {
-    std::cerr << "回放加载失败: " << e.what() << "\n";
-    return EXIT_FAILURE;
   }
-
-  if (batches.empty()) {
-    std::cerr << "回放文件中没有有效帧\n";
+  if (replay_file.empty() == batch_input.empty()) {
+    std::cerr << usage;
     return EXIT_FAILURE;
   }
 
   bas::ModelRuntime model_runtime;
   const bas::ModelBackend backend = ResolveBackend();
   const int timeout_ms = (backend == bas::ModelBackend::OpenAICompatible) ? 120000 : 250;
-  model_runtime.Configure(
-      {backend, "Qwen1.5-1.8B-Chat", 192, true, "http://127.0.0.1:8000/v1/chat/completions", "", timeout_ms});
-
-  bas::AgentPipeline pipeline({3000, 5 * 60 * 1000}, bas::FireControlEngine{}, bas::ManeuverEngine{}, model_runtime);
-  bas::DisAdapter adapter;
-  bas::ReplayMetricsEvaluator metrics;
-
-  std::vector<double> latencies_ms;
-  std::size_t ticks = 0;
-  std::size_t decisions = 0;
-  std::size_t cache_hits = 0;
+  bas::ModelConfig model_config{
+      backend, "Qwen1.5-1.8B-Chat", 192, true, "http://127.0.0.1:8000/v1/chat/completions", "", timeout_ms};
+  if (batch_window_ms >= 0) {
+    model_config.enable_batching = true;
+    model_config.batch_window_ms = batch_window_ms;
+  }
+  if (!model_cache_path.empty()) {
+    // 回归回放反复运行同一场景，缓存不设过期。
+    model_config.enable_response_cache = true;
+    model_config.response_cache_ttl_ms = 0;
+    model_config.response_cache_path = model_cache_path;
+  }
+  model_runtime.Configure(model_config);
+
+  bas::ReplayOptions options;
+  options.reorder_window = reorder_window;
+  options.staged_ingest = staged;
+  options.checkpoint_interval_ms = checkpoint_every_ms;
+  options.from_ms = from_ms;
+  options.to_ms = to_ms;
+  options.pipeline.async_model = async_model;
+  options.pipeline.parallel_stages = staged;
+  options.pipeline.maneuver_threads = maneuver_threads;
+  if (similar_threshold >= 0.0) {
+    options.pipeline.similarity_reuse = true;
+    options.pipeline.similarity_threshold = similar_threshold;
+  }
+  const char* backend_name = backend == bas::ModelBackend::OpenAICompatible ? "OpenAI兼容接口" : "模拟后端";
 
-  for (const auto& batch : batches) {
-    adapter.Ingest(batch);
-    const auto snapshot = adapter.Poll();
-    if (!snapshot.has_value()) {
-      continue;
+  const auto print_model_stats = [&] {
+    if (model_config.enable_batching) {
+      const bas::ModelBatchStats batch = model_runtime.batch_stats();
+      std::cout << "模型合批: 请求=" << batch.requests << "，去重=" << batch.deduplicated << "，批次=" << batch.batches
+                << "，最大批=" << batch.largest_batch << "\n";
     }
-
-    metrics.ObserveSnapshot(*snapshot);
-
-    const auto t0 = std::chrono::steady_clock::now();
-    const bas::DecisionPackage decision = pipeline.Tick(*snapshot, adapter.DrainEvents());
-    const auto t1 = std::chrono::steady_clock::now();
-    metrics.ObserveDecision(snapshot->timestamp_ms, decision);
-
-    ++ticks;
-    ++decisions;
-    if (decision.from_cache) {
-      ++cache_hits;
+    if (model_config.enable_response_cache) {
+      const bas::ModelResponseCacheStats cache_stats = model_runtime.response_cache_stats();
+      std::cout << "模型响应缓存: 命中=" << cache_stats.hits << "，未命中=" << cache_stats.misses
+                << "，加载=" << cache_stats.loaded << "，条目=" << cache_stats.entries << "\n";
+      if (!model_runtime.SaveResponseCache()) {
+        std::cerr << "模型响应缓存写入失败: " << model_cache_path << "\n";
+      }
     }
-
-    latencies_ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+  };
+
+  if (!batch_input.empty()) {
+    std::vector<std::string> inputs;
+    try {
+      inputs = bas::CollectReplayInputs(batch_input);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << "\n";
+      return EXIT_FAILURE;
+    }
+    if (inputs.empty()) {
+      std::cerr << "未找到回放文件: " << batch_input << "\n";
+      return EXIT_FAILURE;
+    }
+    const bas::ReplayBatchReport report = bas::RunReplayBatch(inputs, options, model_runtime, threads);
+    std::cout << "批量回放: " << batch_input << "\n";
+    std::cout << "模型后端: " << backend_name << "\n";
+    for (const auto& run : report.scenarios) {
+      if (!run.error.empty()) {
+        std::cout << "场景: " << run.path << " 失败: " << run.error << "\n";
+        continue;
+      }
+      std::cout << "场景: " << run.path << " 帧数=" << run.frames << " 决策=" << run.decisions
+                << " 生存率=" << run.metrics.survival_rate << "% 敌方损失=" << run.metrics.total_hostile_losses
+                << " 命中贡献率=" << run.metrics.hit_contribution_rate << "% 平均时延(毫秒)=" << run.avg_latency_ms
+                << "\n";
+    }
+    std::cout << "场景数: " << report.scenarios.size() << "，失败: " << report.failed << "\n";
+    std::cout << "总帧数: " << report.frames << "\n";
+    std::cout << "决策总数: " << report.decisions << "\n";
+    if (report.decisions > 0) {
+      std::cout << "缓存命中率: "
+                << (100.0 * static_cast<double>(report.cache_hits) / static_cast<double>(report.decisions)) << "%\n";
+    }
+    print_model_stats();
+    std::cout << "平均时延(毫秒): " << report.avg_latency_ms << "\n";
+    std::cout << "95分位时延(毫秒): " << report.p95_latency_ms << "\n";
+    std::cout << "总耗时(毫秒): " << report.wall_ms << "\n";
+    std::cout << "初始我方兵力: " << report.initial_friendly << "\n";
+    std::cout << "最终存活我方兵力: " << report.final_friendly_alive << "\n";
+    std::cout << "合并生存率: " << report.survival_rate << "%\n";
+    std::cout << "敌方损失数: " << report.hostile_losses << "\n";
+    std::cout << "合并命中贡献率: " << report.hit_contribution_rate << "%\n";
+    return report.failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
   }
 
-  if (decisions == 0 || latencies_ms.empty()) {
-    std::cerr << "回放未产生有效决策\n";
+  const bas::ReplayRunResult run = bas::RunReplay(replay_file, options, model_runtime);
+  if (!run.error.empty()) {
+    std::cerr << run.error << "\n";
     return EXIT_FAILURE;
   }
-
-  std::sort(latencies_ms.begin(), latencies_ms.end());
-  const double avg_ms = std::accumulate(latencies_ms.begin(), latencies_ms.end(), 0.0) /
-                        static_cast<double>(latencies_ms.size());
-  const std::size_t p95_index = static_cast<std::size_t>(latencies_ms.size() * 0.95);
-  const double p95_ms = latencies_ms[std::min(p95_index, latencies_ms.size() - 1)];
-  const bas::ReplayMetricsResult metric_result = metrics.Finalize();
+  const bas::ReplayMetricsResult& metric_result = run.metrics;
 
   std::cout << "回放文件: " << replay_file << "\n";
-  std::cout << "模型后端: " << (backend == bas::ModelBackend::OpenAICompatible ? "OpenAI兼容接口" : "模拟后端")
-            << "\n";
-  std::cout << "帧数: " << batches.size() << "\n";
-  std::cout << "决策循环次数: " << ticks << "\n";
-  std::cout << "决策总数: " << decisions << "\n";
-  std::cout << "缓存命中率: " << (100.0 * static_cast<double>(cache_hits) / static_cast<double>(decisions)) << "%\n";
-  std::cout << "平均时延(毫秒): " << avg_ms << "\n";
-  std::cout << "95分位时延(毫秒): " << p95_ms << "\n";
+  std::cout << "模型后端: " << backend_name << "\n";
+  if (from_ms.has_value() || to_ms.has_value()) {
+    std::cout << "回放时段(毫秒): " << (from_ms.has_value() ? std::to_string(*from_ms) : "开始") << " - "
+              << (to_ms.has_value() ? std::to_string(*to_ms) : "结束") << "\n";
+    if (run.resumed_from_ms.has_value()) {
+      std::cout << "检查点续放: 自 " << *run.resumed_from_ms << " 毫秒\n";
+    } else if (from_ms.has_value()) {
+      std::cout << "检查点续放: 无可用检查点，从头回放\n";
+    }
+  }
+  if (from_ms.has_value()) {
+    std::cout << "定位耗时(毫秒): " << run.seek_ms << "\n";
+  }
+  if (run.checkpoints_written > 0) {
+    std::cout << "检查点数: " << run.checkpoints_written << "\n";
+  }
+  std::cout << "帧数: " << run.frames << "\n";
+  std::cout << "决策循环次数: " << run.ticks << "\n";
+  std::cout << "决策总数: " << run.decisions << "\n";
+  std::cout << "首个决策产出时间(毫秒): " << run.first_decision_ms << "\n";
+  std::cout << "缓存命中率: " << (100.0 * static_cast<double>(run.cache_hits) / static_cast<double>(run.decisions))
+            << "%\n";
+  if (async_model) {
+    std::cout << "异步模型结果数: " << run.model_updates << "\n";
+  }
+  if (options.pipeline.similarity_reuse) {
+    std::cout << "相似复用: 查询=" << run.similar.lookups << "，复用=" << run.similar.reused
+              << "，校验拒绝=" << run.similar.rejected << "\n";
+  }
+  print_model_stats();
+  std::cout << "平均时延(毫秒): " << run.avg_latency_ms << "\n";
+  std::cout << "95分位时延(毫秒): " << run.p95_latency_ms << "\n";
+  std::cout << "阶段时延(平均/最大 毫秒):";
+  PrintStage("融合", run.stages.fusion);
+  PrintStage("火力", run.stages.fire);
+  PrintStage("机动", run.stages.maneuver);
+  PrintStage("火力机动合计", run.stages.decision);
+  PrintStage("上下文", run.stages.context);
+  PrintStage("模型", run.stages.model);
+  std::cout << "\n";
   std::cout << "初始我方兵力: " << metric_result.initial_friendly_count << "\n";
   std::cout << "最终存活我方兵力: " << metric_result.final_friendly_alive << "\n";
   std::cout << "生存率: " << metric_result.survival_rate << "%\n";
@@ -32,7 +32,7 @@ void ReplayMetricsEvaluator::ObserveSnapshot(const BattlefieldSnapshot& snapshot
 
       auto shots_it = shots_by_target_.find(unit.id);
       if (shots_it != shots_by_target_.end()) {
-        std::unordered_set<std::string> unique_shooters;
+        std::unordered_set<EntityId> unique_shooters;
         for (const auto& shot : shots_it->second) {
           if (snapshot.timestamp_ms - shot.timestamp_ms <= kill_credit_window_ms_) {
             unique_shooters.insert(shot.shooter_id);
@@ -76,6 +76,78 @@ ReplayMetricsResult ReplayMetricsEvaluator::Finalize() const {
   return out;
 }
 
+namespace {
+
+void WriteAliveMap(BinaryWriter& out, const std::unordered_map<EntityId, bool>& states) {
+  out.PutSize(states.size());
+  for (const auto& [id, alive] : states) {
+    out.PutId(id);
+    out.PutBool(alive);
+  }
+}
+
+std::unordered_map<EntityId, bool> ReadAliveMap(BinaryReader& in) {
+  std::unordered_map<EntityId, bool> states;
+  const std::size_t count = in.GetSize();
+  for (std::size_t i = 0; i < count; ++i) {
+    const EntityId id = in.GetId();
+    states[id] = in.GetBool();
+  }
+  return states;
+}
+
+}  // namespace
+
+void ReplayMetricsEvaluator::SaveState(BinaryWriter& out) const {
+  out.PutBool(initialized_);
+  WriteAliveMap(out, friendly_alive_state_);
+  WriteAliveMap(out, hostile_alive_state_);
+  out.PutSize(shots_by_target_.size());
+  for (const auto& [target, shots] : shots_by_target_) {
+    out.PutId(target);
+    out.PutSize(shots.size());
+    for (const auto& shot : shots) {
+      out.Put(shot.timestamp_ms);
+      out.PutId(shot.shooter_id);
+    }
+  }
+  out.PutSize(shooter_kill_credit_.size());
+  for (const auto& [shooter, credit] : shooter_kill_credit_) {
+    out.PutId(shooter);
+    out.Put(credit);
+  }
+  out.PutSize(initial_friendly_count_);
+  out.PutSize(final_friendly_alive_);
+  out.PutSize(total_hostile_losses_);
+  out.Put(credited_losses_);
+}
+
+void ReplayMetricsEvaluator::RestoreState(BinaryReader& in) {
+  initialized_ = in.GetBool();
+  friendly_alive_state_ = ReadAliveMap(in);
+  hostile_alive_state_ = ReadAliveMap(in);
+  shots_by_target_.clear();
+  const std::size_t targets = in.GetSize();
+  for (std::size_t i = 0; i < targets; ++i) {
+    auto& shots = shots_by_target_[in.GetId()];
+    shots.resize(in.GetSize());
+    for (auto& shot : shots) {
+      shot.timestamp_ms = in.Get<std::int64_t>();
+      shot.shooter_id = in.GetId();
+    }
+  }
+  shooter_kill_credit_.clear();
+  const std::size_t shooters = in.GetSize();
+  for (std::size_t i = 0; i < shooters; ++i) {
+    const EntityId shooter = in.GetId();
+    shooter_kill_credit_[shooter] = in.Get<double>();
+  }
+  initial_friendly_count_ = static_cast<std::size_t>(in.Get<std::uint64_t>());
+  final_friendly_alive_ = static_cast<std::size_t>(in.Get<std::uint64_t>());
+  total_hostile_losses_ = static_cast<std::size_t>(in.Get<std::uint64_t>());
+  credited_losses_ = in.Get<double>();
+}
+
 void ReplayMetricsEvaluator::PruneShotHistory(std::int64_t now_ms) {
   for (auto it = shots_by_target_.begin(); it != shots_by_target_.end();) {
     auto& records = it->second;
@@ -0,0 +1,456 @@
+#include "bas/system/replay_runner.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+#include "bas/cache/decision_cache.hpp"
+#include "bas/common/bounded_queue.hpp"
+#include "bas/common/mapped_file.hpp"
+#include "bas/common/thread_pool.hpp"
+#include "bas/dis/dis_adapter.hpp"
+#include "bas/dis/dis_stream_parser.hpp"
+#include "bas/system/columnar_replay.hpp"
+#include "bas/system/replay_checkpoint.hpp"
+#include "bas/system/scenario_replay.hpp"
+
+namespace bas {
+
+namespace {
+
+struct TickInput {
+  SnapshotUpdate update;
+  std::vector<EventRecord> events;
+};
+
+// 安全点：此前读入的帧均已决策完毕（DIS 为一个读块结束处），可在此保存检查点。
+struct SafePoint {
+  std::int64_t timestamp_ms = 0;
+  // 累计帧数，含检查点之前的帧。
+  std::uint64_t frames = 0;
+  std::uint64_t resume_offset = 0;
+  const DisStreamParser* stream = nullptr;
+};
+
+// 接收的起止位置：默认从头读到尾；从检查点续放时给出续读位置与解析器状态。
+struct IngestPlan {
+  std::uint64_t resume_offset = 0;
+  std::uint64_t frame_base = 0;
+  // .bas 非单调时从头解析并跳过的帧数。
+  std::uint64_t skip_frames = 0;
+  BinaryReader* stream_state = nullptr;
+  std::size_t chunk_bytes = 1U << 20U;
+  // 快照时间戳超过该值即停止接收，该帧不再决策。
+  std::int64_t stop_after_ms = std::numeric_limits<std::int64_t>::max();
+  // 写检查点时 .bas 按帧索引求下一帧首行偏移。
+  const ReplayFrameIndex* text_index = nullptr;
+  std::function<void(const SafePoint&)> on_safe_point;
+};
+
+bool IsReplayExtension(const std::filesystem::path& path) {
+  const std::string ext = path.extension().string();
+  return ext == ".bas" || ext == ".basc" || ext == ".bin" || ext == ".dis" || ext == ".disbin";
+}
+
+std::uint64_t DigestDecision(std::uint64_t digest, const DecisionPackage& decision) {
+  std::string bytes;
+  for (const auto& a : decision.fire.assignments) {
+    bytes += a.shooter_id.ToString() + ">" + a.target_id.ToString() + ":" + a.weapon_name + ":" + a.tactic + ";";
+  }
+  for (const auto& action : decision.maneuver.actions) {
+    bytes += action.unit_id.ToString() + "@" + std::to_string(action.next_pose.x) + "," +
+             std::to_string(action.next_pose.y) + ";";
+  }
+  bytes += decision.explanation;
+  return DecisionCache::HashBytes(bytes, digest);
+}
+
+// 侧车缺失、损坏或与源文件不符时返回 nullopt，回放退回从头开始。
+std::optional<ReplayCheckpoint> FindCheckpoint(const std::string& checkpoint_path,
+                                               const std::string& path,
+                                               std::uint32_t reorder_window,
+                                               std::int64_t limit_ms,
+                                               std::size_t& chunk_bytes) {
+  if (!std::filesystem::exists(checkpoint_path)) {
+    return std::nullopt;
+  }
+  try {
+    const ReplayCheckpointReader reader(checkpoint_path);
+    if (!reader.Matches(path, reorder_window)) {
+      return std::nullopt;
+    }
+    auto checkpoint = reader.Find(limit_ms);
+    if (checkpoint.has_value()) {
+      chunk_bytes = static_cast<std::size_t>(reader.chunk_bytes());
+    }
+    return checkpoint;
+  } catch (const std::runtime_error&) {
+    return std::nullopt;
+  }
+}
+
+// 接收阶段：喂入适配器并取出增量快照交给 next（直接决策或入队）。
+template <typename Next>
+void Ingest(const std::string& path, const IngestPlan& plan, const ReplayOptions& options, DisAdapter& adapter,
+            std::size_t& frames, const Next& next) {
+  bool stopped = false;
+  std::int64_t last_ts = 0;
+  const auto process_batch = [&](const DisPduBatch& batch) {
+    if (stopped) {
+      return;
+    }
+    ++frames;
+    adapter.Ingest(batch);
+    auto update = adapter.PollUpdate();
+    if (!update.has_value()) {
+      return;
+    }
+    last_ts = update->snapshot->timestamp_ms;
+    if (last_ts > plan.stop_after_ms) {
+      stopped = true;
+      return;
+    }
+    next(TickInput{std::move(*update), adapter.DrainEvents()});
+  };
+  const auto safe_point = [&](std::uint64_t resume_offset, const DisStreamParser* stream) {
+    // 尚无帧决策时（DIS 首块可能未关闭任何批次）不设安全点。
+    if (plan.on_safe_point && !stopped && plan.frame_base + frames > 0) {
+      plan.on_safe_point({last_ts, plan.frame_base + frames, resume_offset, stream});
+    }
+  };
+
+  if (IsColumnarReplay(path)) {
+    // 列式回放：按帧索引逐帧取列，无需文本或字节序解析。
+    const ColumnarReplayReader reader(path);
+    for (std::size_t f = static_cast<std::size_t>(plan.resume_offset); f < reader.frame_count() && !stopped; ++f) {
+      process_batch(reader.ReadFrame(f));
+      reader.ReleaseFrame(f);
+      safe_point(f + 1, nullptr);
+    }
+  } else if (IsBinaryReplay(path)) {
+    // 流式回放：按块喂入映射区域，批次一旦关闭立即决策，已处理的页随即释放。
+    const MappedFile file(path);
+    DisStreamParser stream({options.reorder_window, 4096});
+    if (plan.stream_state != nullptr) {
+      stream.RestoreState(*plan.stream_state);
+    }
+    const auto sink = [&process_batch](DisPduBatch&& batch) { process_batch(batch); };
+    const std::size_t chunk = std::max<std::size_t>(plan.chunk_bytes, 1);
+    for (std::size_t offset = static_cast<std::size_t>(plan.resume_offset); offset < file.size() && !stopped;
+         offset += chunk) {
+      const std::size_t length = std::min(chunk, file.size() - offset);
+      stream.Feed(file.view().subview(offset, length), sink);
+      file.ReleaseRange(offset, length);
+      safe_point(offset + length, &stream);
+    }
+    if (!stopped) {
+      stream.Finish(sink);
+    }
+  } else {
+    ScenarioReplayLoaderConfig config;
+    config.start_offset = plan.resume_offset;
+    const std::vector<DisPduBatch> batches = ScenarioReplayLoader(config).LoadBatches(path);
+    // 帧索引与加载结果逐帧对应时才能按行偏移续读，否则检查点记 0，续放时从头解析后跳帧。
+    const ReplayFrameIndex* index = plan.text_index;
+    const bool seekable = index != nullptr && index->monotonic && index->entries.size() == batches.size();
+    const std::uint64_t file_bytes = seekable ? std::filesystem::file_size(path) : 0;
+    for (std::size_t i = static_cast<std::size_t>(plan.skip_frames); i < batches.size() && !stopped; ++i) {
+      process_batch(batches[i]);
+      const std::size_t next_frame = i + 1;
+      safe_point(!seekable ? 0 : next_frame < index->entries.size() ? index->entries[next_frame].offset : file_bytes,
+                 nullptr);
+    }
+  }
+}
+
+}  // namespace
+
+bool IsBinaryReplay(const std::string& path) {
+  const auto pos = path.find_last_of('.');
+  if (pos == std::string::npos) {
+    return false;
+  }
+  const std::string ext = path.substr(pos + 1);
+  return ext == "bin" || ext == "dis" || ext == "disbin";
+}
+
+ReplayRunResult RunReplay(const std::string& path, const ReplayOptions& options, const ModelRuntime& model_runtime) {
+  ReplayRunResult result;
+  result.path = path;
+
+  AgentPipeline pipeline(options.pipeline, FireControlEngine{}, ManeuverEngine{}, model_runtime);
+  DisAdapter adapter;
+  ReplayMetricsEvaluator metrics;
+  const auto replay_start = std::chrono::steady_clock::now();
+  const std::int64_t from_ms = options.from_ms.value_or(std::numeric_limits<std::int64_t>::min());
+  const std::int64_t to_ms = options.to_ms.value_or(std::numeric_limits<std::int64_t>::max());
+  bool seeking = options.from_ms.has_value();
+
+  const auto decide = [&](const TickInput& input) {
+    const BattlefieldSnapshot& snapshot = *input.update.snapshot;
+    metrics.ObserveSnapshot(snapshot);
+
+    const bool counted = snapshot.timestamp_ms >= from_ms && snapshot.timestamp_ms <= to_ms;
+    if (counted && seeking) {
+      seeking = false;
+      result.seek_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - replay_start).count();
+    }
+    const auto t0 = std::chrono::steady_clock::now();
+    const DecisionPackage decision = pipeline.Tick(input.update, input.events);
+    const auto t1 = std::chrono::steady_clock::now();
+    metrics.ObserveDecision(snapshot.timestamp_ms, decision);
+    result.model_updates += pipeline.DrainModelUpdates().size();
+    if (!counted) {
+      // 检查点与 from_ms 之间的帧只用于预热状态，不计入统计。
+      return;
+    }
+
+    if (result.decisions == 0) {
+      result.first_decision_ms = std::chrono::duration<double, std::milli>(t1 - replay_start).count();
+    }
+    ++result.ticks;
+    ++result.decisions;
+    if (decision.from_cache) {
+      ++result.cache_hits;
+    }
+    result.decision_digest = DigestDecision(result.decision_digest, decision);
+    result.latencies_ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+  };
+
+  IngestPlan plan;
+  plan.chunk_bytes = options.stream_chunk_bytes;
+  plan.stop_after_ms = to_ms;
+  const std::string checkpoint_path = options.checkpoint_path.empty() ? path + ".ckpt" : options.checkpoint_path;
+  std::optional<ReplayCheckpointWriter> writer;
+  ReplayFrameIndex frame_index;
+  std::optional<ReplayCheckpoint> resume;
+  std::optional<BinaryReader> stream_state;
+
+  try {
+    if (options.checkpoint_interval_ms > 0) {
+      // 保存检查点的回放总是从头开始，并重写侧车。
+      if (!IsColumnarReplay(path) && !IsBinaryReplay(path)) {
+        frame_index = BuildTextFrameIndex(path);
+        plan.text_index = &frame_index;
+      }
+      writer.emplace(checkpoint_path, path, options.reorder_window, options.stream_chunk_bytes);
+      const bool text = plan.text_index != nullptr;
+      std::optional<std::int64_t> last_checkpoint_ms;
+      plan.on_safe_point = [&](const SafePoint& point) {
+        if (!text) {
+          frame_index.entries.push_back(
+              {point.timestamp_ms, point.stream != nullptr ? point.resume_offset : point.frames - 1});
+        }
+        if (last_checkpoint_ms.has_value() && point.timestamp_ms - *last_checkpoint_ms < options.checkpoint_interval_ms) {
+          return;
+        }
+        BinaryWriter state;
+        adapter.SaveState(state);
+        pipeline.SaveState(state);
+        metrics.SaveState(state);
+        if (point.stream != nullptr) {
+          point.stream->SaveState(state);
+        }
+        writer->Add({point.timestamp_ms, point.frames, point.resume_offset, std::move(state.bytes())});
+        last_checkpoint_ms = point.timestamp_ms;
+      };
+    } else if (options.from_ms.has_value()) {
+      // 决策缓存不在检查点内：留出一个缓存有效期的预热，到 from_ms 时缓存内容与从头回放一致。
+      resume = FindCheckpoint(checkpoint_path, path, options.reorder_window,
+                              from_ms - std::max<std::int64_t>(options.pipeline.cache_ttl_ms, 1), plan.chunk_bytes);
+    }
+
+    if (resume.has_value()) {
+      BinaryReader state(resume->state);
+      adapter.RestoreState(state);
+      pipeline.RestoreState(state);
+      metrics.RestoreState(state);
+      stream_state.emplace(state);
+      plan.stream_state = IsBinaryReplay(path) ? &*stream_state : nullptr;
+      plan.frame_base = resume->frames;
+      const bool text = !IsColumnarReplay(path) && !IsBinaryReplay(path);
+      if (text && resume->resume_offset == 0) {
+        plan.skip_frames = resume->frames;
+      } else {
+        plan.resume_offset = resume->resume_offset;
+      }
+      result.resumed_from_ms = resume->timestamp_ms;
+    }
+
+    const bool sequential = !options.staged_ingest || writer.has_value() || options.from_ms.has_value() ||
+                            options.to_ms.has_value();
+    if (sequential) {
+      Ingest(path, plan, options, adapter, result.frames, decide);
+    } else {
+      // 接收线程解析第 N+1 帧时决策线程处理第 N 帧；队列有界，决策落后时接收线程阻塞。
+      BoundedQueue<TickInput> queue(options.stage_queue_depth);
+      std::exception_ptr ingest_error;
+      std::thread producer([&] {
+        try {
+          Ingest(path, plan, options, adapter, result.frames,
+                 [&queue](TickInput&& input) { queue.Push(std::move(input)); });
+        } catch (...) {
+          ingest_error = std::current_exception();
+        }
+        queue.Close();
+      });
+      try {
+        TickInput input;
+        while (queue.Pop(input)) {
+          decide(input);
+        }
+      } catch (...) {
+        // 先关闭队列解除接收线程的阻塞，再汇合线程。
+        queue.Close();
+        producer.join();
+        throw;
+      }
+      producer.join();
+      if (ingest_error) {
+        std::rethrow_exception(ingest_error);
+      }
+    }
+    if (writer.has_value()) {
+      result.checkpoints_written = writer->checkpoint_count();
+      writer->Finish(frame_index);
+    }
+  } catch (const std::exception& e) {
+    result.error = std::string("回放加载失败: ") + e.what();
+    return result;
+  }
+
+  if (result.frames == 0 && !result.resumed_from_ms.has_value()) {
+    result.error = "回放文件中没有有效帧";
+    return result;
+  }
+  result.model_updates += pipeline.WaitForModelUpdates().size();
+  if (result.decisions == 0 || result.latencies_ms.empty()) {
+    result.error = options.from_ms.has_value() || options.to_ms.has_value() ? "指定时间段内没有可决策的帧"
+                                                                            : "回放未产生有效决策";
+    return result;
+  }
+
+  std::sort(result.latencies_ms.begin(), result.latencies_ms.end());
+  result.avg_latency_ms = std::accumulate(result.latencies_ms.begin(), result.latencies_ms.end(), 0.0) /
+                          static_cast<double>(result.latencies_ms.size());
+  const std::size_t p95_index = static_cast<std::size_t>(result.latencies_ms.size() * 0.95);
+  result.p95_latency_ms = result.latencies_ms[std::min(p95_index, result.latencies_ms.size() - 1)];
+  result.metrics = metrics.Finalize();
+  result.stages = pipeline.stage_stats();
+  result.similar = pipeline.similar_stats();
+  result.model_batch = model_runtime.batch_stats();
+  result.model_cache = model_runtime.response_cache_stats();
+  return result;
+}
+
+std::vector<std::string> CollectReplayInputs(const std::string& directory_or_manifest) {
+  namespace fs = std::filesystem;
+  const fs::path root(directory_or_manifest);
+  std::vector<std::string> out;
+  if (fs::is_directory(root)) {
+    for (const auto& entry : fs::directory_iterator(root)) {
+      if (entry.is_regular_file() && IsReplayExtension(entry.path())) {
+        out.push_back(entry.path().string());
+      }
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+  }
+
+  std::ifstream manifest(root);
+  if (!manifest.is_open()) {
+    throw std::runtime_error("无法打开回放目录或清单: " + directory_or_manifest);
+  }
+  std::string line;
+  while (std::getline(manifest, line)) {
+    const auto begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string::npos || line[begin] == '#') {
+      continue;
+    }
+    const auto end = line.find_last_not_of(" \t\r");
+    const fs::path entry(line.substr(begin, end - begin + 1));
+    out.push_back(entry.is_absolute() ? entry.string() : (root.parent_path() / entry).string());
+  }
+  return out;
+}
+
+ReplayBatchReport RunReplayBatch(const std::vector<std::string>& paths,
+                                 const ReplayOptions& options,
+                                 const ModelRuntime& model_runtime,
+                                 std::size_t thread_count) {
+  ReplayBatchReport report;
+  report.scenarios.resize(paths.size());
+  const auto start = std::chrono::steady_clock::now();
+
+  // 各场景互不共享可变状态：每个场景开始时从模型运行时派生隔离副本，结束即并回，
+  // 后开始的场景可复用先完成场景的响应缓存。场景结果按下标写回，汇总顺序与线程数无关。
+  std::mutex runtime_mutex;
+  const auto run_one = [&](std::size_t i) {
+    ModelRuntime runtime = [&] {
+      std::lock_guard<std::mutex> lock(runtime_mutex);
+      return model_runtime.Fork();
+    }();
+    report.scenarios[i] = RunReplay(paths[i], options, runtime);
+    std::lock_guard<std::mutex> lock(runtime_mutex);
+    model_runtime.Absorb(runtime);
+  };
+  if (thread_count == 0) {
+    thread_count = std::max(1U, std::thread::hardware_concurrency());
+  }
+  if (thread_count <= 1 || paths.size() <= 1) {
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+      run_one(i);
+    }
+  } else {
+    // 调用线程也参与执行，工作线程数比目标并发少一个。
+    ThreadPool pool(std::min(thread_count, paths.size()) - 1);
+    pool.ParallelFor(paths.size(), 1, [&](std::size_t begin, std::size_t end, std::size_t) {
+      for (std::size_t i = begin; i < end; ++i) {
+        run_one(i);
+      }
+    });
+  }
+
+  std::vector<double> latencies;
+  double weighted_hit_rate = 0.0;
+  for (const auto& run : report.scenarios) {
+    if (!run.error.empty()) {
+      ++report.failed;
+      continue;
+    }
+    report.frames += run.frames;
+    report.decisions += run.decisions;
+    report.cache_hits += run.cache_hits;
+    report.initial_friendly += run.metrics.initial_friendly_count;
+    report.final_friendly_alive += run.metrics.final_friendly_alive;
+    report.hostile_losses += run.metrics.total_hostile_losses;
+    weighted_hit_rate += run.metrics.hit_contribution_rate * static_cast<double>(run.metrics.total_hostile_losses);
+    latencies.insert(latencies.end(), run.latencies_ms.begin(), run.latencies_ms.end());
+  }
+  if (report.initial_friendly > 0) {
+    report.survival_rate =
+        100.0 * static_cast<double>(report.final_friendly_alive) / static_cast<double>(report.initial_friendly);
+  }
+  if (report.hostile_losses > 0) {
+    report.hit_contribution_rate = weighted_hit_rate / static_cast<double>(report.hostile_losses);
+  }
+  if (!latencies.empty()) {
+    std::sort(latencies.begin(), latencies.end());
+    report.avg_latency_ms =
+        std::accumulate(latencies.begin(), latencies.end(), 0.0) / static_cast<double>(latencies.size());
+    const std::size_t p95_index = static_cast<std::size_t>(latencies.size() * 0.95);
+    report.p95_latency_ms = latencies[std::min(p95_index, latencies.size() - 1)];
+  }
+  report.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  return report;
+}
+
+}  // namespace bas
@@ -1,168 +1,381 @@
 #include "bas/system/scenario_replay.hpp"
 
 #include <algorithm>
-#include <cctype>
+#include <array>
+#include <charconv>
+#include <cstring>
 #include <fstream>
-#include <sstream>
+#include <optional>
 #include <stdexcept>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
+#include <utility>
+
+#include "bas/common/mapped_file.hpp"
+#include "bas/common/thread_pool.hpp"
 
 namespace bas {
 
 namespace {
 
-std::int64_t ParseInt64(const std::string& text, const std::string& field_name, int line_no) {
-  try {
-    return std::stoll(text);
-  } catch (const std::exception&) {
-    throw std::runtime_error("第" + std::to_string(line_no) + "行字段[" + field_name + "]不是合法整数");
+// 解析错误携带块内行号，由调用方换算为文件行号后拼成“第N行...”。
+class LineError : public std::runtime_error {
+ public:
+  LineError(std::size_t line, const std::string& detail) : std::runtime_error(detail), line_(line) {}
+  std::size_t line() const { return line_; }
+
+ private:
+  std::size_t line_;
+};
+
+std::runtime_error WithLine(const LineError& e, std::size_t first_line) {
+  return std::runtime_error("第" + std::to_string(first_line + e.line() - 1) + "行" + e.what());
+}
+
+// 出错时才数起始偏移之前的行数，续读不为此多读文件。
+std::size_t LinesBefore(const std::string& path, std::uint64_t offset) {
+  std::ifstream ifs(path, std::ios::binary);
+  std::vector<char> buffer(1U << 16U);
+  std::size_t lines = 0;
+  while (offset > 0 && ifs) {
+    ifs.read(buffer.data(), static_cast<std::streamsize>(std::min<std::uint64_t>(buffer.size(), offset)));
+    const auto n = static_cast<std::size_t>(ifs.gcount());
+    lines += static_cast<std::size_t>(std::count(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(n), '\n'));
+    offset -= n;
+    if (n == 0) {
+      break;
+    }
   }
+  return lines;
 }
 
-double ParseDouble(const std::string& text, const std::string& field_name, int line_no) {
-  try {
-    return std::stod(text);
-  } catch (const std::exception&) {
-    throw std::runtime_error("第" + std::to_string(line_no) + "行字段[" + field_name + "]不是合法浮点数");
+bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f'; }
+
+std::string_view Trim(std::string_view value) {
+  while (!value.empty() && IsSpace(value.front())) {
+    value.remove_prefix(1);
+  }
+  while (!value.empty() && IsSpace(value.back())) {
+    value.remove_suffix(1);
+  }
+  return value;
+}
+
+// from_chars 不接受前导正号，其余须整段消费，不再像 stoll/stod 那样忽略尾随字符。
+template <typename T>
+bool ParseNumber(std::string_view text, T& out) {
+  if (text.size() > 1 && text.front() == '+' && text[1] != '-') {
+    text.remove_prefix(1);
+  }
+  const char* end = text.data() + text.size();
+  const auto [ptr, ec] = std::from_chars(text.data(), end, out);
+  return !text.empty() && ec == std::errc() && ptr == end;
+}
+
+std::int64_t ParseInt64(std::string_view text, const char* field_name, std::size_t line_no) {
+  std::int64_t value = 0;
+  if (!ParseNumber(text, value)) {
+    throw LineError(line_no, std::string("字段[") + field_name + "]不是合法整数");
   }
+  return value;
 }
 
-bool ParseBool(const std::string& text, const std::string& field_name, int line_no) {
+double ParseDouble(std::string_view text, const char* field_name, std::size_t line_no) {
+  double value = 0.0;
+  if (!ParseNumber(text, value)) {
+    throw LineError(line_no, std::string("字段[") + field_name + "]不是合法浮点数");
+  }
+  return value;
+}
+
+bool ParseBool(std::string_view text, const char* field_name, std::size_t line_no) {
   if (text == "1" || text == "true" || text == "TRUE") {
     return true;
   }
   if (text == "0" || text == "false" || text == "FALSE") {
     return false;
   }
-  throw std::runtime_error("第" + std::to_string(line_no) + "行字段[" + field_name + "]不是合法布尔值");
+  throw LineError(line_no, std::string("字段[") + field_name + "]不是合法布尔值");
 }
 
-}  // namespace
+// 一段文本的解析结果：各时间戳的批次按首次出现顺序存放。
+struct ChunkFrames {
+  std::vector<std::int64_t> timestamps;
+  std::vector<DisPduBatch> batches;
+  std::unordered_map<std::int64_t, std::size_t> slot_of;
 
-std::vector<DisPduBatch> ScenarioReplayLoader::LoadBatches(const std::string& path) const {
-  std::ifstream ifs(path);
-  if (!ifs) {
-    throw std::runtime_error("无法打开回放文件: " + path);
+  DisPduBatch& At(std::int64_t ts) {
+    // 回放通常按时间排序，与上一条同帧时免查表。
+    if (!timestamps.empty() && timestamps.back() == ts) {
+      return batches.back();
+    }
+    const auto [it, inserted] = slot_of.try_emplace(ts, batches.size());
+    if (inserted) {
+      timestamps.push_back(ts);
+      batches.emplace_back().timestamp_ms = ts;
+    }
+    return batches[it->second];
   }
+};
 
-  std::unordered_map<std::int64_t, DisPduBatch> batches_by_ts;
-  std::vector<std::int64_t> timestamps;
+using Frame = std::pair<std::int64_t, DisPduBatch>;
+
+std::vector<Frame> TakeSorted(ChunkFrames& chunk) {
+  std::vector<std::size_t> order(chunk.timestamps.size());
+  for (std::size_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  if (!std::is_sorted(chunk.timestamps.begin(), chunk.timestamps.end())) {
+    std::sort(order.begin(), order.end(),
+              [&chunk](std::size_t a, std::size_t b) { return chunk.timestamps[a] < chunk.timestamps[b]; });
+  }
+  std::vector<Frame> frames;
+  frames.reserve(order.size());
+  for (const std::size_t i : order) {
+    frames.emplace_back(chunk.timestamps[i], std::move(chunk.batches[i]));
+  }
+  return frames;
+}
 
-  std::string line;
-  int line_no = 0;
-  while (std::getline(ifs, line)) {
-    ++line_no;
+class LineParser {
+ public:
+  explicit LineParser(ChunkFrames& out) : out_(out) {}
+
+  // 解析 text 中的各行，末行可不带换行符；行号跨调用累计，从 1 开始。
+  void Feed(std::string_view text) {
+    while (!text.empty()) {
+      const auto* nl = static_cast<const char*>(std::memchr(text.data(), '\n', text.size()));
+      const std::size_t length = nl == nullptr ? text.size() : static_cast<std::size_t>(nl - text.data());
+      ++line_no_;
+      ParseLine(text.substr(0, length));
+      text.remove_prefix(nl == nullptr ? length : length + 1);
+    }
+  }
+
+ private:
+  static constexpr std::size_t kMaxFields = 12;
+
+  void ParseLine(std::string_view line) {
     line = Trim(line);
     if (line.empty() || line[0] == '#') {
-      continue;
+      return;
     }
 
-    const auto fields = SplitCsv(line);
-    if (fields.empty()) {
-      continue;
+    // 与 getline 逐段切分一致：末尾逗号后的空段不计为字段。
+    std::array<std::string_view, kMaxFields> fields;
+    std::size_t count = 0;
+    std::size_t start = 0;
+    while (true) {
+      const std::size_t comma = line.find(',', start);
+      const std::string_view field =
+          line.substr(start, comma == std::string_view::npos ? std::string_view::npos : comma - start);
+      if (comma == std::string_view::npos && field.empty() && count > 0) {
+        break;
+      }
+      if (count < kMaxFields) {
+        fields[count] = Trim(field);
+      }
+      ++count;
+      if (comma == std::string_view::npos) {
+        break;
+      }
+      start = comma + 1;
     }
 
-    const std::string rec_type = Trim(fields[0]);
-
+    const std::string_view rec_type = fields[0];
     if (rec_type == "ENV") {
-      if (fields.size() != 5) {
-        throw std::runtime_error("第" + std::to_string(line_no) + "行ENV记录格式错误");
-      }
-      const std::int64_t ts = ParseInt64(Trim(fields[1]), "timestamp", line_no);
-      if (batches_by_ts.find(ts) == batches_by_ts.end()) {
-        timestamps.push_back(ts);
+      if (count != 5) {
+        throw LineError(line_no_, "ENV记录格式错误");
       }
+      const std::int64_t ts = ParseInt64(fields[1], "timestamp", line_no_);
       EnvironmentState env;
-      env.visibility_m = ParseDouble(Trim(fields[2]), "visibility_m", line_no);
-      env.weather_risk = ParseDouble(Trim(fields[3]), "weather_risk", line_no);
-      env.terrain_risk = ParseDouble(Trim(fields[4]), "terrain_risk", line_no);
-      batches_by_ts[ts].env = env;
-      continue;
+      env.visibility_m = ParseDouble(fields[2], "visibility_m", line_no_);
+      env.weather_risk = ParseDouble(fields[3], "weather_risk", line_no_);
+      env.terrain_risk = ParseDouble(fields[4], "terrain_risk", line_no_);
+      out_.At(ts).env = env;
+      return;
     }
 
     if (rec_type == "ENTITY") {
-      if (fields.size() != 12) {
-        throw std::runtime_error("第" + std::to_string(line_no) + "行ENTITY记录格式错误");
-      }
-      const std::int64_t ts = ParseInt64(Trim(fields[1]), "timestamp", line_no);
-      if (batches_by_ts.find(ts) == batches_by_ts.end()) {
-        timestamps.push_back(ts);
+      if (count != 12) {
+        throw LineError(line_no_, "ENTITY记录格式错误");
       }
-
       DisEntityPdu pdu;
-      pdu.timestamp_ms = ts;
-      pdu.entity_id = Trim(fields[2]);
-      pdu.side = SideFromString(Trim(fields[3]));
-      pdu.type = UnitTypeFromString(Trim(fields[4]));
-      pdu.pose.x = ParseDouble(Trim(fields[5]), "x", line_no);
-      pdu.pose.y = ParseDouble(Trim(fields[6]), "y", line_no);
-      pdu.pose.z = ParseDouble(Trim(fields[7]), "z", line_no);
-      pdu.speed_mps = ParseDouble(Trim(fields[8]), "speed_mps", line_no);
-      pdu.heading_deg = ParseDouble(Trim(fields[9]), "heading_deg", line_no);
-      pdu.alive = ParseBool(Trim(fields[10]), "alive", line_no);
-      pdu.threat_level = ParseDouble(Trim(fields[11]), "threat_level", line_no);
-
-      batches_by_ts[ts].entity_updates.push_back(pdu);
-      continue;
+      pdu.timestamp_ms = ParseInt64(fields[1], "timestamp", line_no_);
+      pdu.entity_id = EntityId::Intern(fields[2]);
+      pdu.side = SideFromString(fields[3]);
+      pdu.type = UnitTypeFromString(fields[4]);
+      pdu.pose.x = ParseDouble(fields[5], "x", line_no_);
+      pdu.pose.y = ParseDouble(fields[6], "y", line_no_);
+      pdu.pose.z = ParseDouble(fields[7], "z", line_no_);
+      pdu.speed_mps = ParseDouble(fields[8], "speed_mps", line_no_);
+      pdu.heading_deg = ParseDouble(fields[9], "heading_deg", line_no_);
+      pdu.alive = ParseBool(fields[10], "alive", line_no_);
+      pdu.threat_level = ParseDouble(fields[11], "threat_level", line_no_);
+      out_.At(pdu.timestamp_ms).entity_updates.push_back(pdu);
+      return;
     }
 
     if (rec_type == "FIRE") {
-      if (fields.size() != 8) {
-        throw std::runtime_error("第" + std::to_string(line_no) + "行FIRE记录格式错误");
-      }
-      const std::int64_t ts = ParseInt64(Trim(fields[1]), "timestamp", line_no);
-      if (batches_by_ts.find(ts) == batches_by_ts.end()) {
-        timestamps.push_back(ts);
+      if (count != 8) {
+        throw LineError(line_no_, "FIRE记录格式错误");
       }
-
       DisFirePdu pdu;
-      pdu.timestamp_ms = ts;
-      pdu.shooter_id = Trim(fields[2]);
-      pdu.target_id = Trim(fields[3]);
-      pdu.weapon_name = Trim(fields[4]);
-      pdu.origin.x = ParseDouble(Trim(fields[5]), "x", line_no);
-      pdu.origin.y = ParseDouble(Trim(fields[6]), "y", line_no);
-      pdu.origin.z = ParseDouble(Trim(fields[7]), "z", line_no);
-
-      batches_by_ts[ts].fire_events.push_back(pdu);
-      continue;
+      pdu.timestamp_ms = ParseInt64(fields[1], "timestamp", line_no_);
+      pdu.shooter_id = EntityId::Intern(fields[2]);
+      pdu.target_id = EntityId::Intern(fields[3]);
+      pdu.weapon_name = std::string(fields[4]);
+      pdu.origin.x = ParseDouble(fields[5], "x", line_no_);
+      pdu.origin.y = ParseDouble(fields[6], "y", line_no_);
+      pdu.origin.z = ParseDouble(fields[7], "z", line_no_);
+      out_.At(pdu.timestamp_ms).fire_events.push_back(std::move(pdu));
+      return;
     }
 
-    throw std::runtime_error("第" + std::to_string(line_no) + "行出现未知记录类型: " + rec_type);
+    throw LineError(line_no_, "出现未知记录类型: " + std::string(rec_type));
+  }
+
+  ChunkFrames& out_;
+  std::size_t line_no_ = 0;
+};
+
+template <typename T>
+void MoveAppend(std::vector<T>& into, std::vector<T>& from) {
+  if (into.empty()) {
+    into = std::move(from);
+    return;
+  }
+  into.insert(into.end(), std::make_move_iterator(from.begin()), std::make_move_iterator(from.end()));
+}
+
+}  // namespace
+
+std::vector<DisPduBatch> ScenarioReplayLoader::LoadBatches(const std::string& path) const {
+  const std::size_t threads =
+      config_.threads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : config_.threads;
+  return threads > 1 ? LoadParallel(path, threads) : LoadSequential(path);
+}
+
+std::vector<DisPduBatch> ScenarioReplayLoader::LoadSequential(const std::string& path) const {
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs) {
+    throw std::runtime_error("无法打开回放文件: " + path);
+  }
+  if (config_.start_offset > 0) {
+    ifs.seekg(static_cast<std::streamoff>(config_.start_offset));
   }
 
-  std::sort(timestamps.begin(), timestamps.end());
-  timestamps.erase(std::unique(timestamps.begin(), timestamps.end()), timestamps.end());
+  ChunkFrames chunk;
+  LineParser parser(chunk);
+  std::vector<char> buffer(std::max<std::size_t>(config_.block_bytes, 64));
+  std::size_t filled = 0;
+  try {
+    while (true) {
+      ifs.read(buffer.data() + filled, static_cast<std::streamsize>(buffer.size() - filled));
+      filled += static_cast<std::size_t>(ifs.gcount());
+      const bool eof = !ifs;
+      // 只交出完整的行，块尾不完整的行移到缓冲区开头与下一块拼接。
+      const std::string_view view(buffer.data(), filled);
+      const std::size_t last_nl = view.rfind('\n');
+      const std::size_t complete = eof ? filled : (last_nl == std::string_view::npos ? 0 : last_nl + 1);
+      parser.Feed(view.substr(0, complete));
+      std::memmove(buffer.data(), buffer.data() + complete, filled - complete);
+      filled -= complete;
+      if (eof) {
+        break;
+      }
+      if (filled == buffer.size()) {
+        buffer.resize(buffer.size() * 2);
+      }
+    }
+  } catch (const LineError& e) {
+    throw WithLine(e, config_.start_offset == 0 ? 1 : LinesBefore(path, config_.start_offset) + 1);
+  }
 
+  std::vector<Frame> frames = TakeSorted(chunk);
   std::vector<DisPduBatch> batches;
-  batches.reserve(timestamps.size());
-  for (const auto ts : timestamps) {
-    batches.push_back(batches_by_ts[ts]);
+  batches.reserve(frames.size());
+  for (auto& frame : frames) {
+    batches.push_back(std::move(frame.second));
   }
   return batches;
 }
 
-std::vector<std::string> ScenarioReplayLoader::SplitCsv(const std::string& line) {
-  std::vector<std::string> out;
-  std::stringstream ss(line);
-  std::string token;
-  while (std::getline(ss, token, ',')) {
-    out.push_back(token);
+std::vector<DisPduBatch> ScenarioReplayLoader::LoadParallel(const std::string& path, std::size_t threads) const {
+  std::optional<MappedFile> file;
+  try {
+    file.emplace(path);
+  } catch (const std::runtime_error&) {
+    throw std::runtime_error("无法打开回放文件: " + path);
   }
-  return out;
-}
+  const std::string_view whole(reinterpret_cast<const char*>(file->view().data()), file->size());
+  const std::size_t start = static_cast<std::size_t>(std::min<std::uint64_t>(config_.start_offset, whole.size()));
+  const std::string_view text = whole.substr(start);
+  const std::size_t chunk_count =
+      std::min(threads, std::max<std::size_t>(1, text.size() / std::max<std::size_t>(config_.min_chunk_bytes, 1)));
+  if (chunk_count <= 1) {
+    return LoadSequential(path);
+  }
+
+  // 按字节等分后把切点推到下一行行首，保证每块都是完整的行。
+  std::vector<std::size_t> bounds{0};
+  for (std::size_t k = 1; k < chunk_count; ++k) {
+    std::size_t cut = std::max(bounds.back(), text.size() * k / chunk_count);
+    const std::size_t nl = text.find('\n', cut);
+    cut = nl == std::string_view::npos ? text.size() : nl + 1;
+    bounds.push_back(cut);
+  }
+  bounds.push_back(text.size());
 
-std::string ScenarioReplayLoader::Trim(const std::string& value) {
-  std::size_t start = 0;
-  while (start < value.size() && std::isspace(static_cast<unsigned char>(value[start])) != 0) {
-    ++start;
+  std::vector<ChunkFrames> chunks(chunk_count);
+  std::vector<std::optional<LineError>> errors(chunk_count);
+  ThreadPool pool(chunk_count - 1);
+  pool.ParallelFor(chunk_count, 1, [&](std::size_t begin, std::size_t end, std::size_t) {
+    for (std::size_t k = begin; k < end; ++k) {
+      try {
+        LineParser(chunks[k]).Feed(text.substr(bounds[k], bounds[k + 1] - bounds[k]));
+      } catch (const LineError& e) {
+        errors[k] = e;
+      }
+    }
+  });
+  // 报告文件中最靠前的错误，与单线程一致；只在出错时才数前面各块的行数。
+  for (std::size_t k = 0; k < chunk_count; ++k) {
+    if (errors[k].has_value()) {
+      const auto lines_before =
+          std::count(whole.begin(), whole.begin() + static_cast<std::ptrdiff_t>(start + bounds[k]), '\n');
+      throw WithLine(*errors[k], static_cast<std::size_t>(lines_before) + 1);
+    }
   }
 
-  std::size_t end = value.size();
-  while (end > start && std::isspace(static_cast<unsigned char>(value[end - 1])) != 0) {
-    --end;
+  // 各块内已按时间戳排序，按块序拼接后稳定排序，同一时间戳的记录保持文件顺序，再合并为一帧。
+  std::vector<Frame> frames;
+  for (auto& chunk : chunks) {
+    std::vector<Frame> sorted = TakeSorted(chunk);
+    MoveAppend(frames, sorted);
   }
-  return value.substr(start, end - start);
+  const auto by_ts = [](const Frame& a, const Frame& b) { return a.first < b.first; };
+  if (!std::is_sorted(frames.begin(), frames.end(), by_ts)) {
+    std::stable_sort(frames.begin(), frames.end(), by_ts);
+  }
+
+  std::vector<DisPduBatch> batches;
+  batches.reserve(frames.size());
+  for (std::size_t i = 0; i < frames.size(); ++i) {
+    if (i > 0 && frames[i].first == frames[i - 1].first) {
+      DisPduBatch& into = batches.back();
+      DisPduBatch& from = frames[i].second;
+      MoveAppend(into.entity_updates, from.entity_updates);
+      MoveAppend(into.fire_events, from.fire_events);
+      if (from.env.has_value()) {
+        into.env = from.env;
+      }
+      continue;
+    }
+    batches.push_back(std::move(frames[i].second));
+  }
+  return batches;
 }
 
 }  // namespace bas
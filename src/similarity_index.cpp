@@ -0,0 +1,171 @@
+#include "bas/cache/similarity_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <string>
+
+namespace bas {
+
+namespace {
+
+constexpr std::size_t kTypeCount = 6;
+constexpr std::size_t kCentroidOffset = 2 * kTypeCount;
+constexpr std::size_t kThreatOffset = kCentroidOffset + 4;
+constexpr std::size_t kThreatBins = 4;
+constexpr std::size_t kVisibilityOffset = kThreatOffset + kThreatBins;
+constexpr std::size_t kTagOffset = kVisibilityOffset + 1;
+constexpr std::size_t kTagBits = kSituationFeatureDim - kTagOffset;
+
+void AccumulateSide(const std::vector<EntityState>& units, std::size_t count_offset, std::size_t centroid_offset,
+                    SituationFeatures& out) {
+  double sx = 0.0;
+  double sy = 0.0;
+  std::size_t alive = 0;
+  for (const auto& unit : units) {
+    if (!unit.alive) {
+      continue;
+    }
+    out[count_offset + static_cast<std::size_t>(unit.type)] += 1.0;
+    sx += unit.pose.x;
+    sy += unit.pose.y;
+    ++alive;
+  }
+  if (alive > 0) {
+    out[centroid_offset] = sx / static_cast<double>(alive) / 1000.0;
+    out[centroid_offset + 1] = sy / static_cast<double>(alive) / 1000.0;
+  }
+}
+
+}  // namespace
+
+SituationFeatures ExtractSituationFeatures(const BattlefieldSnapshot& snapshot, const SituationSemantics& semantics) {
+  SituationFeatures out{};
+  AccumulateSide(snapshot.friendly_units, 0, kCentroidOffset, out);
+  AccumulateSide(snapshot.hostile_units, kTypeCount, kCentroidOffset + 2, out);
+  for (const auto& unit : snapshot.hostile_units) {
+    if (unit.alive) {
+      const double level = std::clamp(unit.threat_level, 0.0, 1.0);
+      out[kThreatOffset + std::min(kThreatBins - 1, static_cast<std::size_t>(level * kThreatBins))] += 1.0;
+    }
+  }
+  out[kVisibilityOffset] = snapshot.env.visibility_m / 1000.0;
+  for (const auto& tag : semantics.tags) {
+    out[kTagOffset + std::hash<std::string>{}(tag.name) % kTagBits] = 1.0;
+  }
+  return out;
+}
+
+double FeatureDistance(const SituationFeatures& a, const SituationFeatures& b) {
+  double sum = 0.0;
+  for (std::size_t i = 0; i < kSituationFeatureDim; ++i) {
+    const double d = a[i] - b[i];
+    sum += d * d;
+  }
+  return std::sqrt(sum);
+}
+
+SimilarityIndex::SimilarityIndex(std::size_t capacity, double threshold, std::int64_t ttl_ms, std::uint32_t seed)
+    : threshold_(threshold),
+      ttl_ms_(ttl_ms),
+      // 桶宽取阈值的 4 倍：阈值内的两点在单个投影上落入同桶的概率约 0.8，四表合计召回约九成以上。
+      bucket_width_(std::max(1e-6, 4.0 * threshold)),
+      entries_(std::max<std::size_t>(1, capacity)),
+      visit_stamp_(entries_.size(), 0) {
+  std::mt19937 rng(seed);
+  std::normal_distribution<double> gaussian(0.0, 1.0);
+  std::uniform_real_distribution<double> uniform(0.0, bucket_width_);
+  projections_.resize(kTables * kProjections * kSituationFeatureDim);
+  for (double& p : projections_) {
+    p = gaussian(rng);
+  }
+  offsets_.resize(kTables * kProjections);
+  for (double& b : offsets_) {
+    b = uniform(rng);
+  }
+}
+
+std::optional<SimilarMatch> SimilarityIndex::FindNearest(const SituationFeatures& features, std::int64_t now_ms) {
+  ++stats_.queries;
+  ++query_seq_;
+  std::optional<SimilarMatch> best;
+  for (std::size_t t = 0; t < kTables; ++t) {
+    const auto it = tables_[t].find(BucketOf(t, features));
+    if (it == tables_[t].end()) {
+      continue;
+    }
+    for (const std::uint32_t slot : it->second) {
+      if (visit_stamp_[slot] == query_seq_) {
+        continue;
+      }
+      visit_stamp_[slot] = query_seq_;
+      ++stats_.candidates_checked;
+      const Entry& entry = entries_[slot];
+      if (now_ms - entry.timestamp_ms > ttl_ms_ || now_ms < entry.timestamp_ms) {
+        continue;
+      }
+      const double distance = FeatureDistance(features, entry.features);
+      if (distance <= threshold_ && (!best.has_value() || distance < best->distance)) {
+        best = SimilarMatch{entry.value, distance, entry.timestamp_ms};
+      }
+    }
+  }
+  if (best.has_value()) {
+    ++stats_.matches;
+  }
+  return best;
+}
+
+void SimilarityIndex::Insert(const SituationFeatures& features,
+                             std::shared_ptr<const DecisionPackage> value,
+                             std::int64_t now_ms) {
+  ++stats_.inserts;
+  const auto slot = static_cast<std::uint32_t>(next_);
+  if (entries_[slot].value != nullptr) {
+    Unindex(slot);
+  } else {
+    ++size_;
+  }
+  next_ = (next_ + 1) % entries_.size();
+
+  Entry& entry = entries_[slot];
+  entry.features = features;
+  entry.value = std::move(value);
+  entry.timestamp_ms = now_ms;
+  for (std::size_t t = 0; t < kTables; ++t) {
+    entry.buckets[t] = BucketOf(t, features);
+    tables_[t][entry.buckets[t]].push_back(slot);
+  }
+}
+
+std::uint64_t SimilarityIndex::BucketOf(std::size_t table, const SituationFeatures& features) const {
+  std::uint64_t bucket = 1469598103934665603ULL;
+  for (std::size_t p = 0; p < kProjections; ++p) {
+    const std::size_t row = table * kProjections + p;
+    const double* a = &projections_[row * kSituationFeatureDim];
+    double dot = offsets_[row];
+    for (std::size_t i = 0; i < kSituationFeatureDim; ++i) {
+      dot += a[i] * features[i];
+    }
+    const auto cell = static_cast<std::int64_t>(std::floor(dot / bucket_width_));
+    bucket = (bucket ^ static_cast<std::uint64_t>(cell)) * 1099511628211ULL;
+  }
+  return bucket;
+}
+
+void SimilarityIndex::Unindex(std::uint32_t slot) {
+  for (std::size_t t = 0; t < kTables; ++t) {
+    const auto it = tables_[t].find(entries_[slot].buckets[t]);
+    if (it == tables_[t].end()) {
+      continue;
+    }
+    auto& slots = it->second;
+    slots.erase(std::remove(slots.begin(), slots.end(), slot), slots.end());
+    if (slots.empty()) {
+      tables_[t].erase(it);
+    }
+  }
+}
+
+}  // namespace bas
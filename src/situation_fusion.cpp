@@ -1,19 +1,25 @@
 #include "bas/situation/situation_fusion.hpp"
 
 #include <algorithm>
+#include <optional>
 
 namespace bas {
 
 SituationSemantics SituationFusion::Infer(const BattlefieldSnapshot& snapshot,
-                                          const std::vector<EventRecord>& recent_events) const {
+                                          const EventMemory& memory,
+                                          std::int64_t window_ms,
+                                          const SnapshotIndex* index) const {
   SituationSemantics semantics;
   if (snapshot.friendly_units.empty() || snapshot.hostile_units.empty()) {
     semantics.tags.push_back({"insufficient_contact", 1.0, "缺少敌我有效接触信息"});
     return semantics;
   }
 
-  const int left_flank_threats = CountEnemyOnLeftFlank(snapshot);
-  const int nearby_armor = CountNearbyArmor(snapshot, 2200.0);
+  std::optional<SnapshotIndex> local_index;
+  const SnapshotIndex& geo = index != nullptr ? *index : local_index.emplace(snapshot);
+
+  const int left_flank_threats = CountEnemyOnLeftFlank(geo.friendlies(), geo.hostiles());
+  const int nearby_armor = CountNearbyArmor(geo, 2200.0);
 
   if (left_flank_threats > 0) {
     semantics.tags.push_back({"left_flank_exposed", std::min(1.0, left_flank_threats / 3.0),
@@ -29,8 +35,10 @@ SituationSemantics SituationFusion::Infer(const BattlefieldSnapshot& snapshot,
     semantics.tags.push_back({"low_visibility", 0.85, "可视距离低于700米"});
   }
 
-  const bool recent_artillery_fire = std::any_of(recent_events.begin(), recent_events.end(), [](const EventRecord& ev) {
-    return ev.type == EventType::WeaponFire && ev.message.find("howitzer") != std::string::npos;
+  // 只沿开火事件链检索，按弹药类别判断，不再扫描窗口内全部事件。
+  const auto fire_events = memory.QueryByType(EventType::WeaponFire, snapshot.timestamp_ms, window_ms);
+  const bool recent_artillery_fire = std::any_of(fire_events.begin(), fire_events.end(), [](const EventView& ev) {
+    return ev.fire.munition == MunitionClass::Indirect;
   });
   if (recent_artillery_fire) {
     semantics.tags.push_back({"recent_enemy_artillery_activity", 0.75, "记忆窗口内出现敌方炮兵火力活动"});
@@ -43,32 +51,24 @@ SituationSemantics SituationFusion::Infer(const BattlefieldSnapshot& snapshot,
   return semantics;
 }
 
-int SituationFusion::CountEnemyOnLeftFlank(const BattlefieldSnapshot& snapshot) {
-  const auto min_x_it = std::min_element(snapshot.friendly_units.begin(), snapshot.friendly_units.end(),
-                                         [](const EntityState& a, const EntityState& b) {
-                                           return a.pose.x < b.pose.x;
-                                         });
-  const double left_boundary = min_x_it->pose.x + 200.0;
+int SituationFusion::CountEnemyOnLeftFlank(const EntityTable& friendlies, const EntityTable& hostiles) {
+  const double left_boundary = *std::min_element(friendlies.x.begin(), friendlies.x.end()) + 200.0;
   int count = 0;
-  for (const auto& enemy : snapshot.hostile_units) {
-    if (enemy.pose.x < left_boundary) {
-      ++count;
-    }
+  for (std::size_t i = 0; i < hostiles.size(); ++i) {
+    count += hostiles.x[i] < left_boundary ? 1 : 0;
   }
   return count;
 }
 
-int SituationFusion::CountNearbyArmor(const BattlefieldSnapshot& snapshot, double range_m) {
+int SituationFusion::CountNearbyArmor(const SnapshotIndex& index, double range_m) {
+  const EntityTable& hostiles = index.hostiles();
   int count = 0;
-  for (const auto& enemy : snapshot.hostile_units) {
-    if (enemy.type != UnitType::Armor) {
+  for (std::size_t i = 0; i < hostiles.size(); ++i) {
+    if (hostiles.type[i] != UnitType::Armor) {
       continue;
     }
-    const bool in_range = std::any_of(snapshot.friendly_units.begin(), snapshot.friendly_units.end(),
-                                      [&](const EntityState& friendly) {
-                                        return Distance(enemy.pose, friendly.pose) <= range_m;
-                                      });
-    if (in_range) {
+    const Pose enemy{hostiles.x[i], hostiles.y[i], hostiles.z[i]};
+    if (index.friendly_grid().AnyWithin(enemy, range_m)) {
       ++count;
     }
   }
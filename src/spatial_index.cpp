@@ -0,0 +1,256 @@
+#include "bas/common/spatial_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+namespace bas {
+
+namespace {
+
+bool NeighborLess(const SpatialNeighbor& a, const SpatialNeighbor& b) {
+  if (a.distance_sq != b.distance_sq) {
+    return a.distance_sq < b.distance_sq;
+  }
+  return a.index < b.index;
+}
+
+}  // namespace
+
+SpatialGrid::SpatialGrid(double cell_size_m) : cell_size_(cell_size_m > 0.0 ? cell_size_m : 250.0) {}
+
+std::int32_t SpatialGrid::CellCoord(double v) const {
+  const double c = std::floor(v / cell_size_);
+  constexpr double kLimit = static_cast<double>(std::numeric_limits<std::int32_t>::max() / 2);
+  return static_cast<std::int32_t>(std::clamp(c, -kLimit, kLimit));
+}
+
+void SpatialGrid::Build(const EntityTable& table) {
+  table_ = &table;
+  cells_.clear();
+  items_.clear();
+  cell_by_key_.clear();
+  min_cx_ = min_cy_ = 0;
+  max_cx_ = max_cy_ = -1;
+
+  const std::size_t n = table.size();
+  if (n == 0) {
+    return;
+  }
+
+  struct Entry {
+    std::int32_t cx;
+    std::int32_t cy;
+    std::uint32_t index;
+  };
+  std::vector<Entry> entries(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    entries[i] = {CellCoord(table.x[i]), CellCoord(table.y[i]), static_cast<std::uint32_t>(i)};
+  }
+  std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+    if (a.cx != b.cx) {
+      return a.cx < b.cx;
+    }
+    if (a.cy != b.cy) {
+      return a.cy < b.cy;
+    }
+    return a.index < b.index;
+  });
+
+  items_.reserve(n);
+  min_cx_ = max_cx_ = entries.front().cx;
+  min_cy_ = max_cy_ = entries.front().cy;
+  for (const auto& e : entries) {
+    if (cells_.empty() || cells_.back().cx != e.cx || cells_.back().cy != e.cy) {
+      cells_.push_back({e.cx, e.cy, static_cast<std::uint32_t>(items_.size()), static_cast<std::uint32_t>(items_.size())});
+      min_cx_ = std::min(min_cx_, e.cx);
+      max_cx_ = std::max(max_cx_, e.cx);
+      min_cy_ = std::min(min_cy_, e.cy);
+      max_cy_ = std::max(max_cy_, e.cy);
+    }
+    items_.push_back(e.index);
+    cells_.back().end = static_cast<std::uint32_t>(items_.size());
+  }
+
+  cell_by_key_.reserve(cells_.size());
+  for (std::size_t i = 0; i < cells_.size(); ++i) {
+    cell_by_key_.emplace(Key(cells_[i].cx, cells_[i].cy), static_cast<std::uint32_t>(i));
+  }
+}
+
+const SpatialGrid::Cell* SpatialGrid::FindCell(std::int32_t cx, std::int32_t cy) const {
+  const auto it = cell_by_key_.find(Key(cx, cy));
+  return it == cell_by_key_.end() ? nullptr : &cells_[it->second];
+}
+
+template <typename Visitor>
+void SpatialGrid::VisitCellsInBox(std::int32_t min_cx,
+                                  std::int32_t max_cx,
+                                  std::int32_t min_cy,
+                                  std::int32_t max_cy,
+                                  Visitor&& visit) const {
+  min_cx = std::max(min_cx, min_cx_);
+  max_cx = std::min(max_cx, max_cx_);
+  min_cy = std::max(min_cy, min_cy_);
+  max_cy = std::min(max_cy, max_cy_);
+  if (min_cx > max_cx || min_cy > max_cy) {
+    return;
+  }
+
+  const double box_cells = (static_cast<double>(max_cx) - min_cx + 1.0) * (static_cast<double>(max_cy) - min_cy + 1.0);
+  if (box_cells > static_cast<double>(cells_.size())) {
+    // 查询框远大于已占用网格数（稀疏场景）时，直接遍历已占用网格更省。
+    for (const auto& cell : cells_) {
+      if (cell.cx >= min_cx && cell.cx <= max_cx && cell.cy >= min_cy && cell.cy <= max_cy && !visit(cell)) {
+        return;
+      }
+    }
+    return;
+  }
+
+  for (std::int32_t cx = min_cx; cx <= max_cx; ++cx) {
+    for (std::int32_t cy = min_cy; cy <= max_cy; ++cy) {
+      const Cell* cell = FindCell(cx, cy);
+      if (cell != nullptr && !visit(*cell)) {
+        return;
+      }
+    }
+  }
+}
+
+void SpatialGrid::QueryRadius(const Pose& center, double radius_m, std::vector<std::size_t>& out) const {
+  out.clear();
+  if (empty() || radius_m < 0.0) {
+    return;
+  }
+  const double radius_sq = radius_m * radius_m;
+  VisitCellsInBox(CellCoord(center.x - radius_m), CellCoord(center.x + radius_m), CellCoord(center.y - radius_m),
+                  CellCoord(center.y + radius_m), [&](const Cell& cell) {
+                    for (std::uint32_t k = cell.begin; k < cell.end; ++k) {
+                      if (table_->DistanceSquared(items_[k], center) <= radius_sq) {
+                        out.push_back(items_[k]);
+                      }
+                    }
+                    return true;
+                  });
+  std::sort(out.begin(), out.end());
+}
+
+bool SpatialGrid::AnyWithin(const Pose& center, double radius_m) const {
+  if (empty() || radius_m < 0.0) {
+    return false;
+  }
+  const double radius_sq = radius_m * radius_m;
+  bool found = false;
+  VisitCellsInBox(CellCoord(center.x - radius_m), CellCoord(center.x + radius_m), CellCoord(center.y - radius_m),
+                  CellCoord(center.y + radius_m), [&](const Cell& cell) {
+                    for (std::uint32_t k = cell.begin; k < cell.end; ++k) {
+                      if (table_->DistanceSquared(items_[k], center) <= radius_sq) {
+                        found = true;
+                        return false;
+                      }
+                    }
+                    return true;
+                  });
+  return found;
+}
+
+bool SpatialGrid::Nearest(const Pose& point, SpatialNeighbor& out) const {
+  std::vector<SpatialNeighbor> best;
+  Knn(point, 1, best);
+  if (best.empty()) {
+    return false;
+  }
+  out = best.front();
+  return true;
+}
+
+void SpatialGrid::Knn(const Pose& point, std::size_t k, std::vector<SpatialNeighbor>& out) const {
+  out.clear();
+  if (empty() || k == 0) {
+    return;
+  }
+
+  // out 作为按 NeighborLess 排序的大顶堆，堆顶为当前第 k 近的候选。
+  const auto offer = [&](const Cell& cell) {
+    for (std::uint32_t i = cell.begin; i < cell.end; ++i) {
+      const SpatialNeighbor candidate{items_[i], table_->DistanceSquared(items_[i], point)};
+      if (out.size() < k) {
+        out.push_back(candidate);
+        std::push_heap(out.begin(), out.end(), NeighborLess);
+      } else if (NeighborLess(candidate, out.front())) {
+        std::pop_heap(out.begin(), out.end(), NeighborLess);
+        out.back() = candidate;
+        std::push_heap(out.begin(), out.end(), NeighborLess);
+      }
+    }
+    return true;
+  };
+
+  const std::int32_t pcx = CellCoord(point.x);
+  const std::int32_t pcy = CellCoord(point.y);
+  const std::int64_t max_ring = std::max({std::llabs(static_cast<std::int64_t>(pcx) - min_cx_),
+                                          std::llabs(static_cast<std::int64_t>(pcx) - max_cx_),
+                                          std::llabs(static_cast<std::int64_t>(pcy) - min_cy_),
+                                          std::llabs(static_cast<std::int64_t>(pcy) - max_cy_)});
+
+  for (std::int64_t ring = 0; ring <= max_ring; ++ring) {
+    if (8 * ring > static_cast<std::int64_t>(cells_.size())) {
+      // 环上网格数超过已占用网格数：剩余部分一次性遍历所有未访问网格。
+      for (const auto& cell : cells_) {
+        const std::int64_t cheb = std::max(std::llabs(static_cast<std::int64_t>(cell.cx) - pcx),
+                                           std::llabs(static_cast<std::int64_t>(cell.cy) - pcy));
+        if (cheb >= ring) {
+          offer(cell);
+        }
+      }
+      break;
+    }
+
+    const auto r = static_cast<std::int32_t>(ring);
+    if (r == 0) {
+      if (const Cell* cell = FindCell(pcx, pcy)) {
+        offer(*cell);
+      }
+    } else {
+      for (std::int32_t cx = pcx - r; cx <= pcx + r; ++cx) {
+        if (const Cell* top = FindCell(cx, pcy - r)) {
+          offer(*top);
+        }
+        if (const Cell* bottom = FindCell(cx, pcy + r)) {
+          offer(*bottom);
+        }
+      }
+      for (std::int32_t cy = pcy - r + 1; cy <= pcy + r - 1; ++cy) {
+        if (const Cell* left = FindCell(pcx - r, cy)) {
+          offer(*left);
+        }
+        if (const Cell* right = FindCell(pcx + r, cy)) {
+          offer(*right);
+        }
+      }
+    }
+
+    // 第 ring+1 环及以外的点距查询点至少 ring 个网格宽度。
+    const double bound = static_cast<double>(ring) * cell_size_;
+    if (out.size() == k && out.front().distance_sq <= bound * bound) {
+      break;
+    }
+  }
+
+  std::sort_heap(out.begin(), out.end(), NeighborLess);
+}
+
+SnapshotIndex::SnapshotIndex(const BattlefieldSnapshot& snapshot, double cell_size_m)
+    : friendlies_(&ResolveEntityTable(snapshot.friendly_table, snapshot.friendly_units, snapshot.units_generation,
+                                          friendly_scratch_)),
+      hostiles_(&ResolveEntityTable(snapshot.hostile_table, snapshot.hostile_units, snapshot.units_generation,
+                                         hostile_scratch_)),
+      friendly_grid_(cell_size_m),
+      hostile_grid_(cell_size_m) {
+  friendly_grid_.Build(*friendlies_);
+  hostile_grid_.Build(*hostiles_);
+}
+
+}  // namespace bas
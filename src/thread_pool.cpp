@@ -0,0 +1,219 @@
+#include "bas/common/thread_pool.hpp"
+
+#include <algorithm>
+#include <exception>
+
+namespace bas {
+
+namespace {
+
+// 记录当前线程所属的线程池与槽位，用于本地入队与 CurrentSlot；外部线程仅在 ParallelFor 期间设置。
+thread_local const ThreadPool* tls_pool = nullptr;
+thread_local std::size_t tls_slot = 0;
+
+}  // namespace
+
+ThreadPool::ThreadPool(std::size_t thread_count, std::size_t external_slots)
+    : external_slots_(std::max<std::size_t>(1, external_slots)) {
+  if (thread_count == 0) {
+    thread_count = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+  }
+  // 倒序压栈，先租出编号最小的外部槽位。
+  for (std::size_t i = external_slots_; i > 0; --i) {
+    free_slots_.push_back(thread_count + i - 1);
+  }
+  queues_.reserve(thread_count);
+  for (std::size_t i = 0; i < thread_count; ++i) {
+    queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+  workers_.reserve(thread_count);
+  for (std::size_t i = 0; i < thread_count; ++i) {
+    workers_.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+std::size_t ThreadPool::CurrentSlot() const {
+  return tls_pool == this ? tls_slot : slot_count();
+}
+
+std::size_t ThreadPool::AcquireExternalSlot() {
+  std::unique_lock<std::mutex> lock(slot_mutex_);
+  slot_free_.wait(lock, [this] { return !free_slots_.empty(); });
+  const std::size_t slot = free_slots_.back();
+  free_slots_.pop_back();
+  return slot;
+}
+
+void ThreadPool::ReleaseExternalSlot(std::size_t slot) {
+  {
+    std::lock_guard<std::mutex> lock(slot_mutex_);
+    free_slots_.push_back(slot);
+  }
+  slot_free_.notify_one();
+}
+
+void ThreadPool::Submit(Task task) {
+  const bool own_queue = tls_pool == this && tls_slot < queues_.size();
+  const std::size_t target =
+      own_queue ? tls_slot : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+  {
+    std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+    queues_[target]->tasks.push_back(std::move(task));
+  }
+  {
+    // 在唤醒锁内递增，避免工作线程检查 pending_ 与进入等待之间丢失通知。
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    pending_.fetch_add(1, std::memory_order_release);
+  }
+  wake_.notify_one();
+}
+
+bool ThreadPool::PopLocal(std::size_t index, Task& out) {
+  WorkerQueue& queue = *queues_[index];
+  std::lock_guard<std::mutex> lock(queue.mutex);
+  if (queue.tasks.empty()) {
+    return false;
+  }
+  out = std::move(queue.tasks.back());
+  queue.tasks.pop_back();
+  return true;
+}
+
+bool ThreadPool::Steal(std::size_t thief, Task& out) {
+  const std::size_t n = queues_.size();
+  for (std::size_t k = 1; k <= n; ++k) {
+    WorkerQueue& victim = *queues_[(thief + k) % n];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      out = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ThreadPool::TryRunOne(std::size_t self) {
+  Task task;
+  const bool own = self < queues_.size() && PopLocal(self, task);
+  if (!own && !Steal(self % queues_.size(), task)) {
+    return false;
+  }
+  pending_.fetch_sub(1, std::memory_order_acq_rel);
+  // 并行块自行把异常交给所属组；这里兜住 Submit 任务的异常，避免工作线程终止，
+  // 或在 ParallelFor 调用方协助执行时越过其等待循环。
+  try {
+    task();
+  } catch (...) {
+    failed_tasks_.fetch_add(1, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+void ThreadPool::WorkerLoop(std::size_t index) {
+  tls_pool = this;
+  tls_slot = index;
+  for (;;) {
+    if (TryRunOne(index)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_.wait(lock, [this] { return stopping_ || pending_.load(std::memory_order_acquire) > 0; });
+    if (stopping_ && pending_.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+  }
+}
+
+void ThreadPool::ParallelFor(std::size_t count, std::size_t grain, const RangeTask& fn) {
+  if (count == 0) {
+    return;
+  }
+  grain = std::max<std::size_t>(1, grain);
+  const std::size_t chunks = (count + grain - 1) / grain;
+
+  // 外部线程在整个调用期间独占一个外部槽位；嵌套调用沿用已租槽位。
+  struct SlotLease {
+    ThreadPool* pool;
+    const ThreadPool* saved_pool;
+    std::size_t saved_slot;
+    bool leased;
+    ~SlotLease() {
+      if (leased) {
+        pool->ReleaseExternalSlot(tls_slot);
+        tls_pool = saved_pool;
+        tls_slot = saved_slot;
+      }
+    }
+  };
+  const SlotLease lease{this, tls_pool, tls_slot, tls_pool != this};
+  if (lease.leased) {
+    tls_slot = AcquireExternalSlot();
+    tls_pool = this;
+  }
+  const std::size_t caller_slot = tls_slot;
+  if (chunks == 1) {
+    fn(0, count, caller_slot);
+    return;
+  }
+
+  struct Group {
+    std::atomic<std::size_t> remaining;
+    std::mutex error_mutex;
+    std::exception_ptr error;
+  };
+  auto group = std::make_shared<Group>();
+  group->remaining.store(chunks, std::memory_order_relaxed);
+
+  const auto run_chunk = [this, group, &fn, count, grain](std::size_t chunk) {
+    const std::size_t begin = chunk * grain;
+    const std::size_t end = std::min(count, begin + grain);
+    try {
+      fn(begin, end, CurrentSlot());
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(group->error_mutex);
+      if (!group->error) {
+        group->error = std::current_exception();
+      }
+    }
+    if (group->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      // 经唤醒锁通知，避免调用方检查完成状态与进入等待之间丢失通知。
+      { std::lock_guard<std::mutex> lock(wake_mutex_); }
+      wake_.notify_all();
+    }
+  };
+
+  // 首块留给调用线程，其余入队供工作线程窃取。
+  for (std::size_t chunk = 1; chunk < chunks; ++chunk) {
+    Submit([run_chunk, chunk] { run_chunk(chunk); });
+  }
+  run_chunk(0);
+
+  // 等待期间协助执行队列中的任务（可能属于其他并行组），避免嵌套调用时死锁；
+  // 无任务可取时阻塞，直到有新任务入队或本组完成。
+  while (group->remaining.load(std::memory_order_acquire) != 0) {
+    if (TryRunOne(caller_slot)) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_.wait(lock, [this, &group] {
+      return group->remaining.load(std::memory_order_acquire) == 0 || pending_.load(std::memory_order_acquire) > 0;
+    });
+  }
+  if (group->error) {
+    std::rethrow_exception(group->error);
+  }
+}
+
+}  // namespace bas
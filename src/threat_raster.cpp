@@ -0,0 +1,168 @@
+#include "bas/decision/threat_raster.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace bas {
+
+namespace {
+
+// 变化实体数超过该比例（或累计增量修正次数过多）时整体失效，避免浮点误差累积与增量成本超过重算。
+constexpr double kIncrementalFraction = 0.125;
+constexpr std::size_t kMinIncrementalSources = 4;
+constexpr std::size_t kMaxUpdatesBeforeRebuild = 64;
+
+}  // namespace
+
+ThreatRaster::ThreatRaster(double cell_size_m) : cell_size_(cell_size_m > 0.0 ? cell_size_m : 80.0) {}
+
+std::int32_t ThreatRaster::CellCoord(double v) const {
+  const double c = std::floor(v / cell_size_);
+  constexpr double kLimit = static_cast<double>(std::numeric_limits<std::int32_t>::max() / 2);
+  return static_cast<std::int32_t>(std::clamp(c, -kLimit, kLimit));
+}
+
+std::int32_t ThreatRaster::TileCoord(std::int32_t c) {
+  return c >= 0 ? c / kTileCells : -((-c + kTileCells - 1) / kTileCells);
+}
+
+void ThreatRaster::Update(const std::vector<EntityState>& hostiles) {
+  std::vector<Source> next;
+  next.reserve(hostiles.size());
+  std::unordered_map<EntityId, std::size_t> next_index;
+  next_index.reserve(hostiles.size());
+  for (const auto& h : hostiles) {
+    const Source source{h.id, h.pose.x, h.pose.y, h.threat_level * 120.0 + 20.0,
+                        h.type == UnitType::Artillery ? 12.0 : 0.0};
+    const auto [it, inserted] = next_index.emplace(h.id, next.size());
+    if (inserted) {
+      next.push_back(source);
+    } else {
+      next[it->second] = source;
+    }
+  }
+
+  if (!tiles_.empty()) {
+    std::vector<Source> removed;
+    std::vector<Source> added;
+    for (const Source& old : sources_) {
+      const auto it = next_index.find(old.id);
+      if (it == next_index.end()) {
+        removed.push_back(old);
+        continue;
+      }
+      const Source& now = next[it->second];
+      if (now.x != old.x || now.y != old.y || now.weight != old.weight || now.artillery != old.artillery) {
+        removed.push_back(old);
+        added.push_back(now);
+      }
+    }
+    for (const Source& now : next) {
+      if (source_index_.find(now.id) == source_index_.end()) {
+        added.push_back(now);
+      }
+    }
+
+    const std::size_t changed = std::max(removed.size(), added.size());
+    const std::size_t limit =
+        std::max(kMinIncrementalSources, static_cast<std::size_t>(kIncrementalFraction * static_cast<double>(next.size())));
+    if (changed > limit || updates_since_rebuild_ >= kMaxUpdatesBeforeRebuild) {
+      tiles_.clear();
+      updates_since_rebuild_ = 0;
+      ++stats_.full_invalidations;
+    } else if (changed > 0) {
+      for (auto& [key, tile] : tiles_) {
+        const auto tx = static_cast<std::int32_t>(static_cast<std::uint32_t>(key >> 32U));
+        const auto ty = static_cast<std::int32_t>(static_cast<std::uint32_t>(key));
+        for (const Source& s : removed) {
+          Accumulate(tx, ty, s, -1.0, tile);
+        }
+        for (const Source& s : added) {
+          Accumulate(tx, ty, s, 1.0, tile);
+        }
+      }
+      ++updates_since_rebuild_;
+      ++stats_.incremental_updates;
+    }
+  }
+
+  sources_ = std::move(next);
+  source_index_ = std::move(next_index);
+}
+
+void ThreatRaster::Accumulate(std::int32_t tx, std::int32_t ty, const Source& source, double sign, Tile& tile) const {
+  const double origin_x = (static_cast<double>(tx) * kTileCells + 0.5) * cell_size_;
+  const double origin_y = (static_cast<double>(ty) * kTileCells + 0.5) * cell_size_;
+  for (std::int32_t j = 0; j < kTileCells; ++j) {
+    const double dy = origin_y + j * cell_size_ - source.y;
+    const double dy_sq = dy * dy;
+    double* row = tile.data() + static_cast<std::size_t>(j) * kTileCells;
+    for (std::int32_t i = 0; i < kTileCells; ++i) {
+      const double dx = origin_x + i * cell_size_ - source.x;
+      const double d = std::max(25.0, std::sqrt(dx * dx + dy_sq));
+      double value = source.weight / d;
+      if (source.artillery != 0.0) {
+        value += source.artillery / std::sqrt(d);
+      }
+      row[i] += sign * value;
+    }
+  }
+}
+
+ThreatRaster::Tile& ThreatRaster::TileAt(std::int32_t tx, std::int32_t ty) {
+  const auto [it, inserted] = tiles_.try_emplace(TileKey(tx, ty));
+  if (inserted) {
+    it->second.fill(0.0);
+    for (const Source& s : sources_) {
+      Accumulate(tx, ty, s, 1.0, it->second);
+    }
+    ++stats_.tiles_built;
+  }
+  return it->second;
+}
+
+double ThreatRaster::SampleCell(std::int32_t cx, std::int32_t cy) {
+  const std::int32_t tx = TileCoord(cx);
+  const std::int32_t ty = TileCoord(cy);
+  const Tile& tile = TileAt(tx, ty);
+  const std::int32_t i = cx - tx * kTileCells;
+  const std::int32_t j = cy - ty * kTileCells;
+  return tile[static_cast<std::size_t>(j) * kTileCells + static_cast<std::size_t>(i)];
+}
+
+double ThreatRaster::SampleReadOnly(const Pose& point) const {
+  const std::int32_t cx = CellCoord(point.x);
+  const std::int32_t cy = CellCoord(point.y);
+  const std::int32_t tx = TileCoord(cx);
+  const std::int32_t ty = TileCoord(cy);
+  const auto it = tiles_.find(TileKey(tx, ty));
+  if (it == tiles_.end()) {
+    return PointValue((cx + 0.5) * cell_size_, (cy + 0.5) * cell_size_);
+  }
+  const std::int32_t i = cx - tx * kTileCells;
+  const std::int32_t j = cy - ty * kTileCells;
+  return it->second[static_cast<std::size_t>(j) * kTileCells + static_cast<std::size_t>(i)];
+}
+
+double ThreatRaster::PointValue(double x, double y) const {
+  double value = 0.0;
+  for (const Source& s : sources_) {
+    const double d = std::max(25.0, std::hypot(x - s.x, y - s.y));
+    value += s.weight / d;
+    if (s.artillery != 0.0) {
+      value += s.artillery / std::sqrt(d);
+    }
+  }
+  return value;
+}
+
+void ThreatRaster::Materialize(std::int32_t min_cx, std::int32_t max_cx, std::int32_t min_cy, std::int32_t max_cy) {
+  for (std::int32_t ty = TileCoord(min_cy); ty <= TileCoord(max_cy); ++ty) {
+    for (std::int32_t tx = TileCoord(min_cx); tx <= TileCoord(max_cx); ++tx) {
+      TileAt(tx, ty);
+    }
+  }
+}
+
+}  // namespace bas
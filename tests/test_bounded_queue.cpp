@@ -0,0 +1,47 @@
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+#include "bas/common/bounded_queue.hpp"
+
+int main() {
+  // 有界队列：容量为 2 时生产者随消费推进，顺序不变；关闭后取完剩余元素即结束。
+  bas::BoundedQueue<int> queue(2);
+  std::thread producer([&queue] {
+    for (int i = 0; i < 1000; ++i) {
+      queue.Push(i);
+    }
+    queue.Close();
+  });
+  int expected = 0;
+  int value = 0;
+  while (queue.Pop(value)) {
+    if (value != expected++) {
+      std::cerr << "有界队列顺序错误\n";
+      producer.join();
+      return EXIT_FAILURE;
+    }
+  }
+  producer.join();
+  if (expected != 1000 || queue.Push(1)) {
+    std::cerr << "有界队列关闭语义错误\n";
+    return EXIT_FAILURE;
+  }
+
+  // 队列满时阻塞的生产者在关闭后返回失败，不会永久挂起。
+  bas::BoundedQueue<int> full(0);
+  if (full.capacity() != 1 || !full.Push(1)) {
+    std::cerr << "零容量应按 1 处理\n";
+    return EXIT_FAILURE;
+  }
+  bool pushed = true;
+  std::thread blocked([&full, &pushed] { pushed = full.Push(2); });
+  full.Close();
+  blocked.join();
+  if (pushed || !full.Pop(value) || value != 1 || full.Pop(value)) {
+    std::cerr << "关闭后阻塞生产者或剩余元素处理错误\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,174 @@
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#include "bas/inference/model_runtime.hpp"
+#include "bas/system/columnar_replay.hpp"
+#include "bas/system/replay_runner.hpp"
+#include "bas/system/scenario_replay.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool SameBatches(const std::vector<bas::DisPduBatch>& a, const std::vector<bas::DisPduBatch>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (std::size_t f = 0; f < a.size(); ++f) {
+    if (a[f].env.has_value() != b[f].env.has_value() ||
+        a[f].entity_updates.size() != b[f].entity_updates.size() ||
+        a[f].fire_events.size() != b[f].fire_events.size()) {
+      return false;
+    }
+    if (a[f].env.has_value() && (a[f].env->visibility_m != b[f].env->visibility_m ||
+                                 a[f].env->weather_risk != b[f].env->weather_risk ||
+                                 a[f].env->terrain_risk != b[f].env->terrain_risk)) {
+      return false;
+    }
+    for (std::size_t i = 0; i < a[f].entity_updates.size(); ++i) {
+      const auto& x = a[f].entity_updates[i];
+      const auto& y = b[f].entity_updates[i];
+      if (x.timestamp_ms != y.timestamp_ms || x.entity_id != y.entity_id || x.side != y.side || x.type != y.type ||
+          x.pose.x != y.pose.x || x.pose.y != y.pose.y || x.pose.z != y.pose.z || x.speed_mps != y.speed_mps ||
+          x.heading_deg != y.heading_deg || x.alive != y.alive || x.threat_level != y.threat_level) {
+        return false;
+      }
+    }
+    for (std::size_t i = 0; i < a[f].fire_events.size(); ++i) {
+      const auto& x = a[f].fire_events[i];
+      const auto& y = b[f].fire_events[i];
+      if (x.timestamp_ms != y.timestamp_ms || x.shooter_id != y.shooter_id || x.target_id != y.target_id ||
+          x.weapon_name != y.weapon_name || x.origin.x != y.origin.x || x.origin.y != y.origin.y ||
+          x.origin.z != y.origin.z) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool Rejects(const std::string& path) {
+  try {
+    bas::ColumnarReplayReader reader(path);
+    reader.LoadBatches();
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+int main() {
+  const std::string candidate_a = "data/scenarios/demo_replay.bas";
+  const std::string candidate_b = "../data/scenarios/demo_replay.bas";
+  const std::string replay_path = std::ifstream(candidate_a).good() ? candidate_a : candidate_b;
+  const fs::path dir = fs::temp_directory_path() / "bas_columnar_replay_test";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+
+  // 文本回放往返：逐字段一致。
+  const auto text_batches = bas::ScenarioReplayLoader{}.LoadBatches(replay_path);
+  const std::string text_out = (dir / "demo.basc").string();
+  bas::WriteColumnarReplay(text_batches, text_out);
+  const bas::ColumnarReplayReader reader(text_out);
+  if (reader.frame_count() != text_batches.size() || !SameBatches(text_batches, reader.LoadBatches())) {
+    std::cerr << "文本回放列式往返不一致\n";
+    return EXIT_FAILURE;
+  }
+  for (std::size_t f = 1; f < reader.frame_count(); ++f) {
+    if (reader.timestamp(f) < reader.timestamp(f - 1)) {
+      std::cerr << "帧索引时间戳未升序\n";
+      return EXIT_FAILURE;
+    }
+  }
+  for (std::size_t f = 0; f < reader.frame_count(); ++f) {
+    if (reader.timestamp(f) != text_batches[f].timestamp_ms ||
+        reader.ReadFrame(f).timestamp_ms != reader.timestamp(f)) {
+      std::cerr << "帧时间戳与文本回放不一致（第 " << f << " 帧）\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  // DIS 编号、空帧、纯环境帧与多武器名。
+  std::vector<bas::DisPduBatch> dis(3);
+  for (int i = 0; i < 5; ++i) {
+    bas::DisEntityPdu pdu;
+    pdu.timestamp_ms = 1000;
+    pdu.entity_id = bas::EntityId::FromDis(1, 2, static_cast<std::uint16_t>(i + 1));
+    pdu.side = i % 2 == 0 ? bas::Side::Friendly : bas::Side::Hostile;
+    pdu.type = bas::UnitType::Armor;
+    pdu.pose = {100.0 * i, -3.25 * i, 1.5};
+    pdu.speed_mps = 4.0 + i;
+    pdu.heading_deg = 12.5 * i;
+    pdu.alive = i != 3;
+    pdu.threat_level = 0.1 * i;
+    dis[0].entity_updates.push_back(pdu);
+  }
+  dis[0].fire_events.push_back({1000, bas::EntityId::FromDis(1, 2, 1), bas::EntityId::FromDis(1, 2, 2), "弹药",
+                                {1.0, 2.0, 3.0}});
+  dis[0].fire_events.push_back(
+      {1000, bas::EntityId::Intern("F-9"), bas::EntityId::FromDis(1, 2, 4), "120mm", {4.0, 5.0, 6.0}});
+  dis[2].env = bas::EnvironmentState{800.0, 0.4, 0.2};
+  const std::string dis_out = (dir / "dis.basc").string();
+  bas::WriteColumnarReplay(dis, dis_out);
+  if (!SameBatches(dis, bas::ColumnarReplayReader(dis_out).LoadBatches())) {
+    std::cerr << "DIS 批次列式往返不一致\n";
+    return EXIT_FAILURE;
+  }
+
+  // 批内时间戳不一致（迟到开火并入后续批次）：逐条时间戳原样往返，帧时间戳取最大值；
+  // 纯环境帧使用批次给出的时间戳，而不是沿用上一帧。
+  std::vector<bas::DisPduBatch> mixed(2);
+  mixed[0].entity_updates = {dis[0].entity_updates[0], dis[0].entity_updates[1]};
+  mixed[0].entity_updates[0].timestamp_ms = 2000;
+  mixed[0].entity_updates[1].timestamp_ms = 1500;
+  mixed[0].fire_events = {dis[0].fire_events[0]};
+  mixed[0].fire_events[0].timestamp_ms = 900;
+  mixed[1].env = bas::EnvironmentState{600.0, 0.5, 0.1};
+  mixed[1].timestamp_ms = 2500;
+  const std::string mixed_out = (dir / "mixed.basc").string();
+  bas::WriteColumnarReplay(mixed, mixed_out);
+  const bas::ColumnarReplayReader mixed_reader(mixed_out);
+  const auto mixed_loaded = mixed_reader.LoadBatches();
+  if (!SameBatches(mixed, mixed_loaded) || mixed_reader.timestamp(0) != 2000 || mixed_reader.timestamp(1) != 2500 ||
+      mixed_loaded[1].timestamp_ms != 2500) {
+    std::cerr << "混合时间戳批次或纯环境帧往返不一致\n";
+    return EXIT_FAILURE;
+  }
+
+  // 损坏输入：魔数错误与截断均须拒绝。
+  const std::vector<std::uint8_t> bytes = bas::EncodeColumnarReplay(dis);
+  {
+    std::ofstream bad((dir / "bad_magic.basc").string(), std::ios::binary);
+    bad << "XXXX";
+    bad.write(reinterpret_cast<const char*>(bytes.data()) + 4, static_cast<std::streamsize>(bytes.size() - 4));
+  }
+  {
+    std::ofstream cut((dir / "truncated.basc").string(), std::ios::binary);
+    cut.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size() - 9));
+  }
+  if (!Rejects((dir / "bad_magic.basc").string()) || !Rejects((dir / "truncated.basc").string())) {
+    std::cerr << "损坏的列式回放未被拒绝\n";
+    return EXIT_FAILURE;
+  }
+
+  // 列式回放与文本回放的决策结果一致。
+  bas::ModelRuntime model;
+  model.Configure({bas::ModelBackend::Mock, "Qwen1.5-1.8B-Chat", 128, true,
+                   "http://127.0.0.1:8000/v1/chat/completions", "", 250});
+  const bas::ReplayOptions options;
+  const auto from_text = bas::RunReplay(replay_path, options, model);
+  const auto from_columnar = bas::RunReplay(text_out, options, model);
+  if (!from_columnar.error.empty() || from_columnar.decision_digest != from_text.decision_digest ||
+      from_columnar.metrics.survival_rate != from_text.metrics.survival_rate) {
+    std::cerr << "列式回放决策与文本回放不一致: " << from_columnar.error << "\n";
+    return EXIT_FAILURE;
+  }
+
+  fs::remove_all(dir);
+  return EXIT_SUCCESS;
+}
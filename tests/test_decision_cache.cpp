@@ -0,0 +1,73 @@
+#include <cstdlib>
+#include <iostream>
+
+#include "bas/cache/decision_cache.hpp"
+
+namespace {
+
+bas::DecisionPackage MakePackage(const std::string& explanation) {
+  bas::DecisionPackage pkg;
+  pkg.explanation = explanation;
+  return pkg;
+}
+
+}  // namespace
+
+int main() {
+  bas::DecisionCache cache(1000, 3);
+  cache.Put(1, MakePackage("一"), 0);
+  cache.Put(2, MakePackage("二"), 100);
+  cache.Put(3, MakePackage("三"), 200);
+
+  // 命中返回共享的同一对象，不做拷贝。
+  const bas::DecisionCache::Value first = cache.Get(1, 300);
+  if (first == nullptr || first != cache.Get(1, 300) || first->explanation != "一") {
+    std::cerr << "命中应返回共享决策包\n";
+    return EXIT_FAILURE;
+  }
+
+  // 键 1 刚被访问，满容量时淘汰最久未用的键 2。
+  cache.Put(4, MakePackage("四"), 400);
+  if (cache.size() != 3 || cache.Peek(2) != nullptr || cache.Peek(1) == nullptr || cache.stats().evictions != 1) {
+    std::cerr << "LRU 淘汰错误\n";
+    return EXIT_FAILURE;
+  }
+
+  // LRU 顺序为 3、1、4，再写入时淘汰键 3。键 5 乱序写入于 50，时间链上排在键 4（400）之前。
+  cache.Put(5, MakePackage("五"), 50);
+  if (cache.Peek(3) != nullptr || cache.Peek(1) == nullptr || cache.Peek(5) == nullptr) {
+    std::cerr << "满容量写入应淘汰最久未用的键 3\n";
+    return EXIT_FAILURE;
+  }
+  cache.Prune(1040);
+  if (cache.Peek(1) != nullptr || cache.Peek(5) == nullptr) {
+    std::cerr << "时间链过期顺序错误\n";
+    return EXIT_FAILURE;
+  }
+  cache.Prune(1060);
+  if (cache.size() != 1 || cache.Peek(4) == nullptr || cache.stats().expirations != 2) {
+    std::cerr << "过期清理结果错误\n";
+    return EXIT_FAILURE;
+  }
+
+  // 原地替换保留写入时间：替换后仍在原时刻过期。
+  if (!cache.Replace(4, std::make_shared<const bas::DecisionPackage>(MakePackage("四'"))) ||
+      cache.Get(4, 1399)->explanation != "四'" || cache.Get(4, 1401) != nullptr || cache.Replace(4, nullptr)) {
+    std::cerr << "原地替换错误\n";
+    return EXIT_FAILURE;
+  }
+
+  const bas::DecisionCacheStats& stats = cache.stats();
+  if (stats.hits != 3 || stats.misses != 1 || stats.inserts != 5 || cache.size() != 0) {
+    std::cerr << "计数错误: 命中=" << stats.hits << " 未命中=" << stats.misses << "\n";
+    return EXIT_FAILURE;
+  }
+
+  // 已淘汰的决策包仍由持有者安全使用。
+  if (first->explanation != "一") {
+    std::cerr << "淘汰后共享决策包失效\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
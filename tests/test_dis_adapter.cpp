@@ -0,0 +1,198 @@
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "bas/dis/dis_adapter.hpp"
+#include "bas/memory/event_memory.hpp"
+
+namespace {
+
+bas::DisEntityPdu Entity(std::int64_t t, const char* id, bas::Side side, double x) {
+  return {t, bas::EntityId::Intern(id), side, bas::UnitType::Armor, {x, 0.0, 0.0}, 5.0, 0.0, true, 0.5};
+}
+
+// 快照内容指纹：各阵营按下标列出编号与坐标，并核对列存表与单位列表对齐。
+std::string Fingerprint(const bas::BattlefieldSnapshot& snapshot) {
+  std::string out;
+  for (const auto* side : {&snapshot.friendly_units, &snapshot.hostile_units}) {
+    const bas::EntityTable& table = side == &snapshot.friendly_units ? snapshot.friendly_table : snapshot.hostile_table;
+    if (table.size() != side->size()) {
+      return "列存表长度不一致";
+    }
+    for (std::size_t i = 0; i < side->size(); ++i) {
+      if (table.x[i] != (*side)[i].pose.x) {
+        return "列存表内容不一致";
+      }
+      out += (*side)[i].id.ToString() + ":" + std::to_string((*side)[i].pose.x) + ";";
+    }
+    out += "|";
+  }
+  return out;
+}
+
+// 随机增删改与阵营切换，消费者随机持有/释放快照：每版内容与参考模型一致，已持有的快照不被改动，
+// 回收缓冲按差量追平后与整份复制结果相同。
+bool CheckSnapshotRecycling() {
+  std::mt19937 rng(7U);
+  bas::DisAdapter adapter;
+  std::map<std::string, std::pair<bas::Side, double>> reference;
+  std::deque<std::pair<std::shared_ptr<const bas::BattlefieldSnapshot>, std::string>> held;
+  const bas::Side sides[] = {bas::Side::Friendly, bas::Side::Hostile, bas::Side::Neutral};
+  for (int round = 0; round < 300; ++round) {
+    bas::DisPduBatch batch;
+    for (std::uint32_t i = rng() % 6; i > 0; --i) {
+      const std::string id = "R-" + std::to_string(rng() % 30);
+      const bas::Side side = rng() % 5 == 0 ? sides[rng() % 3] :
+                             reference.count(id) != 0 ? reference[id].first : bas::Side::Friendly;
+      const double x = static_cast<double>(rng() % 1000);
+      batch.entity_updates.push_back(Entity(1000 + round, id.c_str(), side, x));
+      reference[id] = {side, x};
+    }
+    if (batch.entity_updates.empty()) {
+      continue;
+    }
+    adapter.Ingest(batch);
+    const auto update = adapter.PollUpdate();
+    std::map<std::string, double> expected[2];
+    for (const auto& [id, state] : reference) {
+      if (state.first != bas::Side::Neutral) {
+        expected[state.first == bas::Side::Friendly ? 0 : 1][id] = state.second;
+      }
+    }
+    std::map<std::string, double> actual[2];
+    for (int side = 0; side < 2; ++side) {
+      for (const auto& unit : side == 0 ? update->snapshot->friendly_units : update->snapshot->hostile_units) {
+        actual[side][unit.id.ToString()] = unit.pose.x;
+      }
+    }
+    const std::string fingerprint = Fingerprint(*update->snapshot);
+    if (actual[0] != expected[0] || actual[1] != expected[1] || fingerprint.find("不一致") != std::string::npos) {
+      std::cerr << "回收快照内容错误（第 " << round << " 轮）\n";
+      return false;
+    }
+    if (rng() % 3 == 0) {
+      held.emplace_back(update->snapshot, fingerprint);
+    }
+    while (held.size() > 2 || (!held.empty() && rng() % 4 == 0)) {
+      if (Fingerprint(*held.front().first) != held.front().second) {
+        std::cerr << "已发布快照被改动（第 " << round << " 轮）\n";
+        return false;
+      }
+      held.pop_front();
+    }
+  }
+  return true;
+}
+
+// 恢复到更早的检查点后，恢复前发布的缓冲不得经回收池按差量追平：其版本号属于另一条时间线。
+bool CheckRestoreDropsRecycledBuffers() {
+  const auto step = [](bas::DisAdapter& adapter, std::int64_t t, const char* id, double x) {
+    bas::DisPduBatch batch;
+    batch.entity_updates = {Entity(t, id, bas::Side::Friendly, x)};
+    adapter.Ingest(batch);
+    return Fingerprint(*adapter.PollUpdate()->snapshot);
+  };
+
+  bas::DisAdapter adapter;
+  step(adapter, 1000, "P-1", 0.0);
+  step(adapter, 1100, "P-2", 10.0);
+  bas::BinaryWriter state;
+  adapter.SaveState(state);
+  for (int i = 0; i < 4; ++i) {
+    step(adapter, 1200 + i, "P-1", 900.0 + i);
+  }
+
+  bas::DisAdapter fresh;
+  bas::BinaryReader fresh_in(state.bytes());
+  fresh.RestoreState(fresh_in);
+  bas::BinaryReader in(state.bytes());
+  adapter.RestoreState(in);
+  for (int i = 0; i < 6; ++i) {
+    const double x = 20.0 + i;
+    if (step(adapter, 2000 + i, "P-2", x) != step(fresh, 2000 + i, "P-2", x)) {
+      std::cerr << "恢复检查点后复用了恢复前的回收缓冲（第 " << i << " 步）\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+int main() {
+  bas::DisAdapter adapter;
+
+  bas::DisPduBatch first;
+  first.entity_updates = {Entity(1000, "F-1", bas::Side::Friendly, 0.0), Entity(1000, "F-2", bas::Side::Friendly, 10.0),
+                          Entity(1000, "H-1", bas::Side::Hostile, 500.0)};
+  adapter.Ingest(first);
+  const auto initial = adapter.PollUpdate();
+  if (!initial.has_value() || initial->dirty_entities.size() != 3 || initial->snapshot->friendly_units.size() != 2 ||
+      initial->snapshot->hostile_units.size() != 1) {
+    std::cerr << "首次轮询快照或变化列表错误\n";
+    return EXIT_FAILURE;
+  }
+
+  // 消费者仍持有上一版快照时，新数据不得修改已发布快照。
+  const auto held = initial->snapshot;
+  bas::DisPduBatch second;
+  second.entity_updates = {Entity(2000, "F-2", bas::Side::Friendly, 42.0)};
+  adapter.Ingest(second);
+  const auto next = adapter.PollUpdate();
+  if (!next.has_value() || next->dirty_entities.size() != 1 || next->dirty_entities.front() != bas::EntityId::Intern("F-2")) {
+    std::cerr << "增量轮询应仅报告变化实体\n";
+    return EXIT_FAILURE;
+  }
+  if (held->friendly_units[1].pose.x != 10.0 || next->snapshot->friendly_units[1].pose.x != 42.0 ||
+      next->snapshot->friendly_table.x[1] != 42.0 || next->snapshot->timestamp_ms != 2000) {
+    std::cerr << "写时复制语义或列存表同步错误\n";
+    return EXIT_FAILURE;
+  }
+
+  // 阵营变化：从我方移除并加入敌方，剩余实体下标与列存表保持对齐。
+  bas::DisPduBatch third;
+  third.entity_updates = {Entity(3000, "F-1", bas::Side::Hostile, 7.0)};
+  adapter.Ingest(third);
+  const auto moved = adapter.Poll();
+  if (!moved.has_value() || moved->friendly_units.size() != 1 || moved->hostile_units.size() != 2 ||
+      moved->friendly_units[0].id != bas::EntityId::Intern("F-2") || moved->friendly_table.x[0] != 42.0 ||
+      moved->hostile_table.size() != 2 || moved->hostile_units[1].weapons.empty()) {
+    std::cerr << "阵营切换后快照不一致\n";
+    return EXIT_FAILURE;
+  }
+
+  if (adapter.PollUpdate().has_value()) {
+    std::cerr << "无新数据时不应产生快照\n";
+    return EXIT_FAILURE;
+  }
+
+  if (!CheckSnapshotRecycling()) {
+    return EXIT_FAILURE;
+  }
+  if (!CheckRestoreDropsRecycledBuffers()) {
+    return EXIT_FAILURE;
+  }
+
+  // 非规范武器名：上下文保留原名，含 howitzer 的仍归为曲射火力。
+  bas::DisPduBatch fires;
+  fires.fire_events = {{4000, bas::EntityId::Intern("H-1"), bas::EntityId::Intern("F-2"), "弹药", {}},
+                       {4000, bas::EntityId::Intern("H-1"), bas::EntityId::Intern("F-2"), "M109_howitzer", {}}};
+  adapter.Ingest(fires);
+  const auto events = adapter.DrainEvents();
+  bas::EventMemory memory(60 * 1000);
+  memory.AddEvents(events);
+  const std::string context = memory.BuildContext(4000, 60 * 1000);
+  if (events.size() != 2 || events[0].fire.munition != bas::MunitionClass::Unknown ||
+      events[1].fire.munition != bas::MunitionClass::Indirect ||
+      context.find("武器=弹药，目标=F-2") == std::string::npos ||
+      context.find("武器=M109_howitzer，目标=F-2") == std::string::npos) {
+    std::cerr << "非规范武器名渲染或分类错误\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -1,12 +1,16 @@
 #include <cmath>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <fstream>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 #include <vector>
 
 #include "bas/dis/dis_binary_parser.hpp"
+#include "bas/dis/dis_stream_parser.hpp"
 
 namespace {
 
@@ -43,7 +47,7 @@ void PushF64BE(std::vector<std::uint8_t>& out, double value) {
   out.push_back(static_cast<std::uint8_t>(raw & 0xFFU));
 }
 
-std::vector<std::uint8_t> BuildEntityPdu(std::uint32_t timestamp, bool alive) {
+std::vector<std::uint8_t> BuildEntityPdu(std::uint32_t timestamp, bool alive, std::uint16_t entity = 1) {
   std::vector<std::uint8_t> out;
   const std::uint16_t length = 144;
 
@@ -59,7 +63,7 @@ std::vector<std::uint8_t> BuildEntityPdu(std::uint32_t timestamp, bool alive) {
   // Entity ID
   PushU16BE(out, 1);
   PushU16BE(out, 1);
-  PushU16BE(out, 1);
+  PushU16BE(out, entity);
 
   // Force ID + articulation
   PushU8(out, 1);
@@ -163,7 +167,8 @@ int main() {
   }
 
   const auto& entity = batches[0].entity_updates[0];
-  if (entity.entity_id != "1-1-1" || entity.side != bas::Side::Friendly || entity.type != bas::UnitType::Armor) {
+  if (entity.entity_id != bas::EntityId::FromDis(1, 1, 1) || entity.side != bas::Side::Friendly ||
+      entity.type != bas::UnitType::Armor) {
     std::cerr << "实体基础字段不匹配\n";
     return EXIT_FAILURE;
   }
@@ -173,11 +178,110 @@ int main() {
   }
 
   const auto& fire = batches[0].fire_events[0];
-  if (fire.shooter_id != "1-1-1" || fire.target_id != "2-2-2") {
+  if (fire.shooter_id != bas::EntityId::FromDis(1, 1, 1) || fire.target_id != bas::EntityId::FromDis(2, 2, 2)) {
     std::cerr << "开火记录实体编号不匹配\n";
     return EXIT_FAILURE;
   }
 
+  const std::string temp_path = "test_dis_binary_parser.bin";
+  {
+    std::ofstream ofs(temp_path, std::ios::binary);
+    ofs.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  }
+  const auto mapped_batches = parser.ParseFile(temp_path);
+  std::remove(temp_path.c_str());
+  if (mapped_batches.size() != 1 || mapped_batches[0].entity_updates.size() != 1 ||
+      mapped_batches[0].entity_updates[0].pose.y != entity.pose.y) {
+    std::cerr << "内存映射文件解析结果与字节流解析不一致\n";
+    return EXIT_FAILURE;
+  }
+
+  // 流式解析：逐字节喂入，批次在更新时间戳到达后即输出，与整块解析结果一致。
+  std::vector<std::uint8_t> stream_bytes = bytes;
+  const auto later_entity = BuildEntityPdu(2000, false);
+  stream_bytes.insert(stream_bytes.end(), later_entity.begin(), later_entity.end());
+
+  bas::DisStreamParser stream;
+  std::vector<bas::DisPduBatch> streamed;
+  const auto sink = [&streamed](bas::DisPduBatch&& batch) { streamed.push_back(std::move(batch)); };
+  for (std::size_t i = 0; i < stream_bytes.size(); ++i) {
+    stream.Feed(bas::ByteView(stream_bytes.data() + i, 1), sink);
+  }
+  const std::size_t emitted_before_finish = streamed.size();
+  stream.Finish(sink);
+
+  if (emitted_before_finish != 1 || streamed.size() != 2) {
+    std::cerr << "流式解析未按时间戳及时输出批次\n";
+    return EXIT_FAILURE;
+  }
+  if (streamed[0].entity_updates.size() != 1 || streamed[0].fire_events.size() != 1 ||
+      streamed[1].entity_updates.size() != 1 || streamed[1].entity_updates[0].alive) {
+    std::cerr << "流式解析批次内容不匹配\n";
+    return EXIT_FAILURE;
+  }
+
+  // 重排窗口：窗口内迟到的旧时间戳PDU仍归入原批次。
+  std::vector<std::uint8_t> reordered = later_entity;
+  reordered.insert(reordered.end(), entity_pdu.begin(), entity_pdu.end());
+  bas::DisStreamParser windowed({1500, 16});
+  std::vector<bas::DisPduBatch> windowed_batches;
+  windowed.Feed(reordered, [&windowed_batches](bas::DisPduBatch&& batch) {
+    windowed_batches.push_back(std::move(batch));
+  });
+  windowed.Finish([&windowed_batches](bas::DisPduBatch&& batch) { windowed_batches.push_back(std::move(batch)); });
+  if (windowed_batches.size() != 2 || windowed_batches[0].entity_updates[0].timestamp_ms != 1000 ||
+      windowed.late_pdus() != 0) {
+    std::cerr << "重排窗口内的乱序PDU处理错误\n";
+    return EXIT_FAILURE;
+  }
+
+  // 窗口外的迟到PDU：实体状态丢弃，开火并入下一个待输出批次，不输出旧时间戳批次。
+  bas::DisStreamParser strict_window;
+  std::vector<bas::DisPduBatch> late_batches;
+  const auto late_sink = [&late_batches](bas::DisPduBatch&& batch) { late_batches.push_back(std::move(batch)); };
+  std::vector<std::uint8_t> late_tail = BuildEntityPdu(1000, false);
+  late_tail.insert(late_tail.end(), fire_pdu.begin(), fire_pdu.end());
+  strict_window.Feed(entity_pdu, late_sink);
+  strict_window.Feed(later_entity, late_sink);
+  strict_window.Feed(late_tail, late_sink);
+  strict_window.Finish(late_sink);
+  if (late_batches.size() != 2 || strict_window.late_pdus() != 2 || late_batches[1].entity_updates.size() != 1 ||
+      late_batches[1].entity_updates[0].timestamp_ms != 2000 || late_batches[1].fire_events.size() != 1 ||
+      late_batches[1].fire_events[0].timestamp_ms != 1000 || !late_batches[0].entity_updates[0].alive) {
+    std::cerr << "窗口外迟到PDU应丢弃实体状态并将开火并入后续批次\n";
+    return EXIT_FAILURE;
+  }
+
+  // 此后未再出现的实体的迟到状态（如毁伤）不应丢失，排在后续批次的更新状态之前。
+  bas::DisStreamParser unseen_window;
+  std::vector<bas::DisPduBatch> unseen_batches;
+  const auto unseen_sink = [&unseen_batches](bas::DisPduBatch&& batch) { unseen_batches.push_back(std::move(batch)); };
+  unseen_window.Feed(entity_pdu, unseen_sink);
+  unseen_window.Feed(later_entity, unseen_sink);
+  unseen_window.Feed(BuildEntityPdu(1000, false, 3), unseen_sink);
+  unseen_window.Finish(unseen_sink);
+  if (unseen_batches.size() != 2 || unseen_window.late_pdus() != 1 || unseen_batches[1].entity_updates.size() != 2 ||
+      unseen_batches[1].entity_updates[0].entity_id != bas::EntityId::FromDis(1, 1, 3) ||
+      unseen_batches[1].entity_updates[0].alive || unseen_batches[1].entity_updates[1].timestamp_ms != 2000) {
+    std::cerr << "未被覆盖的迟到实体状态应并入后续批次\n";
+    return EXIT_FAILURE;
+  }
+
+  // 站点号 0xFFFF 与文本编号冲突，解析器应拒绝。
+  std::vector<std::uint8_t> reserved_site = entity_pdu;
+  reserved_site[12] = 0xFF;
+  reserved_site[13] = 0xFF;
+  bool reserved_rejected = false;
+  try {
+    static_cast<void>(parser.ParseBytes(reserved_site));
+  } catch (const std::runtime_error&) {
+    reserved_rejected = true;
+  }
+  if (!reserved_rejected) {
+    std::cerr << "解析器应拒绝站点号为0xFFFF的实体编号\n";
+    return EXIT_FAILURE;
+  }
+
   bool threw = false;
   try {
     std::vector<std::uint8_t> bad = bytes;
@@ -0,0 +1,117 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "bas/common/spsc_queue.hpp"
+#include "bas/dis/dis_udp_receiver.hpp"
+
+namespace {
+
+void PushU16BE(std::vector<std::uint8_t>& out, std::uint16_t value) {
+  out.push_back(static_cast<std::uint8_t>((value >> 8U) & 0xFFU));
+  out.push_back(static_cast<std::uint8_t>(value & 0xFFU));
+}
+
+void PushU32BE(std::vector<std::uint8_t>& out, std::uint32_t value) {
+  out.push_back(static_cast<std::uint8_t>((value >> 24U) & 0xFFU));
+  out.push_back(static_cast<std::uint8_t>((value >> 16U) & 0xFFU));
+  out.push_back(static_cast<std::uint8_t>((value >> 8U) & 0xFFU));
+  out.push_back(static_cast<std::uint8_t>(value & 0xFFU));
+}
+
+void PushF64BE(std::vector<std::uint8_t>& out, double value) {
+  std::uint64_t raw = 0;
+  std::memcpy(&raw, &value, sizeof(raw));
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    out.push_back(static_cast<std::uint8_t>((raw >> static_cast<unsigned>(shift)) & 0xFFU));
+  }
+}
+
+std::vector<std::uint8_t> BuildEntityPdu(std::uint32_t timestamp, std::uint16_t entity, std::uint8_t force_id) {
+  std::vector<std::uint8_t> out = {7, 1, 1, 1};
+  PushU32BE(out, timestamp);
+  PushU16BE(out, 144);
+  PushU16BE(out, 0);
+  PushU16BE(out, 1);
+  PushU16BE(out, 1);
+  PushU16BE(out, entity);
+  out.push_back(force_id);
+  out.push_back(0);
+  out.insert(out.end(), {1, 1, 0, 225, 1, 0, 0, 0});
+  out.resize(48, 0);
+  PushF64BE(out, 100.0 * entity);
+  PushF64BE(out, 50.0);
+  PushF64BE(out, 0.0);
+  out.resize(144, 0);
+  return out;
+}
+
+}  // namespace
+
+int main() {
+  bas::SpscQueue<int> queue(2);
+  int value = 0;
+  if (!queue.TryPush(1) || !queue.TryPush(2) || queue.TryPush(3) || !queue.TryPop(value) || value != 1 ||
+      queue.SizeApprox() != 1) {
+    std::cerr << "SPSC队列容量或顺序语义错误\n";
+    return EXIT_FAILURE;
+  }
+
+  bas::DisUdpConfig config;
+  config.bind_address = "127.0.0.1";
+  config.port = 0;
+  bas::DisUdpReceiver receiver(config);
+  receiver.Start();
+
+  const int sender = ::socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in dest{};
+  dest.sin_family = AF_INET;
+  dest.sin_port = htons(receiver.bound_port());
+  ::inet_pton(AF_INET, "127.0.0.1", &dest.sin_addr);
+
+  const auto send = [&](const std::vector<std::uint8_t>& datagram) {
+    ::sendto(sender, datagram.data(), datagram.size(), 0, reinterpret_cast<const sockaddr*>(&dest), sizeof(dest));
+  };
+  send(BuildEntityPdu(1000, 1, 1));
+  send(BuildEntityPdu(1000, 2, 2));
+  send({7, 1, 1, 1, 0, 0});
+  ::close(sender);
+
+  bas::DisAdapter adapter;
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(3);
+  while (std::chrono::steady_clock::now() < deadline) {
+    receiver.DrainInto(adapter);
+    const auto stats = receiver.stats();
+    if (stats.pdus >= 2 && stats.parse_errors >= 1) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  receiver.DrainInto(adapter);
+  receiver.Stop();
+
+  const auto stats = receiver.stats();
+  if (stats.datagrams != 3 || stats.pdus != 2 || stats.parse_errors != 1 || stats.dropped_batches != 0 ||
+      stats.backlog != 0) {
+    std::cerr << "UDP接收统计不符合预期: 数据报=" << stats.datagrams << " PDU=" << stats.pdus
+              << " 解析错误=" << stats.parse_errors << "\n";
+    return EXIT_FAILURE;
+  }
+
+  const auto snapshot = adapter.Poll();
+  if (!snapshot.has_value() || snapshot->friendly_units.size() != 1 || snapshot->hostile_units.size() != 1) {
+    std::cerr << "UDP接收数据未正确进入态势适配器\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
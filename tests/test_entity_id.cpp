@@ -0,0 +1,62 @@
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "bas/common/entity_id.hpp"
+
+int main() {
+  const bas::EntityId dis_id = bas::EntityId::FromDis(1, 2, 3);
+  if (dis_id.raw() != 0x000100020003ULL || dis_id.ToString() != "1-2-3" || dis_id.is_named()) {
+    std::cerr << "DIS编号打包或还原错误\n";
+    return EXIT_FAILURE;
+  }
+  if (bas::EntityId::Intern("1-2-3") != dis_id) {
+    std::cerr << "十进制三元组文本应映射为同一DIS编号\n";
+    return EXIT_FAILURE;
+  }
+
+  const bas::EntityId named_a = bas::EntityId::Intern("F-1");
+  const bas::EntityId named_b("F-1");
+  const bas::EntityId other("H-armor");
+  if (!named_a.is_named() || named_a != named_b || named_a == other || named_a.raw() > 0xFFFFFFFFFFFFULL) {
+    std::cerr << "文本编号驻留结果不稳定\n";
+    return EXIT_FAILURE;
+  }
+
+  std::ostringstream oss;
+  oss << named_a << "," << other;
+  if (oss.str() != "F-1,H-armor") {
+    std::cerr << "驻留编号输出名称错误: " << oss.str() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  if (bas::EntityId().valid() || bas::EntityId("").valid() || !bas::EntityId().ToString().empty()) {
+    std::cerr << "空编号应为无效编号\n";
+    return EXIT_FAILURE;
+  }
+
+  // site=0xFFFF 为文本编号保留，DIS 编号不得占用。
+  bool rejected = false;
+  try {
+    static_cast<void>(bas::EntityId::FromDis(bas::EntityId::kNamedSite, 0, 1));
+  } catch (const std::invalid_argument&) {
+    rejected = true;
+  }
+  if (!rejected || bas::EntityId::Intern("65535-0-1").site() != bas::EntityId::kNamedSite ||
+      bas::EntityId::Intern("65535-0-1").ToString() != "65535-0-1") {
+    std::cerr << "保留站点号未被拒绝或文本回退错误\n";
+    return EXIT_FAILURE;
+  }
+
+  std::unordered_map<bas::EntityId, int> table;
+  table[dis_id] = 1;
+  table[bas::EntityId::Intern("F-1")] = 2;
+  if (table.size() != 2 || table.at(named_b) != 2) {
+    std::cerr << "编号哈希查找失败\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "bas/cache/feature_key.hpp"
+#include "bas/dis/dis_adapter.hpp"
+#include "bas/system/scenario_replay.hpp"
+
+namespace {
+
+using Canonical = std::vector<std::tuple<int, std::uint64_t, std::int64_t, std::int64_t>>;
+
+// 与缓存键等价的规范特征：排序后的（阵营、编号、网格）列表，末尾附双方数量与能见度档位。
+Canonical CanonicalFeatures(const bas::BattlefieldSnapshot& snapshot) {
+  Canonical out;
+  for (const auto* units : {&snapshot.friendly_units, &snapshot.hostile_units}) {
+    for (const auto& unit : *units) {
+      out.emplace_back(static_cast<int>(unit.side), unit.id.raw(),
+                       static_cast<std::int64_t>(std::floor(unit.pose.x / 100.0)),
+                       static_cast<std::int64_t>(std::floor(unit.pose.y / 100.0)));
+    }
+  }
+  std::sort(out.begin(), out.end());
+  out.emplace_back(-1, snapshot.friendly_units.size(), snapshot.hostile_units.size(),
+                   static_cast<std::int64_t>(std::floor(snapshot.env.visibility_m / 100.0)));
+  return out;
+}
+
+struct ReplayCheck {
+  std::size_t frames = 0;
+  std::size_t distinct_features = 0;
+  std::size_t collisions = 0;
+  std::size_t mismatches = 0;
+  std::size_t rebuilds = 0;
+  double max_update_us = 0.0;
+};
+
+// 逐帧喂入适配器：增量键须与全量键一致；同一键对应的规范特征不同即为碰撞。
+ReplayCheck Replay(const std::vector<bas::DisPduBatch>& batches) {
+  ReplayCheck check;
+  bas::DisAdapter adapter;
+  bas::FeatureKeyBuilder incremental;
+  const bas::FeatureKeyBuilder reference;
+  std::map<std::uint64_t, Canonical> seen;
+  for (const auto& batch : batches) {
+    adapter.Ingest(batch);
+    const auto update = adapter.PollUpdate();
+    if (!update.has_value()) {
+      continue;
+    }
+    const auto t0 = std::chrono::steady_clock::now();
+    const std::uint64_t key = check.frames == 0 ? incremental.Rebuild(*update->snapshot)
+                                                : incremental.Update(*update->snapshot, update->dirty_entities);
+    if (check.frames > 0) {
+      check.max_update_us = std::max(
+          check.max_update_us,
+          std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+    }
+    ++check.frames;
+    if (key != reference.Compute(*update->snapshot)) {
+      ++check.mismatches;
+    }
+    const Canonical features = CanonicalFeatures(*update->snapshot);
+    const auto [it, inserted] = seen.emplace(key, features);
+    if (!inserted && it->second != features) {
+      ++check.collisions;
+    }
+  }
+  check.distinct_features = seen.size();
+  check.rebuilds = incremental.rebuilds();
+  return check;
+}
+
+std::vector<bas::DisPduBatch> RandomWalk(std::size_t units, std::size_t frames, std::uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> spawn(-5000.0, 5000.0);
+  std::normal_distribution<double> step(0.0, 40.0);
+  std::uniform_int_distribution<std::size_t> pick(0, units - 1);
+  std::vector<bas::DisEntityPdu> state(units);
+  std::vector<bas::DisPduBatch> batches(frames);
+  for (std::size_t i = 0; i < units; ++i) {
+    state[i].entity_id =
+        bas::EntityId::FromDis(1, static_cast<std::uint16_t>(1 + i / 1000), static_cast<std::uint16_t>(i % 1000 + 1));
+    state[i].side = i % 2 == 0 ? bas::Side::Friendly : bas::Side::Hostile;
+    state[i].type = bas::UnitType::Armor;
+    state[i].pose = {spawn(rng), spawn(rng), 0.0};
+    batches[0].entity_updates.push_back(state[i]);
+  }
+  batches[0].env = bas::EnvironmentState{900.0, 0.1, 0.2};
+  for (std::size_t f = 1; f < frames; ++f) {
+    // 每帧约 5% 实体移动；偶尔有实体转入中立或重新回到某一阵营，触发交换删除与追加。
+    for (std::size_t k = 0; k < units / 20; ++k) {
+      bas::DisEntityPdu& pdu = state[pick(rng)];
+      pdu.timestamp_ms = static_cast<std::int64_t>(f) * 100;
+      pdu.pose.x += step(rng);
+      pdu.pose.y += step(rng);
+      if (k == 0 && f % 25 == 0) {
+        pdu.side = pdu.side == bas::Side::Neutral ? bas::Side::Hostile : bas::Side::Neutral;
+      }
+      batches[f].entity_updates.push_back(pdu);
+    }
+  }
+  return batches;
+}
+
+}  // namespace
+
+int main() {
+  // 同一实体集合打乱顺序，键不变。
+  const auto walk = RandomWalk(64, 1, 7U);
+  bas::BattlefieldSnapshot snapshot;
+  for (const auto& pdu : walk.front().entity_updates) {
+    bas::EntityState unit;
+    unit.id = pdu.entity_id;
+    unit.side = pdu.side;
+    unit.pose = pdu.pose;
+    (pdu.side == bas::Side::Friendly ? snapshot.friendly_units : snapshot.hostile_units).push_back(unit);
+  }
+  bas::BattlefieldSnapshot shuffled = snapshot;
+  std::reverse(shuffled.friendly_units.begin(), shuffled.friendly_units.end());
+  std::rotate(shuffled.hostile_units.begin(), shuffled.hostile_units.begin() + 5, shuffled.hostile_units.end());
+  const bas::FeatureKeyBuilder builder;
+  if (builder.Compute(snapshot) != builder.Compute(shuffled)) {
+    std::cerr << "缓存键与实体顺序相关\n";
+    return EXIT_FAILURE;
+  }
+  shuffled.friendly_units.front().pose.x += 100.0;
+  if (builder.Compute(snapshot) == builder.Compute(shuffled)) {
+    std::cerr << "实体跨网格移动后缓存键未变化\n";
+    return EXIT_FAILURE;
+  }
+
+  const std::string candidate_a = "data/scenarios/demo_replay.bas";
+  const std::string candidate_b = "../data/scenarios/demo_replay.bas";
+  const std::string replay_path = std::ifstream(candidate_a).good() ? candidate_a : candidate_b;
+  const ReplayCheck recorded = Replay(bas::ScenarioReplayLoader{}.LoadBatches(replay_path));
+  const ReplayCheck synthetic = Replay(RandomWalk(2000, 400, 20240611U));
+  for (const ReplayCheck* check : {&recorded, &synthetic}) {
+    if (check->frames == 0 || check->mismatches != 0 || check->collisions != 0) {
+      std::cerr << "缓存键校验失败: 帧=" << check->frames << " 增量不一致=" << check->mismatches
+                << " 碰撞=" << check->collisions << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  // 2000 实体随机游走几乎每帧产生新特征；换阵营的帧才需要重建。
+  if (synthetic.distinct_features < 350 || synthetic.rebuilds > 1 + 400 / 25) {
+    std::cerr << "增量维护退化: 不同特征=" << synthetic.distinct_features << " 重建=" << synthetic.rebuilds << "\n";
+    return EXIT_FAILURE;
+  }
+  std::cout << "2000 实体单帧键更新最长耗时(微秒): " << synthetic.max_update_us << "\n";
+
+  return EXIT_SUCCESS;
+}
@@ -1,6 +1,7 @@
 #include <cstdlib>
 #include <iostream>
 
+#include "bas/decision/assignment_solver.hpp"
 #include "bas/decision/fire_control_engine.hpp"
 
 namespace {
@@ -10,7 +11,7 @@ bas::BattlefieldSnapshot BuildSnapshot() {
   snap.timestamp_ms = 1000000;
 
   bas::EntityState f1;
-  f1.id = "F-1";
+  f1.id = bas::EntityId::Intern("F-1");
   f1.side = bas::Side::Friendly;
   f1.type = bas::UnitType::Armor;
   f1.pose = {0.0, 0.0, 0.0};
@@ -18,14 +19,14 @@ bas::BattlefieldSnapshot BuildSnapshot() {
   snap.friendly_units.push_back(f1);
 
   bas::EntityState f2 = f1;
-  f2.id = "F-2";
+  f2.id = bas::EntityId::Intern("F-2");
   f2.type = bas::UnitType::Infantry;
   f2.pose = {-50.0, -30.0, 0.0};
   f2.weapons = {{"rifle", 800.0, 0.25, 100, 0.0, {bas::UnitType::Infantry}}};
   snap.friendly_units.push_back(f2);
 
   bas::EntityState h1;
-  h1.id = "H-armor";
+  h1.id = bas::EntityId::Intern("H-armor");
   h1.side = bas::Side::Hostile;
   h1.type = bas::UnitType::Armor;
   h1.pose = {500.0, 120.0, 0.0};
@@ -34,7 +35,7 @@ bas::BattlefieldSnapshot BuildSnapshot() {
   snap.hostile_units.push_back(h1);
 
   bas::EntityState h2;
-  h2.id = "H-inf";
+  h2.id = bas::EntityId::Intern("H-inf");
   h2.side = bas::Side::Hostile;
   h2.type = bas::UnitType::Infantry;
   h2.pose = {600.0, 200.0, 0.0};
@@ -50,7 +51,8 @@ bas::BattlefieldSnapshot BuildSnapshot() {
 int main() {
   bas::BattlefieldSnapshot snap = BuildSnapshot();
   bas::EventMemory memory;
-  memory.AddEvent({snap.timestamp_ms - 20000, bas::EventType::WeaponFire, "H-armor", {}, "howitzer"});
+  memory.AddEvent({snap.timestamp_ms - 20000, bas::EventType::WeaponFire, bas::EntityId::Intern("H-armor"), {},
+                   "howitzer"});
 
   bas::FireControlEngine engine({true, true, 2, 70.0});
   bas::FireDecision decision = engine.Decide(snap, {}, memory);
@@ -59,7 +61,7 @@ int main() {
     std::cerr << "未生成火力分配\n";
     return EXIT_FAILURE;
   }
-  if (decision.threats.empty() || decision.threats.front().target_id != "H-armor") {
+  if (decision.threats.empty() || decision.threats.front().target_id != bas::EntityId::Intern("H-armor")) {
     std::cerr << "威胁排序结果不正确\n";
     return EXIT_FAILURE;
   }
@@ -76,5 +78,50 @@ int main() {
     return EXIT_FAILURE;
   }
 
+  // 逐射手贪心会让射手0抢走目标0（总收益10），全局最优为 0->1、1->0（总收益19）。
+  bas::AssignmentProblem problem;
+  problem.target_count = 2;
+  problem.slots_per_target = 1;
+  problem.AddShooter();
+  problem.AddArc(0, 10.0);
+  problem.AddArc(1, 9.0);
+  problem.AddShooter();
+  problem.AddArc(0, 10.0);
+  const bas::AssignmentResult optimal = bas::SolveAuctionAssignment(problem);
+  if (optimal.timed_out || optimal.total_value < 19.0 - 1e-6 || optimal.arc_of_shooter[0] != 1) {
+    std::cerr << "拍卖分配未得到全局最优解\n";
+    return EXIT_FAILURE;
+  }
+
+  // 预算极小时仍须返回满足席位约束的可行解。
+  const bas::AssignmentResult rushed = bas::SolveAuctionAssignment(problem, {1e-3, 1e-9});
+  if (rushed.arc_of_shooter.size() != 2 || (rushed.arc_of_shooter[0] != bas::AssignmentResult::kUnassigned &&
+                                            rushed.arc_of_shooter[1] != bas::AssignmentResult::kUnassigned &&
+                                            problem.arcs[rushed.arc_of_shooter[0]].target ==
+                                                problem.arcs[rushed.arc_of_shooter[1]].target)) {
+    std::cerr << "超时回退结果违反席位约束\n";
+    return EXIT_FAILURE;
+  }
+
+  bas::FireControlConfig auction_config{true, true, 1, 70.0};
+  auction_config.solver = bas::AssignmentSolver::Auction;
+  snap.friendly_units[1].weapons.push_back({"atgm", 2000.0, 0.8, 0, 0.0, {bas::UnitType::Armor}});
+  snap.friendly_units[1].weapons.push_back({"mortar", 2000.0, 0.9, 4, 30.0, {bas::UnitType::Armor}});
+  const bas::FireDecision auction_decision = bas::FireControlEngine(auction_config).Decide(snap, {}, memory);
+  if (auction_decision.assignments.size() != 2) {
+    std::cerr << "拍卖模式应为两个射手各分配一个目标\n";
+    return EXIT_FAILURE;
+  }
+  for (const auto& a : auction_decision.assignments) {
+    if (a.weapon_name == "atgm" || a.weapon_name == "mortar") {
+      std::cerr << "拍卖模式不应选用弹药耗尽或未就绪的武器\n";
+      return EXIT_FAILURE;
+    }
+  }
+  if (auction_decision.assignments[0].target_id == auction_decision.assignments[1].target_id) {
+    std::cerr << "拍卖模式违反每目标射手上限\n";
+    return EXIT_FAILURE;
+  }
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,371 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bas/inference/http_client.hpp"
+#include "bas/inference/model_runtime.hpp"
+
+namespace {
+
+// 本地桩服务：按请求路径返回不同形态的响应，同一连接上可连续处理多个请求。
+class StubServer {
+ public:
+  StubServer() {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    ::listen(listen_fd_, 8);
+    socklen_t len = sizeof(addr);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    thread_ = std::thread([this] { Run(); });
+  }
+
+  ~StubServer() {
+    stop_ = true;
+    ::shutdown(listen_fd_, SHUT_RDWR);
+    ::close(listen_fd_);
+    thread_.join();
+    for (auto& t : connections_) {
+      t.join();
+    }
+  }
+
+  std::string Url(const std::string& path) const { return "http://127.0.0.1:" + std::to_string(port_) + path; }
+  int accepted() const { return accepted_; }
+  int batch_calls() const { return batch_calls_; }
+  int chat_calls() const { return chat_calls_; }
+
+ private:
+  void Run() {
+    while (!stop_) {
+      const int fd = ::accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) {
+        return;
+      }
+      ++accepted_;
+      // 每个连接独立线程处理，多个客户端各自持有的长连接互不阻塞。
+      connections_.emplace_back([this, fd] {
+        Serve(fd);
+        ::close(fd);
+      });
+    }
+  }
+
+  void Serve(int fd) {
+    std::string buffer;
+    char chunk[4096];
+    for (;;) {
+      std::size_t header_end;
+      while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+        const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+          return;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(n));
+      }
+      const std::size_t cl = buffer.find("Content-Length: ");
+      const std::size_t body_len = cl == std::string::npos ? 0 : std::stoul(buffer.substr(cl + 16));
+      while (buffer.size() < header_end + 4 + body_len) {
+        const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+          return;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(n));
+      }
+      const std::string path = buffer.substr(5, buffer.find(' ', 5) - 5);
+      const std::string body = buffer.substr(header_end + 4, body_len);
+      buffer.erase(0, header_end + 4 + body_len);
+
+      std::string reply;
+      if (path == "/echo") {
+        reply = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+      } else if (path == "/chunked") {
+        reply = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n6\r\n world\r\n0\r\n\r\n";
+      } else if (path == "/chunked-split") {
+        // 分块头与数据拆成多次发送，客户端需跨多次读取增量解码。
+        const std::vector<std::string> parts = {"HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n1",
+                                                "0\r\n0123456789", "abcdef\r\n", "3\r\nxyz\r\n0\r", "\n\r\n"};
+        for (const auto& part : parts) {
+          ::send(fd, part.data(), part.size(), MSG_NOSIGNAL);
+          std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        continue;
+      } else if (path == "/slow") {
+        std::this_thread::sleep_for(std::chrono::milliseconds(400));
+        return;
+      } else if (path == "/v1/batch") {
+        // 每条子请求回一个 chat.completion，候选序号取子请求序号。
+        ++batch_calls_;
+        std::string json = "{\"object\":\"batch.completion\",\"responses\":[";
+        std::size_t count = 0;
+        for (std::size_t pos = body.find("\"messages\""); pos != std::string::npos;
+             pos = body.find("\"messages\"", pos + 1)) {
+          json += (count == 0 ? "" : ",");
+          json += "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":"
+                  "\"{\\\"selected_index\\\": " +
+                  std::to_string(count) + ", \\\"explanation\\\": \\\"批量" + std::to_string(count) + "\\\"}\"}}]}";
+          ++count;
+        }
+        json += "]}";
+        reply = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(json.size()) + "\r\n\r\n" + json;
+      } else if (path == "/v2/batch") {
+        // 每条附带含 content 键的无关字段；第 1 条为单条错误。
+        std::string json = "{\"responses\":[";
+        std::size_t count = 0;
+        for (std::size_t pos = body.find("\"messages\""); pos != std::string::npos;
+             pos = body.find("\"messages\"", pos + 1)) {
+          json += (count == 0 ? "" : ",");
+          if (count == 1) {
+            json += "{\"error\":{\"message\":\"overloaded\",\"content\":\"x\"}}";
+          } else {
+            json += "{\"meta\":{\"content\":\"\\u566a\\u58f0\"},\"choices\":[{\"message\":{\"content\":"
+                    "\"{\\\"selected_index\\\": " +
+                    std::to_string(count) + ", \\\"explanation\\\": \\\"批量" + std::to_string(count) +
+                    "\\\"}\"}}]}";
+          }
+          ++count;
+        }
+        json += "]}";
+        reply = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(json.size()) + "\r\n\r\n" + json;
+      } else if (path == "/v4/chat/completions") {
+        // 其他字段中的 content 键排在 choices 之前，正文含转义。
+        const std::string json =
+            "{\"meta\":{\"content\":\"噪声\"},\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":"
+            "\"{\\\"selected_index\\\": 1, \\\"explanation\\\": \\\"\\u7a33\\u5065\\\"}\"}}]}";
+        reply = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(json.size()) + "\r\n\r\n" + json;
+      } else if (path == "/v3/chat/completions") {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        return;
+      } else if (path == "/v1/chat/completions") {
+        ++chat_calls_;
+        const std::string json =
+            "{\"choices\":[{\"message\":{\"role\":\"assistant\",\"content\":"
+            "\"{\\\"selected_index\\\": 1, \\\"explanation\\\": \\\"稳健方案更优\\\"}\"}}]}";
+        reply = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " + std::to_string(json.size()) +
+                "\r\n\r\n" + json;
+      } else {
+        reply = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+      }
+      ::send(fd, reply.data(), reply.size(), MSG_NOSIGNAL);
+      if (reply.find("Connection: close") != std::string::npos) {
+        return;
+      }
+    }
+  }
+
+  int listen_fd_ = -1;
+  std::uint16_t port_ = 0;
+  std::thread thread_;
+  std::vector<std::thread> connections_;
+  std::atomic<bool> stop_{false};
+  std::atomic<int> accepted_{0};
+  std::atomic<int> batch_calls_{0};
+  std::atomic<int> chat_calls_{0};
+};
+
+}  // namespace
+
+int main() {
+  bas::HttpUrl url;
+  if (!bas::HttpUrl::Parse("http://example.com:8080/v1/x", url) || url.host != "example.com" || url.port != 8080 ||
+      url.target != "/v1/x" || bas::HttpUrl::Parse("https://example.com/", url)) {
+    std::cerr << "地址解析错误\n";
+    return EXIT_FAILURE;
+  }
+
+  StubServer server;
+  bas::HttpClient client;
+
+  for (int i = 0; i < 3; ++i) {
+    const bas::HttpResponse r = client.Post(server.Url("/echo"), "payload-" + std::to_string(i), {}, 1000);
+    if (!r.ok() || r.body != "payload-" + std::to_string(i)) {
+      std::cerr << "回显请求失败: " << r.error << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  const bas::HttpResponse chunked = client.Post(server.Url("/chunked"), "{}", {}, 1000);
+  if (!chunked.ok() || chunked.body != "hello world") {
+    std::cerr << "分块响应解码错误: " << chunked.body << "\n";
+    return EXIT_FAILURE;
+  }
+  const bas::HttpResponse split = client.Post(server.Url("/chunked-split"), "{}", {}, 1000);
+  if (!split.ok() || split.body != "0123456789abcdefxyz") {
+    std::cerr << "跨读取的分块响应解码错误: " << split.body << "\n";
+    return EXIT_FAILURE;
+  }
+  if (server.accepted() != 1 || client.stats().connections_reused != 4) {
+    std::cerr << "长连接未复用，建连次数=" << server.accepted() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  const bas::HttpResponse missing = client.Post(server.Url("/missing"), "{}", {}, 1000);
+  if (missing.status != 404 || missing.ok() || client.idle_connections() != 0) {
+    std::cerr << "Connection: close 的连接不应放回连接池\n";
+    return EXIT_FAILURE;
+  }
+
+  const auto t0 = std::chrono::steady_clock::now();
+  const bas::HttpResponse slow = client.Post(server.Url("/slow"), "{}", {}, 100);
+  const auto elapsed =
+      std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+  if (slow.error.empty() || elapsed > 300) {
+    std::cerr << "截止时间未生效，耗时(毫秒)=" << elapsed << "\n";
+    return EXIT_FAILURE;
+  }
+  // 等桩服务处理完超时请求，再验证断开后重建连接。
+  std::this_thread::sleep_for(std::chrono::milliseconds(450));
+  const bas::HttpResponse reconnected = client.Post(server.Url("/echo"), "again", {}, 1000);
+  if (!reconnected.ok() || client.stats().connections_opened < 2 || client.stats().dns_lookups != 1) {
+    std::cerr << "重建连接应复用缓存的解析结果，解析次数=" << client.stats().dns_lookups << "\n";
+    return EXIT_FAILURE;
+  }
+
+  bas::ModelRuntime runtime;
+  bas::ModelConfig config;
+  config.backend = bas::ModelBackend::OpenAICompatible;
+  config.endpoint = server.Url("/v1/chat/completions");
+  config.timeout_ms = 2000;
+  runtime.Configure(config);
+  const bas::ModelResponse model = runtime.RankAndExplain({"上下文", {"方案A", "方案B"}});
+  if (model.selected_index != 1 || model.explanation != "稳健方案更优") {
+    std::cerr << "模型响应解析错误: " << model.explanation << "\n";
+    return EXIT_FAILURE;
+  }
+
+  // 单条响应按 JSON 结构取 choices[0].message.content，不受其他字段中同名键影响。
+  config.endpoint = server.Url("/v4/chat/completions");
+  runtime.Configure(config);
+  const bas::ModelResponse scanned = runtime.RankAndExplain({"上下文", {"方案A", "方案B"}});
+  if (scanned.selected_index != 1 || scanned.explanation != "稳健") {
+    std::cerr << "单条模型响应应取 choices 中的 content: " << scanned.explanation << "\n";
+    return EXIT_FAILURE;
+  }
+  config.endpoint = server.Url("/v1/chat/completions");
+
+  // 合批：并发的不同请求合为一次 /v1/batch 调用，各自取回对应条目。
+  config.enable_batching = true;
+  config.batch_window_ms = 300;
+  config.max_batch_size = 3;
+  runtime.Configure(config);
+  std::vector<bas::ModelResponse> batched(3);
+  std::vector<std::thread> callers;
+  for (int i = 0; i < 3; ++i) {
+    callers.emplace_back([&, i, copy = runtime] {
+      batched[i] = copy.RankAndExplain({"上下文" + std::to_string(i), {"方案A", "方案B", "方案C"}});
+    });
+  }
+  for (auto& t : callers) {
+    t.join();
+  }
+  if (server.batch_calls() != 1 || runtime.batch_stats().batches != 1) {
+    std::cerr << "并发请求未合为一批，批量调用次数=" << server.batch_calls() << "\n";
+    return EXIT_FAILURE;
+  }
+  for (const auto& r : batched) {
+    if (r.explanation != "批量" + std::to_string(r.selected_index)) {
+      std::cerr << "批量响应条目错配: " << r.explanation << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  // 单条失败与无关的 content 字段只影响对应条目。
+  config.endpoint = server.Url("/v2/chat/completions");
+  runtime.Configure(config);
+  std::vector<bas::ModelResponse> mixed(3);
+  callers.clear();
+  for (int i = 0; i < 3; ++i) {
+    callers.emplace_back([&, i, copy = runtime] {
+      mixed[i] = copy.RankAndExplain({"混合" + std::to_string(i), {"方案A", "方案B", "方案C"}});
+    });
+  }
+  for (auto& t : callers) {
+    t.join();
+  }
+  int failed_items = 0;
+  for (const auto& r : mixed) {
+    if (r.explanation.find("回退到候选0") != std::string::npos) {
+      ++failed_items;
+    } else if (r.explanation != "批量" + std::to_string(r.selected_index) || r.selected_index == 1) {
+      std::cerr << "批量响应条目解析错误: " << r.explanation << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  if (failed_items != 1 || runtime.batch_stats().batches != 1) {
+    std::cerr << "单条失败应只影响该条，失败条数=" << failed_items << "\n";
+    return EXIT_FAILURE;
+  }
+
+  // 批量接口 404 时逐条回退，整批共用一个截止时间。
+  config.endpoint = server.Url("/v3/chat/completions");
+  config.timeout_ms = 600;
+  runtime.Configure(config);
+  std::vector<bas::ModelResponse> fallback(3);
+  callers.clear();
+  const auto fallback_start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 3; ++i) {
+    callers.emplace_back([&, i, copy = runtime] {
+      fallback[i] = copy.RankAndExplain({"回退" + std::to_string(i), {"方案A", "方案B"}});
+    });
+  }
+  for (auto& t : callers) {
+    t.join();
+  }
+  const auto fallback_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               std::chrono::steady_clock::now() - fallback_start)
+                               .count();
+  for (const auto& r : fallback) {
+    if (r.selected_index != 0 || r.explanation.find("回退到候选0") == std::string::npos) {
+      std::cerr << "逐条回退超时后应回退到候选0: " << r.explanation << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  if (fallback_ms > 1300) {
+    std::cerr << "逐条回退未共用截止时间，耗时(毫秒)=" << fallback_ms << "\n";
+    return EXIT_FAILURE;
+  }
+
+  // 响应缓存：候选与标签相同、上下文不同的请求不再访问模型服务，落盘后新实例可直接命中。
+  bas::ModelConfig cached_config;
+  cached_config.backend = bas::ModelBackend::OpenAICompatible;
+  cached_config.endpoint = server.Url("/v1/chat/completions");
+  cached_config.timeout_ms = 2000;
+  cached_config.enable_response_cache = true;
+  cached_config.response_cache_path = "test_http_client_response_cache.txt";
+  std::remove(cached_config.response_cache_path.c_str());
+  bas::ModelRuntime cached_runtime;
+  cached_runtime.Configure(cached_config);
+  const int chat_before = server.chat_calls();
+  cached_runtime.RankAndExplain({"单位位于 (100,200)", {"方案A", "方案B"}, {"left_flank_exposed", "b"}});
+  const bas::ModelResponse reused =
+      cached_runtime.RankAndExplain({"单位位于 (180,260)", {"方案A ", "方案B"}, {"b", "left_flank_exposed"}});
+  if (server.chat_calls() != chat_before + 1 || reused.selected_index != 1 ||
+      cached_runtime.response_cache_stats().hits != 1 || !cached_runtime.SaveResponseCache()) {
+    std::cerr << "响应缓存未命中，模型调用次数=" << server.chat_calls() - chat_before << "\n";
+    return EXIT_FAILURE;
+  }
+  bas::ModelRuntime reloaded;
+  reloaded.Configure(cached_config);
+  const bas::ModelResponse persisted = reloaded.RankAndExplain({"新上下文", {"方案A", "方案B"}, {"b", "left_flank_exposed"}});
+  std::remove(cached_config.response_cache_path.c_str());
+  if (server.chat_calls() != chat_before + 1 || persisted.explanation != "稳健方案更优" ||
+      reloaded.response_cache_stats().loaded != 1) {
+    std::cerr << "落盘的响应缓存未被加载\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -15,7 +15,7 @@ bas::BattlefieldSnapshot BuildSnapshot(std::int64_t t, int offset) {
   snap.env = {1000.0, 0.1, 0.2};
 
   bas::EntityState f;
-  f.id = "F-1";
+  f.id = bas::EntityId::Intern("F-1");
   f.side = bas::Side::Friendly;
   f.type = bas::UnitType::Armor;
   f.pose = {0.0 + offset, 0.0, 0.0};
@@ -23,7 +23,7 @@ bas::BattlefieldSnapshot BuildSnapshot(std::int64_t t, int offset) {
   snap.friendly_units.push_back(f);
 
   bas::EntityState h;
-  h.id = "H-1";
+  h.id = bas::EntityId::Intern("H-1");
   h.side = bas::Side::Hostile;
   h.type = bas::UnitType::Armor;
   h.pose = {420.0 + offset, 160.0, 0.0};
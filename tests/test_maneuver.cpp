@@ -1,21 +1,24 @@
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <vector>
 
 #include "bas/decision/maneuver_engine.hpp"
+#include "bas/decision/threat_raster.hpp"
 
 int main() {
   bas::BattlefieldSnapshot snap;
   snap.timestamp_ms = 1000000;
 
   bas::EntityState f1;
-  f1.id = "F-1";
+  f1.id = bas::EntityId::Intern("F-1");
   f1.side = bas::Side::Friendly;
   f1.type = bas::UnitType::Infantry;
   f1.pose = {0.0, 0.0, 0.0};
   snap.friendly_units.push_back(f1);
 
   bas::EntityState h1;
-  h1.id = "H-1";
+  h1.id = bas::EntityId::Intern("H-1");
   h1.side = bas::Side::Hostile;
   h1.type = bas::UnitType::Armor;
   h1.pose = {100.0, 80.0, 0.0};
@@ -34,5 +37,94 @@ int main() {
     return EXIT_FAILURE;
   }
 
+  // 增量修正后的栅格应与按新状态整体重算的栅格一致。
+  std::vector<bas::EntityState> hostiles;
+  for (int i = 0; i < 40; ++i) {
+    bas::EntityState h = h1;
+    h.id = bas::EntityId::FromDis(2, 1, static_cast<std::uint16_t>(i + 1));
+    h.type = i % 4 == 0 ? bas::UnitType::Artillery : bas::UnitType::Armor;
+    h.pose = {-1500.0 + 75.0 * i, 900.0 - 40.0 * i, 0.0};
+    hostiles.push_back(h);
+  }
+  bas::ThreatRaster incremental(80.0);
+  incremental.Update(hostiles);
+  incremental.Materialize(-40, 40, -40, 40);
+  hostiles[3].pose.x += 300.0;
+  hostiles[17].threat_level = 0.1;
+  hostiles.pop_back();
+  incremental.Update(hostiles);
+  if (incremental.stats().incremental_updates != 1 || incremental.stats().full_invalidations != 0) {
+    std::cerr << "少量实体变化应走增量修正\n";
+    return EXIT_FAILURE;
+  }
+  bas::ThreatRaster fresh(80.0);
+  fresh.Update(hostiles);
+  for (int cy = -40; cy <= 40; cy += 7) {
+    for (int cx = -40; cx <= 40; cx += 5) {
+      if (std::abs(incremental.SampleCell(cx, cy) - fresh.SampleCell(cx, cy)) > 1e-9) {
+        std::cerr << "增量栅格与重算结果不一致\n";
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // A* 路径沿栅格逐步推进，不超过规划步数，最终到达目标附近。
+  bas::BattlefieldSnapshot far_snap;
+  far_snap.timestamp_ms = 1000000;
+  far_snap.friendly_units.push_back(f1);
+  for (const auto& h : hostiles) {
+    bas::EntityState moved = h;
+    moved.pose.y += 2000.0;
+    far_snap.hostile_units.push_back(moved);
+  }
+  bas::ManeuverEngine planner({450.0, 80.0, 6});
+  const bas::ManeuverDecision planned = planner.Decide(far_snap, {});
+  if (planned.actions.size() != 1 || planned.actions.front().action_name != "advance_bound") {
+    std::cerr << "远距威胁下应执行跃进\n";
+    return EXIT_FAILURE;
+  }
+  const auto& path = planned.actions.front().path;
+  if (path.size() < 2 || path.size() > 8) {
+    std::cerr << "路径步数超出规划范围\n";
+    return EXIT_FAILURE;
+  }
+  for (std::size_t k = 1; k < path.size(); ++k) {
+    if (bas::Distance(path[k - 1], path[k]) > 80.0 * std::sqrt(2.0) + 1e-6) {
+      std::cerr << "路径相邻点间距超过一个栅格步长\n";
+      return EXIT_FAILURE;
+    }
+  }
+
+  // 并行规划结果须与顺序规划逐点一致。
+  bas::BattlefieldSnapshot crowd = far_snap;
+  crowd.friendly_units.clear();
+  for (int i = 0; i < 64; ++i) {
+    bas::EntityState f = f1;
+    f.id = bas::EntityId::FromDis(1, 1, static_cast<std::uint16_t>(i + 1));
+    f.pose = {-1200.0 + 37.0 * i, -300.0 + 11.0 * (i % 9), 0.0};
+    crowd.friendly_units.push_back(f);
+  }
+  bas::ThreadPool pool(3);
+  const bas::ManeuverDecision sequential = bas::ManeuverEngine({450.0, 80.0, 6}).Decide(crowd, {});
+  const bas::ManeuverDecision parallel = bas::ManeuverEngine({450.0, 80.0, 6}, &pool).Decide(crowd, {});
+  if (sequential.actions.size() != parallel.actions.size()) {
+    std::cerr << "并行规划动作数不一致\n";
+    return EXIT_FAILURE;
+  }
+  for (std::size_t i = 0; i < sequential.actions.size(); ++i) {
+    const auto& a = sequential.actions[i];
+    const auto& b = parallel.actions[i];
+    if (a.unit_id != b.unit_id || a.path.size() != b.path.size()) {
+      std::cerr << "并行规划输出顺序或路径长度不一致\n";
+      return EXIT_FAILURE;
+    }
+    for (std::size_t k = 0; k < a.path.size(); ++k) {
+      if (a.path[k].x != b.path[k].x || a.path[k].y != b.path[k].y) {
+        std::cerr << "并行规划路径不一致\n";
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
   return EXIT_SUCCESS;
 }
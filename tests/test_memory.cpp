@@ -1,14 +1,67 @@
 #include <cstdlib>
 #include <iostream>
+#include <random>
+#include <string>
+#include <vector>
 
 #include "bas/memory/event_memory.hpp"
 
+namespace {
+
+bas::EventRecord RandomEvent(std::mt19937& rng, std::int64_t t) {
+  static const char* const kActors[] = {"H-1", "H-2", "H-3", "F-1", "F-2", "fusion"};
+  const std::size_t actor = rng() % 6;
+  if (actor == 5) {
+    return {t, bas::EventType::TacticalTag, bas::EntityId::Intern(kActors[actor]), {},
+            "stable_contact:当前未发现异常战术压力"};
+  }
+  return {t, bas::EventType::WeaponFire, bas::EntityId::Intern(kActors[actor]), {}, {},
+          {bas::EntityId::Intern("F-1"), rng() % 2 == 0 ? bas::WeaponKind::Howitzer : bas::WeaponKind::TankGun,
+           bas::MunitionClass::Unknown}};
+}
+
+// 增量上下文与按同一事件序列一次性构建的结果须逐字节一致，且不超过预算。
+// jitter_ms 使到达顺序与时间戳顺序不一致，覆盖汇总分组时间范围的增量维护。
+bool CheckIncrementalContext(std::size_t budget, std::uint32_t jitter_ms = 0) {
+  std::mt19937 rng(42U);
+  std::vector<bas::EventRecord> log;
+  bas::EventMemory incremental(10 * 60 * 1000, 512, budget);
+  std::int64_t t = 1000000;
+  for (int tick = 1; tick <= 600; ++tick) {
+    t += 1000;
+    for (std::uint32_t i = rng() % 4; i > 0; --i) {
+      log.push_back(RandomEvent(rng, jitter_ms == 0 ? t : t - static_cast<std::int64_t>(rng() % jitter_ms)));
+      incremental.AddEvent(log.back());
+    }
+    const std::string context = incremental.BuildContext(t, 60 * 1000);
+    if (budget > 0 && context.size() > budget) {
+      std::cerr << "上下文超出预算: " << context.size() << " > " << budget << "\n";
+      return false;
+    }
+    if (tick % 50 == 0) {
+      bas::EventMemory fresh(10 * 60 * 1000, 512, budget);
+      fresh.AddEvents(log);
+      if (fresh.BuildContext(t, 60 * 1000) != context) {
+        std::cerr << "增量上下文与全量构建不一致（预算=" << budget << "，第 " << tick << " 轮）\n";
+        return false;
+      }
+      if (budget > 0 && context.find("[汇总]") == std::string::npos) {
+        std::cerr << "超出预算时应折叠较早事件\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 int main() {
   bas::EventMemory memory(5 * 60 * 1000);
   const std::int64_t now_ms = 1000000;
 
-  memory.AddEvent({now_ms - 6 * 60 * 1000, bas::EventType::SensorContact, "U-1", {}, "expired"});
-  memory.AddEvent({now_ms - 30 * 1000, bas::EventType::WeaponFire, "U-2", {}, "fresh"});
+  memory.AddEvent({now_ms - 6 * 60 * 1000, bas::EventType::SensorContact, bas::EntityId::Intern("U-1"), {}, "expired"});
+  memory.AddEvent({now_ms - 30 * 1000, bas::EventType::WeaponFire, bas::EntityId::Intern("U-2"), {}, "fresh"});
 
   const auto recent = memory.QueryRecent(now_ms, 60 * 1000);
   if (recent.size() != 1 || recent.front().message != "fresh") {
@@ -17,7 +70,7 @@ int main() {
   }
 
   const auto last_fire = memory.LastEventByType(bas::EventType::WeaponFire, now_ms, 60 * 1000);
-  if (!last_fire.has_value() || last_fire->actor_id != "U-2") {
+  if (!last_fire.has_value() || last_fire->actor_id != bas::EntityId::Intern("U-2")) {
     std::cerr << "最近开火事件检索失败\n";
     return EXIT_FAILURE;
   }
@@ -28,5 +81,75 @@ int main() {
     return EXIT_FAILURE;
   }
 
+  // 结构化开火事件不存文本，构建上下文时才渲染。
+  memory.AddEvent({now_ms - 10 * 1000, bas::EventType::WeaponFire, bas::EntityId::Intern("H-9"), {}, {},
+                   {bas::EntityId::Intern("F-1"), bas::WeaponKind::Howitzer, bas::MunitionClass::Indirect}});
+  const auto typed_fire = memory.LastEventByType(bas::EventType::WeaponFire, now_ms, 60 * 1000);
+  if (!typed_fire.has_value() || !typed_fire->message.empty() ||
+      typed_fire->fire.target_id != bas::EntityId::Intern("F-1") ||
+      typed_fire->fire.munition != bas::MunitionClass::Indirect ||
+      memory.BuildContext(now_ms, 60 * 1000).find("武器=howitzer，目标=F-1") == std::string::npos) {
+    std::cerr << "结构化开火事件存取或渲染失败\n";
+    return EXIT_FAILURE;
+  }
+
+  // 环形容量：写满后覆盖最旧事件，类型链与参与方链不再指向被覆盖的记录。
+  bas::EventMemory ring(5 * 60 * 1000, 8);
+  for (int i = 0; i < 20; ++i) {
+    const bas::EventType type = i % 4 == 0 ? bas::EventType::UnitLoss : bas::EventType::WeaponFire;
+    ring.AddEvent({now_ms + i, type, i % 2 == 0 ? bas::EntityId::Intern("A-1") : bas::EntityId::Intern("B-1"), {},
+                   "武器=howitzer"});
+  }
+  if (ring.size() != 8 || ring.QueryRecent(now_ms + 20, 60 * 1000).size() != 8 || ring.interned_messages() != 1) {
+    std::cerr << "环形记忆容量或消息驻留异常\n";
+    return EXIT_FAILURE;
+  }
+  const auto losses = ring.QueryByType(bas::EventType::UnitLoss, now_ms + 20, 60 * 1000);
+  if (losses.size() != 2 || losses.front().timestamp_ms != now_ms + 16) {
+    std::cerr << "按类型检索结果错误\n";
+    return EXIT_FAILURE;
+  }
+  std::int64_t expected = now_ms + 19;
+  for (const bas::EventView ev : ring.QueryByActor(bas::EntityId::Intern("B-1"), now_ms + 20, 60 * 1000)) {
+    if (ev.actor_id != bas::EntityId::Intern("B-1") || ev.timestamp_ms != expected) {
+      std::cerr << "按参与方检索结果错误\n";
+      return EXIT_FAILURE;
+    }
+    expected -= 2;
+  }
+  if (expected != now_ms + 11 || !ring.QueryByActor(bas::EntityId::Intern("C-1"), now_ms + 20, 60 * 1000).empty()) {
+    std::cerr << "参与方事件链长度错误\n";
+    return EXIT_FAILURE;
+  }
+  if (ring.QueryByType(bas::EventType::WeaponFire, now_ms + 20, 3).size() != 3) {
+    std::cerr << "类型链未按时间窗口截止\n";
+    return EXIT_FAILURE;
+  }
+
+  // 驻留消息在所有引用事件被覆盖后回收。
+  for (int i = 0; i < 8; ++i) {
+    ring.AddEvent({now_ms + 100 + i, bas::EventType::SensorContact, bas::EntityId::Intern("C-1"), {},
+                   "接触-" + std::to_string(i % 2)});
+  }
+  if (ring.interned_messages() != 2 || ring.QueryByType(bas::EventType::UnitLoss, now_ms + 200,
+                                                        60 * 1000).size() != 0 ||
+      ring.LastEventByType(bas::EventType::SensorContact, now_ms + 200, 60 * 1000)->message != "接触-1") {
+    std::cerr << "覆盖后驻留消息或类型链未更新\n";
+    return EXIT_FAILURE;
+  }
+
+  // 增量上下文：按到达顺序从旧到新拼接，超预算时较早事件按参与方折叠。
+  if (!CheckIncrementalContext(0) || !CheckIncrementalContext(1024) || !CheckIncrementalContext(1024, 5000)) {
+    return EXIT_FAILURE;
+  }
+  bas::EventMemory ordered(5 * 60 * 1000, 64);
+  ordered.AddEvent({now_ms - 2000, bas::EventType::SensorContact, bas::EntityId::Intern("U-1"), {}, "第一条"});
+  ordered.AddEvent({now_ms - 1000, bas::EventType::SensorContact, bas::EntityId::Intern("U-1"), {}, "第二条"});
+  const std::string ordered_context = ordered.BuildContext(now_ms, 60 * 1000);
+  if (ordered_context.find("第一条") > ordered_context.find("第二条")) {
+    std::cerr << "上下文未按到达顺序排列\n";
+    return EXIT_FAILURE;
+  }
+
   return EXIT_SUCCESS;
 }
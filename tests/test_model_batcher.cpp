@@ -0,0 +1,70 @@
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bas/inference/model_batcher.hpp"
+
+int main() {
+  // 8 个线程提交 6 种载荷：窗口内的请求合成一批，重复载荷共享结果，发送批次应少于请求数。
+  bas::ModelBatcher batcher({300, 6});
+  std::atomic<int> send_calls{0};
+  std::atomic<std::size_t> sent_payloads{0};
+  const bas::ModelBatcher::SendFn send = [&](const std::vector<std::string>& payloads) {
+    ++send_calls;
+    sent_payloads += payloads.size();
+    std::vector<bas::ModelBatchReply> replies;
+    for (const auto& payload : payloads) {
+      replies.push_back({"reply:" + payload, {}});
+    }
+    return replies;
+  };
+
+  std::vector<std::string> results(8);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&, i] {
+      const std::string payload = "prompt-" + std::to_string(i % 6);
+      results[i] = batcher.Submit(payload, send).content;
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (int i = 0; i < 8; ++i) {
+    if (results[i] != "reply:prompt-" + std::to_string(i % 6)) {
+      std::cerr << "合批结果与请求错配: " << results[i] << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  const bas::ModelBatchStats stats = batcher.stats();
+  if (stats.requests != 8 || sent_payloads != 8 - stats.deduplicated || stats.batches != static_cast<std::size_t>(send_calls.load()) ||
+      stats.largest_batch > 6) {
+    std::cerr << "合批统计错误: 请求=" << stats.requests << " 去重=" << stats.deduplicated
+              << " 批次=" << stats.batches << "\n";
+    return EXIT_FAILURE;
+  }
+  if (stats.batches >= 8 - stats.deduplicated) {
+    std::cerr << "并发请求未被合批\n";
+    return EXIT_FAILURE;
+  }
+
+  // 发送函数抛异常或返回条目数不符时，每条请求都应得到错误说明而不是挂起。
+  bas::ModelBatcher failing({0, 4});
+  const bas::ModelBatchReply thrown =
+      failing.Submit("x", [](const std::vector<std::string>&) -> std::vector<bas::ModelBatchReply> {
+        throw std::runtime_error("断开");
+      });
+  const bas::ModelBatchReply short_reply =
+      failing.Submit("y", [](const std::vector<std::string>&) { return std::vector<bas::ModelBatchReply>{}; });
+  if (thrown.error.empty() || short_reply.error.empty()) {
+    std::cerr << "合批发送失败未返回错误说明\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
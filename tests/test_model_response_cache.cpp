@@ -0,0 +1,53 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "bas/inference/model_response_cache.hpp"
+
+int main() {
+  // 候选内多余空白与标签顺序、重复不影响键；候选顺序与模型名影响键。
+  const std::string key = bas::ModelResponseCache::MakeKey("qwen", 128, {"方案A  积极", "方案B"}, {"b", "a", "a"});
+  if (key != bas::ModelResponseCache::MakeKey("qwen", 128, {" 方案A 积极\n", "方案B"}, {"a", "b"}) ||
+      key == bas::ModelResponseCache::MakeKey("qwen", 128, {"方案B", "方案A 积极"}, {"a", "b"}) ||
+      key == bas::ModelResponseCache::MakeKey("other", 128, {"方案A 积极", "方案B"}, {"a", "b"})) {
+    std::cerr << "缓存键规范化错误\n";
+    return EXIT_FAILURE;
+  }
+
+  bas::ModelResponseCache cache(2, 1000);
+  cache.Put("k1", {1, "解释\t第一行\n第二行"}, 0);
+  cache.Put("k2", {0, "二"}, 100);
+  if (!cache.Get("k1", 500).has_value()) {
+    std::cerr << "有效期内应命中\n";
+    return EXIT_FAILURE;
+  }
+  // k2 最久未用，插入 k3 时被淘汰。
+  cache.Put("k3", {0, "三"}, 600);
+  if (cache.Get("k2", 600).has_value() || cache.stats().evictions != 1) {
+    std::cerr << "LRU 淘汰错误\n";
+    return EXIT_FAILURE;
+  }
+  if (cache.Get("k1", 1500).has_value() || cache.stats().expired != 1) {
+    std::cerr << "过期条目不应命中\n";
+    return EXIT_FAILURE;
+  }
+
+  const std::string path = "test_model_response_cache.txt";
+  cache.Put("k1", {1, "解释\t第一行\n第二行"}, 1400);
+  if (!cache.Save(path)) {
+    std::cerr << "缓存落盘失败\n";
+    return EXIT_FAILURE;
+  }
+  // k3 写入于 600，在 1700 时已过期，加载时跳过。
+  bas::ModelResponseCache reloaded(8, 1000);
+  const bool loaded = reloaded.Load(path, 1700);
+  std::remove(path.c_str());
+  const auto hit = reloaded.Get("k1", 1700);
+  if (!loaded || reloaded.stats().loaded != 1 || !hit.has_value() || hit->selected_index != 1 ||
+      hit->explanation != "解释\t第一行\n第二行") {
+    std::cerr << "落盘缓存加载结果错误\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -1,5 +1,12 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
+#include <string>
 
 #include "bas/dis/dis_adapter.hpp"
 #include "bas/inference/model_runtime.hpp"
@@ -11,13 +18,31 @@ bas::DisPduBatch BuildBatch(std::int64_t t) {
   bas::DisPduBatch batch;
   batch.env = bas::EnvironmentState{900.0, 0.1, 0.2};
   batch.entity_updates.push_back(
-      {t, "F-1", bas::Side::Friendly, bas::UnitType::Armor, {0.0, 0.0, 0.0}, 5.0, 0.0, true, 0.4});
+      {t, bas::EntityId::Intern("F-1"), bas::Side::Friendly, bas::UnitType::Armor, {0.0, 0.0, 0.0}, 5.0, 0.0, true,
+       0.4});
   batch.entity_updates.push_back(
-      {t, "H-1", bas::Side::Hostile, bas::UnitType::Armor, {400.0, 120.0, 0.0}, 8.0, 180.0, true, 0.9});
-  batch.fire_events.push_back({t - 60000, "H-1", "F-1", "howitzer", {400.0, 120.0, 0.0}});
+      {t, bas::EntityId::Intern("H-1"), bas::Side::Hostile, bas::UnitType::Armor, {400.0, 120.0, 0.0}, 8.0, 180.0,
+       true, 0.9});
+  batch.fire_events.push_back({t - 60000, bas::EntityId::Intern("H-1"), bas::EntityId::Intern("F-1"), "howitzer",
+                               {400.0, 120.0, 0.0}});
   return batch;
 }
 
+// 只监听不应答的本地端口：连接进入内核队列后请求一直挂起，模拟推理缓慢的模型服务。
+int ListenWithoutAccept(std::uint16_t& port) {
+  const int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = 0;
+  ::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+  ::listen(fd, 8);
+  socklen_t len = sizeof(addr);
+  ::getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &len);
+  port = ntohs(addr.sin_port);
+  return fd;
+}
+
 }  // namespace
 
 int main() {
@@ -31,6 +56,13 @@ int main() {
     return EXIT_FAILURE;
   }
 
+  if (snapshot->friendly_table.size() != snapshot->friendly_units.size() ||
+      snapshot->hostile_table.size() != snapshot->hostile_units.size() ||
+      snapshot->hostile_table.x.front() != snapshot->hostile_units.front().pose.x) {
+    std::cerr << "列存实体表与快照实体未对齐\n";
+    return EXIT_FAILURE;
+  }
+
   bas::ModelRuntime model;
   model.Configure({bas::ModelBackend::Mock, "Qwen1.5-1.8B-Chat", 128, true,
                    "http://127.0.0.1:8000/v1/chat/completions", "", 250});
@@ -49,5 +81,74 @@ int main() {
     return EXIT_FAILURE;
   }
 
+  // 流水线自建机动线程池时，机动结果与顺序规划一致。
+  bas::PipelineConfig pooled_config{3000, 5 * 60 * 1000};
+  bas::AgentPipeline unpooled(pooled_config, bas::FireControlEngine{}, bas::ManeuverEngine{}, model);
+  pooled_config.maneuver_threads = 2;
+  bas::AgentPipeline pooled(pooled_config, bas::FireControlEngine{}, bas::ManeuverEngine{}, model);
+  const bas::DecisionPackage unpooled_first = unpooled.Tick(*snapshot, {});
+  const bas::DecisionPackage pooled_first = pooled.Tick(*snapshot, {});
+  if (pooled_first.maneuver.summary != unpooled_first.maneuver.summary ||
+      pooled_first.maneuver.actions.size() != unpooled_first.maneuver.actions.size()) {
+    std::cerr << "机动线程池下的机动决策与顺序规划不一致\n";
+    return EXIT_FAILURE;
+  }
+
+  // 异步模式：首轮立即返回规则方案，模型结果完成后合并回缓存中的同一决策。
+  bas::PipelineConfig async_config{3000, 5 * 60 * 1000};
+  async_config.async_model = true;
+  bas::AgentPipeline async_pipeline(async_config, bas::FireControlEngine{}, bas::ManeuverEngine{}, model);
+  bas::DecisionPackage pending = async_pipeline.Tick(*snapshot, {});
+  if (!pending.model_pending || pending.fire.assignments.empty() || pending.tick_seq == 0) {
+    std::cerr << "异步模式首轮应返回待定的规则方案\n";
+    return EXIT_FAILURE;
+  }
+  const auto updates = async_pipeline.WaitForModelUpdates();
+  if (updates.size() != 1 || !bas::AgentPipeline::ApplyModelUpdate(pending, updates.front()) ||
+      pending.model_pending || pending.explanation != first.explanation) {
+    std::cerr << "异步模型结果未正确合并\n";
+    return EXIT_FAILURE;
+  }
+  const bas::DecisionPackage merged = async_pipeline.Tick(*snapshot, {});
+  if (!merged.from_cache || merged.model_pending || merged.explanation != first.explanation) {
+    std::cerr << "缓存中的决策应已合并模型解释\n";
+    return EXIT_FAILURE;
+  }
+
+  // 模型服务挂起时 Tick 仍须立即返回，且在途请求不超过上限。
+  std::uint16_t port = 0;
+  const int stalled_fd = ListenWithoutAccept(port);
+  bas::ModelRuntime stalled;
+  stalled.Configure({bas::ModelBackend::OpenAICompatible, "Qwen1.5-1.8B-Chat", 128, true,
+                     "http://127.0.0.1:" + std::to_string(port) + "/v1/chat/completions", "", 1500});
+  bas::PipelineConfig stalled_config{0, 5 * 60 * 1000};
+  stalled_config.async_model = true;
+  stalled_config.max_inflight_model_requests = 1;
+  {
+    bas::AgentPipeline stalled_pipeline(stalled_config, bas::FireControlEngine{}, bas::ManeuverEngine{}, stalled);
+    bas::BattlefieldSnapshot moving = *snapshot;
+    for (int i = 0; i < 3; ++i) {
+      moving.timestamp_ms += 1000;
+      moving.hostile_units.front().pose.x -= 50.0;
+      const auto t0 = std::chrono::steady_clock::now();
+      const bas::DecisionPackage pkg = stalled_pipeline.Tick(moving, {});
+      const auto elapsed =
+          std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+      if (elapsed > 200 || pkg.from_cache) {
+        std::cerr << "模型挂起时 Tick 被阻塞，耗时(毫秒)=" << elapsed << "\n";
+        return EXIT_FAILURE;
+      }
+      if (pkg.model_pending != (i == 0)) {
+        std::cerr << "在途模型请求超出上限\n";
+        return EXIT_FAILURE;
+      }
+    }
+    if (stalled_pipeline.inflight_model_requests() != 1) {
+      std::cerr << "在途模型请求计数错误\n";
+      return EXIT_FAILURE;
+    }
+  }
+  ::close(stalled_fd);
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,248 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bas/inference/model_runtime.hpp"
+#include "bas/system/replay_runner.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 本地桩模型服务：单条与批量接口都固定选择候选 0，同一连接上可连续处理多个请求。
+class StubModelServer {
+ public:
+  StubModelServer() {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    ::listen(listen_fd_, 16);
+    socklen_t len = sizeof(addr);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    thread_ = std::thread([this] { Run(); });
+  }
+
+  ~StubModelServer() {
+    ::shutdown(listen_fd_, SHUT_RDWR);
+    ::close(listen_fd_);
+    thread_.join();
+    for (auto& t : connections_) {
+      t.join();
+    }
+  }
+
+  std::string Url() const { return "http://127.0.0.1:" + std::to_string(port_) + "/v1/chat/completions"; }
+
+ private:
+  void Run() {
+    for (;;) {
+      const int fd = ::accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) {
+        return;
+      }
+      connections_.emplace_back([fd] {
+        Serve(fd);
+        ::close(fd);
+      });
+    }
+  }
+
+  static void Serve(int fd) {
+    static const std::string kChoice =
+        "{\"choices\":[{\"message\":{\"content\":"
+        "\"{\\\"selected_index\\\": 0, \\\"explanation\\\": \\\"桩服务排序\\\"}\"}}]}";
+    std::string buffer;
+    char chunk[4096];
+    for (;;) {
+      std::size_t header_end;
+      while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+        const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+          return;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(n));
+      }
+      const std::size_t cl = buffer.find("Content-Length: ");
+      const std::size_t body_len = cl == std::string::npos ? 0 : std::stoul(buffer.substr(cl + 16));
+      while (buffer.size() < header_end + 4 + body_len) {
+        const ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+          return;
+        }
+        buffer.append(chunk, static_cast<std::size_t>(n));
+      }
+      const std::string path = buffer.substr(5, buffer.find(' ', 5) - 5);
+      const std::string body = buffer.substr(header_end + 4, body_len);
+      buffer.erase(0, header_end + 4 + body_len);
+
+      std::string json = kChoice;
+      if (path == "/v1/batch") {
+        json = "{\"responses\":[";
+        for (std::size_t pos = body.find("\"messages\""), count = 0; pos != std::string::npos;
+             pos = body.find("\"messages\"", pos + 1), ++count) {
+          json += (count == 0 ? "" : ",") + kChoice;
+        }
+        json += "]}";
+      }
+      const std::string reply = "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(json.size()) + "\r\n\r\n" + json;
+      ::send(fd, reply.data(), reply.size(), MSG_NOSIGNAL);
+    }
+  }
+
+  int listen_fd_ = -1;
+  std::uint16_t port_ = 0;
+  std::thread thread_;
+  std::vector<std::thread> connections_;
+};
+
+}  // namespace
+
+int main() {
+  const std::string candidate_a = "data/scenarios/demo_replay.bas";
+  const std::string candidate_b = "../data/scenarios/demo_replay.bas";
+  const std::string replay_path = std::ifstream(candidate_a).good() ? candidate_a : candidate_b;
+
+  const fs::path dir = fs::temp_directory_path() / "bas_replay_batch_test";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+  for (const char* name : {"a.bas", "b.bas", "c.bas"}) {
+    fs::copy_file(replay_path, dir / name);
+  }
+  {
+    std::ofstream manifest(dir / "scenarios.txt");
+    manifest << "# 回归场景清单\n\n"
+             << "a.bas\n"
+             << "  c.bas  \n"
+             << "missing.bas\n"
+             << (dir / "b.bas").string() << "\n";
+  }
+
+  const auto from_dir = bas::CollectReplayInputs(dir.string());
+  if (from_dir.size() != 3 || fs::path(from_dir[0]).filename() != "a.bas" ||
+      fs::path(from_dir[2]).filename() != "c.bas") {
+    std::cerr << "目录收集结果不正确\n";
+    return EXIT_FAILURE;
+  }
+  const auto from_manifest = bas::CollectReplayInputs((dir / "scenarios.txt").string());
+  if (from_manifest.size() != 4 || fs::path(from_manifest[1]).filename() != "c.bas" ||
+      fs::path(from_manifest[3]) != dir / "b.bas") {
+    std::cerr << "清单解析结果不正确\n";
+    return EXIT_FAILURE;
+  }
+  bool threw = false;
+  try {
+    bas::CollectReplayInputs((dir / "no_such_manifest.txt").string());
+  } catch (const std::runtime_error&) {
+    threw = true;
+  }
+  if (!threw) {
+    std::cerr << "缺失清单未报错\n";
+    return EXIT_FAILURE;
+  }
+
+  bas::ModelRuntime model;
+  model.Configure({bas::ModelBackend::Mock, "Qwen1.5-1.8B-Chat", 128, true,
+                   "http://127.0.0.1:8000/v1/chat/completions", "", 250});
+  const bas::ReplayOptions options;
+
+  const bas::ReplayRunResult single = bas::RunReplay(replay_path, options, model);
+  if (!single.error.empty() || single.decisions == 0 || single.decision_digest == 0) {
+    std::cerr << "单场景回放失败: " << single.error << "\n";
+    return EXIT_FAILURE;
+  }
+
+  // 结果须与线程数无关：逐场景指标、决策摘要与合并指标一致。
+  const bas::ReplayBatchReport serial = bas::RunReplayBatch(from_manifest, options, model, 1);
+  const bas::ReplayBatchReport parallel = bas::RunReplayBatch(from_manifest, options, model, 4);
+  if (serial.failed != 1 || parallel.failed != 1 || serial.scenarios[2].error.empty()) {
+    std::cerr << "缺失场景应单独记为失败\n";
+    return EXIT_FAILURE;
+  }
+  for (std::size_t i = 0; i < from_manifest.size(); ++i) {
+    const auto& a = serial.scenarios[i];
+    const auto& b = parallel.scenarios[i];
+    if (a.path != from_manifest[i] || b.path != from_manifest[i] || a.error != b.error) {
+      std::cerr << "场景顺序与输入不一致\n";
+      return EXIT_FAILURE;
+    }
+    if (!a.error.empty()) {
+      continue;
+    }
+    if (a.decision_digest != single.decision_digest || b.decision_digest != single.decision_digest ||
+        a.decisions != b.decisions || a.frames != b.frames ||
+        a.metrics.survival_rate != b.metrics.survival_rate ||
+        a.metrics.total_hostile_losses != b.metrics.total_hostile_losses ||
+        a.metrics.hit_contribution_rate != b.metrics.hit_contribution_rate) {
+      std::cerr << "并行回放结果与串行不一致: " << a.path << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  if (serial.decisions != 3 * single.decisions || parallel.decisions != serial.decisions ||
+      parallel.initial_friendly != 3 * single.metrics.initial_friendly_count ||
+      parallel.survival_rate != single.metrics.survival_rate ||
+      parallel.hostile_losses != 3 * single.metrics.total_hostile_losses ||
+      parallel.hit_contribution_rate != serial.hit_contribution_rate) {
+    std::cerr << "合并指标不正确\n";
+    return EXIT_FAILURE;
+  }
+
+  // 启用合批与响应缓存时各场景在开始时派生独立副本、结束即并回：串行回放中后续相同场景全部命中
+  // 先前场景的缓存；并行时命中数随调度变化，但决策结果一致，统计全部并回调用方的运行时。
+  StubModelServer server;
+  bas::ModelConfig stub_config{bas::ModelBackend::OpenAICompatible, "Qwen1.5-1.8B-Chat", 128, true, server.Url(), "",
+                               2000};
+  stub_config.enable_batching = true;
+  stub_config.batch_window_ms = 1;
+  stub_config.enable_response_cache = true;
+  bas::ModelRuntime serial_model;
+  bas::ModelRuntime parallel_model;
+  serial_model.Configure(stub_config);
+  parallel_model.Configure(stub_config);
+  const bas::ReplayBatchReport cached_serial = bas::RunReplayBatch(from_dir, options, serial_model, 1);
+  const bas::ReplayBatchReport cached_parallel = bas::RunReplayBatch(from_dir, options, parallel_model, 3);
+  const bas::ReplayRunResult& reference = cached_serial.scenarios[0];
+  if (cached_serial.failed != 0 || cached_parallel.failed != 0 || reference.model_cache.misses == 0) {
+    std::cerr << "启用模型缓存的批量回放失败\n";
+    return EXIT_FAILURE;
+  }
+  const std::size_t lookups = reference.model_cache.hits + reference.model_cache.misses;
+  std::size_t parallel_requests = 0;
+  for (const auto* batch : {&cached_serial, &cached_parallel}) {
+    for (const auto& run : batch->scenarios) {
+      if (run.decision_digest != reference.decision_digest ||
+          run.model_cache.hits + run.model_cache.misses != lookups) {
+        std::cerr << "启用模型缓存的场景决策不一致: " << run.path << "\n";
+        return EXIT_FAILURE;
+      }
+      if (batch == &cached_serial && &run != &reference && run.model_cache.misses != 0) {
+        std::cerr << "后续场景未复用先完成场景并回的缓存: " << run.path << "\n";
+        return EXIT_FAILURE;
+      }
+      if (batch == &cached_parallel) {
+        parallel_requests += run.model_batch.requests;
+      }
+    }
+  }
+  if (serial_model.response_cache_stats().misses != reference.model_cache.misses ||
+      parallel_model.batch_stats().requests != parallel_requests) {
+    std::cerr << "场景副本统计未并回运行时\n";
+    return EXIT_FAILURE;
+  }
+
+  fs::remove_all(dir);
+  return EXIT_SUCCESS;
+}
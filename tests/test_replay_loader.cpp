@@ -1,9 +1,110 @@
 #include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "bas/system/scenario_replay.hpp"
 
+namespace {
+
+bool SameBatches(const std::vector<bas::DisPduBatch>& a, const std::vector<bas::DisPduBatch>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (std::size_t f = 0; f < a.size(); ++f) {
+    if (a[f].entity_updates.size() != b[f].entity_updates.size() ||
+        a[f].fire_events.size() != b[f].fire_events.size() || a[f].env.has_value() != b[f].env.has_value()) {
+      return false;
+    }
+    if (a[f].env.has_value() && a[f].env->visibility_m != b[f].env->visibility_m) {
+      return false;
+    }
+    for (std::size_t i = 0; i < a[f].entity_updates.size(); ++i) {
+      const auto& x = a[f].entity_updates[i];
+      const auto& y = b[f].entity_updates[i];
+      if (x.timestamp_ms != y.timestamp_ms || x.entity_id != y.entity_id || x.pose.x != y.pose.x ||
+          x.pose.y != y.pose.y || x.alive != y.alive || x.threat_level != y.threat_level) {
+        return false;
+      }
+    }
+    for (std::size_t i = 0; i < a[f].fire_events.size(); ++i) {
+      if (a[f].fire_events[i].shooter_id != b[f].fire_events[i].shooter_id ||
+          a[f].fire_events[i].weapon_name != b[f].fire_events[i].weapon_name) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+std::string LoadError(const std::string& path, const bas::ScenarioReplayLoaderConfig& config) {
+  try {
+    bas::ScenarioReplayLoader(config).LoadBatches(path);
+  } catch (const std::runtime_error& e) {
+    return e.what();
+  }
+  return {};
+}
+
+// 乱序时间戳、同一时间戳分散在多处、CRLF、注释与行尾逗号：并行切块与小缓冲顺序读取须与默认加载逐项一致。
+int CheckChunkedLoading() {
+  const std::filesystem::path path = std::filesystem::temp_directory_path() / "bas_replay_loader_test.bas";
+  {
+    std::ofstream out(path, std::ios::binary);
+    for (int i = 0; i < 600; ++i) {
+      const int ts = 1000 + (i % 37) * 100;
+      if (i % 50 == 0) {
+        out << "# 第" << i << "段\r\n\r\n";
+      }
+      out << "ENTITY, " << ts << ",U-" << i % 11 << ",friendly,armor," << i << ".5,-" << i
+          << ",0,5,90,1,0.25\r\n";
+      if (i % 7 == 0) {
+        out << "FIRE," << ts << ",U-" << i % 11 << ",H-1,w" << i << ",1,2,3,\n";
+      }
+      if (i % 13 == 0) {
+        out << "ENV," << ts << "," << 1000 + i << ",0.1,0.2\n";
+      }
+    }
+  }
+  const auto expected = bas::ScenarioReplayLoader{}.LoadBatches(path.string());
+  if (expected.size() != 37) {
+    std::cerr << "分散时间戳未归并: " << expected.size() << "\n";
+    return EXIT_FAILURE;
+  }
+  bas::ScenarioReplayLoaderConfig small_blocks;
+  small_blocks.block_bytes = 64;
+  bas::ScenarioReplayLoaderConfig parallel;
+  parallel.threads = 4;
+  parallel.min_chunk_bytes = 256;
+  if (!SameBatches(expected, bas::ScenarioReplayLoader(small_blocks).LoadBatches(path.string())) ||
+      !SameBatches(expected, bas::ScenarioReplayLoader(parallel).LoadBatches(path.string()))) {
+    std::cerr << "分块加载结果与顺序加载不一致\n";
+    return EXIT_FAILURE;
+  }
+
+  // 错误行号在各种读取方式下一致；数值须整段合法。
+  {
+    std::ofstream out(path, std::ios::app);
+    for (int i = 0; i < 40; ++i) {
+      out << "ENV,9000,1500,0.1,0.2\n";
+    }
+    out << "ENV,9100,12abc,0.1,0.2\n";
+  }
+  const std::string message = LoadError(path.string(), {});
+  if (message.find("行字段[visibility_m]不是合法浮点数") == std::string::npos ||
+      LoadError(path.string(), small_blocks) != message || LoadError(path.string(), parallel) != message) {
+    std::cerr << "错误行号不一致: " << message << "\n";
+    return EXIT_FAILURE;
+  }
+  std::filesystem::remove(path);
+  return EXIT_SUCCESS;
+}
+
+}  // namespace
+
 int main() {
   const std::string candidate_a = "data/scenarios/demo_replay.bas";
   const std::string candidate_b = "../data/scenarios/demo_replay.bas";
@@ -32,5 +133,5 @@ int main() {
     return EXIT_FAILURE;
   }
 
-  return EXIT_SUCCESS;
+  return CheckChunkedLoading();
 }
@@ -9,21 +9,29 @@ int main() {
 
   bas::BattlefieldSnapshot s1;
   s1.timestamp_ms = 1000;
-  s1.friendly_units.push_back({"F-1", bas::Side::Friendly, bas::UnitType::Armor, {}, 0.0, 0.0, 0.3, true});
-  s1.friendly_units.push_back({"F-2", bas::Side::Friendly, bas::UnitType::Infantry, {}, 0.0, 0.0, 0.2, true});
-  s1.hostile_units.push_back({"H-1", bas::Side::Hostile, bas::UnitType::Armor, {}, 0.0, 0.0, 0.8, true});
+  s1.friendly_units.push_back({bas::EntityId::Intern("F-1"), bas::Side::Friendly, bas::UnitType::Armor, {}, 0.0, 0.0,
+                               0.3, true});
+  s1.friendly_units.push_back({bas::EntityId::Intern("F-2"), bas::Side::Friendly, bas::UnitType::Infantry, {}, 0.0,
+                               0.0, 0.2, true});
+  s1.hostile_units.push_back({bas::EntityId::Intern("H-1"), bas::Side::Hostile, bas::UnitType::Armor, {}, 0.0, 0.0,
+                              0.8, true});
   evaluator.ObserveSnapshot(s1);
 
   bas::DecisionPackage d1;
-  d1.fire.assignments.push_back({"F-1", "H-1", "tank_gun", 0.0, 0.0, 0.0, "stagger_fire", ""});
-  d1.fire.assignments.push_back({"F-2", "H-1", "rifle", 0.0, 0.0, 0.0, "focus_fire", ""});
+  d1.fire.assignments.push_back({bas::EntityId::Intern("F-1"), bas::EntityId::Intern("H-1"), "tank_gun", 0.0, 0.0, 0.0,
+                                 "stagger_fire", ""});
+  d1.fire.assignments.push_back({bas::EntityId::Intern("F-2"), bas::EntityId::Intern("H-1"), "rifle", 0.0, 0.0, 0.0,
+                                 "focus_fire", ""});
   evaluator.ObserveDecision(1000, d1);
 
   bas::BattlefieldSnapshot s2;
   s2.timestamp_ms = 3000;
-  s2.friendly_units.push_back({"F-1", bas::Side::Friendly, bas::UnitType::Armor, {}, 0.0, 0.0, 0.3, true});
-  s2.friendly_units.push_back({"F-2", bas::Side::Friendly, bas::UnitType::Infantry, {}, 0.0, 0.0, 0.2, false});
-  s2.hostile_units.push_back({"H-1", bas::Side::Hostile, bas::UnitType::Armor, {}, 0.0, 0.0, 0.8, false});
+  s2.friendly_units.push_back({bas::EntityId::Intern("F-1"), bas::Side::Friendly, bas::UnitType::Armor, {}, 0.0, 0.0,
+                               0.3, true});
+  s2.friendly_units.push_back({bas::EntityId::Intern("F-2"), bas::Side::Friendly, bas::UnitType::Infantry, {}, 0.0,
+                               0.0, 0.2, false});
+  s2.hostile_units.push_back({bas::EntityId::Intern("H-1"), bas::Side::Hostile, bas::UnitType::Armor, {}, 0.0, 0.0,
+                              0.8, false});
   evaluator.ObserveSnapshot(s2);
 
   const bas::ReplayMetricsResult result = evaluator.Finalize();
@@ -43,8 +51,8 @@ int main() {
     return EXIT_FAILURE;
   }
 
-  const auto it_f1 = result.shooter_kill_contribution.find("F-1");
-  const auto it_f2 = result.shooter_kill_contribution.find("F-2");
+  const auto it_f1 = result.shooter_kill_contribution.find(bas::EntityId::Intern("F-1"));
+  const auto it_f2 = result.shooter_kill_contribution.find(bas::EntityId::Intern("F-2"));
   if (it_f1 == result.shooter_kill_contribution.end() || it_f2 == result.shooter_kill_contribution.end()) {
     std::cerr << "缺少射手贡献统计\n";
     return EXIT_FAILURE;
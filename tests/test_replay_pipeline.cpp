@@ -24,6 +24,10 @@ int main() {
                    "http://127.0.0.1:8000/v1/chat/completions", "", 250});
 
   bas::AgentPipeline pipeline({3000, 5 * 60 * 1000}, bas::FireControlEngine{}, bas::ManeuverEngine{}, model);
+  // 分阶段并行：火力与机动并发执行，结果须与顺序执行逐项一致。
+  bas::PipelineConfig staged_config{3000, 5 * 60 * 1000};
+  staged_config.parallel_stages = true;
+  bas::AgentPipeline staged(staged_config, bas::FireControlEngine{}, bas::ManeuverEngine{}, model);
   bas::DisAdapter adapter;
 
   int decisions = 0;
@@ -35,7 +39,22 @@ int main() {
       continue;
     }
 
-    const auto decision = pipeline.Tick(*snapshot, adapter.DrainEvents());
+    const auto events = adapter.DrainEvents();
+    const auto decision = pipeline.Tick(*snapshot, events);
+    const auto staged_decision = staged.Tick(*snapshot, events);
+    bool same = staged_decision.explanation == decision.explanation &&
+                staged_decision.fire.summary == decision.fire.summary &&
+                staged_decision.fire.assignments.size() == decision.fire.assignments.size() &&
+                staged_decision.maneuver.actions.size() == decision.maneuver.actions.size();
+    for (std::size_t i = 0; same && i < decision.maneuver.actions.size(); ++i) {
+      same = staged_decision.maneuver.actions[i].unit_id == decision.maneuver.actions[i].unit_id &&
+             staged_decision.maneuver.actions[i].next_pose.x == decision.maneuver.actions[i].next_pose.x &&
+             staged_decision.maneuver.actions[i].next_pose.y == decision.maneuver.actions[i].next_pose.y;
+    }
+    if (!same) {
+      std::cerr << "分阶段并行决策与顺序执行不一致\n";
+      return EXIT_FAILURE;
+    }
     if (!decision.fire.assignments.empty() && !decision.maneuver.actions.empty()) {
       ++valid_tactical_decisions;
     }
@@ -50,6 +69,13 @@ int main() {
     std::cerr << "有效战术决策次数过少: " << valid_tactical_decisions << "\n";
     return EXIT_FAILURE;
   }
+  const bas::PipelineStageStats& stages = staged.stage_stats();
+  if (stages.tick.samples != static_cast<std::size_t>(decisions) || stages.fire.samples != stages.maneuver.samples ||
+      stages.fire.samples != stages.model.samples || stages.fire.samples == 0 ||
+      stages.decision.total_ms <= 0.0) {
+    std::cerr << "阶段时延统计缺失\n";
+    return EXIT_FAILURE;
+  }
 
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,346 @@
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bas/common/binary_io.hpp"
+#include "bas/dis/dis_adapter.hpp"
+#include "bas/inference/model_runtime.hpp"
+#include "bas/system/columnar_replay.hpp"
+#include "bas/system/replay_checkpoint.hpp"
+#include "bas/system/replay_runner.hpp"
+#include "bas/system/scenario_replay.hpp"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// 帧间隔大于决策缓存有效期，逐帧决策互不复用，续放结果应与从头回放逐 Tick 一致。
+constexpr int kFrames = 40;
+constexpr std::int64_t kFrameStepMs = 4000;
+
+std::int64_t FrameTs(int k) { return 1000 + k * kFrameStepMs; }
+
+// monotonic=false 时把开火记录的时间戳提前 50 毫秒，同一帧的记录分散在文件中。
+void WriteTextScenario(const fs::path& path, bool monotonic) {
+  std::ofstream out(path);
+  out << "# 定位回放测试场景\n";
+  for (int k = 0; k < kFrames; ++k) {
+    const std::int64_t ts = FrameTs(k);
+    out << "ENV," << ts << "," << (1500 - k * 10) << ",0.2,0.3\n";
+    for (int j = 1; j <= 4; ++j) {
+      const bool alive = k < 12 * j + 5;
+      out << "ENTITY," << ts << ",F-" << j << ",friendly," << (j % 2 == 0 ? "infantry" : "armor") << ","
+          << (j * 20 + k * 5) << "," << (k * 3) << ",0,5,30," << (alive ? 1 : 0) << ",0.3\n";
+    }
+    for (int j = 1; j <= 4; ++j) {
+      const bool alive = k < 9 * j;
+      out << "ENTITY," << ts << ",H-" << j << ",hostile," << (j % 2 == 0 ? "artillery" : "armor") << ","
+          << (600 - k * 8) << "," << (j * 60 - 100) << ",0,7,210," << (alive ? 1 : 0) << ",0.9\n";
+    }
+    if (k % 3 == 0) {
+      out << "FIRE," << (monotonic ? ts : ts - 50) << ",H-" << (k % 4 + 1) << ",F-" << ((k / 3) % 4 + 1)
+          << ",howitzer,-150,140,0\n";
+    }
+  }
+}
+
+void PushU8(std::vector<std::uint8_t>& out, std::uint8_t value) { out.push_back(value); }
+
+void PushU16BE(std::vector<std::uint8_t>& out, std::uint16_t value) {
+  out.push_back(static_cast<std::uint8_t>((value >> 8U) & 0xFFU));
+  out.push_back(static_cast<std::uint8_t>(value & 0xFFU));
+}
+
+void PushU32BE(std::vector<std::uint8_t>& out, std::uint32_t value) {
+  PushU16BE(out, static_cast<std::uint16_t>(value >> 16U));
+  PushU16BE(out, static_cast<std::uint16_t>(value & 0xFFFFU));
+}
+
+void PushF32BE(std::vector<std::uint8_t>& out, float value) {
+  std::uint32_t raw = 0;
+  std::memcpy(&raw, &value, sizeof(raw));
+  PushU32BE(out, raw);
+}
+
+void PushF64BE(std::vector<std::uint8_t>& out, double value) {
+  std::uint64_t raw = 0;
+  std::memcpy(&raw, &value, sizeof(raw));
+  PushU32BE(out, static_cast<std::uint32_t>(raw >> 32U));
+  PushU32BE(out, static_cast<std::uint32_t>(raw & 0xFFFFFFFFU));
+}
+
+void PushHeader(std::vector<std::uint8_t>& out, std::uint8_t pdu_type, std::uint32_t timestamp, std::uint16_t length) {
+  PushU8(out, 7);
+  PushU8(out, 1);
+  PushU8(out, pdu_type);
+  PushU8(out, pdu_type == 1 ? 1 : 2);
+  PushU32BE(out, timestamp);
+  PushU16BE(out, length);
+  PushU16BE(out, 0);
+}
+
+void PushEntityPdu(std::vector<std::uint8_t>& out, std::uint32_t timestamp, std::uint16_t entity, std::uint8_t force,
+                   double x, double y, bool alive) {
+  const std::size_t start = out.size();
+  PushHeader(out, 1, timestamp, 144);
+  PushU16BE(out, 1);
+  PushU16BE(out, 1);
+  PushU16BE(out, entity);
+  PushU8(out, force);
+  PushU8(out, 0);
+  PushU8(out, 1);
+  PushU8(out, 1);
+  PushU16BE(out, 225);
+  PushU8(out, 1);
+  for (int i = 0; i < 3 + 8; ++i) PushU8(out, 0);
+  PushF32BE(out, 3.0f);
+  PushF32BE(out, 4.0f);
+  PushF32BE(out, 0.0f);
+  PushF64BE(out, x);
+  PushF64BE(out, y);
+  PushF64BE(out, 0.0);
+  for (int i = 0; i < 3; ++i) PushF32BE(out, 0.0f);
+  PushU32BE(out, alive ? 0U : (3U << 3U));
+  out.resize(start + 144, 0);
+}
+
+void PushFirePdu(std::vector<std::uint8_t>& out, std::uint32_t timestamp, std::uint16_t shooter, std::uint16_t target) {
+  const std::size_t start = out.size();
+  PushHeader(out, 2, timestamp, 96);
+  for (const std::uint16_t id : {shooter, target}) {
+    PushU16BE(out, 1);
+    PushU16BE(out, 1);
+    PushU16BE(out, id);
+  }
+  for (int i = 0; i < 16; ++i) PushU8(out, 0);
+  PushF64BE(out, 500.0);
+  PushF64BE(out, 100.0);
+  PushF64BE(out, 0.0);
+  out.resize(start + 96, 0);
+}
+
+// 每帧的开火 PDU 推迟到下一帧的实体 PDU 之后发出，乱序窗口内批次跨读块保持打开。
+void WriteDisScenario(const fs::path& path) {
+  std::vector<std::uint8_t> bytes;
+  std::vector<std::uint8_t> deferred;
+  for (int k = 0; k < kFrames; ++k) {
+    const auto ts = static_cast<std::uint32_t>(FrameTs(k));
+    for (std::uint16_t j = 1; j <= 3; ++j) {
+      PushEntityPdu(bytes, ts, j, 1, j * 20.0 + k * 5.0, k * 3.0, k < 12 * j + 5);
+      PushEntityPdu(bytes, ts, static_cast<std::uint16_t>(100 + j), 2, 600.0 - k * 8.0, j * 60.0 - 100.0, k < 9 * j);
+    }
+    bytes.insert(bytes.end(), deferred.begin(), deferred.end());
+    deferred.clear();
+    if (k % 2 == 0) {
+      PushFirePdu(deferred, ts, static_cast<std::uint16_t>(100 + k % 3 + 1), static_cast<std::uint16_t>(k % 3 + 1));
+    }
+  }
+  bytes.insert(bytes.end(), deferred.begin(), deferred.end());
+  std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()),
+                                              static_cast<std::streamsize>(bytes.size()));
+}
+
+bool SameRun(const bas::ReplayRunResult& expected, const bas::ReplayRunResult& actual, const std::string& label) {
+  if (!expected.error.empty() || !actual.error.empty()) {
+    std::cerr << label << ": 回放失败: " << expected.error << actual.error << "\n";
+    return false;
+  }
+  const auto& a = expected.metrics;
+  const auto& b = actual.metrics;
+  if (expected.ticks != actual.ticks || expected.decisions != actual.decisions ||
+      expected.decision_digest != actual.decision_digest) {
+    std::cerr << label << ": Tick 数或决策摘要不一致 (" << expected.ticks << " vs " << actual.ticks << ")\n";
+    return false;
+  }
+  if (a.initial_friendly_count != b.initial_friendly_count || a.final_friendly_alive != b.final_friendly_alive ||
+      a.total_hostile_losses != b.total_hostile_losses || std::fabs(a.hit_contribution_rate - b.hit_contribution_rate) > 1e-9 ||
+      a.shooter_kill_contribution.size() != b.shooter_kill_contribution.size()) {
+    std::cerr << label << ": 回放指标不一致\n";
+    return false;
+  }
+  for (const auto& [shooter, credit] : a.shooter_kill_contribution) {
+    const auto it = b.shooter_kill_contribution.find(shooter);
+    if (it == b.shooter_kill_contribution.end() || std::fabs(it->second - credit) > 1e-9) {
+      std::cerr << label << ": 射手毁伤贡献不一致\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+// 写侧车、按时间段从头回放与从检查点续放三者对比。
+bool CheckSeek(const fs::path& source, const bas::ModelRuntime& model, std::uint32_t reorder_window,
+               std::size_t chunk_bytes, const std::string& label) {
+  bas::ReplayOptions base;
+  base.reorder_window = reorder_window;
+  base.stream_chunk_bytes = chunk_bytes;
+  const fs::path sidecar = source.string() + ".ckpt";
+  fs::remove(sidecar);
+
+  bas::ReplayOptions ranged = base;
+  ranged.from_ms = FrameTs(25);
+  ranged.to_ms = FrameTs(33);
+  const bas::ReplayRunResult cold = bas::RunReplay(source.string(), ranged, model);
+  if (!cold.error.empty() || cold.resumed_from_ms.has_value() || cold.ticks == 0) {
+    std::cerr << label << ": 无侧车的时间段回放异常 " << cold.error << "\n";
+    return false;
+  }
+
+  bas::ReplayOptions writing = base;
+  writing.checkpoint_interval_ms = 3 * kFrameStepMs;
+  const bas::ReplayRunResult full = bas::RunReplay(source.string(), writing, model);
+  if (!full.error.empty() || full.checkpoints_written < 5 || !fs::exists(sidecar)) {
+    std::cerr << label << ": 检查点未写出 " << full.error << "\n";
+    return false;
+  }
+  const bas::ReplayRunResult plain = bas::RunReplay(source.string(), base, model);
+  if (!SameRun(plain, full, label + " 写检查点的全程回放")) {
+    return false;
+  }
+
+  const bas::ReplayRunResult warm = bas::RunReplay(source.string(), ranged, model);
+  if (!warm.resumed_from_ms.has_value() || *warm.resumed_from_ms > FrameTs(25) - 3000 ||
+      warm.frames >= cold.frames) {
+    std::cerr << label << ": 未从检查点续放\n";
+    return false;
+  }
+  if (!SameRun(cold, warm, label + " 续放")) {
+    return false;
+  }
+
+  const bas::ReplayCheckpointReader reader(sidecar.string());
+  if (reader.checkpoint_count() != full.checkpoints_written ||
+      reader.index().entries.empty() == reader.index().monotonic || reader.Find(0).has_value()) {
+    std::cerr << label << ": 侧车内容异常\n";
+    return false;
+  }
+  return true;
+}
+
+bool CheckAdapterRoundTrip() {
+  bas::DisAdapter a;
+  bas::DisPduBatch first;
+  first.entity_updates.push_back({1000, bas::EntityId::Intern("F-1"), bas::Side::Friendly, bas::UnitType::Armor,
+                                  {1, 2, 0}, 5, 30, true, 0.3});
+  first.entity_updates.push_back({1000, bas::EntityId::Intern("N-1"), bas::Side::Neutral, bas::UnitType::Unknown,
+                                  {9, 9, 0}, 0, 0, true, 0.0});
+  first.env = bas::EnvironmentState{800, 0.1, 0.2};
+  a.Ingest(first);
+  a.PollUpdate();
+  a.DrainEvents();
+
+  bas::BinaryWriter out;
+  a.SaveState(out);
+  bas::DisAdapter b;
+  bas::BinaryReader in(out.bytes());
+  b.RestoreState(in);
+  if (in.remaining() != 0) {
+    std::cerr << "适配器状态未完整读取\n";
+    return false;
+  }
+
+  bas::DisPduBatch second;
+  second.entity_updates.push_back({2000, bas::EntityId::Intern("N-1"), bas::Side::Hostile, bas::UnitType::Armor,
+                                   {8, 8, 0}, 3, 10, true, 0.9});
+  a.Ingest(second);
+  b.Ingest(second);
+  const auto ua = a.PollUpdate();
+  const auto ub = b.PollUpdate();
+  if (!ua || !ub || !ub->full_refresh || ua->version != ub->version ||
+      ua->snapshot->hostile_units.size() != 1 || ub->snapshot->hostile_units.size() != 1 ||
+      ub->snapshot->friendly_units.size() != 1 || ub->snapshot->env.visibility_m != 800 ||
+      ub->snapshot->friendly_units[0].weapons.size() != ua->snapshot->friendly_units[0].weapons.size()) {
+    std::cerr << "适配器状态恢复后快照不一致\n";
+    return false;
+  }
+
+  bas::BinaryReader truncated(bas::ByteView(out.bytes().data(), out.bytes().size() / 2));
+  try {
+    bas::DisAdapter c;
+    c.RestoreState(truncated);
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+  std::cerr << "截断的状态数据未报错\n";
+  return false;
+}
+
+}  // namespace
+
+int main() {
+  if (!CheckAdapterRoundTrip()) {
+    return EXIT_FAILURE;
+  }
+
+  const fs::path dir = fs::temp_directory_path() / "bas_replay_seek_test";
+  fs::remove_all(dir);
+  fs::create_directories(dir);
+
+  bas::ModelRuntime model;
+  model.Configure({bas::ModelBackend::Mock, "Qwen1.5-1.8B-Chat", 128, true,
+                   "http://127.0.0.1:8000/v1/chat/completions", "", 250});
+
+  const fs::path text = dir / "seek.bas";
+  WriteTextScenario(text, true);
+  if (!bas::BuildTextFrameIndex(text.string()).monotonic ||
+      bas::BuildTextFrameIndex(text.string()).entries.size() != kFrames) {
+    std::cerr << "文本帧索引不正确\n";
+    return EXIT_FAILURE;
+  }
+  if (!CheckSeek(text, model, 0, 1U << 20U, "文本回放")) {
+    return EXIT_FAILURE;
+  }
+
+  const fs::path scattered = dir / "scattered.bas";
+  WriteTextScenario(scattered, false);
+  if (bas::BuildTextFrameIndex(scattered.string()).monotonic) {
+    std::cerr << "非单调文本未识别\n";
+    return EXIT_FAILURE;
+  }
+  if (!CheckSeek(scattered, model, 0, 1U << 20U, "非单调文本回放")) {
+    return EXIT_FAILURE;
+  }
+
+  const fs::path columnar = dir / "seek.basc";
+  bas::WriteColumnarReplay(bas::ScenarioReplayLoader{}.LoadBatches(text.string()), columnar.string());
+  if (!CheckSeek(columnar, model, 0, 1U << 20U, "列式回放")) {
+    return EXIT_FAILURE;
+  }
+
+  // 小读块让残缺PDU跨块暂存，乱序窗口让批次在检查点处保持打开。
+  const fs::path dis = dir / "seek.dis";
+  WriteDisScenario(dis);
+  if (!CheckSeek(dis, model, 5000, 1000, "DIS回放")) {
+    return EXIT_FAILURE;
+  }
+
+  // 源文件改动后侧车过期，损坏的侧车被忽略，两者都退回从头回放且结果不变。
+  bas::ReplayOptions ranged;
+  ranged.from_ms = FrameTs(25);
+  ranged.to_ms = FrameTs(33);
+  const bas::ReplayRunResult reference = bas::RunReplay(text.string(), ranged, model);
+  std::ofstream(text, std::ios::app) << "# 追加注释\n";
+  const bas::ReplayRunResult stale = bas::RunReplay(text.string(), ranged, model);
+  if (stale.resumed_from_ms.has_value() || !SameRun(reference, stale, "过期侧车")) {
+    std::cerr << "过期侧车未被忽略\n";
+    return EXIT_FAILURE;
+  }
+  fs::resize_file(dis.string() + ".ckpt", 20);
+  bas::ReplayOptions dis_ranged = ranged;
+  dis_ranged.reorder_window = 5000;
+  const bas::ReplayRunResult corrupt = bas::RunReplay(dis.string(), dis_ranged, model);
+  if (!corrupt.error.empty() || corrupt.resumed_from_ms.has_value() || corrupt.ticks == 0) {
+    std::cerr << "损坏侧车未被忽略 " << corrupt.error << "\n";
+    return EXIT_FAILURE;
+  }
+
+  fs::remove_all(dir);
+  std::cout << "test_replay_seek passed\n";
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+
+#include "bas/cache/similarity_index.hpp"
+#include "bas/dis/dis_adapter.hpp"
+#include "bas/inference/model_runtime.hpp"
+#include "bas/system/agent_pipeline.hpp"
+
+namespace {
+
+bas::SituationFeatures RandomFeatures(std::mt19937& rng) {
+  std::uniform_real_distribution<double> value(0.0, 20.0);
+  bas::SituationFeatures f{};
+  for (double& x : f) {
+    x = value(rng);
+  }
+  return f;
+}
+
+std::shared_ptr<const bas::DecisionPackage> Tagged(std::uint64_t seq) {
+  auto pkg = std::make_shared<bas::DecisionPackage>();
+  pkg->tick_seq = seq;
+  return pkg;
+}
+
+bas::DisPduBatch BuildBatch(std::int64_t t, double hostile_x) {
+  bas::DisPduBatch batch;
+  batch.env = bas::EnvironmentState{900.0, 0.1, 0.2};
+  batch.entity_updates.push_back(
+      {t, bas::EntityId::Intern("F-1"), bas::Side::Friendly, bas::UnitType::Armor, {0.0, 0.0, 0.0}, 5.0, 0.0, true,
+       0.4});
+  batch.entity_updates.push_back(
+      {t, bas::EntityId::Intern("H-1"), bas::Side::Hostile, bas::UnitType::Armor, {hostile_x, 120.0, 0.0}, 8.0, 180.0,
+       true, 0.9});
+  return batch;
+}
+
+}  // namespace
+
+int main() {
+  // 阈值内的扰动应以较高概率找回原条目；远离的点不得误报。
+  std::mt19937 rng(17U);
+  bas::SimilarityIndex index(512, 0.5, 10000);
+  std::vector<bas::SituationFeatures> stored;
+  for (std::uint64_t i = 0; i < 400; ++i) {
+    stored.push_back(RandomFeatures(rng));
+    index.Insert(stored.back(), Tagged(i + 1), 1000);
+  }
+  std::normal_distribution<double> jitter(0.0, 0.05);
+  std::size_t found = 0;
+  for (std::size_t i = 0; i < stored.size(); ++i) {
+    bas::SituationFeatures query = stored[i];
+    for (double& x : query) {
+      x += jitter(rng);
+    }
+    const auto match = index.FindNearest(query, 2000);
+    if (match.has_value()) {
+      if (match->value->tick_seq != i + 1 || match->distance > 0.5) {
+        std::cerr << "近邻查询返回了错误条目\n";
+        return EXIT_FAILURE;
+      }
+      ++found;
+    }
+  }
+  if (found < stored.size() * 8 / 10) {
+    std::cerr << "近邻召回过低: " << found << "/" << stored.size() << "\n";
+    return EXIT_FAILURE;
+  }
+  if (index.FindNearest(RandomFeatures(rng), 2000).has_value()) {
+    std::cerr << "远离的特征不应命中\n";
+    return EXIT_FAILURE;
+  }
+  if (index.FindNearest(stored.front(), 1000 + 10001).has_value()) {
+    std::cerr << "过期条目不应命中\n";
+    return EXIT_FAILURE;
+  }
+  // 环形容量：写满后最旧条目被覆盖并从桶中移除。
+  bas::SimilarityIndex small(2, 0.5, 10000);
+  small.Insert(stored[0], Tagged(1), 0);
+  small.Insert(stored[1], Tagged(2), 0);
+  small.Insert(stored[2], Tagged(3), 0);
+  if (small.size() != 2 || small.FindNearest(stored[0], 0).has_value() || !small.FindNearest(stored[2], 0).has_value()) {
+    std::cerr << "环形覆盖未移除最旧条目\n";
+    return EXIT_FAILURE;
+  }
+
+  // 流水线：目标跨网格小幅移动，精确缓存未命中但相似复用命中；弹药耗尽后校验拒绝并重新计算。
+  bas::DisAdapter adapter;
+  adapter.Ingest(BuildBatch(1000000, 400.0));
+  bas::BattlefieldSnapshot snapshot = *adapter.Poll();
+  bas::ModelRuntime model;
+  model.Configure({bas::ModelBackend::Mock, "Qwen1.5-1.8B-Chat", 128, true,
+                   "http://127.0.0.1:8000/v1/chat/completions", "", 250});
+  bas::PipelineConfig config{3000, 5 * 60 * 1000};
+  config.similarity_reuse = true;
+  bas::AgentPipeline pipeline(config, bas::FireControlEngine{}, bas::ManeuverEngine{}, model);
+  const bas::DecisionPackage first = pipeline.Tick(snapshot, {});
+  if (first.from_cache || first.fire.assignments.empty()) {
+    std::cerr << "首轮决策结果无效\n";
+    return EXIT_FAILURE;
+  }
+
+  snapshot.timestamp_ms += 500;
+  snapshot.hostile_units.front().pose.x += 120.0;
+  const bas::DecisionPackage reused = pipeline.Tick(snapshot, {});
+  if (!reused.from_similar || !reused.from_cache || reused.tick_seq != first.tick_seq) {
+    std::cerr << "相近态势应复用上一决策\n";
+    return EXIT_FAILURE;
+  }
+
+  snapshot.timestamp_ms += 500;
+  snapshot.hostile_units.front().pose.x += 120.0;
+  for (auto& weapon : snapshot.friendly_units.front().weapons) {
+    weapon.ammo = 0;
+  }
+  const bas::DecisionPackage recomputed = pipeline.Tick(snapshot, {});
+  if (recomputed.from_cache || recomputed.from_similar || pipeline.similar_stats().rejected != 1 ||
+      pipeline.similar_stats().reused != 1) {
+    std::cerr << "弹药耗尽后不应复用旧决策\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
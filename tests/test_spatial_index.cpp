@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "bas/common/spatial_index.hpp"
+
+namespace {
+
+bas::EntityTable MakeTable(std::size_t count, std::uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> pos(-4000.0, 4000.0);
+  bas::EntityTable table;
+  for (std::size_t i = 0; i < count; ++i) {
+    bas::EntityState unit;
+    // 让部分实体落在同一位置，检验距离相同时的行号次序。
+    unit.pose = (i % 17 == 0 && i > 0) ? bas::Pose{table.x[i - 1], table.y[i - 1], 0.0}
+                                       : bas::Pose{pos(rng), pos(rng), 0.0};
+    table.Append(unit);
+  }
+  return table;
+}
+
+std::vector<bas::SpatialNeighbor> BruteForce(const bas::EntityTable& table, const bas::Pose& point) {
+  std::vector<bas::SpatialNeighbor> all;
+  for (std::size_t i = 0; i < table.size(); ++i) {
+    all.push_back({i, table.DistanceSquared(i, point)});
+  }
+  std::sort(all.begin(), all.end(), [](const bas::SpatialNeighbor& a, const bas::SpatialNeighbor& b) {
+    return a.distance_sq != b.distance_sq ? a.distance_sq < b.distance_sq : a.index < b.index;
+  });
+  return all;
+}
+
+}  // namespace
+
+int main() {
+  const bas::EntityTable table = MakeTable(600, 7U);
+  bas::SpatialGrid grid(250.0);
+  grid.Build(table);
+
+  std::mt19937 rng(11U);
+  std::uniform_real_distribution<double> pos(-6000.0, 6000.0);
+  std::vector<std::size_t> in_radius;
+  std::vector<bas::SpatialNeighbor> knn;
+  for (int q = 0; q < 200; ++q) {
+    const bas::Pose point{pos(rng), pos(rng), 0.0};
+    const auto expected = BruteForce(table, point);
+
+    const double radius = 100.0 + 20.0 * q;
+    std::vector<std::size_t> expected_radius;
+    for (const auto& n : expected) {
+      if (n.distance_sq <= radius * radius) {
+        expected_radius.push_back(n.index);
+      }
+    }
+    std::sort(expected_radius.begin(), expected_radius.end());
+    grid.QueryRadius(point, radius, in_radius);
+    if (in_radius != expected_radius || grid.AnyWithin(point, radius) != !expected_radius.empty()) {
+      std::cerr << "半径查询与暴力扫描不一致，查询序号=" << q << "\n";
+      return EXIT_FAILURE;
+    }
+
+    bas::SpatialNeighbor nearest;
+    if (!grid.Nearest(point, nearest) || nearest.index != expected.front().index) {
+      std::cerr << "最近邻与暴力扫描不一致，查询序号=" << q << "\n";
+      return EXIT_FAILURE;
+    }
+
+    const std::size_t k = 1 + static_cast<std::size_t>(q % 25);
+    grid.Knn(point, k, knn);
+    if (knn.size() != k) {
+      std::cerr << "k近邻数量错误\n";
+      return EXIT_FAILURE;
+    }
+    for (std::size_t i = 0; i < k; ++i) {
+      if (knn[i].index != expected[i].index) {
+        std::cerr << "k近邻与暴力扫描不一致，查询序号=" << q << "\n";
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // 单位数不变但位置已改：未递增代号的列存表视为过期，须按单位列表重建。
+  bas::BattlefieldSnapshot snapshot;
+  bas::EntityState unit;
+  unit.pose = {10.0, 0.0, 0.0};
+  snapshot.friendly_units.push_back(unit);
+  snapshot.hostile_units.push_back(unit);
+  snapshot.RebuildTables();
+  if (&bas::SnapshotIndex(snapshot).friendlies() != &snapshot.friendly_table) {
+    std::cerr << "代号一致的列存表应直接引用\n";
+    return EXIT_FAILURE;
+  }
+  snapshot.friendly_units[0].pose.x = 900.0;
+  snapshot.units_generation++;
+  const bas::SnapshotIndex stale(snapshot);
+  if (&stale.friendlies() == &snapshot.friendly_table || stale.friendlies().x[0] != 900.0) {
+    std::cerr << "单位变化后仍引用了过期列存表\n";
+    return EXIT_FAILURE;
+  }
+
+  bas::SpatialGrid empty_grid;
+  empty_grid.Build(bas::EntityTable{});
+  bas::SpatialNeighbor unused;
+  if (empty_grid.Nearest({0.0, 0.0, 0.0}, unused) || empty_grid.AnyWithin({0.0, 0.0, 0.0}, 1e9)) {
+    std::cerr << "空索引不应返回结果\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "bas/common/thread_pool.hpp"
+
+int main() {
+  bas::ThreadPool pool(4);
+  if (pool.size() != 4 || pool.slot_count() != 8 || pool.CurrentSlot() != pool.slot_count()) {
+    std::cerr << "线程池槽位数不正确\n";
+    return EXIT_FAILURE;
+  }
+
+  std::vector<int> hits(10007, 0);
+  std::atomic<bool> bad_slot{false};
+  pool.ParallelFor(hits.size(), 64, [&](std::size_t begin, std::size_t end, std::size_t slot) {
+    if (slot >= pool.slot_count()) {
+      bad_slot = true;
+    }
+    for (std::size_t i = begin; i < end; ++i) {
+      ++hits[i];
+    }
+  });
+  for (const int h : hits) {
+    if (h != 1) {
+      std::cerr << "ParallelFor 下标未被恰好执行一次\n";
+      return EXIT_FAILURE;
+    }
+  }
+  if (bad_slot) {
+    std::cerr << "执行槽位越界\n";
+    return EXIT_FAILURE;
+  }
+
+  // 嵌套调用：外层块内再次并行，调用线程协助执行，不应死锁。
+  std::atomic<std::size_t> nested_sum{0};
+  pool.ParallelFor(8, 1, [&](std::size_t outer, std::size_t, std::size_t) {
+    pool.ParallelFor(100, 10, [&](std::size_t begin, std::size_t end, std::size_t) {
+      for (std::size_t i = begin; i < end; ++i) {
+        nested_sum += outer * 100 + i;
+      }
+    });
+  });
+  if (nested_sum != 8 * 4950 + 100 * 28 * 100) {
+    std::cerr << "嵌套并行结果错误: " << nested_sum << "\n";
+    return EXIT_FAILURE;
+  }
+
+  bool thrown = false;
+  try {
+    pool.ParallelFor(50, 1, [](std::size_t begin, std::size_t, std::size_t) {
+      if (begin == 37) {
+        throw std::runtime_error("块失败");
+      }
+    });
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  if (!thrown) {
+    std::cerr << "并行块异常未传递给调用方\n";
+    return EXIT_FAILURE;
+  }
+
+  // 并发的外部调用方各自租用不同的外部槽位，调用结束后归还。
+  std::atomic<std::size_t> caller_slots[2] = {{0}, {0}};
+  std::atomic<int> inside{0};
+  std::vector<std::thread> callers;
+  for (int c = 0; c < 2; ++c) {
+    callers.emplace_back([&pool, &caller_slots, &inside, c] {
+      const auto self = std::this_thread::get_id();
+      pool.ParallelFor(2, 1, [&](std::size_t, std::size_t, std::size_t slot) {
+        if (std::this_thread::get_id() == self) {
+          caller_slots[c] = slot;
+          ++inside;
+          // 等另一调用方也进入，确保两次租用重叠。
+          for (int spin = 0; spin < 2000 && inside < 2; ++spin) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          }
+        }
+      });
+    });
+  }
+  for (auto& caller : callers) {
+    caller.join();
+  }
+  if (caller_slots[0] == caller_slots[1] || caller_slots[0] < pool.size() || caller_slots[1] < pool.size() ||
+      caller_slots[0] >= pool.slot_count() || caller_slots[1] >= pool.slot_count() ||
+      pool.CurrentSlot() != pool.slot_count()) {
+    std::cerr << "并发外部调用方共用了槽位: " << caller_slots[0] << "," << caller_slots[1] << "\n";
+    return EXIT_FAILURE;
+  }
+
+  // 独立任务抛出异常时计数，工作线程继续服务。
+  pool.Submit([] { throw std::runtime_error("任务失败"); });
+  std::atomic<int> after_failure{0};
+  pool.ParallelFor(16, 1, [&after_failure](std::size_t, std::size_t, std::size_t) { ++after_failure; });
+  for (int spin = 0; spin < 2000 && pool.failed_tasks() == 0; ++spin) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (pool.failed_tasks() != 1 || after_failure != 16) {
+    std::cerr << "独立任务异常未被隔离\n";
+    return EXIT_FAILURE;
+  }
+
+  std::atomic<int> submitted{0};
+  {
+    bas::ThreadPool short_lived(2);
+    for (int i = 0; i < 100; ++i) {
+      short_lived.Submit([&submitted] { ++submitted; });
+    }
+  }
+  if (submitted != 100) {
+    std::cerr << "析构前未执行完已提交任务\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}